@@ -1,4 +1,32 @@
 #version 460 core 
 
 // this file does not exist and will be created at runtime
-#include "defined_macros.glsl"
\ No newline at end of file
+#include "defined_macros.glsl"
+
+#ifdef USE_BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
+
+#define LIGHT_COUNT 2
+#define IRRADIANCE_COEFFICIENT_COUNT 9
+
+struct LightSource{
+    vec3 position;
+    float intensity;
+    vec3 color;
+    float distance;
+};
+
+// Data that is the same for all shader programs during a frame (updated once per frame).
+layout(std140, binding = 0) uniform FrameData {
+    mat4 viewProjectionMatrix;
+    vec3 cameraPositionInWorldSpace;
+    float ambientLightIntensity;
+    float environmentIntensity;
+    vec4 vIrradianceCoefficients[IRRADIANCE_COEFFICIENT_COUNT]; // spherical harmonics of irradiance divided by pi (RGB)
+};
+
+// Scene's light sources (updated once per frame).
+layout(std140, binding = 1) uniform LightData {
+    LightSource vLightSources[LIGHT_COUNT];
+};
\ No newline at end of file
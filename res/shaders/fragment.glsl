@@ -4,45 +4,60 @@ in vec2 fragmentUv;
 in vec3 fragmentNormal;
 in vec3 fragmentPosition;
 in mat3 tangentBitangentNormalMatrix;
+flat in uint fragmentMaterialIndex;
 
 struct Material {
     vec3 diffuseColor;
-    vec3 specularColor;
     float shininess;
-}; 
+    vec3 specularColor;
+    float padding;
+    uvec2 diffuseTexture; // bindless handles (zero if not used or bindless textures are not supported)
+    uvec2 normalTexture;
+    uvec2 metallicRoughnessTexture;
+    uvec2 emissionTexture;
+};
 
-struct LightSource{
-    vec3 position;
-    vec3 color;
-    float intensity;
-    float distance;
+// Materials of all meshes in the scene, indexed by material index of a mesh.
+layout(std430, binding = 1) readonly buffer MaterialBuffer {
+    Material vMaterials[];
 };
 
-#ifdef USE_DIFFUSE_TEXTURE
+#ifdef USE_BINDLESS_TEXTURES
+vec4 sampleBindlessTexture(uvec2 textureHandle, vec2 uv){
+    if (textureHandle == uvec2(0)){
+        return vec4(0.0F, 0.0F, 0.0F, 1.0F); // same as sampling texture unit without a texture
+    }
+    return texture(sampler2D(textureHandle), uv);
+}
+#define SAMPLE_MATERIAL_TEXTURE(textureName) sampleBindlessTexture(material.textureName, fragmentUv)
+#else
+#define SAMPLE_MATERIAL_TEXTURE(textureName) texture(textureName, fragmentUv)
+#endif
+
+#if defined(USE_DIFFUSE_TEXTURE) && !defined(USE_BINDLESS_TEXTURES)
 layout(binding = 0) uniform sampler2D diffuseTexture;
 #endif
 
-#ifdef USE_NORMAL_TEXTURE
+#if defined(USE_NORMAL_TEXTURE) && !defined(USE_BINDLESS_TEXTURES)
 layout(binding = 1) uniform sampler2D normalTexture;
 #endif
 
-#ifdef USE_METALLIC_ROUGHNESS_TEXTURE
+#if defined(USE_METALLIC_ROUGHNESS_TEXTURE) && !defined(USE_BINDLESS_TEXTURES)
 layout(binding = 2) uniform sampler2D metallicRoughnessTexture;
 #endif
 
-#ifdef USE_EMISSION_TEXTURE
+#if defined(USE_EMISSION_TEXTURE) && !defined(USE_BINDLESS_TEXTURES)
 layout(binding = 3) uniform sampler2D emissionTexture;
 #endif
 
-layout(binding = 4) uniform samplerCube environmentMap;
+// Environment prefiltered with GGX distributions, roughness of a mip level is its index divided by the last index.
+layout(binding = 4) uniform samplerCube specularEnvironmentMap;
 
-#define LIGHT_COUNT 2
+// Scale (red) and bias (green) of F0 in the split-sum approximation of the specular BRDF,
+// indexed by cosine of the view angle (U) and roughness (V).
+layout(binding = 5) uniform sampler2D brdfLookupTexture;
 
-uniform vec3 cameraPositionInWorldSpace;
-uniform float ambientLightIntensity;
-uniform float environmentIntensity;
-uniform Material material;
-uniform LightSource vLightSources[LIGHT_COUNT];
+Material material;
 
 out vec4 color;
 
@@ -74,12 +89,51 @@ vec3 calculateColorFromPointLight(LightSource lightSource, vec3 fragmentNormalUn
     return diffuseLight + specularColor + ambientLightIntensity * fragmentDiffuseColor;
 }
 
+vec3 calculateEnvironmentIrradiance(vec3 fragmentNormalUnit){
+    // Evaluate the first 3 bands of spherical harmonics (coefficients are already convolved with the cosine lobe).
+    vec3 n = fragmentNormalUnit;
+    vec3 irradiance =
+        vIrradianceCoefficients[0].rgb * 0.282095F +
+        vIrradianceCoefficients[1].rgb * (0.488603F * n.y) +
+        vIrradianceCoefficients[2].rgb * (0.488603F * n.z) +
+        vIrradianceCoefficients[3].rgb * (0.488603F * n.x) +
+        vIrradianceCoefficients[4].rgb * (1.092548F * n.x * n.y) +
+        vIrradianceCoefficients[5].rgb * (1.092548F * n.y * n.z) +
+        vIrradianceCoefficients[6].rgb * (0.315392F * (3.0F * n.z * n.z - 1.0F)) +
+        vIrradianceCoefficients[7].rgb * (1.092548F * n.x * n.z) +
+        vIrradianceCoefficients[8].rgb * (0.546274F * (n.x * n.x - n.y * n.y));
+    return max(irradiance, vec3(0.0F));
+}
+
+vec3 calculateColorFromEnvironment(vec3 fragmentNormalUnit, vec3 fragmentDiffuseColor, float metallic, float roughness){
+    vec3 fragmentToCameraDirectionUnit = normalize(cameraPositionInWorldSpace - fragmentPosition);
+    vec3 reflectionDirectionUnit = reflect(-fragmentToCameraDirectionUnit, fragmentNormalUnit);
+    float cosView = max(dot(fragmentNormalUnit, fragmentToCameraDirectionUnit), 0.0F);
+
+    // Calculate diffuse color.
+    vec3 diffuseLight = calculateEnvironmentIrradiance(fragmentNormalUnit) * fragmentDiffuseColor * (1.0F - metallic);
+
+    // Calculate specular color (split-sum approximation).
+    float maxLod = float(textureQueryLevels(specularEnvironmentMap) - 1);
+    vec3 prefilteredColor = textureLod(specularEnvironmentMap, reflectionDirectionUnit, roughness * maxLod).rgb;
+    vec2 brdf = texture(brdfLookupTexture, vec2(cosView, roughness)).rg;
+    vec3 f0 = mix(vec3(0.04F), fragmentDiffuseColor, metallic);
+    vec3 specularLight = prefilteredColor * (f0 * brdf.x + brdf.y);
+
+    return (diffuseLight + specularLight) * environmentIntensity;
+}
+
 void main()
 {
+    // Get material of this mesh.
+    material = vMaterials[fragmentMaterialIndex];
+
     // Calculate normal.
 #ifdef USE_NORMAL_TEXTURE
-    vec3 fragmentNormalUnit = texture(normalTexture, fragmentUv).rgb; // read normal in range [0; 1]
-    fragmentNormalUnit = fragmentNormalUnit * 2.0F - 1.0F; // convert to range [-1; 1]
+    // Normal maps can be compressed to 2 channels (BC5) so reconstruct Z from X and Y.
+    vec3 fragmentNormalUnit;
+    fragmentNormalUnit.xy = SAMPLE_MATERIAL_TEXTURE(normalTexture).rg * 2.0F - 1.0F; // convert to range [-1; 1]
+    fragmentNormalUnit.z = sqrt(max(1.0F - dot(fragmentNormalUnit.xy, fragmentNormalUnit.xy), 0.0F));
     fragmentNormalUnit = normalize(tangentBitangentNormalMatrix * fragmentNormalUnit); // transform normal to world space
 #else
     // Normals may be unnormalized after the rasterization (when they are interpolated).
@@ -92,18 +146,18 @@ void main()
     // Prepare diffuse color.
     vec3 fragmentDiffuseColor = material.diffuseColor;
 #ifdef USE_DIFFUSE_TEXTURE
-    fragmentDiffuseColor *= vec3(texture(diffuseTexture, fragmentUv));
+    fragmentDiffuseColor *= vec3(SAMPLE_MATERIAL_TEXTURE(diffuseTexture));
 #endif
 
 #ifdef USE_EMISSION_TEXTURE
     // Use emission texture as a color texture for now...
-    fragmentDiffuseColor += vec3(texture(emissionTexture, fragmentUv));
+    fragmentDiffuseColor += vec3(SAMPLE_MATERIAL_TEXTURE(emissionTexture));
 #endif
 
     // Prepare specular color.
     vec3 fragmentSpecularColor = material.specularColor;
 #ifdef USE_METALLIC_ROUGHNESS_TEXTURE
-    vec3 fragmentMetallRoughness = texture(metallicRoughnessTexture, fragmentUv).rgb;
+    vec3 fragmentMetallRoughness = SAMPLE_MATERIAL_TEXTURE(metallicRoughnessTexture).rgb;
     fragmentSpecularColor *= vec3(1.0F - fragmentMetallRoughness.g);
 #endif
 
@@ -112,14 +166,13 @@ void main()
         color.xyz += calculateColorFromPointLight(vLightSources[i], fragmentNormalUnit, fragmentDiffuseColor, fragmentSpecularColor);
     }
 
-    // Calculate environment reflection light.
-    vec3 cameraToFragmentDirectionUnit = normalize(fragmentPosition - cameraPositionInWorldSpace);
-    vec3 fragmentReflectionFromEyeDirectionUnit = reflect(cameraToFragmentDirectionUnit, fragmentNormalUnit);
-    vec3 environmentColor = texture(environmentMap, fragmentReflectionFromEyeDirectionUnit).rgb;
-
+    // Calculate environment light.
 #ifdef USE_METALLIC_ROUGHNESS_TEXTURE
-    color.xyz += environmentColor * fragmentMetallRoughness.b * environmentIntensity;
+    float metallic = fragmentMetallRoughness.b;
+    float roughness = fragmentMetallRoughness.g;
 #else
-    color.xyz += environmentColor * environmentIntensity;
+    float metallic = 0.0F;
+    float roughness = sqrt(2.0F / (material.shininess + 2.0F)); // roughness that matches the specular exponent
 #endif
+    color.xyz += calculateColorFromEnvironment(fragmentNormalUnit, fragmentDiffuseColor, metallic, roughness);
 } 
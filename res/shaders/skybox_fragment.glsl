@@ -4,7 +4,7 @@ in vec3 textureCoordinates;
 
 out vec4 color;
 
-uniform samplerCube environmentMap;
+layout(binding = 4) uniform samplerCube environmentMap;
 
 void main()
 {
@@ -1,21 +1,62 @@
 #include "base.glsl"
 
+#ifdef USE_PACKED_VERTICES
+layout (location = 0) in vec3 position; // relative to the mesh's AABB (world matrix converts to model space)
+layout (location = 1) in vec2 packedNormal; // octahedral-encoded
+layout (location = 2) in vec2 uv;
+layout (location = 3) in vec2 packedTangent; // octahedral-encoded
+#else
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 uv;
 layout (location = 3) in vec3 tangent;
+#endif
 
 out vec3 fragmentPosition;
 out vec3 fragmentNormal;
 out vec2 fragmentUv;
 out mat3 tangentBitangentNormalMatrix;
+flat out uint fragmentMaterialIndex;
+
+struct MeshInstanceData {
+    mat4 worldMatrix;
+    mat4 normalMatrix; // only 3x3 part is used
+    uint iMaterialIndex;
+};
+
+// Data of all meshes drawn this frame, a draw command specifies the index of its mesh as the base instance.
+layout(std430, binding = 0) readonly buffer MeshInstanceBuffer {
+    MeshInstanceData vMeshInstances[];
+};
+
+#ifdef USE_PACKED_VERTICES
+// Decodes a unit vector that was encoded using octahedral mapping.
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 vector = vec3(encoded, 1.0F - abs(encoded.x) - abs(encoded.y));
+
+    // Unfold the lower hemisphere.
+    float fold = max(-vector.z, 0.0F);
+    vector.x += vector.x >= 0.0F ? -fold : fold;
+    vector.y += vector.y >= 0.0F ? -fold : fold;
 
-uniform mat4 worldMatrix;
-uniform mat3 normalMatrix;
-uniform mat4 viewProjectionMatrix;
+    return normalize(vector);
+}
+#endif
 
 void main()
 {
+#ifdef USE_PACKED_VERTICES
+    // Decode vertex vectors.
+    vec3 normal = decodeOctahedral(packedNormal);
+    vec3 tangent = decodeOctahedral(packedTangent);
+#endif
+
+    // Get matrices of this mesh.
+    MeshInstanceData meshInstance = vMeshInstances[gl_BaseInstance + gl_InstanceID];
+    mat4 worldMatrix = meshInstance.worldMatrix;
+    mat3 normalMatrix = mat3(meshInstance.normalMatrix);
+
     // Calculate position in world space.
     vec4 positionInWorldSpace = worldMatrix * vec4(position, 1.0F);
 
@@ -26,6 +67,7 @@ void main()
     fragmentPosition = positionInWorldSpace.xyz;
     fragmentNormal = normalMatrix * normal;
     fragmentUv = uv;
+    fragmentMaterialIndex = meshInstance.iMaterialIndex;
 
     // Calculate vectors for TBN matrix.
     vec3 tangentUnit = normalize(normalMatrix * tangent);
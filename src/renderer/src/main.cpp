@@ -1,5 +1,9 @@
 // Standard.
 #include <iostream>
+#include <format>
+#include <string>
+#include <string_view>
+#include <optional>
 
 // Custom.
 #include "Application.h"
@@ -10,18 +14,65 @@
 #include <crtdbg.h>
 #endif
 
-int main() {
+/**
+ * Parses command line arguments for headless rendering.
+ *
+ * Expected usage: `--headless <path to GLTF/GLB> [--frames N] [--size WIDTHxHEIGHT] [--output DIR] [--egl]`.
+ *
+ * @param iArgCount Number of arguments.
+ * @param pArgs     Arguments.
+ *
+ * @return Empty if the app should be started normally (with a window), otherwise headless parameters.
+ */
+std::optional<Application::HeadlessParameters> parseHeadlessParameters(int iArgCount, char** pArgs) {
+    std::optional<Application::HeadlessParameters> parameters;
+
+    for (int i = 1; i < iArgCount; i++) {
+        const std::string_view sArgument = pArgs[i]; // NOLINT: pointer arithmetic
+        const auto bHasValue = i + 1 < iArgCount;
+
+        if (sArgument == "--headless" && bHasValue) {
+            parameters = Application::HeadlessParameters{};
+            parameters->pathToModel = pArgs[++i]; // NOLINT: pointer arithmetic
+        } else if (sArgument == "--frames" && bHasValue && parameters.has_value()) {
+            parameters->iFrameCount = std::stoull(pArgs[++i]); // NOLINT: pointer arithmetic
+        } else if (sArgument == "--size" && bHasValue && parameters.has_value()) {
+            const std::string sSize = pArgs[++i]; // NOLINT: pointer arithmetic
+            const auto iSeparatorPos = sSize.find('x');
+            if (iSeparatorPos == std::string::npos) {
+                throw std::runtime_error("expected the size to be specified as WIDTHxHEIGHT");
+            }
+            parameters->iWidth = std::stoi(sSize.substr(0, iSeparatorPos));
+            parameters->iHeight = std::stoi(sSize.substr(iSeparatorPos + 1));
+        } else if (sArgument == "--output" && bHasValue && parameters.has_value()) {
+            parameters->pathToOutputDirectory = pArgs[++i]; // NOLINT: pointer arithmetic
+        } else if (sArgument == "--egl" && parameters.has_value()) {
+            parameters->bUseEglContext = true;
+        } else {
+            throw std::runtime_error(std::format("unexpected command line argument \"{}\"", sArgument));
+        }
+    }
+
+    return parameters;
+}
+
+int main(int iArgCount, char** pArgs) {
     // Enable run-time memory check for debug builds (on Windows).
 #if defined(WIN32) && defined(DEBUG)
     _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 #elif defined(WIN32) && !defined(DEBUG)
     OutputDebugStringA("Using release build configuration, memory checks are disabled.");
 #endif
-    
+
     // Run app.
     Application app;
     try {
-        app.run();
+        const auto headlessParameters = parseHeadlessParameters(iArgCount, pArgs);
+        if (headlessParameters.has_value()) {
+            app.runHeadless(*headlessParameters);
+        } else {
+            app.run();
+        }
     } catch (const std::exception& exception) {
         std::cerr << exception.what() << std::endl;
         return 1;
@@ -4,6 +4,10 @@
 #include <format>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
 
 // Custom.
 #include "window/GLFW.hpp"
@@ -11,11 +15,15 @@
 #include "import/MeshImporter.h"
 #include "window/ImGuiWindow.hpp"
 #include "shader/ShaderUniformHelpers.hpp"
+#include "shader/UniformBuffer.h"
+#include "shader/PersistentStorageBuffer.h"
+#include "GeometryBuffer.h"
 
 // External.
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "tinygltf/stb_image_write.h"
 
 void GLAPIENTRY opengGlMessageCallback(
     GLenum source,
@@ -80,39 +88,63 @@ void Application::run() {
     initWindow();
     setupImGui();
     initOpenGl();
+    initRenderResources();
 
-    createFramebuffers();
+    mainLoop();
 
-    // Prepare environment map.
-    iSkyboxCubemapId = TextureImporter::loadCubemap("res/skybox");
-    iSkyboxShaderProgramId = compileSkyboxShaderProgram();
-    pSkyboxMesh = std::move(MeshImporter::importMesh("res/skybox/skybox.glb")[0]);
+    shutdownImGui();
+}
 
-    // Prepare post-processing shader program.
-    iPostProcessingShaderProgramId = compilePostProcessShaderProgram();
+void Application::runHeadless(const HeadlessParameters& parameters) {
+    // Make sure we have something to render.
+    if (parameters.iFrameCount == 0) [[unlikely]] {
+        throw std::runtime_error("expected the number of frames to render to be positive");
+    }
+    if (parameters.iWidth <= 0 || parameters.iHeight <= 0) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "expected the image size to be positive, specified size: {}x{}",
+            parameters.iWidth,
+            parameters.iHeight));
+    }
 
-    // Prepare screen quad.
-    createScreenQuad();
+    // Save parameters.
+    headlessParameters = parameters;
 
-    mainLoop();
+    // Create camera.
+    pCamera = std::make_unique<Camera>();
 
-    shutdownImGui();
+    initWindow();
+    initOpenGl();
+    initRenderResources();
+
+    headlessLoop();
 }
 
 void Application::initWindow() {
     // Initialize GLFW.
-    GLFW::get();
+    GLFW::get(headlessParameters.has_value());
+
+    if (headlessParameters.has_value()) {
+        if (headlessParameters->bUseEglContext) {
+            // Use EGL instead of the default offscreen context API.
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
 
-    // Create maximized window.
-    glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
+        // Create invisible window of the requested size.
+        pGLFWWindow = glfwCreateWindow(
+            headlessParameters->iWidth, headlessParameters->iHeight, "OpenGL", nullptr, nullptr);
+    } else {
+        // Create maximized window.
+        glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
 
-    // Get main monitor.
-    const auto pMonitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* pMode = glfwGetVideoMode(pMonitor);
+        // Get main monitor.
+        const auto pMonitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* pMode = glfwGetVideoMode(pMonitor);
 
-    // Create GLFW window.
-    pGLFWWindow =
-        glfwCreateWindow(pMode->width, pMode->height, "OpenGL", nullptr, nullptr); // NOLINT: magic number
+        // Create GLFW window.
+        pGLFWWindow = glfwCreateWindow(
+            pMode->width, pMode->height, "OpenGL", nullptr, nullptr); // NOLINT: magic number
+    }
     if (pGLFWWindow == nullptr) {
         throw std::runtime_error("failed to create window");
     }
@@ -153,6 +185,63 @@ void Application::initWindow() {
     glfwSetKeyCallback(pGLFWWindow, Application::glfwWindowKeyboardCallback);
 }
 
+void Application::initRenderResources() {
+    createFramebuffers();
+
+    // Prepare buffer for vertices/indices of all meshes.
+    pGeometryBuffer = GeometryBuffer::create(
+        VertexFormat::FULL, iInitialGeometryVertexCapacity, iInitialGeometryIndexCapacity);
+    pPackedGeometryBuffer = GeometryBuffer::create(
+        VertexFormat::PACKED, iInitialGeometryVertexCapacity, iInitialGeometryIndexCapacity);
+
+    // Prepare uploader for texture pixels.
+    pTextureUploader = TextureUploader::create(TextureUploader::iDefaultStagingSizeInBytes);
+    pTextureStreamer = TextureStreamer::create();
+
+    // Prepare environment map and lighting.
+    const auto pSkyboxFaces = TextureImporter::decodeCubemap("res/skybox");
+    pEnvironmentLighting = EnvironmentLighting::create(*pSkyboxFaces, pTextureUploader.get());
+    pSkyboxCubemap = TextureImporter::loadCubemap(pSkyboxFaces, pTextureUploader.get());
+    iSkyboxShaderProgramId = compileSkyboxShaderProgram();
+    iSkyboxViewProjectionMatrixLocation = static_cast<int>(
+        ShaderUniformHelpers::getUniformLocation(iSkyboxShaderProgramId, "viewProjectionMatrix"));
+    pSkyboxMesh = std::move(MeshImporter::importMesh(
+        "res/skybox/skybox.glb", pGeometryBuffer.get(), nullptr, &textureCache)[0]);
+
+    // Prepare post-processing shader program.
+    iPostProcessingShaderProgramId = compilePostProcessShaderProgram();
+
+    // Query uniform locations once so that we don't need to do this while drawing.
+    iPostProcessingGammaLocation =
+        static_cast<int>(ShaderUniformHelpers::getUniformLocation(iPostProcessingShaderProgramId, "gamma"));
+    iPostProcessingExposureLocation = static_cast<int>(
+        ShaderUniformHelpers::getUniformLocation(iPostProcessingShaderProgramId, "exposure"));
+    iPostProcessingTonemappingLocation = static_cast<int>(
+        ShaderUniformHelpers::getUniformLocation(iPostProcessingShaderProgramId, "bEnableTonemapping"));
+
+    // Prepare screen quad.
+    createScreenQuad();
+
+    // Prepare uniform buffers shared by all shader programs.
+    pFrameUniformBuffer = UniformBuffer::create(
+        static_cast<unsigned int>(UniformBlockBinding::FRAME_DATA), sizeof(FrameUniformData));
+    pLightUniformBuffer = UniformBuffer::create(
+        static_cast<unsigned int>(UniformBlockBinding::LIGHT_DATA), sizeof(LightUniformData));
+
+    // Prepare storage buffer for matrices of meshes.
+    pMeshInstanceBuffer = PersistentStorageBuffer::create(
+        static_cast<unsigned int>(StorageBlockBinding::MESH_INSTANCE_DATA),
+        sizeof(MeshInstanceData),
+        iInitialMeshInstanceCapacity);
+
+    // Prepare buffer for indirect draw commands (one command per mesh).
+    pDrawCommandBuffer = PersistentStorageBuffer::create(
+        std::nullopt, sizeof(DrawElementsIndirectCommand), iInitialMeshInstanceCapacity);
+
+    // Prepare storage buffer for materials of meshes.
+    pMaterialBuffer = MaterialBuffer::create();
+}
+
 void Application::createFramebuffers() {
     // Remove previous objects (if existed).
     glDeleteFramebuffers(1, &iRenderFramebufferId);
@@ -250,7 +339,7 @@ void Application::createScreenQuad() {
     vertex.uv = glm::vec2(1.0F, 1.0F);
     vVertices.push_back(vertex);
 
-    pScreenQuadMesh = Mesh::create(std::move(vVertices), {0, 1, 2, 0, 2, 3});
+    pScreenQuadMesh = Mesh::create(std::move(vVertices), {0, 1, 2, 0, 2, 3}, pGeometryBuffer.get());
 }
 
 void Application::initOpenGl() {
@@ -275,6 +364,9 @@ void Application::initOpenGl() {
 
     // Enable MSAA.
     glEnable(GL_MULTISAMPLE);
+
+    // Filter across cubemap faces (noticeable on small levels of the prefiltered environment).
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 }
 
 void Application::mainLoop() {
@@ -296,6 +388,12 @@ void Application::mainLoop() {
         ImGui::NewFrame();
         ImGuiWindow::drawWindow(this);
 
+        // Add meshes of the model that is being imported (if any).
+        updateSceneImport(sceneImportUploadBudgetInMs);
+
+        // Copy pixels of loaded textures to the GPU.
+        pTextureUploader->update(TextureUploader::iDefaultFrameBudgetInBytes);
+
         // Apply rotation from ImGui slider.
         setModelRotation(modelRotationToApply);
 
@@ -306,6 +404,9 @@ void Application::mainLoop() {
 
         drawNextFrame();
 
+        // Load mip levels that textures need for sizes they had during this frame.
+        updateTextureStreaming();
+
         // Finish drawing the Dear ImGui frame.
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -315,63 +416,270 @@ void Application::mainLoop() {
     }
 }
 
+void Application::headlessLoop() {
+    using namespace std::chrono;
+
+    // Prepare output directory.
+    const auto& pathToOutputDirectory = headlessParameters->pathToOutputDirectory;
+    std::filesystem::create_directories(pathToOutputDirectory);
+
+    // Import the model to render.
+    prepareScene(headlessParameters->pathToModel);
+    std::cout << std::format(
+                     "imported \"{}\" using {} worker thread(s){}, parse: {:.3f} ms, image decode: "
+                     "{:.3f} ms, primitive decode: {:.3f} ms, upload: {:.3f} ms",
+                     headlessParameters->pathToModel.string(),
+                     stats.lastImport.iWorkerThreadCount,
+                     stats.lastImport.bIsLoadedFromCache ? " (from mesh cache)" : "",
+                     stats.lastImport.parseTimeInMs,
+                     stats.lastImport.imageDecodeTimeInMs,
+                     stats.lastImport.primitiveDecodeTimeInMs,
+                     stats.lastImport.uploadTimeInMs)
+              << std::endl;
+    if (!stats.lastImport.bIsLoadedFromCache) {
+        std::cout << std::format(
+                         "vertex cache optimization: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                         stats.lastImport.vertexCacheBeforeOptimization.getAcmr(),
+                         stats.lastImport.vertexCacheAfterOptimization.getAcmr(),
+                         stats.lastImport.vertexCacheBeforeOptimization.getAtvr(),
+                         stats.lastImport.vertexCacheAfterOptimization.getAtvr())
+                  << std::endl;
+    }
+
+    // Prepare a file to write frame timings to.
+    const auto pathToTimingsFile = pathToOutputDirectory / "timings.csv";
+    std::ofstream timingsFile(pathToTimingsFile);
+    if (!timingsFile.is_open()) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("failed to create the file \"{}\"", pathToTimingsFile.string()));
+    }
+    timingsFile << "frame,cpu_time_ms,gpu_time_ms\n";
+
+    // Prepare a query to measure the time the GPU spent on a frame.
+    unsigned int iTimerQueryId = 0;
+    glGenQueries(1, &iTimerQueryId);
+
+    // Use a fixed time step (instead of the real time) to produce the same frames on each run.
+    constexpr float timeStepInSec = 1.0F / 60.0F; // NOLINT: 60 FPS
+
+    double totalCpuTimeInMs = 0.0;
+    double totalGpuTimeInMs = 0.0;
+    for (size_t iFrameIndex = 0; iFrameIndex < headlessParameters->iFrameCount; iFrameIndex++) {
+        const auto frameStartTime = steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, iTimerQueryId);
+
+        // Apply rotation and notify camera.
+        setModelRotation(modelRotationToApply);
+        pCamera->onBeforeNewFrame(timeStepInSec);
+
+        drawNextFrame();
+
+        glEndQuery(GL_TIME_ELAPSED);
+        const auto cpuTimeInMs = duration<double, std::milli>(steady_clock::now() - frameStartTime).count();
+
+        // Wait for the GPU to finish the frame.
+        GLuint64 iGpuTimeInNs = 0;
+        glGetQueryObjectui64v(iTimerQueryId, GL_QUERY_RESULT, &iGpuTimeInNs);
+        const auto gpuTimeInMs = static_cast<double>(iGpuTimeInNs) / 1000000.0; // NOLINT: ns to ms
+
+        // Save the frame.
+        saveDefaultFramebufferToDisk(pathToOutputDirectory / std::format("frame_{:04}.png", iFrameIndex));
+        glfwSwapBuffers(pGLFWWindow);
+
+        // Load needed mip levels before the next frame (to produce the same frames on each run).
+        updateTextureStreaming();
+        pTextureUploader->update({});
+
+        // Save timings.
+        timingsFile << std::format("{},{:.3f},{:.3f}\n", iFrameIndex, cpuTimeInMs, gpuTimeInMs);
+        totalCpuTimeInMs += cpuTimeInMs;
+        totalGpuTimeInMs += gpuTimeInMs;
+    }
+
+    glDeleteQueries(1, &iTimerQueryId);
+
+    const auto frameCount = static_cast<double>(headlessParameters->iFrameCount);
+    std::cout << std::format(
+                     "rendered {} frame(s) to \"{}\", average CPU time: {:.3f} ms, average GPU time: "
+                     "{:.3f} ms",
+                     headlessParameters->iFrameCount,
+                     pathToOutputDirectory.string(),
+                     totalCpuTimeInMs / frameCount,
+                     totalGpuTimeInMs / frameCount)
+              << std::endl;
+}
+
+void Application::saveDefaultFramebufferToDisk(const std::filesystem::path& pathToImage) const {
+    // Get framebuffer size.
+    int iWidth = -1;
+    int iHeight = -1;
+    glfwGetWindowSize(pGLFWWindow, &iWidth, &iHeight);
+
+    // Read pixels of the frame that we are about to present.
+    constexpr int iChannelCount = 3;
+    std::vector<unsigned char> vPixels(static_cast<size_t>(iWidth) * iHeight * iChannelCount);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1); // rows are tightly packed
+    glReadPixels(0, 0, iWidth, iHeight, GL_RGB, GL_UNSIGNED_BYTE, vPixels.data());
+
+    // Write image (OpenGL's first row is the bottom one).
+    stbi_flip_vertically_on_write(1);
+    const auto iResult = stbi_write_png(
+        pathToImage.string().c_str(),
+        iWidth,
+        iHeight,
+        iChannelCount,
+        vPixels.data(),
+        iWidth * iChannelCount);
+    if (iResult == 0) [[unlikely]] {
+        throw std::runtime_error(std::format("failed to write image to \"{}\"", pathToImage.string()));
+    }
+}
+
 void Application::prepareScene(const std::filesystem::path& pathToModel) {
-    // Clear current scene.
+    loadSceneAsync(pathToModel);
+
+    // Wait for worker threads and then add all meshes at once.
+    pSceneImport->waitUntilDecoded();
+    updateSceneImport({});
+
+    // Copy all texture pixels before the first frame.
+    pTextureUploader->update({});
+}
+
+void Application::loadSceneAsync(const std::filesystem::path& pathToModel) {
+    // Cancel the previous import (keep its displayed meshes until the new model is ready).
+    pSceneImport = MeshImporter::importMeshAsync(pathToModel);
+    bIsSceneImportDisplayed = false;
+}
+
+void Application::cancelSceneImport() {
+    if (pSceneImport == nullptr) {
+        return;
+    }
+
+    stats.lastImport = pSceneImport->getStatistics();
+    pSceneImport = nullptr;
+}
+
+std::optional<float> Application::getSceneImportProgress() const {
+    if (pSceneImport == nullptr) {
+        return {};
+    }
+
+    return pSceneImport->getProgress();
+}
+
+void Application::updateSceneImport(std::optional<float> uploadTimeBudgetInMs) {
+    if (pSceneImport == nullptr) {
+        return;
+    }
+
+    auto vImportedMeshes = pSceneImport->uploadReadyMeshes(
+        pGeometryBuffer.get(),
+        bUsePackedVertices ? pPackedGeometryBuffer.get() : nullptr,
+        &textureCache,
+        pTextureUploader.get(),
+        pTextureStreamer.get(),
+        uploadTimeBudgetInMs);
+    const auto bIsFinished = pSceneImport->isFinished();
+
+    // Replace old displayed models once the new model has something to display.
+    if (!bIsSceneImportDisplayed && (!vImportedMeshes.empty() || bIsFinished)) {
+        clearScene();
+        setCameraToCaptureModel(pSceneImport->getLargestMeshSize().value_or(0.0F));
+        bIsSceneImportDisplayed = true;
+    }
+
+    if (!vImportedMeshes.empty()) {
+        addMeshesToScene(std::move(vImportedMeshes));
+    }
+
+    if (bIsFinished) {
+        stats.lastImport = pSceneImport->getStatistics();
+        pSceneImport = nullptr;
+    }
+}
+
+void Application::updateTextureStreaming() {
+    // Geometry of displayed meshes can't be released so textures use the rest of the budget.
+    const auto iBudgetInBytes = static_cast<size_t>(std::max(iVideoMemoryBudgetInMb, 0)) * 1024 * 1024;
+    const auto iGeometrySizeInBytes = getGeometrySizeInBytes();
+    const auto iTextureBudgetInBytes =
+        iBudgetInBytes > iGeometrySizeInBytes ? iBudgetInBytes - iGeometrySizeInBytes : 0;
+    if (!pTextureStreamer->update(iTextureBudgetInBytes, pTextureUploader.get(), pMaterialBuffer.get())) {
+        return;
+    }
+
+    // Reference new texture objects of replaced textures.
+    if (pMaterialBuffer->isUsingBindlessTextures()) {
+        pMaterialBuffer->setMaterials(std::vector<Material*>(sceneMaterials.begin(), sceneMaterials.end()));
+    }
+}
+
+void Application::clearScene() {
+    // Release texture handles before textures are deleted.
+    pMaterialBuffer->clear();
+    sceneMaterials.clear();
     meshesToDraw.clear();
+}
+
+void Application::addMeshesToScene(std::vector<std::unique_ptr<Mesh>>&& vMeshes) {
+    // Collect new unique materials (meshes can share materials).
+    bool bHasNewMaterials = false;
+    for (const auto& pMesh : vMeshes) {
+        bHasNewMaterials |= sceneMaterials.insert(pMesh->pMaterial.get()).second;
+    }
 
-    // Import meshes from file.
-    auto vImportedMeshes = MeshImporter::importMesh(pathToModel);
+    // Store all materials of the scene in the material buffer.
+    if (bHasNewMaterials) {
+        pMaterialBuffer->setMaterials(std::vector<Material*>(sceneMaterials.begin(), sceneMaterials.end()));
+    }
 
-    // See which macros we need to define.
-    std::unordered_set<ShaderProgramMacro> macros;
-    for (const auto& pMesh : vImportedMeshes) {
-        if (pMesh->material.iDiffuseTextureId > 0) {
+    for (auto& pMesh : vMeshes) {
+        // See which macros we need to define.
+        std::unordered_set<ShaderProgramMacro> macros;
+        if (pMaterialBuffer->isUsingBindlessTextures()) {
+            macros.insert(ShaderProgramMacro::USE_BINDLESS_TEXTURES);
+        }
+        if (pMesh->pMaterial->pDiffuseTexture != nullptr) {
             macros.insert(ShaderProgramMacro::USE_DIFFUSE_TEXTURE);
         }
-        if (pMesh->material.iNormalTextureId > 0) {
+        if (pMesh->pMaterial->pNormalTexture != nullptr) {
             macros.insert(ShaderProgramMacro::USE_NORMAL_TEXTURE);
         }
-        if (pMesh->material.iMetallicRoughnessTextureId > 0) {
+        if (pMesh->pMaterial->pMetallicRoughnessTexture != nullptr) {
             macros.insert(ShaderProgramMacro::USE_METALLIC_ROUGHNESS_TEXTURE);
         }
-        if (pMesh->material.iEmissionTextureId > 0) {
+        if (pMesh->pMaterial->pEmissionTexture != nullptr) {
             macros.insert(ShaderProgramMacro::USE_EMISSION_TEXTURE);
         }
-    }
-
-    // Prepare shader program for the specified macros.
-    prepareShaderProgram(macros);
+        if (pMesh->pGeometry->getVertexFormat() == VertexFormat::PACKED) {
+            macros.insert(ShaderProgramMacro::USE_PACKED_VERTICES);
+        }
 
-    float cameraDistance = 0.0F;
+        // Prepare shader program for the specified macros.
+        prepareShaderProgram(macros);
 
-    // Add to meshes to be drawn.
-    for (auto& pMesh : vImportedMeshes) {
-        // Calculate camera's distance to capture the meshes.
-        const auto xBound = std::abs(pMesh->aabb.extents.x) * 2;
-        const auto yBound = std::abs(pMesh->aabb.extents.y) * 2;
-        const auto zBound = std::abs(pMesh->aabb.extents.z) * 2;
-        if (xBound > cameraDistance) {
-            cameraDistance = xBound;
-        }
-        if (yBound > cameraDistance) {
-            cameraDistance = yBound;
-        }
-        if (zBound > cameraDistance) {
-            cameraDistance = zBound;
-        }
+        // Apply current rotation.
+        pMesh->setWorldMatrix(
+            MathHelpers::buildRotationMatrix(glm::vec3(modelRotationToApply, 0.0F)) *
+            glm::identity<glm::mat4x4>());
 
         // Add mesh to be drawn.
         meshesToDraw[macros].meshes.insert(std::move(pMesh));
     }
+}
 
+void Application::setCameraToCaptureModel(float modelSize) {
     // Set camera's position/rotation.
-    pCamera->setLocation(glm::vec3(0.0F, 0.0F, cameraDistance * 2));
+    pCamera->setLocation(glm::vec3(0.0F, 0.0F, modelSize * 2));
     pCamera->setFreeCameraRotation(glm::vec3(0.0F, 0.0F, -1.0F));
 
     // Set light source position.
-    vLightSources[0].setLightPosition(glm::vec3(cameraDistance * 2, cameraDistance * 2, cameraDistance * 2));
-    vLightSources[1].setLightPosition(
-        glm::vec3(-cameraDistance * 2, -cameraDistance * 2, -cameraDistance * 2));
+    vLightSources[0].setLightPosition(glm::vec3(modelSize * 2, modelSize * 2, modelSize * 2));
+    vLightSources[1].setLightPosition(glm::vec3(-modelSize * 2, -modelSize * 2, -modelSize * 2));
 }
 
 void Application::setModelRotation(const glm::vec2& rotation) {
@@ -385,6 +693,17 @@ void Application::setModelRotation(const glm::vec2& rotation) {
 
 Application::ProfilingStatistics* Application::getProfilingStats() { return &stats; }
 
+GeometryBuffer::Statistics Application::getGeometryBufferStats(VertexFormat vertexFormat) const {
+    return vertexFormat == VertexFormat::PACKED ? pPackedGeometryBuffer->getStatistics()
+                                                : pGeometryBuffer->getStatistics();
+}
+
+size_t Application::getLoadedTextureCount() const { return textureCache.getLoadedTextureCount(); }
+
+size_t Application::getPendingTextureUploadSize() const {
+    return pTextureUploader->getPendingSizeInBytes();
+}
+
 float* Application::getModelRotationToApply() { return glm::value_ptr(modelRotationToApply); }
 
 float* Application::getFirstLightSourcePosition() { return vLightSources[0].getLightPosition(); }
@@ -401,9 +720,126 @@ float* Application::getExposure() { return &exposure; }
 
 bool* Application::getTonemappingEnabled() { return &bApplyTonemapping; }
 
+bool* Application::getUsePackedVertices() { return &bUsePackedVertices; }
+
+float* Application::getLodPixelErrorThreshold() { return &lodPixelErrorThreshold; }
+
+bool* Application::getUseClusterCulling() { return &bUseClusterCulling; }
+
+int* Application::getVideoMemoryBudgetInMb() { return &iVideoMemoryBudgetInMb; }
+
+const TextureStreamer* Application::getTextureStreamer() const { return pTextureStreamer.get(); }
+
+size_t Application::getGeometrySizeInBytes() const {
+    return pGeometryBuffer->getSizeInBytes() + pPackedGeometryBuffer->getSizeInBytes();
+}
+
+float Application::getMaxAxisScale(const glm::mat4x4& worldMatrix) {
+    return std::max(
+        {glm::length(glm::vec3(worldMatrix[0])),
+         glm::length(glm::vec3(worldMatrix[1])),
+         glm::length(glm::vec3(worldMatrix[2]))});
+}
+
+std::pair<glm::vec3, float> Application::getInstanceBoundingSphere(const Mesh* pMesh, size_t iInstanceIndex) {
+    const auto& worldMatrix = pMesh->getInstanceWorldMatrix(iInstanceIndex);
+    return {
+        glm::vec3(worldMatrix * glm::vec4(pMesh->aabb.center, 1.0F)),
+        glm::length(pMesh->aabb.extents) * getMaxAxisScale(worldMatrix)};
+}
+
+size_t Application::selectMeshLod(
+    const Mesh* pMesh,
+    size_t iInstanceIndex,
+    const glm::vec3& cameraLocation,
+    float pixelsPerUnitAtDistance1) const {
+    if (pMesh->vLods.size() == 1 || lodPixelErrorThreshold <= 0.0F) {
+        return 0;
+    }
+
+    // Find bounding sphere in world space (simplification errors are relative to its radius).
+    const auto [worldCenter, radius] = getInstanceBoundingSphere(pMesh, iInstanceIndex);
+
+    // Project errors from the closest point of the sphere.
+    constexpr float minDistance = 0.0001F;
+    const auto distance = std::max(glm::distance(worldCenter, cameraLocation) - radius, minDistance);
+    const auto pixelsPerUnit = pixelsPerUnitAtDistance1 / distance;
+
+    // Errors of levels only grow.
+    size_t iSelectedLod = 0;
+    for (size_t i = 1; i < pMesh->vLods.size(); i++) {
+        if (pMesh->vLods[i].error * radius * pixelsPerUnit > lodPixelErrorThreshold) {
+            break;
+        }
+        iSelectedLod = i;
+    }
+
+    return iSelectedLod;
+}
+
+float Application::getProjectedMeshSize(
+    const Mesh* pMesh,
+    size_t iInstanceIndex,
+    const glm::vec3& cameraLocation,
+    float pixelsPerUnitAtDistance1) const {
+    // Find bounding sphere in world space.
+    const auto [worldCenter, radius] = getInstanceBoundingSphere(pMesh, iInstanceIndex);
+
+    // Project from the closest point of the sphere.
+    constexpr float minDistance = 0.0001F;
+    const auto distance = std::max(glm::distance(worldCenter, cameraLocation) - radius, minDistance);
+
+    return 2.0F * radius * pixelsPerUnitAtDistance1 / distance;
+}
+
+void Application::cullMeshClusters(
+    const Mesh* pMesh, size_t iInstanceIndex, const glm::vec3& cameraLocation) {
+    vVisibleClusterRanges.clear();
+
+    // Prepare transforms of bounding spheres and cone axes.
+    const auto& worldMatrix = pMesh->getInstanceWorldMatrix(iInstanceIndex);
+    const auto& normalMatrix = pMesh->getInstanceNormalMatrix(iInstanceIndex);
+    const auto scale = getMaxAxisScale(worldMatrix);
+    const auto* const pFrustum = pCamera->getCameraProperties()->getCameraFrustum();
+
+    for (const auto& cluster : pMesh->vClusters) {
+        const auto center = glm::vec3(worldMatrix * glm::vec4(cluster.center, 1.0F));
+        const auto radius = cluster.radius * scale;
+
+        // Test bounding sphere.
+        if (!pFrustum->isSphereInFrustum(center, radius)) {
+            stats.iCulledClustersLastFrame += 1;
+            continue;
+        }
+
+        // Test normal cone: all triangles are back-facing if the camera looks at the cluster
+        // from inside of the cone (tested for all points of the bounding sphere). The axis is transformed
+        // by the normal matrix which keeps it on the front side of triangles even for mirrored instances
+        // (their winding is reversed but they are drawn with clockwise front faces).
+        if (cluster.coneCutoff < 1.0F) {
+            const auto coneAxis = glm::normalize(normalMatrix * cluster.coneAxis);
+            const auto toCluster = center - cameraLocation;
+            if (glm::dot(toCluster, coneAxis) >= cluster.coneCutoff * glm::length(toCluster) + radius) {
+                stats.iCulledClustersLastFrame += 1;
+                continue;
+            }
+        }
+
+        // Merge with the previous cluster if they are adjacent in the index buffer.
+        if (!vVisibleClusterRanges.empty() &&
+            vVisibleClusterRanges.back().first + vVisibleClusterRanges.back().second == cluster.iFirstIndex) {
+            vVisibleClusterRanges.back().second += cluster.iIndexCount;
+        } else {
+            vVisibleClusterRanges.emplace_back(cluster.iFirstIndex, cluster.iIndexCount);
+        }
+    }
+}
+
 void Application::drawNextFrame() {
     // Refresh culled object counter.
     stats.iCulledObjectsLastFrame = 0;
+    stats.iCulledClustersLastFrame = 0;
+    stats.vDrawnTrianglesPerLodLastFrame = {};
 
     // Set framebuffer to render the scene to.
     glBindFramebuffer(GL_FRAMEBUFFER, iRenderFramebufferId);
@@ -415,67 +851,257 @@ void Application::drawNextFrame() {
     const auto viewMatrix = pCamera->getCameraProperties()->getViewMatrix();
     const auto projectionMatrix = pCamera->getCameraProperties()->getProjectionMatrix();
 
+    // Update per-frame data (shared by all shader programs).
+    FrameUniformData frameData;
+    frameData.viewProjectionMatrix = projectionMatrix * viewMatrix;
+    frameData.cameraPositionInWorldSpace = pCamera->getCameraProperties()->getWorldLocation();
+    frameData.ambientLightIntensity = ambientLightIntensity;
+    frameData.environmentIntensity = environmentIntensity;
+    frameData.vIrradianceCoefficients = pEnvironmentLighting->getIrradianceCoefficients();
+    pFrameUniformBuffer->copyData(frameData);
+
+    // Update light sources (shared by all shader programs).
+    LightUniformData lightData;
+    for (size_t i = 0; i < vLightSources.size(); i++) {
+        lightData[i] = vLightSources[i].getUniformData();
+    }
+    pLightUniformBuffer->copyData(lightData);
+
+    // Bind environment lighting textures.
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, pEnvironmentLighting->getSpecularCubemap().getTextureId());
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, pEnvironmentLighting->getBrdfLookupTexture().getTextureId());
+
+    // Prepare regions for matrices and draw commands of meshes (enough for all mesh instances and all
+    // clusters of non-instanced meshes or one command per level of detail and winding of instanced meshes,
+    // only visible ones will be written).
+    size_t iMeshInstanceCount = 0;
+    size_t iDrawCommandCount = 0;
+    for (const auto& [macros, shader] : meshesToDraw) {
+        for (const auto& pMesh : shader.meshes) {
+            iMeshInstanceCount += pMesh->getInstanceCount();
+            if (pMesh->getInstanceCount() == 1) {
+                iDrawCommandCount += std::max(pMesh->vClusters.size(), size_t(1));
+            } else {
+                iDrawCommandCount += std::min(pMesh->getInstanceCount(), 2 * pMesh->vLods.size());
+            }
+        }
+    }
+    iMeshInstanceCount = std::max(iMeshInstanceCount, size_t(1));
+    iDrawCommandCount = std::max(iDrawCommandCount, size_t(1));
+    auto* const pMeshInstances =
+        static_cast<MeshInstanceData*>(pMeshInstanceBuffer->mapNextRegion(iMeshInstanceCount));
+    auto* const pDrawCommands =
+        static_cast<DrawElementsIndirectCommand*>(pDrawCommandBuffer->mapNextRegion(iDrawCommandCount));
+    unsigned int iMeshInstanceIndex = 0;
+    unsigned int iDrawCommandIndex = 0;
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, pDrawCommandBuffer->getBufferId());
+
+    // Prepare parameters to select levels of detail.
+    const auto cameraLocation = pCamera->getCameraProperties()->getWorldLocation();
+    const auto pixelsPerUnitAtDistance1 =
+        static_cast<float>(pCamera->getCameraProperties()->getRenderTargetHeight()) /
+        (2.0F * std::tan(glm::radians(static_cast<float>(pCamera->getCameraProperties()->getVerticalFov())) *
+                         0.5F)); // NOLINT: half of FOV
+
+    // Material textures are either referenced from the material buffer or bound per batch.
+    const auto bBindMaterialTextures = !pMaterialBuffer->isUsingBindlessTextures();
+    if (bBindMaterialTextures) {
+        const auto iSamplerId = pMaterialBuffer->getSamplerId();
+        const std::array<unsigned int, 4> vSamplerIds = {iSamplerId, iSamplerId, iSamplerId, iSamplerId};
+        glBindSamplers(0, static_cast<int>(vSamplerIds.size()), vSamplerIds.data());
+    }
+
     // Draw meshes of each shader variation.
     for (const auto& [macros, shader] : meshesToDraw) {
         // Set shader program.
         glUseProgram(shader.iShaderProgramId);
 
-        // Bind cubemap.
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, iSkyboxCubemapId);
+        // Meshes of a shader variation store their vertices/indices in the same buffer.
+        const auto bUsesPackedVertices = macros.contains(ShaderProgramMacro::USE_PACKED_VERTICES);
+        auto* const pShaderGeometryBuffer =
+            bUsesPackedVertices ? pPackedGeometryBuffer.get() : pGeometryBuffer.get();
 
-        // Set ambient light.
-        ShaderUniformHelpers::setFloatToShader(
-            shader.iShaderProgramId, "ambientLightIntensity", ambientLightIntensity);
+        // Do frustum culling and select levels of detail of mesh instances.
+        vVisibleMeshInstances.clear();
+        for (const auto& pMesh : shader.meshes) {
+            for (size_t i = 0; i < pMesh->getInstanceCount(); i++) {
+                if (!pCamera->getCameraProperties()->getCameraFrustum()->isAabbInFrustum(
+                        pMesh->aabb, pMesh->getInstanceWorldMatrix(i))) {
+                    stats.iCulledObjectsLastFrame += 1;
+                    continue;
+                }
+                vVisibleMeshInstances.push_back(VisibleMeshInstance{
+                    .pMesh = pMesh.get(),
+                    .iInstanceIndex = static_cast<unsigned int>(i),
+                    .iLod = static_cast<unsigned int>(
+                        selectMeshLod(pMesh.get(), i, cameraLocation, pixelsPerUnitAtDistance1)),
+                    .bIsMirrored = pMesh->isInstanceMirrored(i)});
+
+                // Tell which resolution textures of the mesh need.
+                pTextureStreamer->requestResolution(
+                    *pMesh->pMaterial,
+                    getProjectedMeshSize(pMesh.get(), i, cameraLocation, pixelsPerUnitAtDistance1));
+            }
+        }
 
-        // Set environment intensity.
-        ShaderUniformHelpers::setFloatToShader(
-            shader.iShaderProgramId, "environmentIntensity", environmentIntensity);
+        // Sort by index type, winding and textures so that meshes with the same index type, winding and
+        // textures are drawn using one command (with bindless textures all meshes of an index type and
+        // winding are drawn using one command), then by mesh and level of detail so that instances of a mesh
+        // are drawn using one instanced draw.
+        std::ranges::sort(
+            vVisibleMeshInstances,
+            [bBindMaterialTextures](const VisibleMeshInstance& a, const VisibleMeshInstance& b) {
+                const auto indexFormatA = a.pMesh->pGeometry->getIndexFormat();
+                const auto indexFormatB = b.pMesh->pGeometry->getIndexFormat();
+                if (indexFormatA != indexFormatB) {
+                    return indexFormatA < indexFormatB;
+                }
+                if (a.bIsMirrored != b.bIsMirrored) {
+                    return b.bIsMirrored;
+                }
+                if (bBindMaterialTextures) {
+                    const auto vTextureIdsA = a.pMesh->pMaterial->getTextureIds();
+                    const auto vTextureIdsB = b.pMesh->pMaterial->getTextureIds();
+                    if (vTextureIdsA != vTextureIdsB) {
+                        return vTextureIdsA < vTextureIdsB;
+                    }
+                }
+                return std::tie(a.pMesh, a.iLod, a.iInstanceIndex) <
+                       std::tie(b.pMesh, b.iLod, b.iInstanceIndex);
+            });
+
+        // Submit one multi-draw command per batch.
+        for (size_t iBatchStart = 0; iBatchStart < vVisibleMeshInstances.size();) {
+            const auto& material = *vVisibleMeshInstances[iBatchStart].pMesh->pMaterial;
+            const auto& batchGeometry = *vVisibleMeshInstances[iBatchStart].pMesh->pGeometry;
+            const auto bIsBatchMirrored = vVisibleMeshInstances[iBatchStart].bIsMirrored;
+            const auto iFirstCommandIndex = iDrawCommandIndex;
+
+            // Write draw commands and per-instance data of meshes in this batch.
+            const auto vBatchTextureIds = material.getTextureIds();
+            size_t iBatchEnd = iBatchStart;
+            while (iBatchEnd < vVisibleMeshInstances.size() &&
+                   vVisibleMeshInstances[iBatchEnd].pMesh->pGeometry->getIndexFormat() ==
+                       batchGeometry.getIndexFormat() &&
+                   vVisibleMeshInstances[iBatchEnd].bIsMirrored == bIsBatchMirrored &&
+                   (!bBindMaterialTextures ||
+                    vVisibleMeshInstances[iBatchEnd].pMesh->pMaterial->getTextureIds() == vBatchTextureIds)) {
+                const auto* const pMesh = vVisibleMeshInstances[iBatchEnd].pMesh;
+                const auto iLod = vVisibleMeshInstances[iBatchEnd].iLod;
+                const auto& lod = pMesh->vLods[iLod];
+
+                // Find instances of this mesh that use the same level of detail (drawn using one command).
+                size_t iGroupEnd = iBatchEnd + 1;
+                while (iGroupEnd < vVisibleMeshInstances.size() &&
+                       vVisibleMeshInstances[iGroupEnd].pMesh == pMesh &&
+                       vVisibleMeshInstances[iGroupEnd].iLod == iLod &&
+                       vVisibleMeshInstances[iGroupEnd].bIsMirrored == bIsBatchMirrored) {
+                    iGroupEnd += 1;
+                }
+                const auto iGroupInstanceCount = static_cast<unsigned int>(iGroupEnd - iBatchEnd);
+
+                // Clusters only cover the most detailed level (other levels are drawn as a whole) and are
+                // only culled for non-instanced meshes since culling results differ between instances.
+                vVisibleClusterRanges.clear();
+                if (bUseClusterCulling && iLod == 0 && !pMesh->vClusters.empty() &&
+                    pMesh->getInstanceCount() == 1) {
+                    cullMeshClusters(pMesh, 0, cameraLocation);
+                    if (vVisibleClusterRanges.empty()) {
+                        stats.iCulledObjectsLastFrame += 1;
+                        iBatchEnd = iGroupEnd;
+                        continue;
+                    }
+                } else {
+                    vVisibleClusterRanges.emplace_back(lod.iFirstIndex, lod.iIndexCount);
+                }
+
+                // Write world/normal matrix and material index of each instance (consecutive so that
+                // instances are indexed by base instance plus instance ID).
+                for (size_t i = iBatchEnd; i < iGroupEnd; i++) {
+                    const auto iInstanceIndex = vVisibleMeshInstances[i].iInstanceIndex;
+
+                    auto& meshInstance =
+                        pMeshInstances[iMeshInstanceIndex + (i - iBatchEnd)]; // NOLINT: pointer arithmetic
+                    meshInstance.worldMatrix = pMesh->getInstanceWorldMatrix(iInstanceIndex);
+                    if (bUsesPackedVertices) {
+                        // Positions are stored relative to the AABB.
+                        meshInstance.worldMatrix = meshInstance.worldMatrix *
+                                                   PackedVertex::getPositionDequantizationMatrix(pMesh->aabb);
+                    }
+                    meshInstance.normalMatrix = glm::mat4x4(pMesh->getInstanceNormalMatrix(iInstanceIndex));
+                    meshInstance.iMaterialIndex = pMesh->pMaterial->iMaterialIndex;
+                }
+
+                // Write draw commands (base instance is used in shaders as an index into mesh matrices).
+                for (const auto& [iFirstIndex, iIndexCount] : vVisibleClusterRanges) {
+#if defined(DEBUG)
+                    if (iDrawCommandIndex >= iDrawCommandCount) [[unlikely]] {
+                        throw std::runtime_error(std::format(
+                            "draw command {} is outside of the mapped region of {} commands",
+                            iDrawCommandIndex,
+                            iDrawCommandCount));
+                    }
+#endif
 
-        // Set light properties.
-        for (size_t i = 0; i < vLightSources.size(); i++) {
-            vLightSources[i].setToShader(shader.iShaderProgramId, i);
-        }
+                    auto& command = pDrawCommands[iDrawCommandIndex]; // NOLINT: pointer arithmetic
+                    command.iIndexCount = iIndexCount;
+                    command.iInstanceCount = iGroupInstanceCount;
+                    command.iFirstIndex = pMesh->pGeometry->getFirstIndex() + iFirstIndex;
+                    command.iBaseVertex = pMesh->pGeometry->getBaseVertex();
+                    command.iBaseInstance = iMeshInstanceIndex;
 
-        // Set camera position.
-        ShaderUniformHelpers::setVector3ToShader(
-            shader.iShaderProgramId,
-            "cameraPositionInWorldSpace",
-            pCamera->getCameraProperties()->getWorldLocation());
-
-        // Set view/projection matrix.
-        ShaderUniformHelpers::setMatrix4ToShader(
-            shader.iShaderProgramId, "viewProjectionMatrix", projectionMatrix * viewMatrix);
-
-        // Draw meshes.
-        for (const auto& mesh : shader.meshes) {
-            // Do frustum culling.
-            if (!pCamera->getCameraProperties()->getCameraFrustum()->isAabbInFrustum(
-                    mesh->aabb, *mesh->getWorldMatrix())) {
-                stats.iCulledObjectsLastFrame += 1;
-                continue;
+                    if (iLod < stats.vDrawnTrianglesPerLodLastFrame.size()) {
+                        stats.vDrawnTrianglesPerLodLastFrame[iLod] += iIndexCount / 3 * iGroupInstanceCount;
+                    }
+
+                    iDrawCommandIndex += 1;
+                }
+
+                iMeshInstanceIndex += iGroupInstanceCount;
+                iBatchEnd = iGroupEnd;
             }
 
-            // Set world/normal matrix.
-            ShaderUniformHelpers::setMatrix4ToShader(
-                shader.iShaderProgramId, "worldMatrix", *mesh->getWorldMatrix());
-            ShaderUniformHelpers::setMatrix3ToShader(
-                shader.iShaderProgramId, "normalMatrix", *mesh->getNormalMatrix());
+            // Bind textures of this batch.
+            if (bBindMaterialTextures) {
+                material.bindTextures();
+            }
 
-            // Set vertex array object.
-            glBindVertexArray(mesh->iVertexArrayObjectId);
+            // Mirroring world matrices reverse the winding of triangles.
+            glFrontFace(bIsBatchMirrored ? GL_CW : GL_CCW);
 
-            // Set element object.
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->iIndexBufferObjectId);
+            // Bind the index buffer of this batch's index type.
+            glBindVertexArray(pShaderGeometryBuffer->getVertexArrayObjectId(batchGeometry.getIndexFormat()));
 
-            // Set material properties.
-            mesh->material.setToShader(shader.iShaderProgramId);
+            // Submit draw commands.
+            glMultiDrawElementsIndirect(
+                GL_TRIANGLES,
+                batchGeometry.getIndexType(),
+                reinterpret_cast<void*>( // NOLINT: offset in the indirect buffer
+                    pDrawCommandBuffer->getCurrentRegionOffset() +
+                    iFirstCommandIndex * sizeof(DrawElementsIndirectCommand)),
+                static_cast<int>(iDrawCommandIndex - iFirstCommandIndex),
+                0); // commands are tightly packed
 
-            // Submit a draw command.
-            glDrawElements(GL_TRIANGLES, mesh->iIndexCount, GL_UNSIGNED_INT, nullptr);
+            iBatchStart = iBatchEnd;
         }
     }
 
+    // Restore the default winding of front faces.
+    glFrontFace(GL_CCW);
+
+    // Don't overwrite mesh matrices and draw commands until the GPU finished drawing this frame.
+    pMeshInstanceBuffer->fenceCurrentRegion();
+    pDrawCommandBuffer->fenceCurrentRegion();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // Unbind samplers so that other textures use their own parameters.
+    if (bBindMaterialTextures) {
+        glBindSamplers(0, 4, nullptr); // NOLINT: material texture units
+    }
+
     // Draw the skybox.
     drawSkybox();
 
@@ -583,18 +1209,17 @@ void Application::drawSkybox() {
     glUseProgram(iSkyboxShaderProgramId);
 
     // Bind cubemap.
-    glBindTexture(GL_TEXTURE_CUBE_MAP, iSkyboxCubemapId);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, pSkyboxCubemap->getTextureId());
 
     // Set view/projection matrix.
     ShaderUniformHelpers::setMatrix4ToShader(
-        iSkyboxShaderProgramId,
-        "viewProjectionMatrix",
+        iSkyboxViewProjectionMatrixLocation,
         projectionMatrix * glm::mat4(glm::mat3(
                                viewMatrix))); // remove translation to make skybox centered on camera location
 
     // Set vertex/index buffers.
-    glBindVertexArray(pSkyboxMesh->iVertexArrayObjectId);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pSkyboxMesh->iIndexBufferObjectId);
+    glBindVertexArray(pGeometryBuffer->getVertexArrayObjectId(pSkyboxMesh->pGeometry->getIndexFormat()));
 
     // Disable backface culling to render cubemap (because the camera will be inside of that cube).
     glCullFace(GL_FRONT);
@@ -603,7 +1228,12 @@ void Application::drawSkybox() {
 
     {
         // Submit a draw command.
-        glDrawElements(GL_TRIANGLES, pSkyboxMesh->iIndexCount, GL_UNSIGNED_INT, nullptr);
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES,
+            static_cast<int>(pSkyboxMesh->vLods[0].iIndexCount),
+            pSkyboxMesh->pGeometry->getIndexType(),
+            reinterpret_cast<void*>(pSkyboxMesh->pGeometry->getFirstIndexOffsetInBytes()), // NOLINT
+            pSkyboxMesh->pGeometry->getBaseVertex());
     }
 
     // Return backface culling and depth comparison function.
@@ -624,21 +1254,26 @@ void Application::drawPostProcessingScreenQuad() {
         glBindTexture(GL_TEXTURE_2D, iPostProcessFramebufferColorTextreId);
 
         // Set gamma to shaders.
-        ShaderUniformHelpers::setFloatToShader(iPostProcessingShaderProgramId, "gamma", gamma);
+        ShaderUniformHelpers::setFloatToShader(iPostProcessingGammaLocation, gamma);
 
         // Set exposure to shaders.
-        ShaderUniformHelpers::setFloatToShader(iPostProcessingShaderProgramId, "exposure", exposure);
+        ShaderUniformHelpers::setFloatToShader(iPostProcessingExposureLocation, exposure);
 
         // Set tone mapping enabler to shaders.
         ShaderUniformHelpers::setFloatToShader(
-            iPostProcessingShaderProgramId, "bEnableTonemapping", static_cast<float>(bApplyTonemapping));
+            iPostProcessingTonemappingLocation, static_cast<float>(bApplyTonemapping));
 
         // Set vertex/index buffers.
-        glBindVertexArray(pScreenQuadMesh->iVertexArrayObjectId);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pScreenQuadMesh->iIndexBufferObjectId);
+        glBindVertexArray(
+            pGeometryBuffer->getVertexArrayObjectId(pScreenQuadMesh->pGeometry->getIndexFormat()));
 
         // Submit a draw command.
-        glDrawElements(GL_TRIANGLES, pScreenQuadMesh->iIndexCount, GL_UNSIGNED_INT, nullptr);
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES,
+            static_cast<int>(pScreenQuadMesh->vLods[0].iIndexCount),
+            pScreenQuadMesh->pGeometry->getIndexType(),
+            reinterpret_cast<void*>(pScreenQuadMesh->pGeometry->getFirstIndexOffsetInBytes()), // NOLINT
+            pScreenQuadMesh->pGeometry->getBaseVertex());
     }
 
     // Restore depth test.
@@ -5,15 +5,28 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 // Custom.
 #include "math/GLMath.hpp"
 #include "camera/Camera.h"
 #include "Mesh.h"
+#include "GeometryBuffer.h"
 #include "shader/ShaderProgramMacro.hpp"
+#include "shader/UniformBlocks.hpp"
+#include "shader/UniformBuffer.h"
+#include "shader/StorageBlocks.hpp"
+#include "shader/PersistentStorageBuffer.h"
+#include "shader/MaterialBuffer.h"
+#include "import/TextureCache.h"
+#include "import/MeshImporter.h"
 #include "LightSource.h"
+#include "TextureUploader.h"
+#include "TextureStreamer.h"
+#include "EnvironmentLighting.h"
 
 struct GLFWwindow;
 
@@ -37,15 +50,56 @@ public:
         /** The total number of objects that was culled and not submitted for drawing. */
         size_t iCulledObjectsLastFrame = 0;
 
+        /** The total number of clusters of visible meshes that were culled and not submitted for drawing. */
+        size_t iCulledClustersLastFrame = 0;
+
+        /** The total number of triangles drawn using each level of detail of meshes. */
+        std::array<size_t, MeshOptimizer::iMaxLodCount> vDrawnTrianglesPerLodLastFrame{};
+
         /** Last time when @ref iFramesPerSecond was updated. */
         std::chrono::steady_clock::time_point timeAtLastFpsUpdate = std::chrono::steady_clock::now();
+
+        /** Time spent in stages of the last model import. */
+        MeshImporter::ImportStatistics lastImport;
+    };
+
+    /** Groups parameters for rendering without a visible window (see @ref runHeadless). */
+    struct HeadlessParameters {
+        /** Path to the GLTF/GLB file to render. */
+        std::filesystem::path pathToModel;
+
+        /** Directory to store captured frames and timings in (created if does not exist). */
+        std::filesystem::path pathToOutputDirectory = "headless_output";
+
+        /** Total number of frames to render and capture. */
+        size_t iFrameCount = 1;
+
+        /** Width of the rendered image. */
+        int iWidth = 1280; // NOLINT: default value
+
+        /** Height of the rendered image. */
+        int iHeight = 720; // NOLINT: default value
+
+        /** `true` to create an EGL context, `false` to create an OSMesa (software) context. */
+        bool bUseEglContext = false;
     };
 
     /** Runs the application. */
     void run();
 
     /**
-     * Prepares a scene with meshes to draw (fills @ref meshesToDraw).
+     * Runs the application without a visible window: renders the specified number of frames
+     * of the specified model to an offscreen context and saves each frame as an image along with
+     * frame timings.
+     *
+     * @remark Uses a fixed time step and no user input so that the output is deterministic.
+     *
+     * @param parameters Rendering parameters.
+     */
+    void runHeadless(const HeadlessParameters& parameters);
+
+    /**
+     * Prepares a scene with meshes to draw (fills @ref meshesToDraw) and waits for the import to finish.
      *
      * @remark Clears old displayed models (if existed).
      *
@@ -53,6 +107,26 @@ public:
      */
     void prepareScene(const std::filesystem::path& pathToModel);
 
+    /**
+     * Starts importing the specified model on worker threads and returns immediately, meshes are
+     * added to the scene as they become ready (a few per frame).
+     *
+     * @remark Old displayed models are drawn until first meshes of the new model are ready.
+     *
+     * @param pathToModel Path to the file to import and display.
+     */
+    void loadSceneAsync(const std::filesystem::path& pathToModel);
+
+    /** Cancels the import started by @ref loadSceneAsync (already displayed meshes are kept). */
+    void cancelSceneImport();
+
+    /**
+     * Returns progress of the import started by @ref loadSceneAsync.
+     *
+     * @return Empty if no import is in progress, otherwise value in range [0.0; 1.0].
+     */
+    std::optional<float> getSceneImportProgress() const;
+
     /**
      * Returns app statistics.
      *
@@ -62,6 +136,29 @@ public:
      */
     ProfilingStatistics* getProfilingStats();
 
+    /**
+     * Returns memory usage of the buffer that stores vertices/indices of meshes of the specified format.
+     *
+     * @param vertexFormat Format of vertices stored in the buffer.
+     *
+     * @return Statistics.
+     */
+    GeometryBuffer::Statistics getGeometryBufferStats(VertexFormat vertexFormat) const;
+
+    /**
+     * Returns the number of textures loaded from imported models that are currently in use.
+     *
+     * @return Texture count.
+     */
+    size_t getLoadedTextureCount() const;
+
+    /**
+     * Returns size of texture pixels that were loaded but not copied to the GPU yet.
+     *
+     * @return Size in bytes.
+     */
+    size_t getPendingTextureUploadSize() const;
+
     /**
      * Value for ImGui slider to modify rotation.
      *
@@ -118,6 +215,49 @@ public:
      */
     bool* getTonemappingEnabled();
 
+    /**
+     * Returns packed vertices toggle (for models loaded after it's changed) to be modified in ImGui.
+     *
+     * @return Pointer that points to parameter.
+     */
+    bool* getUsePackedVertices();
+
+    /**
+     * Returns maximum screen-space error of selected levels of detail to be modified in ImGui slider.
+     *
+     * @return Pointer that points to parameter.
+     */
+    float* getLodPixelErrorThreshold();
+
+    /**
+     * Returns cluster culling toggle to be modified in ImGui.
+     *
+     * @return Pointer that points to parameter.
+     */
+    bool* getUseClusterCulling();
+
+    /**
+     * Returns size of video memory (in megabytes) that imported textures and geometry can use
+     * to be modified in ImGui.
+     *
+     * @return Pointer that points to parameter.
+     */
+    int* getVideoMemoryBudgetInMb();
+
+    /**
+     * Returns streamer of imported textures (to display its statistics).
+     *
+     * @return Texture streamer.
+     */
+    const TextureStreamer* getTextureStreamer() const;
+
+    /**
+     * Returns size of video memory used by buffers of imported meshes.
+     *
+     * @return Size in bytes.
+     */
+    size_t getGeometrySizeInBytes() const;
+
 private:
     /**
      * GLFW callback that's called after the framebuffer size was changed.
@@ -213,6 +353,12 @@ private:
     /** Initializes GLFW. */
     void initWindow();
 
+    /**
+     * Prepares framebuffers, environment map, skybox, post-processing resources, uniform and
+     * storage buffers.
+     */
+    void initRenderResources();
+
     /** Prepares and initializes framebuffers. */
     void createFramebuffers();
 
@@ -222,6 +368,114 @@ private:
     /** Processes window messages and does the rendering. */
     void mainLoop();
 
+    /** Renders and captures frames according to @ref headlessParameters. */
+    void headlessLoop();
+
+    /**
+     * Adds meshes of @ref pSceneImport that became ready to the scene.
+     *
+     * @param uploadTimeBudgetInMs Time after which no more meshes will be created, empty to add all
+     * ready meshes.
+     */
+    void updateSceneImport(std::optional<float> uploadTimeBudgetInMs);
+
+    /** Removes all meshes and materials of the scene. */
+    void clearScene();
+
+    /**
+     * Adds the specified meshes to @ref meshesToDraw and their materials to @ref pMaterialBuffer.
+     *
+     * @param vMeshes Meshes to add.
+     */
+    void addMeshesToScene(std::vector<std::unique_ptr<Mesh>>&& vMeshes);
+
+    /**
+     * Places camera and light sources so that a model of the specified size is visible.
+     *
+     * @param modelSize Largest size (along any axis) of a mesh of the model.
+     */
+    void setCameraToCaptureModel(float modelSize);
+
+    /**
+     * Returns the largest scale that the specified matrix applies along its axes (used to scale radii
+     * of bounding spheres).
+     *
+     * @param worldMatrix Matrix that transforms from model space to world space.
+     *
+     * @return Scale.
+     */
+    static float getMaxAxisScale(const glm::mat4x4& worldMatrix);
+
+    /**
+     * Returns the sphere that encloses the AABB of the specified mesh instance in world space.
+     *
+     * @param pMesh          Mesh.
+     * @param iInstanceIndex Index of the mesh's instance.
+     *
+     * @return Center and radius of the sphere.
+     */
+    static std::pair<glm::vec3, float> getInstanceBoundingSphere(const Mesh* pMesh, size_t iInstanceIndex);
+
+    /**
+     * Selects the least detailed level of the specified mesh which simplification error
+     * (projected to the screen from the mesh's bounding sphere) does not exceed @ref lodPixelErrorThreshold.
+     *
+     * @param pMesh                   Mesh to draw.
+     * @param iInstanceIndex          Index of the mesh's instance to draw.
+     * @param cameraLocation          Location of the camera in world space.
+     * @param pixelsPerUnitAtDistance1 Number of screen pixels that one world unit covers at distance 1
+     * from the camera.
+     *
+     * @return Index of the level of detail in @ref Mesh::vLods.
+     */
+    size_t selectMeshLod(
+        const Mesh* pMesh,
+        size_t iInstanceIndex,
+        const glm::vec3& cameraLocation,
+        float pixelsPerUnitAtDistance1) const;
+
+    /**
+     * Returns size of the bounding sphere of the specified mesh instance on the screen.
+     *
+     * @param pMesh                   Mesh to draw.
+     * @param iInstanceIndex          Index of the mesh's instance to draw.
+     * @param cameraLocation          Location of the camera in world space.
+     * @param pixelsPerUnitAtDistance1 Number of screen pixels that one world unit covers at distance 1
+     * from the camera.
+     *
+     * @return Diameter in pixels.
+     */
+    float getProjectedMeshSize(
+        const Mesh* pMesh,
+        size_t iInstanceIndex,
+        const glm::vec3& cameraLocation,
+        float pixelsPerUnitAtDistance1) const;
+
+    /**
+     * Loads or releases mip levels of textures for sizes that textures had on the screen during the last
+     * frame (within the budget that geometry buffers leave) and updates texture handles of materials
+     * if textures were replaced.
+     */
+    void updateTextureStreaming();
+
+    /**
+     * Tests clusters of the most detailed level of the specified mesh against the camera frustum and
+     * their normal cones against the camera location, and saves index ranges of the remaining clusters
+     * to @ref vVisibleClusterRanges (adjacent clusters are merged into one range).
+     *
+     * @param pMesh          Mesh that has clusters.
+     * @param iInstanceIndex Index of the mesh's instance to draw.
+     * @param cameraLocation Location of the camera in world space.
+     */
+    void cullMeshClusters(const Mesh* pMesh, size_t iInstanceIndex, const glm::vec3& cameraLocation);
+
+    /**
+     * Reads pixels of the default framebuffer and saves them as a PNG image.
+     *
+     * @param pathToImage Path to the resulting image file.
+     */
+    void saveDefaultFramebufferToDisk(const std::filesystem::path& pathToImage) const;
+
     /** Draws next frame. */
     void drawNextFrame();
 
@@ -252,6 +506,40 @@ private:
     /** Virtual camera. */
     std::unique_ptr<Camera> pCamera;
 
+    /**
+     * Stores vertices/indices of all meshes.
+     *
+     * @warning Declared before all meshes so that it's destroyed after them.
+     */
+    std::unique_ptr<GeometryBuffer> pGeometryBuffer;
+
+    /**
+     * Stores vertices/indices of imported meshes in @ref VertexFormat::PACKED.
+     *
+     * @warning Declared before all meshes so that it's destroyed after them.
+     */
+    std::unique_ptr<GeometryBuffer> pPackedGeometryBuffer;
+
+    /** Copies pixels of textures to the GPU asynchronously (under a per-frame budget). */
+    std::unique_ptr<TextureUploader> pTextureUploader;
+
+    /**
+     * Loads detailed mip levels of imported textures once they are needed.
+     *
+     * @warning Declared before @ref pMaterialBuffer so that texture handles are released before
+     * replaced textures are deleted.
+     */
+    std::unique_ptr<TextureStreamer> pTextureStreamer;
+
+    /** Textures of imported models (so that images shared between meshes are loaded once). */
+    TextureCache textureCache;
+
+    /** Import started by @ref loadSceneAsync (`nullptr` if no import is in progress). */
+    std::unique_ptr<AsyncMeshImport> pSceneImport;
+
+    /** Whether meshes of @ref pSceneImport replaced old displayed models or not. */
+    bool bIsSceneImportDisplayed = false;
+
     /** Stores pairs of "macros of a shader program" - "meshes that use this shader program". */
     std::unordered_map<
         std::unordered_set<ShaderProgramMacro>,
@@ -259,12 +547,61 @@ private:
         ShaderProgramMacroUnorderedSetHash>
         meshesToDraw;
 
+    /** Unique materials of meshes from @ref meshesToDraw. */
+    std::unordered_set<Material*> sceneMaterials;
+
+    /**
+     * Stores materials of meshes from @ref meshesToDraw.
+     *
+     * @warning Declared after meshes so that it's destroyed before their textures are deleted.
+     */
+    std::unique_ptr<MaterialBuffer> pMaterialBuffer;
+
     /**
      * Scene's light sources.
      *
      * @warning Total number of light sources is equal to the number from shaders.
      */
-    std::array<LightSource, 2> vLightSources;
+    std::array<LightSource, iLightSourceCount> vLightSources;
+
+    /** Buffer for `FrameData` uniform block, updated once per frame. */
+    std::unique_ptr<UniformBuffer> pFrameUniformBuffer;
+
+    /** Buffer for `LightData` uniform block, updated once per frame. */
+    std::unique_ptr<UniformBuffer> pLightUniformBuffer;
+
+    /** Stores world/normal matrices of meshes drawn in a frame (indexed by base instance of draws). */
+    std::unique_ptr<PersistentStorageBuffer> pMeshInstanceBuffer;
+
+    /** Stores indirect draw commands of meshes drawn in a frame. */
+    std::unique_ptr<PersistentStorageBuffer> pDrawCommandBuffer;
+
+    /** Instance of a mesh that passed frustum culling. */
+    struct VisibleMeshInstance {
+        /** Mesh to draw. */
+        const Mesh* pMesh = nullptr;
+
+        /** Index of the mesh's instance. */
+        unsigned int iInstanceIndex = 0;
+
+        /** Selected level of detail. */
+        unsigned int iLod = 0;
+
+        /** `true` if the instance's world matrix mirrors the mesh (drawn with reversed front faces). */
+        bool bIsMirrored = false;
+    };
+
+    /**
+     * Mesh instances of a shader program that passed frustum culling (reused between frames), instances
+     * of a mesh that use the same level of detail are drawn using one instanced draw command.
+     */
+    std::vector<VisibleMeshInstance> vVisibleMeshInstances;
+
+    /**
+     * Ranges of indices (first index relative to the mesh and index count) of the mesh's clusters
+     * that passed culling (reused between meshes).
+     */
+    std::vector<std::pair<unsigned int, unsigned int>> vVisibleClusterRanges;
 
     /** Mesh that holds skybox cubemap. */
     std::unique_ptr<Mesh> pSkyboxMesh;
@@ -275,6 +612,9 @@ private:
     /** Various statistics for profiling. */
     ProfilingStatistics stats;
 
+    /** Not empty if the app is running without a visible window (see @ref runHeadless). */
+    std::optional<HeadlessParameters> headlessParameters;
+
     /** GLFW window. */
     GLFWwindow* pGLFWWindow = nullptr;
 
@@ -298,11 +638,26 @@ private:
     /** ID of the shader program used to do post-processing. */
     unsigned int iPostProcessingShaderProgramId = 0;
 
+    /** Location of the `gamma` uniform of @ref iPostProcessingShaderProgramId. */
+    int iPostProcessingGammaLocation = -1;
+
+    /** Location of the `exposure` uniform of @ref iPostProcessingShaderProgramId. */
+    int iPostProcessingExposureLocation = -1;
+
+    /** Location of the `bEnableTonemapping` uniform of @ref iPostProcessingShaderProgramId. */
+    int iPostProcessingTonemappingLocation = -1;
+
     /** ID of the shader program used to render skybox. */
     unsigned int iSkyboxShaderProgramId = 0;
 
-    /** ID of the cubemap texture used for skybox. */
-    unsigned int iSkyboxCubemapId = 0;
+    /** Location of the `viewProjectionMatrix` uniform of @ref iSkyboxShaderProgramId. */
+    int iSkyboxViewProjectionMatrixLocation = -1;
+
+    /** Cubemap texture used for skybox. */
+    std::shared_ptr<Texture> pSkyboxCubemap;
+
+    /** Image-based lighting precomputed from the skybox. */
+    std::unique_ptr<EnvironmentLighting> pEnvironmentLighting;
 
     /** Gamma correction value. */
     float gamma = 1.4F; // NOLINT
@@ -328,6 +683,19 @@ private:
     /** `true` to apply tone mapping during post-processing, `false` otherwise. */
     bool bApplyTonemapping = true;
 
+    /** `true` to store vertices of imported meshes in @ref pPackedGeometryBuffer (when possible). */
+    bool bUsePackedVertices = false;
+
+    /** Maximum screen-space error (in pixels) of a selected level of detail, 0 to always draw full detail. */
+    float lodPixelErrorThreshold = 1.0F;
+
+    /** `true` to cull clusters of meshes that passed frustum culling (see @ref Mesh::vClusters). */
+    bool bUseClusterCulling = true;
+
+    /** Size of video memory (in megabytes) that imported textures and geometry can use. */
+    int iVideoMemoryBudgetInMb =
+        static_cast<int>(TextureStreamer::iDefaultBudgetInBytes / (1024 * 1024)); // NOLINT
+
     /** `true` if mouse cursor is hidden, `false `otherwise. */
     bool bIsMouseCursorCaptured = false;
 
@@ -336,4 +704,16 @@ private:
 
     /** Sample count for multi-sample anti-aliasing. */
     static constexpr int iMsaaSampleCount = 8;
+
+    /** Initial number of meshes that @ref pMeshInstanceBuffer can store per frame (grows if needed). */
+    static constexpr size_t iInitialMeshInstanceCapacity = 1024;
+
+    /** Initial number of vertices that @ref pGeometryBuffer and @ref pPackedGeometryBuffer can store. */
+    static constexpr size_t iInitialGeometryVertexCapacity = 1024 * 1024;
+
+    /** Initial number of indices that @ref pGeometryBuffer and @ref pPackedGeometryBuffer can store. */
+    static constexpr size_t iInitialGeometryIndexCapacity = 3 * 1024 * 1024;
+
+    /** Time per frame that can be spent creating meshes of @ref pSceneImport. */
+    static constexpr float sceneImportUploadBudgetInMs = 4.0F;
 };
@@ -0,0 +1,833 @@
+#include "EnvironmentLighting.h"
+
+// Standard.
+#include <format>
+#include <fstream>
+#include <future>
+#include <numbers>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+// Custom.
+#include "window/GLFW.hpp"
+#include "Texture.h"
+#include "TextureUploader.h"
+#include "threading/ThreadPool.h"
+#include "io/FileHelpers.h"
+#include "math/MathHelpers.hpp"
+
+// External.
+#include "xxHash/xxhash.h"
+#include "glm/gtc/packing.hpp"
+
+/** Identifies cache files. */
+static constexpr std::array<char, 8> vCacheFileMagic = {'E', 'N', 'V', 'C', 'A', 'C', 'H', 'E'};
+
+/** Number of faces of a cubemap. */
+static constexpr size_t iCubemapFaceCount = 6;
+
+/** Number of GGX samples per texel of a prefiltered cubemap level. */
+static constexpr uint32_t iPrefilterSampleCount = 128;
+
+/** Number of GGX samples per texel of the BRDF lookup texture. */
+static constexpr uint32_t iBrdfSampleCount = 256;
+
+static_assert(
+    EnvironmentLighting::iSpecularCubemapSize % 4 == 0,
+    "irradiance projection processes 4 texels of a row at once");
+static_assert(
+    (EnvironmentLighting::iSpecularCubemapSize >> (EnvironmentLighting::iSpecularLevelCount - 1)) >= 4,
+    "the last prefiltered level is expected to be at least 4x4");
+
+/** Axes of a cubemap face: a texel at face coordinates (s, t) points in direction `major + s * u + t * v`. */
+struct CubemapFaceAxes {
+    /** Axis that the face is perpendicular to. */
+    glm::vec3 major;
+
+    /** Direction of increasing S (along rows). */
+    glm::vec3 u;
+
+    /** Direction of increasing T (from the first row to the last one). */
+    glm::vec3 v;
+};
+
+/** Axes of faces in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i` (as defined by OpenGL). */
+static const std::array<CubemapFaceAxes, iCubemapFaceCount> vCubemapFaceAxes = {
+    CubemapFaceAxes{glm::vec3(1.0F, 0.0F, 0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, -1.0F, 0.0F)},
+    CubemapFaceAxes{glm::vec3(-1.0F, 0.0F, 0.0F), glm::vec3(0.0F, 0.0F, 1.0F), glm::vec3(0.0F, -1.0F, 0.0F)},
+    CubemapFaceAxes{glm::vec3(0.0F, 1.0F, 0.0F), glm::vec3(1.0F, 0.0F, 0.0F), glm::vec3(0.0F, 0.0F, 1.0F)},
+    CubemapFaceAxes{glm::vec3(0.0F, -1.0F, 0.0F), glm::vec3(1.0F, 0.0F, 0.0F), glm::vec3(0.0F, 0.0F, -1.0F)},
+    CubemapFaceAxes{glm::vec3(0.0F, 0.0F, 1.0F), glm::vec3(1.0F, 0.0F, 0.0F), glm::vec3(0.0F, -1.0F, 0.0F)},
+    CubemapFaceAxes{
+        glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(-1.0F, 0.0F, 0.0F), glm::vec3(0.0F, -1.0F, 0.0F)}};
+
+/** One level of a cubemap with linear RGB colors. */
+struct RadianceCubemapLevel {
+    /** Width and height of each face. */
+    int iSize = 0;
+
+    /** Texels of all faces one after another (rows from top to bottom). */
+    std::vector<glm::vec3> vTexels;
+
+    /**
+     * Returns a texel.
+     *
+     * @param iFace Index of the face.
+     * @param iX    Column of the texel.
+     * @param iY    Row of the texel.
+     *
+     * @return Texel.
+     */
+    const glm::vec3& getTexel(size_t iFace, int iX, int iY) const {
+        return vTexels[(iFace * iSize + static_cast<size_t>(iY)) * iSize + static_cast<size_t>(iX)];
+    }
+};
+
+/** 4 floats that are processed at once (with SSE instructions when they are available). */
+struct Float4 {
+#if defined(__SSE__) || defined(_M_X64)
+    __m128 v;
+
+    static Float4 broadcast(float value) { return {_mm_set1_ps(value)}; }
+    static Float4 set(float x, float y, float z, float w) { return {_mm_setr_ps(x, y, z, w)}; }
+    friend Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend Float4 inverseSqrt(Float4 a) { return {_mm_div_ps(_mm_set1_ps(1.0F), _mm_sqrt_ps(a.v))}; }
+    float getSum() const {
+        std::array<float, 4> vValues{};
+        _mm_storeu_ps(vValues.data(), v);
+        return vValues[0] + vValues[1] + vValues[2] + vValues[3];
+    }
+#else
+    std::array<float, 4> v;
+
+    static Float4 broadcast(float value) { return {{value, value, value, value}}; }
+    static Float4 set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+    friend Float4 operator+(Float4 a, Float4 b) {
+        return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+    }
+    friend Float4 operator*(Float4 a, Float4 b) {
+        return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+    }
+    friend Float4 inverseSqrt(Float4 a) {
+        return {{1.0F / std::sqrt(a.v[0]),
+                 1.0F / std::sqrt(a.v[1]),
+                 1.0F / std::sqrt(a.v[2]),
+                 1.0F / std::sqrt(a.v[3])}};
+    }
+    float getSum() const { return v[0] + v[1] + v[2] + v[3]; }
+#endif
+};
+
+/**
+ * Returns coordinate of a texel's center on a cubemap face.
+ *
+ * @param iTexel Column or row of the texel.
+ * @param iSize  Size of the face.
+ *
+ * @return Coordinate in range [-1; 1].
+ */
+static float getFaceCoordinate(int iTexel, int iSize) {
+    return (static_cast<float>(iTexel) + 0.5F) * 2.0F / static_cast<float>(iSize) - 1.0F; // NOLINT
+}
+
+/**
+ * Returns direction that a texel's center points to.
+ *
+ * @param iFace Index of the face.
+ * @param iX    Column of the texel.
+ * @param iY    Row of the texel.
+ * @param iSize Size of the face.
+ *
+ * @return Normalized direction.
+ */
+static glm::vec3 getTexelDirection(size_t iFace, int iX, int iY, int iSize) {
+    const auto& axes = vCubemapFaceAxes[iFace];
+    return glm::normalize(
+        axes.major + getFaceCoordinate(iX, iSize) * axes.u + getFaceCoordinate(iY, iSize) * axes.v);
+}
+
+/**
+ * Samples a cubemap level with bilinear filtering (texels are not blended across edges of faces).
+ *
+ * @param level     Cubemap level.
+ * @param direction Direction to sample (not necessarily normalized).
+ *
+ * @return Color.
+ */
+static glm::vec3 sampleLevel(const RadianceCubemapLevel& level, const glm::vec3& direction) {
+    // Find the face that the direction points to.
+    const auto absolute = glm::abs(direction);
+    size_t iFace = 0;
+    float majorAxisLength = absolute.x;
+    if (absolute.y >= absolute.x && absolute.y >= absolute.z) {
+        iFace = direction.y > 0.0F ? 2 : 3;
+        majorAxisLength = absolute.y;
+    } else if (absolute.z >= absolute.x) {
+        iFace = direction.z > 0.0F ? 4 : 5; // NOLINT
+        majorAxisLength = absolute.z;
+    } else {
+        iFace = direction.x > 0.0F ? 0 : 1;
+    }
+
+    // Find coordinates of the nearest texels.
+    const auto& axes = vCubemapFaceAxes[iFace];
+    const auto size = static_cast<float>(level.iSize);
+    const auto maxCoordinate = size - 1.0F;
+    const auto x = std::clamp(
+        (glm::dot(direction, axes.u) / majorAxisLength + 1.0F) * 0.5F * size - 0.5F, 0.0F, maxCoordinate);
+    const auto y = std::clamp(
+        (glm::dot(direction, axes.v) / majorAxisLength + 1.0F) * 0.5F * size - 0.5F, 0.0F, maxCoordinate);
+    const auto iX0 = static_cast<int>(x);
+    const auto iY0 = static_cast<int>(y);
+    const auto iX1 = std::min(iX0 + 1, level.iSize - 1);
+    const auto iY1 = std::min(iY0 + 1, level.iSize - 1);
+    const auto fractionX = x - static_cast<float>(iX0);
+    const auto fractionY = y - static_cast<float>(iY0);
+
+    return glm::mix(
+        glm::mix(level.getTexel(iFace, iX0, iY0), level.getTexel(iFace, iX1, iY0), fractionX),
+        glm::mix(level.getTexel(iFace, iX0, iY1), level.getTexel(iFace, iX1, iY1), fractionX),
+        fractionY);
+}
+
+/**
+ * Samples a cubemap with trilinear filtering.
+ *
+ * @param vLevels   Mip levels of the cubemap.
+ * @param direction Direction to sample (not necessarily normalized).
+ * @param lod       Level of detail.
+ *
+ * @return Color.
+ */
+static glm::vec3
+sampleCubemap(const std::vector<RadianceCubemapLevel>& vLevels, const glm::vec3& direction, float lod) {
+    lod = std::clamp(lod, 0.0F, static_cast<float>(vLevels.size() - 1));
+    const auto iLevel = static_cast<size_t>(lod);
+    const auto fraction = lod - static_cast<float>(iLevel);
+    if (fraction == 0.0F) {
+        return sampleLevel(vLevels[iLevel], direction);
+    }
+
+    return glm::mix(
+        sampleLevel(vLevels[iLevel], direction), sampleLevel(vLevels[iLevel + 1], direction), fraction);
+}
+
+/**
+ * Converts decoded sRGB faces to a cubemap with linear colors of the specified size (by averaging texels
+ * that fall into a new texel).
+ *
+ * @remark Uses the smallest mip level of faces that is not smaller than the new cubemap.
+ *
+ * @param cubemap Decoded faces.
+ * @param iSize   Size of a face of the new cubemap.
+ *
+ * @return Cubemap level.
+ */
+static RadianceCubemapLevel
+createRadianceCubemap(const TextureImporter::DecodedCubemap& cubemap, int iSize) {
+    RadianceCubemapLevel level;
+    level.iSize = iSize;
+    level.vTexels.resize(iCubemapFaceCount * iSize * iSize);
+
+    int iSourceLevel = 0;
+    while (iSourceLevel + 1 < cubemap.iLevelCount && cubemap.getLevelSize(iSourceLevel + 1) >= iSize) {
+        iSourceLevel++;
+    }
+    const auto iSourceSize = cubemap.getLevelSize(iSourceLevel);
+
+    for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+        const auto* pPixels = cubemap.getFace(iSourceLevel, iFace).data();
+        for (int iY = 0; iY < iSize; iY++) {
+            const auto iSourceY0 = iY * iSourceSize / iSize;
+            const auto iSourceY1 = std::max(iSourceY0 + 1, (iY + 1) * iSourceSize / iSize);
+            for (int iX = 0; iX < iSize; iX++) {
+                const auto iSourceX0 = iX * iSourceSize / iSize;
+                const auto iSourceX1 = std::max(iSourceX0 + 1, (iX + 1) * iSourceSize / iSize);
+
+                auto sum = glm::vec3(0.0F, 0.0F, 0.0F);
+                for (int iSourceY = iSourceY0; iSourceY < iSourceY1; iSourceY++) {
+                    for (int iSourceX = iSourceX0; iSourceX < iSourceX1; iSourceX++) {
+                        const auto* pPixel = pPixels + (static_cast<size_t>(iSourceY) * iSourceSize +
+                                                        static_cast<size_t>(iSourceX)) *
+                                                           3;
+                        sum += glm::vec3(
+                            MathHelpers::srgbToLinear(pPixel[0]),
+                            MathHelpers::srgbToLinear(pPixel[1]),
+                            MathHelpers::srgbToLinear(pPixel[2]));
+                    }
+                }
+
+                const auto iTexelCount = (iSourceX1 - iSourceX0) * (iSourceY1 - iSourceY0);
+                level.vTexels[(iFace * iSize + iY) * iSize + iX] = sum / static_cast<float>(iTexelCount);
+            }
+        }
+    }
+
+    return level;
+}
+
+/**
+ * Creates the next (twice smaller) mip level of a cubemap.
+ *
+ * @param level Cubemap level (bigger than 1x1).
+ *
+ * @return Cubemap level.
+ */
+static RadianceCubemapLevel createNextLevel(const RadianceCubemapLevel& level) {
+    RadianceCubemapLevel nextLevel;
+    nextLevel.iSize = level.iSize / 2;
+    nextLevel.vTexels.resize(iCubemapFaceCount * nextLevel.iSize * nextLevel.iSize);
+
+    for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+        for (int iY = 0; iY < nextLevel.iSize; iY++) {
+            for (int iX = 0; iX < nextLevel.iSize; iX++) {
+                nextLevel.vTexels[(iFace * nextLevel.iSize + iY) * nextLevel.iSize + iX] =
+                    (level.getTexel(iFace, iX * 2, iY * 2) + level.getTexel(iFace, iX * 2 + 1, iY * 2) +
+                     level.getTexel(iFace, iX * 2, iY * 2 + 1) +
+                     level.getTexel(iFace, iX * 2 + 1, iY * 2 + 1)) *
+                    0.25F; // NOLINT
+            }
+        }
+    }
+
+    return nextLevel;
+}
+
+/**
+ * Projects radiance of a cubemap to the first 3 bands of spherical harmonics and convolves it with the
+ * cosine lobe.
+ *
+ * @remark Processes 4 texels of a row at once.
+ *
+ * @param level Cubemap level which size is a multiple of 4.
+ *
+ * @return RGB coefficients of irradiance divided by pi.
+ */
+static std::array<glm::vec4, iIrradianceCoefficientCount>
+projectIrradiance(const RadianceCubemapLevel& level) {
+    // Sums of radiance multiplied by each basis function (RGB of each coefficient one after another).
+    std::array<double, iIrradianceCoefficientCount * 3> vSums{};
+    double totalWeight = 0.0;
+
+    for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+        const auto& axes = vCubemapFaceAxes[iFace];
+        for (int iY = 0; iY < level.iSize; iY++) {
+            const auto t = getFaceCoordinate(iY, level.iSize);
+
+            // Direction of a texel is `major + s * u + t * v`, prepare parts that are the same for a row.
+            const auto rowDirection = axes.major + t * axes.v;
+            const auto rowX = Float4::broadcast(rowDirection.x);
+            const auto rowY = Float4::broadcast(rowDirection.y);
+            const auto rowZ = Float4::broadcast(rowDirection.z);
+            const auto uX = Float4::broadcast(axes.u.x);
+            const auto uY = Float4::broadcast(axes.u.y);
+            const auto uZ = Float4::broadcast(axes.u.z);
+            const auto rowLengthSquared = Float4::broadcast(1.0F + t * t);
+
+            std::array<Float4, iIrradianceCoefficientCount * 3> vRowSums;
+            vRowSums.fill(Float4::broadcast(0.0F));
+            auto rowWeight = Float4::broadcast(0.0F);
+
+            for (int iX = 0; iX < level.iSize; iX += 4) {
+                const auto s = Float4::set(
+                    getFaceCoordinate(iX, level.iSize),
+                    getFaceCoordinate(iX + 1, level.iSize),
+                    getFaceCoordinate(iX + 2, level.iSize),
+                    getFaceCoordinate(iX + 3, level.iSize));
+
+                // Normalize directions.
+                const auto inverseLength = inverseSqrt(rowLengthSquared + s * s);
+                const auto x = (rowX + s * uX) * inverseLength;
+                const auto y = (rowY + s * uY) * inverseLength;
+                const auto z = (rowZ + s * uZ) * inverseLength;
+
+                // Solid angle of a texel is proportional to `1 / length^3`.
+                const auto weight = inverseLength * inverseLength * inverseLength;
+                rowWeight = rowWeight + weight;
+
+                // Evaluate basis functions.
+                const std::array<Float4, iIrradianceCoefficientCount> vBasis = {
+                    Float4::broadcast(0.282095F),                                              // NOLINT
+                    y * Float4::broadcast(0.488603F),                                          // NOLINT
+                    z * Float4::broadcast(0.488603F),                                          // NOLINT
+                    x * Float4::broadcast(0.488603F),                                          // NOLINT
+                    x * y * Float4::broadcast(1.092548F),                                      // NOLINT
+                    y * z * Float4::broadcast(1.092548F),                                      // NOLINT
+                    (z * z * Float4::broadcast(3.0F) + Float4::broadcast(-1.0F)) *             // NOLINT
+                        Float4::broadcast(0.315392F),                                          // NOLINT
+                    x * z * Float4::broadcast(1.092548F),                                      // NOLINT
+                    (x * x + y * y * Float4::broadcast(-1.0F)) * Float4::broadcast(0.546274F)}; // NOLINT
+
+                // Accumulate weighted radiance.
+                const auto& texel0 = level.getTexel(iFace, iX, iY);
+                const auto& texel1 = level.getTexel(iFace, iX + 1, iY);
+                const auto& texel2 = level.getTexel(iFace, iX + 2, iY);
+                const auto& texel3 = level.getTexel(iFace, iX + 3, iY);
+                const std::array<Float4, 3> vRadiance = {
+                    Float4::set(texel0.x, texel1.x, texel2.x, texel3.x) * weight,
+                    Float4::set(texel0.y, texel1.y, texel2.y, texel3.y) * weight,
+                    Float4::set(texel0.z, texel1.z, texel2.z, texel3.z) * weight};
+                for (size_t i = 0; i < vBasis.size(); i++) {
+                    for (size_t iChannel = 0; iChannel < vRadiance.size(); iChannel++) {
+                        auto& rowSum = vRowSums[i * 3 + iChannel];
+                        rowSum = rowSum + vBasis[i] * vRadiance[iChannel];
+                    }
+                }
+            }
+
+            // Accumulate rows in doubles to not lose precision.
+            for (size_t i = 0; i < vSums.size(); i++) {
+                vSums[i] += vRowSums[i].getSum();
+            }
+            totalWeight += rowWeight.getSum();
+        }
+    }
+
+    // Weights sum up to the solid angle of a sphere, then convolve each band with the cosine lobe
+    // (divided by pi).
+    const auto scale = 4.0 * std::numbers::pi / totalWeight;
+    static constexpr std::array<double, iIrradianceCoefficientCount> vBandFactors = {
+        1.0, 2.0 / 3.0, 2.0 / 3.0, 2.0 / 3.0, 0.25, 0.25, 0.25, 0.25, 0.25}; // NOLINT
+
+    std::array<glm::vec4, iIrradianceCoefficientCount> vCoefficients{};
+    for (size_t i = 0; i < vCoefficients.size(); i++) {
+        const auto factor = scale * vBandFactors[i];
+        vCoefficients[i] = glm::vec4(
+            static_cast<float>(vSums[i * 3] * factor),
+            static_cast<float>(vSums[i * 3 + 1] * factor),
+            static_cast<float>(vSums[i * 3 + 2] * factor),
+            0.0F);
+    }
+
+    return vCoefficients;
+}
+
+/**
+ * Returns a point of the Hammersley sequence.
+ *
+ * @param iIndex Index of the point.
+ * @param iCount Number of points.
+ *
+ * @return Point in range [0; 1).
+ */
+static glm::vec2 getHammersleyPoint(uint32_t iIndex, uint32_t iCount) {
+    // Reverse bits of the index (radical inverse in base 2).
+    uint32_t iBits = iIndex;
+    iBits = (iBits << 16U) | (iBits >> 16U);                               // NOLINT
+    iBits = ((iBits & 0x55555555U) << 1U) | ((iBits & 0xAAAAAAAAU) >> 1U); // NOLINT
+    iBits = ((iBits & 0x33333333U) << 2U) | ((iBits & 0xCCCCCCCCU) >> 2U); // NOLINT
+    iBits = ((iBits & 0x0F0F0F0FU) << 4U) | ((iBits & 0xF0F0F0F0U) >> 4U); // NOLINT
+    iBits = ((iBits & 0x00FF00FFU) << 8U) | ((iBits & 0xFF00FF00U) >> 8U); // NOLINT
+
+    return glm::vec2(
+        static_cast<float>(iIndex) / static_cast<float>(iCount),
+        static_cast<float>(iBits) * 2.3283064365386963e-10F); // NOLINT: divide by 2^32
+}
+
+/**
+ * Importance samples a GGX distribution around the normal (0, 0, 1).
+ *
+ * @param point     Point in range [0; 1).
+ * @param roughness Roughness.
+ *
+ * @return Halfway direction.
+ */
+static glm::vec3 sampleGgxHalfwayDirection(const glm::vec2& point, float roughness) {
+    const auto alpha = roughness * roughness;
+    const auto phi = 2.0F * std::numbers::pi_v<float> * point.x;
+    const auto cosTheta = std::sqrt((1.0F - point.y) / (1.0F + (alpha * alpha - 1.0F) * point.y));
+    const auto sinTheta = std::sqrt(1.0F - cosTheta * cosTheta);
+
+    return glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+/** Light direction that is used to prefilter a texel. */
+struct PrefilterSample {
+    /** Light direction around the normal (0, 0, 1). */
+    glm::vec3 direction;
+
+    /** Level of detail of the source cubemap to sample (to avoid aliasing of sparse samples). */
+    float lod = 0.0F;
+};
+
+/**
+ * Returns light directions that prefilter a cubemap with a GGX distribution (assuming that view direction
+ * is equal to the normal).
+ *
+ * @param roughness   Roughness of the distribution.
+ * @param iSourceSize Size of the most detailed level of the source cubemap.
+ *
+ * @return Samples with positive weight.
+ */
+static std::vector<PrefilterSample> getPrefilterSamples(float roughness, int iSourceSize) {
+    const auto alphaSquared = roughness * roughness * roughness * roughness;
+    const auto texelSolidAngle = 4.0F * std::numbers::pi_v<float> /
+                                 (static_cast<float>(iCubemapFaceCount) * static_cast<float>(iSourceSize) *
+                                  static_cast<float>(iSourceSize));
+
+    std::vector<PrefilterSample> vSamples;
+    for (uint32_t i = 0; i < iPrefilterSampleCount; i++) {
+        const auto halfway =
+            sampleGgxHalfwayDirection(getHammersleyPoint(i, iPrefilterSampleCount), roughness);
+        const auto light = 2.0F * halfway.z * halfway - glm::vec3(0.0F, 0.0F, 1.0F);
+        if (light.z <= 0.0F) {
+            continue;
+        }
+
+        // Probability of the light direction (N.H is equal to V.H since view direction is the normal).
+        const auto denominator = halfway.z * halfway.z * (alphaSquared - 1.0F) + 1.0F;
+        const auto distribution = alphaSquared / (std::numbers::pi_v<float> * denominator * denominator);
+        const auto probability = distribution * 0.25F; // NOLINT
+
+        // Sample a level which texels cover the solid angle of the sample.
+        const auto sampleSolidAngle = 1.0F / (static_cast<float>(iPrefilterSampleCount) * probability);
+        vSamples.push_back(PrefilterSample{
+            .direction = light,
+            .lod = std::max(0.5F * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0F, 0.0F)}); // NOLINT
+    }
+
+    return vSamples;
+}
+
+/**
+ * Returns offset of the first texel of a level of the prefiltered cubemap.
+ *
+ * @param iLevel Index of the level.
+ *
+ * @return Offset in half floats.
+ */
+static size_t getSpecularLevelOffset(int iLevel) {
+    size_t iOffset = 0;
+    for (int i = 0; i < iLevel; i++) {
+        const auto iSize = static_cast<size_t>(EnvironmentLighting::iSpecularCubemapSize >> i);
+        iOffset += iCubemapFaceCount * iSize * iSize * 3;
+    }
+    return iOffset;
+}
+
+/**
+ * Prefilters a face of a cubemap with a GGX distribution.
+ *
+ * @param vSourceLevels Mip levels of the source cubemap.
+ * @param vSamples      Samples of the distribution.
+ * @param iFace         Index of the face.
+ * @param iSize         Size of the prefiltered face.
+ * @param pTexels       Half float RGB texels to write the face to.
+ */
+static void prefilterFace(
+    const std::vector<RadianceCubemapLevel>& vSourceLevels,
+    const std::vector<PrefilterSample>& vSamples,
+    size_t iFace,
+    int iSize,
+    uint16_t* pTexels) {
+    for (int iY = 0; iY < iSize; iY++) {
+        for (int iX = 0; iX < iSize; iX++) {
+            // Prepare basis around the normal.
+            const auto normal = getTexelDirection(iFace, iX, iY, iSize);
+            const auto up = std::abs(normal.z) < 0.999F // NOLINT
+                                ? glm::vec3(0.0F, 0.0F, 1.0F)
+                                : glm::vec3(1.0F, 0.0F, 0.0F);
+            const auto tangent = glm::normalize(glm::cross(up, normal));
+            const auto bitangent = glm::cross(normal, tangent);
+
+            // Sum samples weighted by N.L.
+            auto sum = glm::vec3(0.0F, 0.0F, 0.0F);
+            float totalWeight = 0.0F;
+            for (const auto& sample : vSamples) {
+                const auto light = tangent * sample.direction.x + bitangent * sample.direction.y +
+                                   normal * sample.direction.z;
+                sum += sampleCubemap(vSourceLevels, light, sample.lod) * sample.direction.z;
+                totalWeight += sample.direction.z;
+            }
+
+            const auto color = sum / totalWeight;
+            auto* pTexel = pTexels + (static_cast<size_t>(iY) * iSize + static_cast<size_t>(iX)) * 3;
+            pTexel[0] = glm::packHalf1x16(color.x);
+            pTexel[1] = glm::packHalf1x16(color.y);
+            pTexel[2] = glm::packHalf1x16(color.z);
+        }
+    }
+}
+
+/**
+ * Computes the split-sum approximation of the specular BRDF (scale and bias of F0) for combinations
+ * of view angles and roughness.
+ *
+ * @return Half float RG texels (U is cosine of the view angle, V is roughness).
+ */
+static std::vector<uint16_t> computeBrdfLookupTexels() {
+    static constexpr auto iSize = EnvironmentLighting::iBrdfLookupTextureSize;
+
+    std::vector<uint16_t> vTexels(static_cast<size_t>(iSize) * iSize * 2);
+    for (int iY = 0; iY < iSize; iY++) {
+        const auto roughness = (static_cast<float>(iY) + 0.5F) / static_cast<float>(iSize); // NOLINT
+        const auto alpha = roughness * roughness;
+        const auto k = alpha * 0.5F; // NOLINT: Schlick-GGX remapping for image-based lighting
+
+        for (int iX = 0; iX < iSize; iX++) {
+            const auto cosView = (static_cast<float>(iX) + 0.5F) / static_cast<float>(iSize); // NOLINT
+            const auto view = glm::vec3(std::sqrt(1.0F - cosView * cosView), 0.0F, cosView);
+
+            float scale = 0.0F;
+            float bias = 0.0F;
+            for (uint32_t i = 0; i < iBrdfSampleCount; i++) {
+                const auto halfway =
+                    sampleGgxHalfwayDirection(getHammersleyPoint(i, iBrdfSampleCount), roughness);
+                const auto cosViewHalfway = std::max(glm::dot(view, halfway), 0.0F);
+                const auto light = 2.0F * cosViewHalfway * halfway - view;
+                if (light.z <= 0.0F) {
+                    continue;
+                }
+
+                const auto geometry = (cosView / (cosView * (1.0F - k) + k)) *
+                                      (light.z / (light.z * (1.0F - k) + k));
+                const auto visibility = geometry * cosViewHalfway / (halfway.z * cosView);
+                const auto fresnel = std::pow(1.0F - cosViewHalfway, 5.0F); // NOLINT
+
+                scale += (1.0F - fresnel) * visibility;
+                bias += fresnel * visibility;
+            }
+
+            auto* pTexel = vTexels.data() + (static_cast<size_t>(iY) * iSize + static_cast<size_t>(iX)) * 2;
+            pTexel[0] = glm::packHalf1x16(scale / static_cast<float>(iBrdfSampleCount));
+            pTexel[1] = glm::packHalf1x16(bias / static_cast<float>(iBrdfSampleCount));
+        }
+    }
+
+    return vTexels;
+}
+
+/**
+ * Returns hash of pixels of the most detailed level of a cubemap.
+ *
+ * @param cubemap Decoded faces.
+ *
+ * @return Hash.
+ */
+static uint64_t getCubemapHash(const TextureImporter::DecodedCubemap& cubemap) {
+    const auto pState = std::unique_ptr<XXH3_state_t, decltype(&XXH3_freeState)>(
+        XXH3_createState(), &XXH3_freeState);
+    if (pState == nullptr) [[unlikely]] {
+        throw std::runtime_error("failed to create a hash state");
+    }
+
+    XXH3_64bits_reset_withSeed(pState.get(), EnvironmentLighting::iFormatVersion);
+    XXH3_64bits_update(pState.get(), &cubemap.iSize, sizeof(cubemap.iSize));
+    for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+        const auto face = cubemap.getFace(0, iFace);
+        XXH3_64bits_update(pState.get(), face.data(), face.size());
+    }
+
+    return XXH3_64bits_digest(pState.get());
+}
+
+std::unique_ptr<EnvironmentLighting> EnvironmentLighting::create(
+    const TextureImporter::DecodedCubemap& cubemap, TextureUploader* pTextureUploader) {
+    auto pLighting = std::unique_ptr<EnvironmentLighting>(new EnvironmentLighting());
+
+    // Load from the cache or precompute.
+    const auto iSourceHash = getCubemapHash(cubemap);
+    std::optional<PrecomputedData> optionalData;
+    if (bIsCacheEnabled) {
+        optionalData = loadFromCache(iSourceHash);
+    }
+    pLighting->bIsLoadedFromCache = optionalData.has_value();
+    if (!optionalData.has_value()) {
+        optionalData = precompute(cubemap);
+        if (bIsCacheEnabled) {
+            saveToCache(iSourceHash, *optionalData);
+        }
+    }
+    const auto pData = std::make_shared<const PrecomputedData>(std::move(*optionalData));
+    pLighting->vIrradianceCoefficients = pData->vIrradianceCoefficients;
+
+    // Create prefiltered cubemap.
+    unsigned int iCubemapId = 0;
+    glGenTextures(1, &iCubemapId);
+    pLighting->pSpecularCubemap = Texture::create(iCubemapId);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, iCubemapId);
+    glTexStorage2D(
+        GL_TEXTURE_CUBE_MAP, iSpecularLevelCount, GL_RGB16F, iSpecularCubemapSize, iSpecularCubemapSize);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    TextureUploader::TextureData specularData;
+    specularData.iBindTarget = GL_TEXTURE_CUBE_MAP;
+    specularData.iFormat = GL_RGB;
+    specularData.iType = GL_HALF_FLOAT;
+    specularData.pDataOwner = pData;
+    for (int iLevel = 0; iLevel < iSpecularLevelCount; iLevel++) {
+        const auto iSize = iSpecularCubemapSize >> iLevel;
+        const auto iFaceSize = static_cast<size_t>(iSize) * iSize * 3;
+        for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+            const auto* pFace =
+                pData->vSpecularTexels.data() + getSpecularLevelOffset(iLevel) + iFace * iFaceSize;
+            specularData.vLevels.push_back(TextureUploader::Level{
+                .iTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<int>(iFace),
+                .iLevel = iLevel,
+                .iWidth = iSize,
+                .iHeight = iSize,
+                .vData = std::span<const unsigned char>(
+                    reinterpret_cast<const unsigned char*>(pFace), iFaceSize * sizeof(uint16_t))}); // NOLINT
+        }
+    }
+    TextureUploader::submit(pLighting->pSpecularCubemap, std::move(specularData), pTextureUploader);
+
+    // Create BRDF lookup texture.
+    unsigned int iLookupTextureId = 0;
+    glGenTextures(1, &iLookupTextureId);
+    pLighting->pBrdfLookupTexture = Texture::create(iLookupTextureId);
+    glBindTexture(GL_TEXTURE_2D, iLookupTextureId);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F, iBrdfLookupTextureSize, iBrdfLookupTextureSize);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    TextureUploader::TextureData brdfData;
+    brdfData.iFormat = GL_RG;
+    brdfData.iType = GL_HALF_FLOAT;
+    brdfData.pDataOwner = pData;
+    brdfData.vLevels.push_back(TextureUploader::Level{
+        .iTarget = GL_TEXTURE_2D,
+        .iLevel = 0,
+        .iWidth = iBrdfLookupTextureSize,
+        .iHeight = iBrdfLookupTextureSize,
+        .vData = std::span<const unsigned char>(
+            reinterpret_cast<const unsigned char*>(pData->vBrdfTexels.data()), // NOLINT
+            pData->vBrdfTexels.size() * sizeof(uint16_t))});
+    TextureUploader::submit(pLighting->pBrdfLookupTexture, std::move(brdfData), pTextureUploader);
+
+    return pLighting;
+}
+
+const std::array<glm::vec4, iIrradianceCoefficientCount>&
+EnvironmentLighting::getIrradianceCoefficients() const {
+    return vIrradianceCoefficients;
+}
+
+const Texture& EnvironmentLighting::getSpecularCubemap() const { return *pSpecularCubemap; }
+
+const Texture& EnvironmentLighting::getBrdfLookupTexture() const { return *pBrdfLookupTexture; }
+
+bool EnvironmentLighting::isLoadedFromCache() const { return bIsLoadedFromCache; }
+
+EnvironmentLighting::PrecomputedData
+EnvironmentLighting::precompute(const TextureImporter::DecodedCubemap& cubemap) {
+    // Prepare mip levels of the source (levels that are smaller than a prefiltered face are sampled
+    // to avoid aliasing).
+    std::vector<RadianceCubemapLevel> vSourceLevels;
+    vSourceLevels.push_back(createRadianceCubemap(cubemap, iSpecularCubemapSize));
+    while (vSourceLevels.back().iSize > 1) {
+        vSourceLevels.push_back(createNextLevel(vSourceLevels.back()));
+    }
+
+    PrecomputedData data;
+    data.vIrradianceCoefficients = projectIrradiance(vSourceLevels[0]);
+    data.vSpecularTexels.resize(getSpecularLevelOffset(iSpecularLevelCount));
+
+    // The first level stores the source as is (mirror reflection).
+    const auto& baseLevel = vSourceLevels[0];
+    for (size_t i = 0; i < baseLevel.vTexels.size(); i++) {
+        data.vSpecularTexels[i * 3] = glm::packHalf1x16(baseLevel.vTexels[i].x);
+        data.vSpecularTexels[i * 3 + 1] = glm::packHalf1x16(baseLevel.vTexels[i].y);
+        data.vSpecularTexels[i * 3 + 2] = glm::packHalf1x16(baseLevel.vTexels[i].z);
+    }
+
+    // Prefilter faces of other levels on worker threads.
+    std::vector<std::vector<PrefilterSample>> vLevelSamples(iSpecularLevelCount);
+    std::vector<std::future<void>> vTasks;
+    for (int iLevel = 1; iLevel < iSpecularLevelCount; iLevel++) {
+        const auto roughness = static_cast<float>(iLevel) / static_cast<float>(iSpecularLevelCount - 1);
+        vLevelSamples[iLevel] = getPrefilterSamples(roughness, iSpecularCubemapSize);
+
+        const auto iSize = iSpecularCubemapSize >> iLevel;
+        const auto iFaceSize = static_cast<size_t>(iSize) * iSize * 3;
+        for (size_t iFace = 0; iFace < iCubemapFaceCount; iFace++) {
+            auto* pTexels = data.vSpecularTexels.data() + getSpecularLevelOffset(iLevel) + iFace * iFaceSize;
+            const auto& vSamples = vLevelSamples[iLevel];
+            vTasks.push_back(ThreadPool::get().addTask([&vSourceLevels, &vSamples, iFace, iSize, pTexels]() {
+                prefilterFace(vSourceLevels, vSamples, iFace, iSize, pTexels);
+            }));
+        }
+    }
+
+    // Compute the lookup texture while faces are prefiltered.
+    data.vBrdfTexels = computeBrdfLookupTexels();
+
+    for (auto& task : vTasks) {
+        task.get();
+    }
+
+    return data;
+}
+
+std::optional<EnvironmentLighting::PrecomputedData> EnvironmentLighting::loadFromCache(uint64_t iSourceHash) {
+    const auto pathToCacheFile = getPathToCacheFile(iSourceHash);
+    if (!std::filesystem::exists(pathToCacheFile)) {
+        return {};
+    }
+
+    std::ifstream file(pathToCacheFile, std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    // Check header.
+    FileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header)); // NOLINT
+    if (file.fail() || header.vMagic != vCacheFileMagic || header.iFormatVersion != iFormatVersion ||
+        header.iSpecularCubemapSize != iSpecularCubemapSize ||
+        header.iSpecularLevelCount != iSpecularLevelCount ||
+        header.iBrdfLookupTextureSize != iBrdfLookupTextureSize || header.iSourceHash != iSourceHash) {
+        return {};
+    }
+
+    // Read data.
+    PrecomputedData data;
+    data.vSpecularTexels.resize(getSpecularLevelOffset(iSpecularLevelCount));
+    data.vBrdfTexels.resize(static_cast<size_t>(iBrdfLookupTextureSize) * iBrdfLookupTextureSize * 2);
+    const auto readBytes = [&file](void* pData, size_t iSizeInBytes) {
+        file.read(static_cast<char*>(pData), static_cast<std::streamsize>(iSizeInBytes));
+    };
+    readBytes(data.vIrradianceCoefficients.data(), sizeof(data.vIrradianceCoefficients));
+    readBytes(data.vSpecularTexels.data(), data.vSpecularTexels.size() * sizeof(uint16_t));
+    readBytes(data.vBrdfTexels.data(), data.vBrdfTexels.size() * sizeof(uint16_t));
+    if (file.fail()) {
+        return {};
+    }
+
+    return data;
+}
+
+void EnvironmentLighting::saveToCache(uint64_t iSourceHash, const PrecomputedData& data) {
+    FileHeader header;
+    header.vMagic = vCacheFileMagic;
+    header.iFormatVersion = iFormatVersion;
+    header.iSpecularCubemapSize = iSpecularCubemapSize;
+    header.iSpecularLevelCount = iSpecularLevelCount;
+    header.iBrdfLookupTextureSize = iBrdfLookupTextureSize;
+    header.iSourceHash = iSourceHash;
+
+    FileHelpers::writeCacheFile(getPathToCacheFile(iSourceHash), [&header, &data](std::ofstream& file) {
+        const auto writeBytes = [&file](const void* pData, size_t iSizeInBytes) {
+            file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(iSizeInBytes));
+        };
+        writeBytes(&header, sizeof(header));
+        writeBytes(data.vIrradianceCoefficients.data(), sizeof(data.vIrradianceCoefficients));
+        writeBytes(data.vSpecularTexels.data(), data.vSpecularTexels.size() * sizeof(uint16_t));
+        writeBytes(data.vBrdfTexels.data(), data.vBrdfTexels.size() * sizeof(uint16_t));
+    });
+}
+
+std::filesystem::path EnvironmentLighting::getPathToCacheFile(uint64_t iSourceHash) {
+    return pathToCacheDirectory / std::format("{:016x}.envcache", iSourceHash);
+}
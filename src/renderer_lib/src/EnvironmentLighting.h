@@ -0,0 +1,181 @@
+#pragma once
+
+// Standard.
+#include <filesystem>
+#include <memory>
+#include <array>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+// Custom.
+#include "math/GLMath.hpp"
+#include "shader/UniformBlocks.hpp"
+#include "import/TextureImporter.h"
+
+class Texture;
+class TextureUploader;
+
+/**
+ * Image-based lighting precomputed from an environment cubemap: irradiance (for diffuse lighting) projected
+ * to spherical harmonics, a cubemap which mip levels store the environment prefiltered with GGX
+ * distributions of increasing roughness (for specular lighting) and a lookup table of the split-sum
+ * approximation of the specular BRDF.
+ *
+ * @remark Precomputed data is cached on disk (by hash of the cubemap's pixels) so it's only computed once.
+ */
+class EnvironmentLighting {
+public:
+    EnvironmentLighting(const EnvironmentLighting&) = delete;
+    EnvironmentLighting& operator=(const EnvironmentLighting&) = delete;
+
+    /**
+     * Loads lighting of the specified cubemap from the cache or precomputes (and caches) it.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param cubemap          Decoded faces of the environment cubemap.
+     * @param pTextureUploader Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     *
+     * @return Created lighting.
+     */
+    static std::unique_ptr<EnvironmentLighting>
+    create(const TextureImporter::DecodedCubemap& cubemap, TextureUploader* pTextureUploader);
+
+    /**
+     * Returns spherical harmonics coefficients of irradiance divided by pi (so that evaluating them
+     * for a normal and multiplying by the diffuse color gives reflected radiance).
+     *
+     * @return RGB coefficients (alpha is unused) in the order of `FrameData` block from shaders.
+     */
+    const std::array<glm::vec4, iIrradianceCoefficientCount>& getIrradianceCoefficients() const;
+
+    /**
+     * Returns cubemap with prefiltered environment (the roughness of a mip level is its index divided by
+     * the index of the last level).
+     *
+     * @return Cubemap texture.
+     */
+    const Texture& getSpecularCubemap() const;
+
+    /**
+     * Returns 2D texture with scale (red) and bias (green) of F0 in the split-sum approximation of the
+     * specular BRDF, indexed by cosine of the view angle (U) and roughness (V).
+     *
+     * @return Lookup texture.
+     */
+    const Texture& getBrdfLookupTexture() const;
+
+    /**
+     * Tells whether the lighting was loaded from the cache or precomputed.
+     *
+     * @return `true` if loaded from the cache.
+     */
+    bool isLoadedFromCache() const;
+
+    /** Directory to store cache files in. */
+    static inline std::filesystem::path pathToCacheDirectory =
+        std::filesystem::temp_directory_path() / "opengl-renderer" / "environment_cache";
+
+    /** Whether precomputed lighting should be loaded from/saved to the cache or not. */
+    static inline bool bIsCacheEnabled = true;
+
+    /** Version of the cache format, increase when the format or precomputed data changes. */
+    static constexpr uint32_t iFormatVersion = 1;
+
+    /** Width and height of the most detailed level of the prefiltered cubemap. */
+    static constexpr int iSpecularCubemapSize = 256; // NOLINT
+
+    /** Number of mip levels of the prefiltered cubemap (the last one is 4x4). */
+    static constexpr int iSpecularLevelCount = 7; // NOLINT
+
+    /** Width and height of the BRDF lookup texture. */
+    static constexpr int iBrdfLookupTextureSize = 64; // NOLINT
+
+private:
+    /** Lighting that is stored in cache files. */
+    struct PrecomputedData {
+        /** See @ref getIrradianceCoefficients. */
+        std::array<glm::vec4, iIrradianceCoefficientCount> vIrradianceCoefficients{};
+
+        /** Half float RGB texels of all faces of each level (levels are stored one after another). */
+        std::vector<uint16_t> vSpecularTexels;
+
+        /** Half float RG texels of the BRDF lookup texture. */
+        std::vector<uint16_t> vBrdfTexels;
+    };
+
+    /** Header of a cache file, followed by data of @ref PrecomputedData. */
+    struct FileHeader {
+        /** Identifies the file type. */
+        std::array<char, 8> vMagic{};
+
+        /** Equal to @ref iFormatVersion of the app that wrote the file. */
+        uint32_t iFormatVersion = 0;
+
+        /** Equal to @ref iSpecularCubemapSize of the app that wrote the file. */
+        int32_t iSpecularCubemapSize = 0;
+
+        /** Equal to @ref iSpecularLevelCount of the app that wrote the file. */
+        int32_t iSpecularLevelCount = 0;
+
+        /** Equal to @ref iBrdfLookupTextureSize of the app that wrote the file. */
+        int32_t iBrdfLookupTextureSize = 0;
+
+        /** Hash of the cubemap's pixels. */
+        uint64_t iSourceHash = 0;
+    };
+
+    EnvironmentLighting() = default;
+
+    /**
+     * Precomputes lighting of the specified cubemap.
+     *
+     * @remark Prefilters cubemap faces on worker threads and waits for them.
+     *
+     * @param cubemap Decoded faces of the environment cubemap.
+     *
+     * @return Precomputed lighting.
+     */
+    static PrecomputedData precompute(const TextureImporter::DecodedCubemap& cubemap);
+
+    /**
+     * Loads precomputed lighting from the cache.
+     *
+     * @param iSourceHash Hash of the cubemap's pixels.
+     *
+     * @return Empty if there is no valid cache file.
+     */
+    static std::optional<PrecomputedData> loadFromCache(uint64_t iSourceHash);
+
+    /**
+     * Writes precomputed lighting to the cache.
+     *
+     * @remark Failures are only logged (see @ref FileHelpers::writeCacheFile).
+     *
+     * @param iSourceHash Hash of the cubemap's pixels.
+     * @param data        Precomputed lighting.
+     */
+    static void saveToCache(uint64_t iSourceHash, const PrecomputedData& data);
+
+    /**
+     * Returns path to the cache file of a cubemap.
+     *
+     * @param iSourceHash Hash of the cubemap's pixels.
+     *
+     * @return Path to the file.
+     */
+    static std::filesystem::path getPathToCacheFile(uint64_t iSourceHash);
+
+    /** See @ref getIrradianceCoefficients. */
+    std::array<glm::vec4, iIrradianceCoefficientCount> vIrradianceCoefficients{};
+
+    /** Cubemap with prefiltered environment. */
+    std::shared_ptr<Texture> pSpecularCubemap;
+
+    /** Lookup texture of the specular BRDF. */
+    std::shared_ptr<Texture> pBrdfLookupTexture;
+
+    /** Whether the lighting was loaded from the cache or not. */
+    bool bIsLoadedFromCache = false;
+};
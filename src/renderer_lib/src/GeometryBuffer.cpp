@@ -0,0 +1,281 @@
+#include "GeometryBuffer.h"
+
+// Standard.
+#include <format>
+#include <limits>
+#include <algorithm>
+
+// Custom.
+#include "window/GLFW.hpp"
+
+GeometryAllocation::GeometryAllocation(
+    GeometryBuffer* pGeometryBuffer,
+    size_t iVertexOffset,
+    size_t iVertexCount,
+    IndexFormat indexFormat,
+    size_t iIndexOffset,
+    size_t iIndexCount)
+    : pGeometryBuffer(pGeometryBuffer), iVertexOffset(iVertexOffset), iVertexCount(iVertexCount),
+      indexFormat(indexFormat), iIndexOffset(iIndexOffset), iIndexCount(iIndexCount) {}
+
+GeometryAllocation::~GeometryAllocation() { pGeometryBuffer->free(*this); }
+
+int GeometryAllocation::getBaseVertex() const { return static_cast<int>(iVertexOffset); }
+
+unsigned int GeometryAllocation::getFirstIndex() const { return static_cast<unsigned int>(iIndexOffset); }
+
+size_t GeometryAllocation::getFirstIndexOffsetInBytes() const {
+    return iIndexOffset * GeometryBuffer::getIndexSize(indexFormat);
+}
+
+int GeometryAllocation::getIndexCount() const { return static_cast<int>(iIndexCount); }
+
+VertexFormat GeometryAllocation::getVertexFormat() const { return pGeometryBuffer->getVertexFormat(); }
+
+IndexFormat GeometryAllocation::getIndexFormat() const { return indexFormat; }
+
+unsigned int GeometryAllocation::getIndexType() const {
+    return indexFormat == IndexFormat::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+GeometryBuffer::GeometryBuffer(VertexFormat vertexFormat)
+    : vertexAllocator(0), vertexFormat(vertexFormat) {}
+
+GeometryBuffer::~GeometryBuffer() {
+    for (auto& indexPool : vIndexPools) {
+        glDeleteVertexArrays(1, &indexPool.iVertexArrayObjectId);
+        glDeleteBuffers(1, &indexPool.iIndexBufferObjectId);
+    }
+    glDeleteBuffers(1, &iVertexBufferObjectId);
+}
+
+std::unique_ptr<GeometryBuffer>
+GeometryBuffer::create(VertexFormat vertexFormat, size_t iVertexCapacity, size_t iIndexCapacity) {
+    auto pBuffer = std::unique_ptr<GeometryBuffer>(new GeometryBuffer(vertexFormat));
+
+    // Create vertex array objects (VAO), one per index type.
+    for (auto& indexPool : pBuffer->vIndexPools) {
+        glGenVertexArrays(1, &indexPool.iVertexArrayObjectId);
+    }
+
+    // Create buffers (VAOs will reference them).
+    pBuffer->growVertexBuffer(std::max(iVertexCapacity, size_t(1)));
+    pBuffer->growIndexBuffer(IndexFormat::UINT16, std::max(iIndexCapacity, size_t(1)));
+    pBuffer->growIndexBuffer(IndexFormat::UINT32, std::max(iIndexCapacity, size_t(1)));
+
+    return pBuffer;
+}
+
+std::unique_ptr<GeometryAllocation>
+GeometryBuffer::allocate(std::span<const Vertex> vVertices, std::span<const unsigned int> vIndices) {
+    return allocate(VertexFormat::FULL, vVertices.data(), vVertices.size(), vIndices);
+}
+
+std::unique_ptr<GeometryAllocation>
+GeometryBuffer::allocate(std::span<const PackedVertex> vVertices, std::span<const unsigned int> vIndices) {
+    return allocate(VertexFormat::PACKED, vVertices.data(), vVertices.size(), vIndices);
+}
+
+VertexFormat GeometryBuffer::getVertexFormat() const { return vertexFormat; }
+
+std::unique_ptr<GeometryAllocation> GeometryBuffer::allocate(
+    VertexFormat vertexFormat,
+    const void* pVertices,
+    size_t iVertexCount,
+    std::span<const unsigned int> vIndices) {
+    // Make sure the vertices have the same layout.
+    if (vertexFormat != this->vertexFormat) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "unable to allocate vertices of format {} in a geometry buffer of format {}",
+            static_cast<int>(vertexFormat),
+            static_cast<int>(this->vertexFormat)));
+    }
+
+    // Use 16-bit indices if all vertices can be referenced (base vertex is added after fetching an index).
+    const auto indexFormat =
+        iVertexCount <= size_t(std::numeric_limits<unsigned short>::max()) + 1 ? IndexFormat::UINT16
+                                                                              : IndexFormat::UINT32;
+
+    // Allocate ranges.
+    const auto iVertexOffset = allocateRange(
+        vertexAllocator, iVertexCount, [this](size_t iNewCapacity) { growVertexBuffer(iNewCapacity); });
+    const auto iIndexOffset =
+        allocateRange(getIndexPool(indexFormat).allocator, vIndices.size(), [&](size_t iNewCapacity) {
+            growIndexBuffer(indexFormat, iNewCapacity);
+        });
+    auto pAllocation = std::unique_ptr<GeometryAllocation>(new GeometryAllocation(
+        this, iVertexOffset, iVertexCount, indexFormat, iIndexOffset, vIndices.size()));
+
+    // Copy vertices.
+    const auto iVertexSize = getVertexSize();
+    glBindBuffer(GL_ARRAY_BUFFER, iVertexBufferObjectId);
+    glBufferSubData(
+        GL_ARRAY_BUFFER,
+        static_cast<GLintptr>(iVertexOffset * iVertexSize),
+        static_cast<GLsizeiptr>(iVertexCount * iVertexSize),
+        pVertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Narrow indices if needed.
+    std::vector<unsigned short> vShortIndices;
+    const void* pIndices = vIndices.data();
+    if (indexFormat == IndexFormat::UINT16) {
+        vShortIndices.assign(vIndices.begin(), vIndices.end());
+        pIndices = vShortIndices.data();
+    }
+
+    // Copy indices (not using the "element array" target to not modify the VAO).
+    const auto iIndexSize = getIndexSize(indexFormat);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, getIndexPool(indexFormat).iIndexBufferObjectId);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER,
+        static_cast<GLintptr>(iIndexOffset * iIndexSize),
+        static_cast<GLsizeiptr>(vIndices.size() * iIndexSize),
+        pIndices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return pAllocation;
+}
+
+unsigned int GeometryBuffer::getVertexArrayObjectId(IndexFormat indexFormat) const {
+    return vIndexPools[static_cast<size_t>(indexFormat)].iVertexArrayObjectId;
+}
+
+size_t GeometryBuffer::getIndexSize(IndexFormat indexFormat) {
+    return indexFormat == IndexFormat::UINT16 ? sizeof(unsigned short) : sizeof(unsigned int);
+}
+
+size_t GeometryBuffer::getVertexSize() const {
+    return vertexFormat == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+GeometryBuffer::Statistics GeometryBuffer::getStatistics() const {
+    Statistics stats;
+    stats.vertices = vertexAllocator.getStatistics();
+    stats.indices = vIndexPools[static_cast<size_t>(IndexFormat::UINT32)].allocator.getStatistics();
+    stats.shortIndices = vIndexPools[static_cast<size_t>(IndexFormat::UINT16)].allocator.getStatistics();
+    return stats;
+}
+
+size_t GeometryBuffer::getSizeInBytes() const {
+    size_t iSizeInBytes = vertexAllocator.getStatistics().iCapacity * getVertexSize();
+    for (size_t i = 0; i < vIndexPools.size(); i++) {
+        iSizeInBytes +=
+            vIndexPools[i].allocator.getStatistics().iCapacity * getIndexSize(static_cast<IndexFormat>(i));
+    }
+    return iSizeInBytes;
+}
+
+unsigned int
+GeometryBuffer::reallocateBuffer(unsigned int iOldBufferId, size_t iOldSizeInBytes, size_t iNewSizeInBytes) {
+    // Create a new buffer.
+    unsigned int iNewBufferId = 0;
+    glGenBuffers(1, &iNewBufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, iNewBufferId);
+    glBufferData(
+        GL_COPY_WRITE_BUFFER,
+        static_cast<GLsizeiptr>(iNewSizeInBytes),
+        nullptr,
+        GL_STATIC_DRAW); // `STATIC` because the data is rarely changed
+
+    // Copy old data (used ranges may be anywhere so copy everything).
+    if (iOldBufferId != 0) {
+        if (iOldSizeInBytes > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, iOldBufferId);
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(iOldSizeInBytes));
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &iOldBufferId);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return iNewBufferId;
+}
+
+size_t GeometryBuffer::allocateRange(
+    FreeListAllocator& allocator, size_t iSize, const std::function<void(size_t)>& onGrow) {
+    if (iSize == 0) {
+        // Nothing to allocate.
+        return 0;
+    }
+
+    // Try to find a free range.
+    auto iOffset = allocator.allocate(iSize);
+    if (iOffset.has_value()) {
+        return *iOffset;
+    }
+
+    // Grow at least 2 times to not reallocate on each mesh.
+    const auto iCapacity = allocator.getStatistics().iCapacity;
+    const auto iNewCapacity = std::max(iCapacity * 2, iCapacity + iSize);
+
+    // Make sure we don't exceed type limits of draw commands.
+    constexpr size_t iTypeLimit = std::numeric_limits<int>::max();
+    if (iNewCapacity > iTypeLimit) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "geometry buffer size {} (in vertices or indices) exceeds type limit of {}",
+            iNewCapacity,
+            iTypeLimit));
+    }
+
+    onGrow(iNewCapacity);
+
+    iOffset = allocator.allocate(iSize);
+    if (!iOffset.has_value()) [[unlikely]] {
+        throw std::runtime_error(std::format("failed to allocate {} element(s) after growing", iSize));
+    }
+
+    return *iOffset;
+}
+
+void GeometryBuffer::growVertexBuffer(size_t iNewVertexCapacity) {
+    iVertexBufferObjectId = reallocateBuffer(
+        iVertexBufferObjectId,
+        vertexAllocator.getStatistics().iCapacity * getVertexSize(),
+        iNewVertexCapacity * getVertexSize());
+    vertexAllocator.grow(iNewVertexCapacity);
+
+    // Point vertex attributes of all VAOs to the new buffer.
+    for (const auto& indexPool : vIndexPools) {
+        glBindVertexArray(indexPool.iVertexArrayObjectId);
+        glBindBuffer(GL_ARRAY_BUFFER, iVertexBufferObjectId);
+        if (vertexFormat == VertexFormat::PACKED) {
+            PackedVertex::setVertexAttributes();
+        } else {
+            Vertex::setVertexAttributes();
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void GeometryBuffer::growIndexBuffer(IndexFormat indexFormat, size_t iNewIndexCapacity) {
+    auto& indexPool = getIndexPool(indexFormat);
+    const auto iIndexSize = getIndexSize(indexFormat);
+
+    indexPool.iIndexBufferObjectId = reallocateBuffer(
+        indexPool.iIndexBufferObjectId,
+        indexPool.allocator.getStatistics().iCapacity * iIndexSize,
+        iNewIndexCapacity * iIndexSize);
+    indexPool.allocator.grow(iNewIndexCapacity);
+
+    // Point VAO to the new buffer.
+    glBindVertexArray(indexPool.iVertexArrayObjectId);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexPool.iIndexBufferObjectId);
+    glBindVertexArray(0);
+}
+
+GeometryBuffer::IndexPool& GeometryBuffer::getIndexPool(IndexFormat indexFormat) {
+    return vIndexPools[static_cast<size_t>(indexFormat)];
+}
+
+void GeometryBuffer::free(const GeometryAllocation& allocation) {
+    if (allocation.iVertexCount > 0) {
+        vertexAllocator.free(allocation.iVertexOffset, allocation.iVertexCount);
+    }
+    if (allocation.iIndexCount > 0) {
+        getIndexPool(allocation.indexFormat).allocator.free(allocation.iIndexOffset, allocation.iIndexCount);
+    }
+}
@@ -0,0 +1,358 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <array>
+#include <span>
+#include <memory>
+#include <functional>
+
+// Custom.
+#include "Mesh.h"
+#include "memory/FreeListAllocator.h"
+
+class GeometryBuffer;
+
+/** Layout of a command for `glMultiDrawElementsIndirect` (defined by OpenGL). */
+struct DrawElementsIndirectCommand {
+    /** Number of indices to draw. */
+    unsigned int iIndexCount = 0;
+
+    /** Number of instances to draw. */
+    unsigned int iInstanceCount = 0;
+
+    /** Index of the first index (in the index buffer) to draw. */
+    unsigned int iFirstIndex = 0;
+
+    /** Value added to each index before fetching a vertex. */
+    int iBaseVertex = 0;
+
+    /** Value of `gl_BaseInstance` in shaders. */
+    unsigned int iBaseInstance = 0;
+};
+
+/** Range of vertices and indices in a @ref GeometryBuffer, returns the range to the buffer when destroyed. */
+class GeometryAllocation {
+    // Only geometry buffer creates allocations.
+    friend class GeometryBuffer;
+
+public:
+    GeometryAllocation(const GeometryAllocation&) = delete;
+    GeometryAllocation& operator=(const GeometryAllocation&) = delete;
+
+    ~GeometryAllocation();
+
+    /**
+     * Returns index of the first vertex in the vertex buffer (added to each index when drawing).
+     *
+     * @return Base vertex.
+     */
+    int getBaseVertex() const;
+
+    /**
+     * Returns index of the first index in the index buffer.
+     *
+     * @return First index.
+     */
+    unsigned int getFirstIndex() const;
+
+    /**
+     * Returns offset of the first index in the index buffer (to be used as `indices` in draw commands).
+     *
+     * @return Offset in bytes.
+     */
+    size_t getFirstIndexOffsetInBytes() const;
+
+    /**
+     * Returns type of the allocated indices (allocations of different index types are stored
+     * in different index buffers, see @ref GeometryBuffer::getVertexArrayObjectId).
+     *
+     * @return Index format.
+     */
+    IndexFormat getIndexFormat() const;
+
+    /**
+     * Returns OpenGL type of the allocated indices (to be used as `type` in draw commands).
+     *
+     * @return `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`.
+     */
+    unsigned int getIndexType() const;
+
+    /**
+     * Returns the number of allocated indices.
+     *
+     * @return Index count.
+     */
+    int getIndexCount() const;
+
+    /**
+     * Returns layout of the allocated vertices.
+     *
+     * @return Vertex format of the buffer that the range belongs to.
+     */
+    VertexFormat getVertexFormat() const;
+
+private:
+    /**
+     * Initializes the object.
+     *
+     * @param pGeometryBuffer Buffer that the range belongs to.
+     * @param iVertexOffset   Index of the first vertex.
+     * @param iVertexCount    Number of vertices.
+     * @param indexFormat     Type of indices.
+     * @param iIndexOffset    Index of the first index (in the index buffer of the specified type).
+     * @param iIndexCount     Number of indices.
+     */
+    GeometryAllocation(
+        GeometryBuffer* pGeometryBuffer,
+        size_t iVertexOffset,
+        size_t iVertexCount,
+        IndexFormat indexFormat,
+        size_t iIndexOffset,
+        size_t iIndexCount);
+
+    /** Buffer that the range belongs to. */
+    GeometryBuffer* const pGeometryBuffer = nullptr;
+
+    /** Index of the first vertex. */
+    const size_t iVertexOffset = 0;
+
+    /** Number of vertices. */
+    const size_t iVertexCount = 0;
+
+    /** Type of indices. */
+    const IndexFormat indexFormat = IndexFormat::UINT32;
+
+    /** Index of the first index (in the index buffer of @ref indexFormat). */
+    const size_t iIndexOffset = 0;
+
+    /** Number of indices. */
+    const size_t iIndexCount = 0;
+};
+
+/**
+ * Vertex and index buffers shared by multiple meshes (each mesh occupies a range of vertices and indices)
+ * so that meshes can be drawn without switching buffers.
+ *
+ * @remark Meshes that have no more than 65536 vertices store 16-bit indices in a separate index buffer
+ * (draw commands use one index type so there's one vertex array object per index type).
+ *
+ * @remark Ranges are managed by free-list allocators so the space of destroyed meshes is reused.
+ */
+class GeometryBuffer {
+    // Allocations return their ranges.
+    friend class GeometryAllocation;
+
+public:
+    /** Groups information about memory usage. */
+    struct Statistics {
+        /** Usage of the vertex buffer (in vertices). */
+        FreeListAllocator::Statistics vertices;
+
+        /** Usage of the 32-bit index buffer (in indices). */
+        FreeListAllocator::Statistics indices;
+
+        /** Usage of the 16-bit index buffer (in indices). */
+        FreeListAllocator::Statistics shortIndices;
+    };
+
+    GeometryBuffer(const GeometryBuffer&) = delete;
+    GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+
+    /** @warning Expects that all allocations were destroyed. */
+    ~GeometryBuffer();
+
+    /**
+     * Creates a new buffer.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param vertexFormat    Layout of vertices that the buffer will store.
+     * @param iVertexCapacity Initial number of vertices that the buffer can store (grows if needed).
+     * @param iIndexCapacity  Initial number of indices that each index buffer can store (grows if needed).
+     *
+     * @return Created buffer.
+     */
+    static std::unique_ptr<GeometryBuffer>
+    create(VertexFormat vertexFormat, size_t iVertexCapacity, size_t iIndexCapacity);
+
+    /**
+     * Copies the specified mesh data to the buffer.
+     *
+     * @warning Expects that the buffer uses @ref VertexFormat::FULL.
+     *
+     * @param vVertices Vertices of the mesh.
+     * @param vIndices  Indices of the mesh (relative to the first vertex of the mesh), stored as 16-bit
+     * indices if there are no more than 65536 vertices.
+     *
+     * @return Allocated range, frees the range when destroyed.
+     */
+    std::unique_ptr<GeometryAllocation>
+    allocate(std::span<const Vertex> vVertices, std::span<const unsigned int> vIndices);
+
+    /**
+     * Copies the specified mesh data to the buffer.
+     *
+     * @warning Expects that the buffer uses @ref VertexFormat::PACKED.
+     *
+     * @param vVertices Vertices of the mesh.
+     * @param vIndices  Indices of the mesh (relative to the first vertex of the mesh), stored as 16-bit
+     * indices if there are no more than 65536 vertices.
+     *
+     * @return Allocated range, frees the range when destroyed.
+     */
+    std::unique_ptr<GeometryAllocation>
+    allocate(std::span<const PackedVertex> vVertices, std::span<const unsigned int> vIndices);
+
+    /**
+     * Returns layout of vertices in the buffer.
+     *
+     * @return Vertex format.
+     */
+    VertexFormat getVertexFormat() const;
+
+    /**
+     * Returns ID of the vertex array object that references the vertex buffer and the index buffer
+     * of the specified type.
+     *
+     * @param indexFormat Type of indices of meshes to draw.
+     *
+     * @return VAO ID.
+     */
+    unsigned int getVertexArrayObjectId(IndexFormat indexFormat) const;
+
+    /**
+     * Returns size of one index of the specified type.
+     *
+     * @param indexFormat Index type.
+     *
+     * @return Size in bytes.
+     */
+    static size_t getIndexSize(IndexFormat indexFormat);
+
+    /**
+     * Returns information about memory usage.
+     *
+     * @return Statistics.
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Returns size of video memory used by the vertex buffer and index buffers.
+     *
+     * @return Size in bytes.
+     */
+    size_t getSizeInBytes() const;
+
+private:
+    /** Index buffer of one index type. */
+    struct IndexPool {
+        /** Manages ranges of @ref iIndexBufferObjectId (in indices). */
+        FreeListAllocator allocator = FreeListAllocator(0);
+
+        /** ID of the vertex array object that references the vertex buffer and this index buffer. */
+        unsigned int iVertexArrayObjectId = 0;
+
+        /** ID of the index buffer. */
+        unsigned int iIndexBufferObjectId = 0;
+    };
+
+    /**
+     * Initializes the object.
+     *
+     * @param vertexFormat Layout of vertices that the buffer will store.
+     */
+    GeometryBuffer(VertexFormat vertexFormat);
+
+    /**
+     * Copies the specified mesh data to the buffer.
+     *
+     * @param vertexFormat Format of the specified vertices (must be equal to @ref vertexFormat).
+     * @param pVertices    Vertices of the mesh.
+     * @param iVertexCount Number of vertices.
+     * @param vIndices     Indices of the mesh (relative to the first vertex of the mesh).
+     *
+     * @return Allocated range, frees the range when destroyed.
+     */
+    std::unique_ptr<GeometryAllocation> allocate(
+        VertexFormat vertexFormat,
+        const void* pVertices,
+        size_t iVertexCount,
+        std::span<const unsigned int> vIndices);
+
+    /**
+     * Returns size of one vertex in the buffer.
+     *
+     * @return Size in bytes.
+     */
+    size_t getVertexSize() const;
+
+    /**
+     * Creates a new buffer of the specified size and copies the old buffer to it.
+     *
+     * @param iOldBufferId    ID of the buffer to replace (deleted).
+     * @param iOldSizeInBytes Size of the old buffer.
+     * @param iNewSizeInBytes Size of the new buffer.
+     *
+     * @return ID of the new buffer.
+     */
+    static unsigned int
+    reallocateBuffer(unsigned int iOldBufferId, size_t iOldSizeInBytes, size_t iNewSizeInBytes);
+
+    /**
+     * Allocates a range using the specified allocator, grows the storage if there's no free space.
+     *
+     * @param allocator Allocator to use.
+     * @param iSize     Size of the range.
+     * @param onGrow    Called with the new capacity to grow the storage and the allocator.
+     *
+     * @return Offset of the allocated range (0 if the size is 0).
+     */
+    static size_t allocateRange(
+        FreeListAllocator& allocator, size_t iSize, const std::function<void(size_t)>& onGrow);
+
+    /**
+     * Recreates the vertex buffer with the specified capacity (keeping its data) and grows
+     * @ref vertexAllocator.
+     *
+     * @param iNewVertexCapacity New number of vertices that the buffer can store.
+     */
+    void growVertexBuffer(size_t iNewVertexCapacity);
+
+    /**
+     * Recreates the index buffer of the specified type with the specified capacity (keeping its data)
+     * and grows its allocator.
+     *
+     * @param indexFormat       Type of the index buffer.
+     * @param iNewIndexCapacity New number of indices that the buffer can store.
+     */
+    void growIndexBuffer(IndexFormat indexFormat, size_t iNewIndexCapacity);
+
+    /**
+     * Returns index buffer of the specified type.
+     *
+     * @param indexFormat Index type.
+     *
+     * @return Index pool.
+     */
+    IndexPool& getIndexPool(IndexFormat indexFormat);
+
+    /**
+     * Called by allocations to return their ranges.
+     *
+     * @param allocation Allocation being destroyed.
+     */
+    void free(const GeometryAllocation& allocation);
+
+    /** Manages ranges of @ref iVertexBufferObjectId (in vertices). */
+    FreeListAllocator vertexAllocator;
+
+    /** Index buffers where index is @ref IndexFormat. */
+    std::array<IndexPool, 2> vIndexPools;
+
+    /** ID of the vertex buffer. */
+    unsigned int iVertexBufferObjectId = 0;
+
+    /** Layout of vertices in @ref iVertexBufferObjectId. */
+    const VertexFormat vertexFormat = VertexFormat::FULL;
+};
@@ -3,18 +3,13 @@
 // Standard.
 #include <algorithm>
 
-// Custom.
-#include "shader/ShaderUniformHelpers.hpp"
-
-void LightSource::setToShader(unsigned int iShaderProgramId, size_t iLightSourceIndex) const {
-    ShaderUniformHelpers::setVector3ToShader(
-        iShaderProgramId, std::format("vLightSources[{}].position", iLightSourceIndex), position);
-    ShaderUniformHelpers::setVector3ToShader(
-        iShaderProgramId, std::format("vLightSources[{}].color", iLightSourceIndex), color);
-    ShaderUniformHelpers::setFloatToShader(
-        iShaderProgramId, std::format("vLightSources[{}].intensity", iLightSourceIndex), intensity);
-    ShaderUniformHelpers::setFloatToShader(
-        iShaderProgramId, std::format("vLightSources[{}].distance", iLightSourceIndex), distance);
+LightSourceUniformData LightSource::getUniformData() const {
+    LightSourceUniformData data;
+    data.position = position;
+    data.intensity = intensity;
+    data.color = color;
+    data.distance = distance;
+    return data;
 }
 
 void LightSource::setLightPosition(const glm::vec3& position) { this->position = position; }
@@ -2,18 +2,17 @@
 
 // Custom.
 #include "math/GLMath.hpp"
+#include "shader/UniformBlocks.hpp"
 
 /** Represents a single light source. */
 class LightSource {
 public:
     /**
-     * Sets light properties to the specified shader program.
+     * Returns light properties in the format of the light source from shaders.
      *
-     * @param iShaderProgramId  Shader program to set light source properties to.
-     * @param iLightSourceIndex Index of this light source to copy the properties to the specified light
-     * source in the array of lights (in shaders).
+     * @return Light properties to copy to the uniform buffer with light sources.
      */
-    void setToShader(unsigned int iShaderProgramId, size_t iLightSourceIndex) const;
+    LightSourceUniformData getUniformData() const;
 
     /**
      * Sets light source position in world space.
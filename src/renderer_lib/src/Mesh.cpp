@@ -2,11 +2,13 @@
 
 // Standard.
 #include <format>
+#include <array>
+#include <cmath>
+#include <algorithm>
 
 // Custom.
 #include "window/GLFW.hpp"
-#include "shader/ShaderUniformHelpers.hpp"
-#include "import/TextureImporter.h"
+#include "GeometryBuffer.h"
 
 void Vertex::setVertexAttributes() {
     // Prepare offsets of fields.
@@ -56,196 +58,261 @@ void Vertex::setVertexAttributes() {
         reinterpret_cast<void*>(iTangentOffset)); // NOLINT: beginning offset
 }
 
-Mesh::~Mesh() {
-    // Don't need to wait for the GPU to finish using this data because:
-    // When a buffer, texture, sampler, renderbuffer, query, or sync object is deleted, its name immediately
-    // becomes invalid (e.g. is marked unused), but the underlying object will not be deleted until it is no
-    // longer in use.
-
-    // Delete vertex buffer objects.
-    glDeleteBuffers(1, &iVertexBufferObjectId);
-    glDeleteVertexArrays(1, &iVertexArrayObjectId);
+/**
+ * Encodes a unit vector using octahedral mapping.
+ *
+ * @param vector Unit vector (zero vectors are encoded as (0, 0)).
+ *
+ * @return Encoded vector in range [-1; 1].
+ */
+static inline glm::vec2 encodeOctahedral(const glm::vec3& vector) {
+    const auto sum = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+    if (sum == 0.0F) [[unlikely]] {
+        return glm::vec2(0.0F, 0.0F);
+    }
 
-    // Delete index buffer.
-    glDeleteBuffers(1, &iIndexBufferObjectId);
+    // Project to the octahedron.
+    auto encoded = glm::vec2(vector.x / sum, vector.y / sum);
 
-    // Delete textures.
-    glDeleteTextures(1, &material.iDiffuseTextureId);
-    glDeleteTextures(1, &material.iMetallicRoughnessTextureId);
-    glDeleteTextures(1, &material.iEmissionTextureId);
-    glDeleteTextures(1, &material.iNormalTextureId);
+    // Fold the lower hemisphere over the diagonals.
+    if (vector.z < 0.0F) {
+        encoded = glm::vec2(
+            (1.0F - std::abs(encoded.y)) * (encoded.x >= 0.0F ? 1.0F : -1.0F),
+            (1.0F - std::abs(encoded.x)) * (encoded.y >= 0.0F ? 1.0F : -1.0F));
+    }
 
-#if defined(DEBUG)
-    static_assert(sizeof(Mesh) == 184, "add new resources to be deleted"); // NOLINT
-#endif
+    return encoded;
 }
 
-std::unique_ptr<Mesh> Mesh::create(std::vector<Vertex>&& vVertices, std::vector<unsigned int>&& vIndices) {
-    static_assert(sizeof(vIndices[0]) == sizeof(unsigned int), "change index format in the `draw` command");
-
-    // Prepare the resulting mesh.
-    auto pMesh = std::make_unique<Mesh>();
-
-    // Prepare vertex/index buffers.
-    pMesh->prepareVertexBuffer(std::move(vVertices));
-    pMesh->prepareIndexBuffer(std::move(vIndices));
+void PackedVertex::setVertexAttributes() {
+    // Prepare offsets of fields.
+    const auto iPositionOffset = offsetof(PackedVertex, iPositionXy);
+    const auto iNormalOffset = offsetof(PackedVertex, iNormal);
+    const auto iUvOffset = offsetof(PackedVertex, iUv);
+    const auto iTangentOffset = offsetof(PackedVertex, iTangent);
 
-    // Prepare normal matrix.
-    pMesh->normalMatrix = getNormalMatrixFromWorldMatrix(pMesh->worldMatrix);
+    // Specify position.
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+        0,                                         // attribute index (layout location)
+        3,                                         // number of components
+        GL_UNSIGNED_SHORT,                         // type of component
+        GL_TRUE,                                   // whether data should be normalized or not
+        sizeof(PackedVertex),                      // stride (size in bytes between elements)
+        reinterpret_cast<void*>(iPositionOffset)); // NOLINT: beginning offset
 
-    return pMesh;
-}
+    // Specify normal.
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(
+        1,                                       // attribute index (layout location)
+        2,                                       // number of components
+        GL_SHORT,                                // type of component
+        GL_TRUE,                                 // whether data should be normalized or not
+        sizeof(PackedVertex),                    // stride (size in bytes between elements)
+        reinterpret_cast<void*>(iNormalOffset)); // NOLINT: beginning offset
 
-void Mesh::setDiffuseTexture(const std::filesystem::path& pathToImageFile) {
-    // Delete previous texture.
-    glDeleteTextures(1, &material.iDiffuseTextureId);
+    // Specify UV.
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(
+        2,                                   // attribute index (layout location)
+        2,                                   // number of components
+        GL_HALF_FLOAT,                       // type of component
+        GL_FALSE,                            // whether data should be normalized or not
+        sizeof(PackedVertex),                // stride (size in bytes between elements)
+        reinterpret_cast<void*>(iUvOffset)); // NOLINT: beginning offset
 
-    // Create new texture.
-    material.iDiffuseTextureId = TextureImporter::loadTexture(pathToImageFile, true);
+    // Specify tangent.
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(
+        3,                                        // attribute index (layout location)
+        2,                                        // number of components
+        GL_SHORT,                                 // type of component
+        GL_TRUE,                                  // whether data should be normalized or not
+        sizeof(PackedVertex),                     // stride (size in bytes between elements)
+        reinterpret_cast<void*>(iTangentOffset)); // NOLINT: beginning offset
 }
 
-void Mesh::setNormalTexture(const std::filesystem::path& pathToImageFile) {
-    // Delete previous texture.
-    glDeleteTextures(1, &material.iNormalTextureId);
-
-    // Create new texture.
-    material.iNormalTextureId = TextureImporter::loadTexture(pathToImageFile, false);
-}
+bool PackedVertex::isPackable(std::span<const Vertex> vVertices) {
+    // Half floats have at least 1/512 precision in range [-4; 4] which is enough for textures
+    // up to 2048 pixels that are repeated a few times, larger UVs (heavily tiled surfaces) will be blurry.
+    constexpr float maxUvValue = 4.0F;
 
-void Mesh::setMetallicRoughnessTexture(const std::filesystem::path& pathToImageFile) {
-    // Delete previous texture.
-    glDeleteTextures(1, &material.iMetallicRoughnessTextureId);
+    for (const auto& vertex : vVertices) {
+        if (std::abs(vertex.uv.x) > maxUvValue || std::abs(vertex.uv.y) > maxUvValue) {
+            return false;
+        }
+    }
 
-    // Create new texture.
-    material.iMetallicRoughnessTextureId = TextureImporter::loadTexture(pathToImageFile, false);
+    return true;
 }
 
-void Mesh::setEmissionTexture(const std::filesystem::path& pathToImageFile) {
-    // Delete previous texture.
-    glDeleteTextures(1, &material.iEmissionTextureId);
-
-    // Create new texture.
-    material.iEmissionTextureId = TextureImporter::loadTexture(pathToImageFile, false);
+PackedVertex PackedVertex::pack(const Vertex& vertex, const AABB& aabb) {
+    PackedVertex packedVertex;
+
+    // Quantize position relative to the AABB.
+    const auto min = aabb.center - aabb.extents;
+    const auto toUnit = [](float value, float minValue, float size) -> float {
+        return size > 0.0F ? std::clamp((value - minValue) / size, 0.0F, 1.0F) : 0.0F;
+    };
+    packedVertex.iPositionXy = glm::packUnorm2x16(glm::vec2(
+        toUnit(vertex.position.x, min.x, aabb.extents.x * 2.0F),
+        toUnit(vertex.position.y, min.y, aabb.extents.y * 2.0F)));
+    packedVertex.iPositionZ =
+        glm::packUnorm2x16(glm::vec2(toUnit(vertex.position.z, min.z, aabb.extents.z * 2.0F), 0.0F));
+
+    packedVertex.iNormal = glm::packSnorm2x16(encodeOctahedral(vertex.normal));
+    packedVertex.iUv = glm::packHalf2x16(vertex.uv);
+    packedVertex.iTangent = glm::packSnorm2x16(encodeOctahedral(vertex.tangent));
+
+    return packedVertex;
 }
 
-void Mesh::setWorldMatrix(const glm::mat4x4& newWorldMatrix) {
-    // Save new world matrix.
-    worldMatrix = newWorldMatrix;
+glm::mat4x4 PackedVertex::getPositionDequantizationMatrix(const AABB& aabb) {
+    // Position = min + unit * size.
+    auto matrix = glm::identity<glm::mat4x4>();
+    for (int i = 0; i < 3; i++) {
+        matrix[i][i] = aabb.extents[i] * 2.0F;
+    }
+    matrix[3] = glm::vec4(aabb.center - aabb.extents, 1.0F);
 
-    // Update normal matrix.
-    normalMatrix = getNormalMatrixFromWorldMatrix(worldMatrix);
+    return matrix;
 }
 
-glm::mat4x4* Mesh::getWorldMatrix() { return &worldMatrix; }
+Mesh::~Mesh() {
+    // Don't need to wait for the GPU to finish using this data because:
+    // When a buffer, texture, sampler, renderbuffer, query, or sync object is deleted, its name immediately
+    // becomes invalid (e.g. is marked unused), but the underlying object will not be deleted until it is no
+    // longer in use.
 
-glm::mat3x3* Mesh::getNormalMatrix() { return &normalMatrix; }
+    // Textures are deleted by the material when it's no longer used by any mesh.
 
-glm::mat3x3 Mesh::getNormalMatrixFromWorldMatrix(const glm::mat4x4& worldMatrix) {
-    return glm::mat3x3(glm::transpose(glm::inverse(worldMatrix)));
+#if defined(DEBUG)
+    static_assert(sizeof(Mesh) == 312, "add new resources to be deleted"); // NOLINT
+#endif
 }
 
-void Material::setTexture2dParameters() {
-    // Set texture wrapping.
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    // Set texture filtering.
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(
-        GL_TEXTURE_2D,
-        GL_TEXTURE_MAG_FILTER,
-        GL_LINEAR); // no need to set `MIPMAP` option since magnification does not use mipmaps
-
-    // Enable anisotropic texture filtering (core in OpenGL 4.6 which we are using).
-    float maxSupportedAnisotropy = 0.0F;
-    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxSupportedAnisotropy);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, maxSupportedAnisotropy);
+std::unique_ptr<Mesh> Mesh::create(
+    std::vector<Vertex>&& vVertices, std::vector<unsigned int>&& vIndices, GeometryBuffer* pGeometryBuffer) {
+    // Generate AABB.
+    const auto aabb = AABB::createFromVertices(&vVertices);
+
+    return create(
+        std::span<const Vertex>(vVertices),
+        std::span<const unsigned int>(vIndices),
+        std::span<const MeshLod>(),
+        std::span<const MeshCluster>(),
+        aabb,
+        pGeometryBuffer);
 }
 
-void Mesh::prepareVertexBuffer(std::vector<Vertex>&& vVertices) {
-    // Create vertex array object (VAO).
-    glGenVertexArrays(1, &iVertexArrayObjectId);
+std::unique_ptr<Mesh> Mesh::create(
+    std::span<const Vertex> vVertices,
+    std::span<const unsigned int> vIndices,
+    std::span<const MeshLod> vLods,
+    std::span<const MeshCluster> vClusters,
+    const AABB& aabb,
+    GeometryBuffer* pGeometryBuffer) {
+    // Prepare the resulting mesh.
+    auto pMesh = std::make_unique<Mesh>();
 
-    // Bind our vertex array object to the OpenGL context.
-    glBindVertexArray(iVertexArrayObjectId);
+    // Copy vertices/indices to the shared buffer.
+    if (pGeometryBuffer->getVertexFormat() == VertexFormat::PACKED) {
+        std::vector<PackedVertex> vPackedVertices;
+        vPackedVertices.reserve(vVertices.size());
+        for (const auto& vertex : vVertices) {
+            vPackedVertices.push_back(PackedVertex::pack(vertex, aabb));
+        }
+        pMesh->pGeometry =
+            pGeometryBuffer->allocate(std::span<const PackedVertex>(vPackedVertices), vIndices);
+    } else {
+        pMesh->pGeometry = pGeometryBuffer->allocate(vVertices, vIndices);
+    }
 
-    // Create vertex buffer object (VBO).
-    glGenBuffers(1, &iVertexBufferObjectId);
+    pMesh->aabb = aabb;
 
-    // Set our vertex buffer to the "array" target  in OpenGL context to update its data.
-    glBindBuffer(GL_ARRAY_BUFFER, iVertexBufferObjectId);
+    // Save levels of detail.
+    if (vLods.empty()) {
+        pMesh->vLods.push_back(MeshLod{.iIndexCount = static_cast<unsigned int>(vIndices.size())});
+    } else {
+        pMesh->vLods.assign(vLods.begin(), vLods.end());
+    }
+    pMesh->vClusters.assign(vClusters.begin(), vClusters.end());
 
-    // Copy vertices to the buffer.
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        vVertices.size() * sizeof(vVertices[0]),
-        vVertices.data(),
-        GL_STATIC_DRAW); // `STATIC` because the data will not be changed
+    // Prepare normal matrices.
+    pMesh->normalMatrix = getNormalMatrixFromWorldMatrix(pMesh->worldMatrix);
+    pMesh->updateInstanceMatrices();
 
-    // Describe vertex attributes.
-    Vertex::setVertexAttributes();
+    return pMesh;
+}
 
-    // Finished with vertex buffer.
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void Mesh::setWorldMatrix(const glm::mat4x4& newWorldMatrix) {
+    // Skip recalculating matrices of instances if nothing changed (called every frame).
+    if (newWorldMatrix == worldMatrix) {
+        return;
+    }
 
-    // Generate AABB.
-    aabb = AABB::createFromVertices(&vVertices);
+    // Save new world matrix.
+    worldMatrix = newWorldMatrix;
+
+    // Update normal matrices.
+    normalMatrix = getNormalMatrixFromWorldMatrix(worldMatrix);
+    updateInstanceMatrices();
 }
 
-void Mesh::prepareIndexBuffer(std::vector<unsigned int>&& vIndices) {
-    // Make sure we don't exceed type limit.
-    constexpr size_t iTypeLimit = std::numeric_limits<int>::max();
-    if (vIndices.size() > iTypeLimit) [[unlikely]] {
-        throw std::runtime_error(
-            std::format("index count {} exceeds type limit of {}", vIndices.size(), iTypeLimit));
-    }
+glm::mat4x4* Mesh::getWorldMatrix() { return &worldMatrix; }
 
-    // Save index count.
-    iIndexCount = static_cast<int>(vIndices.size());
+glm::mat3x3* Mesh::getNormalMatrix() { return &normalMatrix; }
 
-    // Create element buffer object.
-    glGenBuffers(1, &iIndexBufferObjectId);
+void Mesh::setInstanceMatrices(std::span<const glm::mat4x4> vMatrices) {
+    if (vMatrices.empty()) [[unlikely]] {
+        throw std::runtime_error("expected a mesh to have at least one instance");
+    }
 
-    // Set our index buffer to the "element array" target in OpenGL context to update its data.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iIndexBufferObjectId);
+    vInstanceMatrices.assign(vMatrices.begin(), vMatrices.end());
+    updateInstanceMatrices();
+}
 
-    // Copy indices to the buffer.
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        vIndices.size() * sizeof(vIndices[0]),
-        vIndices.data(),
-        GL_STATIC_DRAW); // `STATIC` because the data will not be changed
+size_t Mesh::getInstanceCount() const { return vInstanceMatrices.size(); }
 
-    // Finished with index buffer.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+const glm::mat4x4& Mesh::getInstanceWorldMatrix(size_t iInstanceIndex) const {
+    return vInstanceWorldMatrices[iInstanceIndex];
 }
 
-void Material::setToShader(unsigned int iShaderProgramId) const {
-    // Set diffuse texture at texture unit (location) 0.
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, iDiffuseTextureId);
-    setTexture2dParameters();
+const glm::mat3x3& Mesh::getInstanceNormalMatrix(size_t iInstanceIndex) const {
+    return vInstanceNormalMatrices[iInstanceIndex];
+}
 
-    // Set normal texture at texture unit (location) 1.
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, iNormalTextureId);
-    setTexture2dParameters();
+bool Mesh::isInstanceMirrored(size_t iInstanceIndex) const { return vIsInstanceMirrored[iInstanceIndex]; }
 
-    // Set metallic+roughness texture at texture unit (location) 2.
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, iMetallicRoughnessTextureId);
-    setTexture2dParameters();
+glm::mat3x3 Mesh::getNormalMatrixFromWorldMatrix(const glm::mat4x4& worldMatrix) {
+    return glm::mat3x3(glm::transpose(glm::inverse(worldMatrix)));
+}
 
-    // Set emission texture at texture unit (location) 3.
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, iEmissionTextureId);
-    setTexture2dParameters();
+void Mesh::updateInstanceMatrices() {
+    vInstanceWorldMatrices.resize(vInstanceMatrices.size());
+    vInstanceNormalMatrices.resize(vInstanceMatrices.size());
+    vIsInstanceMirrored.resize(vInstanceMatrices.size());
+    for (size_t i = 0; i < vInstanceMatrices.size(); i++) {
+        vInstanceWorldMatrices[i] = worldMatrix * vInstanceMatrices[i];
+        vInstanceNormalMatrices[i] = getNormalMatrixFromWorldMatrix(vInstanceWorldMatrices[i]);
+        vIsInstanceMirrored[i] = glm::determinant(glm::mat3x3(vInstanceWorldMatrices[i])) < 0.0F;
+    }
+}
 
-    // Set diffuse color.
-    ShaderUniformHelpers::setVector3ToShader(iShaderProgramId, "material.diffuseColor", diffuseColor);
+std::array<unsigned int, 4> Material::getTextureIds() const {
+    const auto getTextureId = [](const std::shared_ptr<Texture>& pTexture) -> unsigned int {
+        return pTexture == nullptr ? 0 : pTexture->getTextureId();
+    };
 
-    // Set specular color.
-    ShaderUniformHelpers::setVector3ToShader(iShaderProgramId, "material.specularColor", specularColor);
+    return {
+        getTextureId(pDiffuseTexture),
+        getTextureId(pNormalTexture),
+        getTextureId(pMetallicRoughnessTexture),
+        getTextureId(pEmissionTexture)};
+}
 
-    // Set shininess.
-    ShaderUniformHelpers::setFloatToShader(iShaderProgramId, "material.shininess", shininess);
+void Material::bindTextures() const {
+    // Bind diffuse, normal, metallic+roughness and emission textures to units (locations) 0-3.
+    const auto vTextureIds = getTextureIds();
+    glBindTextures(0, static_cast<int>(vTextureIds.size()), vTextureIds.data());
 }
@@ -2,36 +2,46 @@
 
 // Standard.
 #include <vector>
-#include <filesystem>
+#include <array>
 #include <memory>
+#include <span>
 
 // Custom.
 #include "math/GLMath.hpp"
 #include "shapes/AABB.h"
+#include "Texture.h"
 
-/** Determines material properties of a mesh. */
+class GeometryBuffer;
+class GeometryAllocation;
+
+/** Determines material properties of a mesh (can be shared between meshes). */
 struct Material {
     /**
-     * Sets material's properties to the specified shader.
+     * Returns IDs of diffuse, normal, metallic-roughness and emission textures (0 if not used).
      *
-     * @param iShaderProgramId Shader program to set material's properties to.
+     * @return Texture IDs.
      */
-    void setToShader(unsigned int iShaderProgramId) const;
+    std::array<unsigned int, 4> getTextureIds() const;
 
-    /** Sets texture 2D parameters for the currently active Texture_2D such as texture wrapping/filtering. */
-    static void setTexture2dParameters();
+    /**
+     * Binds material's textures to texture units 0-3.
+     *
+     * @remark Only needed when bindless textures are not supported, otherwise texture handles are
+     * stored in the material buffer (see @ref MaterialBuffer).
+     */
+    void bindTextures() const;
 
-    /** ID of the diffuse texture (if used). */
-    unsigned int iDiffuseTextureId = 0;
+    /** Diffuse texture (if used). */
+    std::shared_ptr<Texture> pDiffuseTexture;
 
-    /** ID of the normal texture (if used). */
-    unsigned int iNormalTextureId = 0;
+    /** Normal texture (if used). */
+    std::shared_ptr<Texture> pNormalTexture;
 
-    /** ID of the metallic (blue) + roughness (green) texture (if used). */
-    unsigned int iMetallicRoughnessTextureId = 0;
+    /** Metallic (blue) + roughness (green) texture (if used). */
+    std::shared_ptr<Texture> pMetallicRoughnessTexture;
 
-    /** ID of the emission texture (if used). */
-    unsigned int iEmissionTextureId = 0;
+    /** Emission texture (if used). */
+    std::shared_ptr<Texture> pEmissionTexture;
 
     /** Diffuse light color. */
     glm::vec3 diffuseColor = glm::vec3(1.0F, 1.0F, 1.0F);
@@ -41,6 +51,21 @@ struct Material {
 
     /** Determines how shiny the surface is. */
     float shininess = 32.0F; // NOLINT
+
+    /** Index of the material in the material buffer (assigned by @ref MaterialBuffer). */
+    unsigned int iMaterialIndex = 0;
+};
+
+/** Layout of vertices in a geometry buffer. */
+enum class VertexFormat : unsigned char {
+    FULL,   //< @ref Vertex
+    PACKED, //< @ref PackedVertex
+};
+
+/** Type of indices in a geometry buffer. */
+enum class IndexFormat : unsigned char {
+    UINT16, //< `unsigned short`, used by meshes that have no more than 65536 vertices
+    UINT32, //< `unsigned int`
 };
 
 /** Groups information about one vertex. */
@@ -61,53 +86,148 @@ struct Vertex {
     glm::vec3 tangent;
 };
 
-/** Groups information to draw an object. */
-struct Mesh {
-    ~Mesh();
+/**
+ * Compact version of @ref Vertex (20 bytes instead of 44) to reduce vertex fetch bandwidth and memory usage.
+ *
+ * @remark Positions are quantized inside the mesh's AABB so they need to be transformed using
+ * @ref getPositionDequantizationMatrix (shaders expect that it's applied to the world matrix).
+ */
+struct PackedVertex {
+    /** Describes to OpenGL how vertex data should be interpreted. */
+    static void setVertexAttributes();
 
     /**
-     * Creates a new mesh with the specified data.
-     *
-     * @remark Expects that OpenGL is initialized.
+     * Tells whether the specified vertices can be packed without a noticeable loss of precision.
      *
-     * @param vVertices Vertices of the mesh.
-     * @param vIndices  Indices of the mesh.
+     * @param vVertices Vertices to test.
      *
-     * @return Created mesh. The resulting object is wrapped into a `unique_ptr` for "move" simplicity
-     * (so that I don't need to implement move functions and make sure created buffers will not be
-     * deleted multiple times).
+     * @return `true` if UVs are small enough to be stored as half floats.
      */
-    static std::unique_ptr<Mesh>
-    create(std::vector<Vertex>&& vVertices, std::vector<unsigned int>&& vIndices);
+    static bool isPackable(std::span<const Vertex> vVertices);
 
     /**
-     * Assigns the specified diffuse texture to be used.
+     * Packs the specified vertex.
+     *
+     * @param vertex Vertex to pack.
+     * @param aabb   AABB of the vertex's mesh (used to quantize position).
      *
-     * @param pathToImageFile Path to the image file to use.
+     * @return Packed vertex.
      */
-    void setDiffuseTexture(const std::filesystem::path& pathToImageFile);
+    static PackedVertex pack(const Vertex& vertex, const AABB& aabb);
 
     /**
-     * Assigns the specified normal texture to be used.
+     * Returns a matrix that transforms packed positions to model space.
+     *
+     * @param aabb AABB that was used to pack vertices.
      *
-     * @param pathToImageFile Path to the image file to use.
+     * @return Matrix to apply before the world matrix.
+     */
+    static glm::mat4x4 getPositionDequantizationMatrix(const AABB& aabb);
+
+    /** Position (X and Y) as unorm16 relative to the AABB (0 - AABB min, 1 - AABB max). */
+    unsigned int iPositionXy = 0;
+
+    /** Position (Z) as unorm16 relative to the AABB, the upper 16 bits are unused. */
+    unsigned int iPositionZ = 0;
+
+    /** Octahedral-encoded normal as snorm16. */
+    unsigned int iNormal = 0;
+
+    /** UV as half floats. */
+    unsigned int iUv = 0;
+
+    /** Octahedral-encoded tangent as snorm16. */
+    unsigned int iTangent = 0;
+};
+
+/** Range of indices of a mesh that draws it with some level of detail. */
+struct MeshLod {
+    /** Index of the first index of the level (relative to the first index of the mesh). */
+    unsigned int iFirstIndex = 0;
+
+    /** Number of indices of the level. */
+    unsigned int iIndexCount = 0;
+
+    /**
+     * Maximum deviation of the simplified surface from the original surface relative to the mesh's
+     * radius (half of the AABB's diagonal), 0 for the original mesh.
+     */
+    float error = 0.0F;
+};
+
+/**
+ * Small group of nearby triangles of a mesh (a range of indices of the most detailed level) that is culled
+ * separately from other triangles of the mesh.
+ */
+struct MeshCluster {
+    /** Index of the first index of the cluster (relative to the first index of the mesh). */
+    unsigned int iFirstIndex = 0;
+
+    /** Number of indices of the cluster. */
+    unsigned int iIndexCount = 0;
+
+    /** Center of the sphere that encloses all triangles of the cluster (in model space). */
+    glm::vec3 center = glm::vec3(0.0F, 0.0F, 0.0F);
+
+    /** Radius of the sphere that encloses all triangles of the cluster (in model space). */
+    float radius = 0.0F;
+
+    /** Average direction (unit vector in model space) where front faces of the triangles point to. */
+    glm::vec3 coneAxis = glm::vec3(0.0F, 0.0F, 1.0F);
+
+    /**
+     * Sine of the angle between @ref coneAxis and the most deviating triangle normal, if the cluster
+     * is viewed from a direction that is inside of the cone with this half-angle around the reversed
+     * axis all triangles are back-facing. Values greater than or equal to 1 mean that the cluster is
+     * never fully back-facing.
      */
-    void setNormalTexture(const std::filesystem::path& pathToImageFile);
+    float coneCutoff = 1.0F;
+};
+
+/** Groups information to draw an object. */
+struct Mesh {
+    ~Mesh();
 
     /**
-     * Assigns the specified texture where the roughness values are sampled from the Green channel and
-     * the metalness values are sampled from the Blue channel.
+     * Creates a new mesh with the specified data.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param vVertices       Vertices of the mesh.
+     * @param vIndices        Indices of the mesh.
+     * @param pGeometryBuffer Buffer to copy vertices and indices to.
      *
-     * @param pathToImageFile Path to the image file to use.
+     * @return Created mesh. The resulting object is wrapped into a `unique_ptr` for "move" simplicity
+     * (so that I don't need to implement move functions and make sure the geometry will not be
+     * freed multiple times).
      */
-    void setMetallicRoughnessTexture(const std::filesystem::path& pathToImageFile);
+    static std::unique_ptr<Mesh> create(
+        std::vector<Vertex>&& vVertices,
+        std::vector<unsigned int>&& vIndices,
+        GeometryBuffer* pGeometryBuffer);
 
     /**
-     * Assigns the specified emission texture.
+     * Creates a new mesh with the specified data and an already calculated AABB.
      *
-     * @param pathToImageFile Path to the image file to use.
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param vVertices       Vertices of the mesh (copied to the geometry buffer).
+     * @param vIndices        Indices of all levels of detail of the mesh (copied to the geometry buffer).
+     * @param vLods           Ranges of `vIndices` from the most detailed to the least detailed level,
+     * if empty all indices are used as a single level.
+     * @param vClusters       Clusters of the most detailed level (can be empty).
+     * @param aabb            AABB of the mesh in model space.
+     * @param pGeometryBuffer Buffer to copy vertices and indices to.
+     *
+     * @return Created mesh.
      */
-    void setEmissionTexture(const std::filesystem::path& pathToImageFile);
+    static std::unique_ptr<Mesh> create(
+        std::span<const Vertex> vVertices,
+        std::span<const unsigned int> vIndices,
+        std::span<const MeshLod> vLods,
+        std::span<const MeshCluster> vClusters,
+        const AABB& aabb,
+        GeometryBuffer* pGeometryBuffer);
 
     /**
      * Sets new world matrix to be used.
@@ -130,20 +250,68 @@ struct Mesh {
      */
     glm::mat3x3* getNormalMatrix();
 
-    /** Mesh's material. */
-    Material material;
+    /**
+     * Sets matrices that place copies (instances) of the mesh in model space (for example, transforms
+     * of all nodes that reference the mesh), the mesh is drawn once per matrix. By default the mesh
+     * has one instance with an identity matrix.
+     *
+     * @param vMatrices Matrices (at least one).
+     */
+    void setInstanceMatrices(std::span<const glm::mat4x4> vMatrices);
+
+    /**
+     * Returns the number of instances of the mesh (see @ref setInstanceMatrices).
+     *
+     * @return Instance count.
+     */
+    size_t getInstanceCount() const;
+
+    /**
+     * Returns matrix that transforms positions of the specified instance from model space to world space
+     * (world matrix combined with the instance's matrix).
+     *
+     * @param iInstanceIndex Index of the instance.
+     *
+     * @return World matrix of the instance.
+     */
+    const glm::mat4x4& getInstanceWorldMatrix(size_t iInstanceIndex) const;
+
+    /**
+     * Returns matrix that transforms normals of the specified instance from model space to world space.
+     *
+     * @param iInstanceIndex Index of the instance.
+     *
+     * @return Normal matrix of the instance.
+     */
+    const glm::mat3x3& getInstanceNormalMatrix(size_t iInstanceIndex) const;
+
+    /**
+     * Tells whether the world matrix of the specified instance mirrors the mesh (has a negative
+     * determinant), such instances have their triangle winding reversed.
+     *
+     * @param iInstanceIndex Index of the instance.
+     *
+     * @return `true` if front faces of the instance are wound clockwise.
+     */
+    bool isInstanceMirrored(size_t iInstanceIndex) const;
+
+    /** Mesh's material (shared between meshes that use the same material). */
+    std::shared_ptr<Material> pMaterial = std::make_shared<Material>();
 
     /** Mesh's AABB in model space. */
     AABB aabb;
 
-    /** ID of the vertex array object that references a vertex buffer object and its attributes. */
-    unsigned int iVertexArrayObjectId = 0;
+    /** Range of the geometry buffer that stores vertices and indices of the mesh. */
+    std::unique_ptr<GeometryAllocation> pGeometry;
 
-    /** ID of the index buffer object. */
-    unsigned int iIndexBufferObjectId = 0;
+    /** Levels of detail (ranges of @ref pGeometry indices), the first one is the original mesh. */
+    std::vector<MeshLod> vLods;
 
-    /** Total number of indices in the mesh. */
-    int iIndexCount = 0;
+    /**
+     * Clusters that cover the most detailed level of detail (used to cull parts of the mesh),
+     * empty if the mesh is drawn as a whole.
+     */
+    std::vector<MeshCluster> vClusters;
 
 private:
     /**
@@ -155,21 +323,8 @@ private:
      */
     static glm::mat3x3 getNormalMatrixFromWorldMatrix(const glm::mat4x4& worldMatrix);
 
-    /**
-     * Creates a vertex buffer, fills it and assigns it to the OpenGL context. The resulting buffer object ID
-     * is assigned to @ref iVertexBufferObjectId.
-     *
-     * @param vVertices Vertices to use.
-     */
-    void prepareVertexBuffer(std::vector<Vertex>&& vVertices);
-
-    /**
-     * Creates an index buffer, fills it and assigns it to the OpenGL context. The resulting buffer object ID
-     * is assigned to @ref iIndexBufferObjectId.
-     *
-     * @param vIndices Indices to use.
-     */
-    void prepareIndexBuffer(std::vector<unsigned int>&& vIndices);
+    /** Recalculates world and normal matrices of instances. */
+    void updateInstanceMatrices();
 
     /** Matrix that transforms data (such as positions) from model space to world space. */
     glm::mat4x4 worldMatrix = glm::identity<glm::mat4x4>();
@@ -177,6 +332,15 @@ private:
     /** Matrix that uniformly transform normals from model space to world space. */
     glm::mat3x3 normalMatrix = glm::identity<glm::mat3x3>();
 
-    /** ID of the vertex buffer object. */
-    unsigned int iVertexBufferObjectId = 0;
+    /** Matrices that place instances of the mesh in model space. */
+    std::vector<glm::mat4x4> vInstanceMatrices = {glm::identity<glm::mat4x4>()};
+
+    /** World matrix of each instance (@ref worldMatrix combined with the instance's matrix). */
+    std::vector<glm::mat4x4> vInstanceWorldMatrices;
+
+    /** Normal matrix of each instance. */
+    std::vector<glm::mat3x3> vInstanceNormalMatrices;
+
+    /** Stores `true` for instances that have a mirroring world matrix. */
+    std::vector<bool> vIsInstanceMirrored;
 };
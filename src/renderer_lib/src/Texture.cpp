@@ -0,0 +1,24 @@
+#include "Texture.h"
+
+// Standard.
+#include <utility>
+
+// Custom.
+#include "window/GLFW.hpp"
+
+Texture::Texture(unsigned int iTextureId) : iTextureId(iTextureId) {}
+
+Texture::~Texture() {
+    // Don't need to wait for the GPU to finish using the texture because:
+    // When a texture is deleted, its name immediately becomes invalid (e.g. is marked unused),
+    // but the underlying object will not be deleted until it is no longer in use.
+    glDeleteTextures(1, &iTextureId);
+}
+
+std::shared_ptr<Texture> Texture::create(unsigned int iTextureId) {
+    return std::shared_ptr<Texture>(new Texture(iTextureId));
+}
+
+unsigned int Texture::getTextureId() const { return iTextureId; }
+
+void Texture::swapTextureId(Texture& other) { std::swap(iTextureId, other.iTextureId); }
@@ -0,0 +1,49 @@
+#pragma once
+
+// Standard.
+#include <memory>
+
+/** Owns an OpenGL texture object, deletes the texture when destroyed. */
+class Texture {
+public:
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    ~Texture();
+
+    /**
+     * Takes ownership of the specified texture.
+     *
+     * @param iTextureId ID of an existing texture object.
+     *
+     * @return Created object. The resulting object is wrapped into a `shared_ptr` so that
+     * the texture can be shared between materials.
+     */
+    static std::shared_ptr<Texture> create(unsigned int iTextureId);
+
+    /**
+     * Returns ID of the texture object.
+     *
+     * @return Texture ID.
+     */
+    unsigned int getTextureId() const;
+
+    /**
+     * Exchanges texture objects with the specified texture (used to replace storage of a texture
+     * that is referenced by materials, the specified texture then owns the old texture object).
+     *
+     * @param other Texture to exchange texture objects with.
+     */
+    void swapTextureId(Texture& other);
+
+private:
+    /**
+     * Initializes the object.
+     *
+     * @param iTextureId ID of the texture object.
+     */
+    Texture(unsigned int iTextureId);
+
+    /** ID of the texture object. */
+    unsigned int iTextureId = 0;
+};
@@ -0,0 +1,349 @@
+#include "TextureStreamer.h"
+
+// Standard.
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <bit>
+#include <tuple>
+
+// Custom.
+#include "Texture.h"
+#include "Mesh.h"
+#include "shader/MaterialBuffer.h"
+
+std::unique_ptr<TextureStreamer> TextureStreamer::create() {
+    return std::unique_ptr<TextureStreamer>(new TextureStreamer());
+}
+
+std::shared_ptr<Texture>
+TextureStreamer::createTexture(TextureSource&& source, TextureUploader* pTextureUploader) {
+    auto pStreamedTexture = std::make_shared<StreamedTexture>();
+    pStreamedTexture->source = std::move(source);
+    pStreamedTexture->bIsStreamed = true;
+    const auto& vLevels = pStreamedTexture->source.data.vLevels;
+    for (const auto& level : vLevels) {
+        pStreamedTexture->vLevelSizes.push_back(level.vData.size());
+    }
+
+    // Only store levels that fit into the initial resolution.
+    const auto iInitialLevel = getInitialLevel(vLevels);
+    auto pTexture = createStorage(pStreamedTexture->source, iInitialLevel);
+
+    // Copy initial levels.
+    auto data = pStreamedTexture->source.data;
+    data.vLevels.assign(vLevels.begin() + static_cast<std::ptrdiff_t>(iInitialLevel), vLevels.end());
+    for (auto& level : data.vLevels) {
+        level.iLevel -= static_cast<int>(iInitialLevel);
+    }
+    pStreamedTexture->iResidentLevel = iInitialLevel;
+    addTexture(pTexture, pStreamedTexture, data);
+
+    TextureUploader::submit(pTexture, std::move(data), pTextureUploader);
+
+    return pTexture;
+}
+
+void TextureStreamer::registerTexture(
+    const std::shared_ptr<Texture>& pTexture,
+    int iInternalFormat,
+    const std::array<int, 4>& vSwizzle,
+    int iWidth,
+    int iHeight,
+    size_t iBytesPerTexel,
+    TextureUploader::TextureData& data) {
+    auto pStreamedTexture = std::make_shared<StreamedTexture>();
+    pStreamedTexture->source.iInternalFormat = iInternalFormat;
+    pStreamedTexture->source.vSwizzle = vSwizzle;
+
+    // Describe levels (without data, they are generated on the GPU).
+    auto& vLevels = pStreamedTexture->source.data.vLevels;
+    const auto iLevelCount =
+        static_cast<int>(std::bit_width(static_cast<unsigned int>(std::max(iWidth, iHeight))));
+    for (int i = 0; i < iLevelCount; i++) {
+        const auto iLevelWidth = std::max(iWidth >> i, 1);
+        const auto iLevelHeight = std::max(iHeight >> i, 1);
+        vLevels.push_back(TextureUploader::Level{
+            .iTarget = GL_TEXTURE_2D, .iLevel = i, .iWidth = iLevelWidth, .iHeight = iLevelHeight});
+        pStreamedTexture->vLevelSizes.push_back(
+            static_cast<size_t>(iLevelWidth) * static_cast<size_t>(iLevelHeight) * iBytesPerTexel);
+    }
+
+    addTexture(pTexture, pStreamedTexture, data);
+}
+
+void TextureStreamer::requestResolution(const Material& material, float sizeInPixels) {
+    for (const auto* pTexture :
+         {material.pDiffuseTexture.get(),
+          material.pNormalTexture.get(),
+          material.pMetallicRoughnessTexture.get(),
+          material.pEmissionTexture.get()}) {
+        if (pTexture == nullptr) {
+            continue;
+        }
+
+        const auto it = streamedTextures.find(pTexture);
+        if (it == streamedTextures.end()) {
+            continue;
+        }
+
+        auto& streamedTexture = *it->second;
+        streamedTexture.requestedResolution = std::max(streamedTexture.requestedResolution, sizeInPixels);
+        streamedTexture.iLastDrawnUpdateIndex = iUpdateIndex;
+    }
+}
+
+bool TextureStreamer::update(
+    size_t iBudgetInBytes, TextureUploader* pTextureUploader, MaterialBuffer* pMaterialBuffer) {
+    // Delete replaced texture objects that are no longer used by frames in flight.
+    while (!vRetiredTextures.empty() &&
+           vRetiredTextures.front().iUpdateIndex + iRetiredTextureUpdateCount <= iUpdateIndex) {
+        pMaterialBuffer->releaseTextureHandle(vRetiredTextures.front().pTexture->getTextureId());
+        vRetiredTextures.pop_front();
+    }
+
+    // Remove deleted textures.
+    std::erase_if(streamedTextures, [](const auto& item) { return item.second->pTexture.expired(); });
+
+    // Select levels for the requested resolutions and calculate used memory.
+    struct Request {
+        std::shared_ptr<StreamedTexture> pStreamedTexture;
+        size_t iLevel = 0;
+        size_t iLastDrawnUpdateIndex = 0;
+        float priority = 0.0F;
+    };
+    std::vector<Request> vLoadRequests;
+    std::vector<Request> vReleaseRequests;
+    iResidentSizeInBytes = 0;
+    for (const auto& [pTexture, pStreamedTexture] : streamedTextures) {
+        auto& streamedTexture = *pStreamedTexture;
+        const auto& vLevels = streamedTexture.source.data.vLevels;
+
+        iResidentSizeInBytes += getSizeFromLevel(streamedTexture, streamedTexture.iResidentLevel);
+        if (streamedTexture.iLoadingLevel.has_value()) {
+            iResidentSizeInBytes += getSizeFromLevel(streamedTexture, *streamedTexture.iLoadingLevel);
+        }
+
+        // Find the least detailed level that covers the requested resolution (textures that were not
+        // drawn need the initial level).
+        size_t iLevel = getInitialLevel(vLevels);
+        while (iLevel > 0 && static_cast<float>(std::max(vLevels[iLevel].iWidth, vLevels[iLevel].iHeight)) <
+                                 streamedTexture.requestedResolution) {
+            iLevel -= 1;
+        }
+        if (!streamedTexture.bIsStreamed) {
+            // Released levels can't be loaded back.
+            iLevel = std::max(iLevel, streamedTexture.iResidentLevel);
+        }
+
+        // Textures that are magnified the most are loaded first and released last.
+        const auto residentResolution = static_cast<float>(std::max(
+            vLevels[streamedTexture.iResidentLevel].iWidth, vLevels[streamedTexture.iResidentLevel].iHeight));
+        const auto priority = streamedTexture.requestedResolution / residentResolution;
+        streamedTexture.requestedResolution = 0.0F;
+
+        if (streamedTexture.bIsUpdating || iLevel == streamedTexture.iResidentLevel) {
+            continue;
+        }
+        auto& vRequests = iLevel < streamedTexture.iResidentLevel ? vLoadRequests : vReleaseRequests;
+        vRequests.push_back(Request{
+            .pStreamedTexture = pStreamedTexture,
+            .iLevel = iLevel,
+            .iLastDrawnUpdateIndex = streamedTexture.iLastDrawnUpdateIndex,
+            .priority = priority});
+    }
+    std::ranges::sort(vLoadRequests, std::ranges::greater{}, &Request::priority);
+
+    // Release least recently drawn textures first.
+    std::ranges::sort(vReleaseRequests, [](const Request& a, const Request& b) {
+        return std::tie(a.iLastDrawnUpdateIndex, a.priority) < std::tie(b.iLastDrawnUpdateIndex, b.priority);
+    });
+
+    // Release levels that are not needed (only when memory is needed to avoid reloading them later).
+    size_t iNextReleaseRequest = 0;
+    const auto releaseLevels = [&](size_t iRequiredSizeInBytes, const Request& requester) {
+        while (iResidentSizeInBytes + iRequiredSizeInBytes > iBudgetInBytes &&
+               iNextReleaseRequest < vReleaseRequests.size()) {
+            const auto& request = vReleaseRequests[iNextReleaseRequest];
+            if (std::tie(request.iLastDrawnUpdateIndex, request.priority) >=
+                std::tie(requester.iLastDrawnUpdateIndex, requester.priority)) {
+                break;
+            }
+            auto& streamedTexture = *request.pStreamedTexture;
+            iNextReleaseRequest += 1;
+
+            const auto iReleasedSize = getSizeFromLevel(streamedTexture, streamedTexture.iResidentLevel) -
+                                       getSizeFromLevel(streamedTexture, request.iLevel);
+            replaceStorage(
+                streamedTexture, createStorage(streamedTexture.source, request.iLevel), request.iLevel);
+            iResidentSizeInBytes -= iReleasedSize;
+            iReleasedSizeInBytes += iReleasedSize;
+        }
+    };
+    releaseLevels(
+        0,
+        Request{
+            .iLastDrawnUpdateIndex = std::numeric_limits<size_t>::max(),
+            .priority = std::numeric_limits<float>::max()});
+
+    // Start loading more detailed levels (a texture is replaced once its new levels are copied).
+    size_t iQueuedSizeInBytes = pTextureUploader != nullptr ? pTextureUploader->getPendingSizeInBytes() : 0;
+    for (const auto& request : vLoadRequests) {
+        if (iQueuedSizeInBytes >= iMaxQueuedSizeInBytes) {
+            break;
+        }
+        auto& streamedTexture = *request.pStreamedTexture;
+
+        // Both old and new storage exist until the new one is filled, load fewer levels if needed.
+        auto iLevel = request.iLevel;
+        releaseLevels(getSizeFromLevel(streamedTexture, iLevel), request);
+        while (iLevel < streamedTexture.iResidentLevel &&
+               iResidentSizeInBytes + getSizeFromLevel(streamedTexture, iLevel) > iBudgetInBytes) {
+            iLevel += 1;
+        }
+        if (iLevel == streamedTexture.iResidentLevel) {
+            continue;
+        }
+
+        streamedTexture.pLoadingTexture = createStorage(streamedTexture.source, iLevel);
+        streamedTexture.iLoadingLevel = iLevel;
+        streamedTexture.bIsUpdating = true;
+        iResidentSizeInBytes += getSizeFromLevel(streamedTexture, iLevel);
+
+        // Copy only new levels (other levels are copied from the current storage).
+        auto data = streamedTexture.source.data;
+        data.vLevels.assign(
+            data.vLevels.begin() + static_cast<std::ptrdiff_t>(iLevel),
+            data.vLevels.begin() + static_cast<std::ptrdiff_t>(streamedTexture.iResidentLevel));
+        for (auto& level : data.vLevels) {
+            level.iLevel -= static_cast<int>(iLevel);
+            iQueuedSizeInBytes += level.vData.size();
+        }
+        data.onUploaded = [this, pWeakStreamedTexture = std::weak_ptr(request.pStreamedTexture)]() {
+            const auto pStreamedTexture = pWeakStreamedTexture.lock();
+            if (pStreamedTexture == nullptr || pStreamedTexture->pTexture.expired()) {
+                return;
+            }
+            auto pLoadingTexture = std::move(pStreamedTexture->pLoadingTexture);
+            const auto iLoadingLevel = *pStreamedTexture->iLoadingLevel;
+            pStreamedTexture->iLoadingLevel = {};
+            pStreamedTexture->bIsUpdating = false;
+            replaceStorage(*pStreamedTexture, std::move(pLoadingTexture), iLoadingLevel);
+        };
+
+        // Pixels are copied to the new storage (that is not used by materials yet).
+        const auto pLoadingTexture = streamedTexture.pLoadingTexture;
+        TextureUploader::submit(pLoadingTexture, std::move(data), pTextureUploader);
+    }
+
+    iUpdateIndex += 1;
+
+    const auto bReplaced = bTexturesReplaced;
+    bTexturesReplaced = false;
+    return bReplaced;
+}
+
+size_t TextureStreamer::getTextureCount() const {
+    return static_cast<size_t>(std::ranges::count_if(
+        streamedTextures, [](const auto& item) { return !item.second->pTexture.expired(); }));
+}
+
+size_t TextureStreamer::getStreamedTextureCount() const {
+    return static_cast<size_t>(std::ranges::count_if(streamedTextures, [](const auto& item) {
+        return item.second->bIsStreamed && !item.second->pTexture.expired();
+    }));
+}
+
+size_t TextureStreamer::getResidentSizeInBytes() const { return iResidentSizeInBytes; }
+
+size_t TextureStreamer::getReleasedSizeInBytes() const { return iReleasedSizeInBytes; }
+
+void TextureStreamer::addTexture(
+    const std::shared_ptr<Texture>& pTexture,
+    const std::shared_ptr<StreamedTexture>& pStreamedTexture,
+    TextureUploader::TextureData& data) {
+    pStreamedTexture->pTexture = pTexture;
+    pStreamedTexture->iLastDrawnUpdateIndex = iUpdateIndex;
+    streamedTextures[pTexture.get()] = pStreamedTexture;
+
+    // The storage can't be changed until pixels are copied.
+    pStreamedTexture->bIsUpdating = true;
+    data.onUploaded = [pWeakStreamedTexture = std::weak_ptr(pStreamedTexture)]() {
+        const auto pStreamedTexture = pWeakStreamedTexture.lock();
+        if (pStreamedTexture != nullptr) {
+            pStreamedTexture->bIsUpdating = false;
+        }
+    };
+}
+
+size_t TextureStreamer::getInitialLevel(const std::vector<TextureUploader::Level>& vLevels) {
+    size_t iLevel = 0;
+    while (iLevel + 1 < vLevels.size() &&
+           std::max(vLevels[iLevel].iWidth, vLevels[iLevel].iHeight) > iInitialResolution) {
+        iLevel += 1;
+    }
+    return iLevel;
+}
+
+std::shared_ptr<Texture> TextureStreamer::createStorage(const TextureSource& source, size_t iTopLevel) {
+    const auto& vLevels = source.data.vLevels;
+
+    // Create a new texture object.
+    unsigned int iTextureId = 0;
+    glGenTextures(1, &iTextureId);
+    auto pTexture = Texture::create(iTextureId);
+
+    // Allocate immutable storage for levels starting from the specified one.
+    glBindTexture(GL_TEXTURE_2D, iTextureId);
+    glTexStorage2D(
+        GL_TEXTURE_2D,
+        static_cast<int>(vLevels.size() - iTopLevel),
+        source.iInternalFormat,
+        vLevels[iTopLevel].iWidth,
+        vLevels[iTopLevel].iHeight);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, source.vSwizzle.data());
+
+    return pTexture;
+}
+
+void TextureStreamer::replaceStorage(
+    StreamedTexture& texture, std::shared_ptr<Texture> pNewTexture, size_t iNewTopLevel) {
+    const auto pTexture = texture.pTexture.lock();
+    const auto& vLevels = texture.source.data.vLevels;
+
+    // Copy levels that both storages have.
+    for (size_t iLevel = std::max(texture.iResidentLevel, iNewTopLevel); iLevel < vLevels.size(); iLevel++) {
+        glCopyImageSubData(
+            pTexture->getTextureId(),
+            GL_TEXTURE_2D,
+            static_cast<int>(iLevel - texture.iResidentLevel),
+            0,
+            0,
+            0,
+            pNewTexture->getTextureId(),
+            GL_TEXTURE_2D,
+            static_cast<int>(iLevel - iNewTopLevel),
+            0,
+            0,
+            0,
+            vLevels[iLevel].iWidth,
+            vLevels[iLevel].iHeight,
+            1);
+    }
+
+    // Materials keep referencing the same texture, the old texture object is deleted later.
+    pTexture->swapTextureId(*pNewTexture);
+    texture.iResidentLevel = iNewTopLevel;
+    vRetiredTextures.push_back(
+        RetiredTexture{.pTexture = std::move(pNewTexture), .iUpdateIndex = iUpdateIndex});
+    bTexturesReplaced = true;
+}
+
+size_t TextureStreamer::getSizeFromLevel(const StreamedTexture& texture, size_t iTopLevel) {
+    size_t iSizeInBytes = 0;
+    for (size_t i = iTopLevel; i < texture.vLevelSizes.size(); i++) {
+        iSizeInBytes += texture.vLevelSizes[i];
+    }
+    return iSizeInBytes;
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+// Standard.
+#include <memory>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <optional>
+#include <vector>
+
+// Custom.
+#include "TextureUploader.h"
+
+class Texture;
+class MaterialBuffer;
+struct Material;
+
+/**
+ * Keeps only the least detailed mip levels of textures with precomputed mipmaps in video memory and loads
+ * more detailed levels depending on the size that meshes which use the textures have on the screen
+ * (within a budget of video memory).
+ *
+ * @remark Also tracks memory of other registered textures (see @ref registerTexture): when over budget,
+ * textures that were not drawn for the longest time are downscaled first (their detailed levels are
+ * released, textures without precomputed mipmaps can't load them back).
+ *
+ * @remark Textures have immutable storage (required by bindless handles) so to change the number of
+ * resident levels a texture with new storage is created and its texture object is swapped with the
+ * streamed texture (see @ref Texture::swapTextureId), materials that use streamed textures should then be
+ * updated (see @ref update).
+ */
+class TextureStreamer {
+public:
+    /** Precomputed mipmaps of a streamed texture. */
+    struct TextureSource {
+        /** Internal format of the texture (a compressed format). */
+        int iInternalFormat = 0;
+
+        /** Values of `GL_TEXTURE_SWIZZLE_RGBA`. */
+        std::array<int, 4> vSwizzle = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+
+        /** All mip levels starting from the most detailed one (kept in memory while the texture is used). */
+        TextureUploader::TextureData data;
+    };
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    /**
+     * Creates a new streamer.
+     *
+     * @return Created streamer.
+     */
+    static std::unique_ptr<TextureStreamer> create();
+
+    /**
+     * Creates a texture that only stores mip levels that are not bigger than @ref iInitialResolution
+     * (more detailed levels are loaded in @ref update once they are needed).
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param source           Mipmaps of the texture.
+     * @param pTextureUploader Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     *
+     * @return Created texture.
+     */
+    std::shared_ptr<Texture> createTexture(TextureSource&& source, TextureUploader* pTextureUploader);
+
+    /**
+     * Starts tracking memory of a texture that stores a full mip chain (without precomputed mipmaps)
+     * so that it can be downscaled when over budget.
+     *
+     * @param pTexture        Texture with immutable storage of `bit_width(max(width, height))` levels.
+     * @param iInternalFormat Internal format of the texture.
+     * @param vSwizzle        Values of `GL_TEXTURE_SWIZZLE_RGBA` of the texture.
+     * @param iWidth          Width of the most detailed level.
+     * @param iHeight         Height of the most detailed level.
+     * @param iBytesPerTexel  Size of one texel.
+     * @param data            Pixels that will be copied to the texture (the texture is not downscaled until
+     * they are copied).
+     */
+    void registerTexture(
+        const std::shared_ptr<Texture>& pTexture,
+        int iInternalFormat,
+        const std::array<int, 4>& vSwizzle,
+        int iWidth,
+        int iHeight,
+        size_t iBytesPerTexel,
+        TextureUploader::TextureData& data);
+
+    /**
+     * Notifies the streamer that textures of the specified material are drawn on a mesh of the specified
+     * size on the screen during this frame.
+     *
+     * @param material     Material of a drawn mesh.
+     * @param sizeInPixels Size of the mesh's bounding sphere on the screen.
+     */
+    void requestResolution(const Material& material, float sizeInPixels);
+
+    /**
+     * Selects mip levels that textures need for sizes requested since the last call, starts loading
+     * more detailed levels and releases levels that are no longer needed (if over budget, least recently
+     * drawn textures first).
+     *
+     * @remark Expected to be called once per frame (after the frame was drawn).
+     *
+     * @param iBudgetInBytes   Size of video memory that textures can use.
+     * @param pTextureUploader Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     * @param pMaterialBuffer  Buffer to release bindless handles of replaced textures from.
+     *
+     * @return `true` if texture objects of some streamed textures were replaced since the last call
+     * (bindless handles of materials that use them should be updated), `false` otherwise.
+     */
+    bool update(size_t iBudgetInBytes, TextureUploader* pTextureUploader, MaterialBuffer* pMaterialBuffer);
+
+    /**
+     * Returns the number of tracked textures that are still used.
+     *
+     * @return Texture count.
+     */
+    size_t getTextureCount() const;
+
+    /**
+     * Returns the number of tracked textures that are still used and have precomputed mipmaps.
+     *
+     * @return Texture count.
+     */
+    size_t getStreamedTextureCount() const;
+
+    /**
+     * Returns size of video memory used by tracked textures (during the last @ref update).
+     *
+     * @return Size in bytes.
+     */
+    size_t getResidentSizeInBytes() const;
+
+    /**
+     * Returns total size of levels that were released to stay within the budget.
+     *
+     * @return Size in bytes.
+     */
+    size_t getReleasedSizeInBytes() const;
+
+    /**
+     * Largest size of the most detailed mip level that is stored when a streamed texture is created
+     * (textures are not downscaled below it).
+     */
+    static constexpr int iInitialResolution = 128; // NOLINT
+
+    /** Default size of video memory that textures and geometry can use. */
+    static constexpr size_t iDefaultBudgetInBytes = size_t{3072} * 1024 * 1024; // NOLINT: 3 GB
+
+private:
+    /** State of a streamed texture. */
+    struct StreamedTexture {
+        /** Texture that materials use. */
+        std::weak_ptr<Texture> pTexture;
+
+        /** Mipmaps of the texture (levels have no data if @ref bIsStreamed is `false`). */
+        TextureSource source;
+
+        /** Size of each level. */
+        std::vector<size_t> vLevelSizes;
+
+        /** Whether released levels can be loaded back or not. */
+        bool bIsStreamed = false;
+
+        /** Index of the most detailed level that the texture stores. */
+        size_t iResidentLevel = 0;
+
+        /** Index of the most detailed level that is being loaded (if loading). */
+        std::optional<size_t> iLoadingLevel;
+
+        /** Texture with storage for @ref iLoadingLevel that is being filled (if loading). */
+        std::shared_ptr<Texture> pLoadingTexture;
+
+        /** Largest size on the screen that the texture was requested for since the last update. */
+        float requestedResolution = 0.0F;
+
+        /** Index of the last update before which the texture was drawn. */
+        size_t iLastDrawnUpdateIndex = 0;
+
+        /** Whether pixels are being copied to the texture (its storage can't be changed) or not. */
+        bool bIsUpdating = false;
+    };
+
+    /** Texture object that was replaced (might still be used by frames in flight). */
+    struct RetiredTexture {
+        /** Owns the replaced texture object. */
+        std::shared_ptr<Texture> pTexture;
+
+        /** Index of the update during which the texture was replaced. */
+        size_t iUpdateIndex = 0;
+    };
+
+    TextureStreamer() = default;
+
+    /**
+     * Creates a texture with storage for mip levels starting from the specified one.
+     *
+     * @param source    Mipmaps of the texture.
+     * @param iTopLevel Index of the most detailed level to store.
+     *
+     * @return Created texture.
+     */
+    static std::shared_ptr<Texture> createStorage(const TextureSource& source, size_t iTopLevel);
+
+    /**
+     * Copies stored mip levels of a streamed texture to a texture with storage for levels starting from
+     * the specified one and replaces the streamed texture's texture object.
+     *
+     * @param texture      Streamed texture.
+     * @param pNewTexture  Texture with new storage (levels that are not copied are expected to be filled).
+     * @param iNewTopLevel Index of the most detailed level of the new storage.
+     */
+    void replaceStorage(StreamedTexture& texture, std::shared_ptr<Texture> pNewTexture, size_t iNewTopLevel);
+
+    /**
+     * Returns index of the most detailed level that is not bigger than @ref iInitialResolution
+     * (textures are not downscaled below it).
+     *
+     * @param vLevels All levels of a texture.
+     *
+     * @return Level index.
+     */
+    static size_t getInitialLevel(const std::vector<TextureUploader::Level>& vLevels);
+
+    /**
+     * Returns size of mip levels starting from the specified one.
+     *
+     * @param texture   Streamed texture.
+     * @param iTopLevel Index of the most detailed level.
+     *
+     * @return Size in bytes.
+     */
+    static size_t getSizeFromLevel(const StreamedTexture& texture, size_t iTopLevel);
+
+    /**
+     * Starts tracking a texture.
+     *
+     * @param pTexture        Texture.
+     * @param pStreamedTexture State of the texture.
+     * @param data            Pixels that will be copied to the texture.
+     */
+    void addTexture(
+        const std::shared_ptr<Texture>& pTexture,
+        const std::shared_ptr<StreamedTexture>& pStreamedTexture,
+        TextureUploader::TextureData& data);
+
+    /** Tracked textures. */
+    std::unordered_map<const Texture*, std::shared_ptr<StreamedTexture>> streamedTextures;
+
+    /** Texture objects that were replaced (in the order of replacement). */
+    std::deque<RetiredTexture> vRetiredTextures;
+
+    /** Size of video memory used by tracked textures. */
+    size_t iResidentSizeInBytes = 0;
+
+    /** Total size of levels that were released to stay within the budget. */
+    size_t iReleasedSizeInBytes = 0;
+
+    /** Number of finished updates (also used to stamp drawn textures). */
+    size_t iUpdateIndex = 0;
+
+    /** Whether texture objects were replaced since the last update or not. */
+    bool bTexturesReplaced = false;
+
+    /** Number of updates after which replaced texture objects are deleted. */
+    static constexpr size_t iRetiredTextureUpdateCount = 4;
+
+    /** Size of pixels after which no more levels are started to load during an update. */
+    static constexpr size_t iMaxQueuedSizeInBytes = 32 * 1024 * 1024; // NOLINT: 32 MB
+};
@@ -0,0 +1,337 @@
+#include "TextureUploader.h"
+
+// Standard.
+#include <format>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+// Custom.
+#include "Texture.h"
+#include "threading/ThreadPool.h"
+
+TextureUploader::TextureUploader(size_t iStagingSizeInBytes) : iStagingSizeInBytes(iStagingSizeInBytes) {}
+
+TextureUploader::~TextureUploader() {
+    // Wait for worker threads to finish writing to the staging buffer.
+    for (const auto& pChunk : vCopyingChunks) {
+        pChunk->copyTask.wait();
+    }
+
+    // Wait for the GPU to finish reading the staging buffer before unmapping.
+    while (!vSubmittedBatches.empty()) {
+        releaseFinishedBatches(true);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, iBufferId);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glDeleteBuffers(1, &iBufferId);
+}
+
+std::unique_ptr<TextureUploader> TextureUploader::create(size_t iStagingSizeInBytes) {
+    if (iStagingSizeInBytes < iStagingAlignment) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("expected the staging buffer size to be at least {} bytes", iStagingAlignment));
+    }
+    iStagingSizeInBytes = iStagingSizeInBytes / iStagingAlignment * iStagingAlignment;
+
+    auto pUploader = std::unique_ptr<TextureUploader>(new TextureUploader(iStagingSizeInBytes));
+
+    // Create an immutable buffer that will stay mapped while it's used by the GPU.
+    constexpr GLbitfield iFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto iBufferSize = static_cast<GLsizeiptr>(iStagingSizeInBytes);
+    glGenBuffers(1, &pUploader->iBufferId);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pUploader->iBufferId);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, iBufferSize, nullptr, iFlags);
+    pUploader->pMappedData =
+        static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, iBufferSize, iFlags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (pUploader->pMappedData == nullptr) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("failed to persistently map a pixel buffer of size {} byte(s)", iBufferSize));
+    }
+
+    return pUploader;
+}
+
+void TextureUploader::uploadImmediately(const Texture& texture, const TextureData& data) {
+    glBindTexture(data.iBindTarget, texture.getTextureId());
+
+    // Copy pixels (rows are tightly packed).
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const auto& level : data.vLevels) {
+        copyRows(data, level, 0, level.iHeight, level.vData.data(), level.vData.size());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // restore default value
+
+    if (data.bGenerateMipmaps) {
+        glGenerateMipmap(data.iBindTarget);
+    }
+
+    if (data.onUploaded) {
+        data.onUploaded();
+    }
+}
+
+void TextureUploader::queueUpload(const std::shared_ptr<Texture>& pTexture, TextureData&& data) {
+    auto pPendingTexture = std::make_shared<PendingTexture>();
+    pPendingTexture->pTexture = pTexture;
+    pPendingTexture->data = std::move(data);
+
+    // Split levels into chunks of rows so that a big level does not need to fit into the staging buffer
+    // and can be uploaded over multiple frames.
+    const auto iChunkSizeLimit = std::min(iMaxChunkSizeInBytes, iStagingSizeInBytes / 2);
+    const auto& vLevels = pPendingTexture->data.vLevels;
+    for (size_t iLevelIndex = 0; iLevelIndex < vLevels.size(); iLevelIndex++) {
+        const auto& level = vLevels[iLevelIndex];
+
+        // Compressed levels are split by rows of blocks.
+        const auto iRowHeight = pPendingTexture->data.bIsCompressed ? 4 : 1;
+        const auto iRowCount = static_cast<size_t>((level.iHeight + iRowHeight - 1) / iRowHeight);
+        if (level.vData.empty() || iRowCount == 0 || level.vData.size() % iRowCount != 0) [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "unexpected data size {} of a texture level with {} row(s)", level.vData.size(), iRowCount));
+        }
+        const auto iRowSize = level.vData.size() / iRowCount;
+        if ((iRowSize + iStagingAlignment - 1) / iStagingAlignment * iStagingAlignment > iStagingSizeInBytes)
+            [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "a texture row of size {} byte(s) does not fit into the staging buffer", iRowSize));
+        }
+        const auto iRowsPerChunk = std::max(iChunkSizeLimit / iRowSize, size_t{1});
+
+        for (size_t iRow = 0; iRow < iRowCount; iRow += iRowsPerChunk) {
+            const auto iChunkRowCount = std::min(iRowsPerChunk, iRowCount - iRow);
+
+            auto pChunk = std::make_unique<Chunk>();
+            pChunk->pTexture = pPendingTexture;
+            pChunk->iLevelIndex = iLevelIndex;
+            pChunk->iOffsetY = static_cast<int>(iRow) * iRowHeight;
+            const auto iChunkEndY = static_cast<int>(iRow + iChunkRowCount) * iRowHeight;
+            pChunk->iHeight = std::min(iChunkEndY, level.iHeight) - pChunk->iOffsetY;
+            pChunk->vData = level.vData.subspan(iRow * iRowSize, iChunkRowCount * iRowSize);
+
+            pPendingTexture->iRemainingChunkCount += 1;
+            iPendingSizeInBytes += pChunk->vData.size();
+            vQueuedChunks.push_back(std::move(pChunk));
+        }
+    }
+}
+
+void TextureUploader::submit(
+    const std::shared_ptr<Texture>& pTexture, TextureData&& data, TextureUploader* pTextureUploader) {
+    if (pTextureUploader == nullptr) {
+        uploadImmediately(*pTexture, data);
+        return;
+    }
+
+    pTextureUploader->queueUpload(pTexture, std::move(data));
+}
+
+void TextureUploader::update(std::optional<size_t> iBudgetInBytes) {
+    releaseFinishedBatches(false);
+    startCopyingChunks();
+    submitCopiedChunks(iBudgetInBytes);
+
+    if (iBudgetInBytes.has_value()) {
+        return;
+    }
+
+    // Wait for the GPU to release staging regions until all queued chunks are submitted.
+    while (!vQueuedChunks.empty()) {
+        releaseFinishedBatches(true);
+        startCopyingChunks();
+        submitCopiedChunks({});
+    }
+}
+
+size_t TextureUploader::getPendingSizeInBytes() const { return iPendingSizeInBytes; }
+
+size_t TextureUploader::getUploadedSizeInBytes() const { return iUploadedSizeInBytes; }
+
+std::optional<std::pair<size_t, size_t>> TextureUploader::reserveStagingRegion(size_t iSizeInBytes) {
+    if (iStagingUsedSize == 0) {
+        // Start from the beginning to avoid skipping space at the end.
+        iStagingHead = 0;
+    } else if (iStagingUsedSize == iStagingSizeInBytes) {
+        return {};
+    }
+
+    // Regions are released in order so free space starts at the head and ends at the tail.
+    const auto iStagingTail = (iStagingHead + iStagingSizeInBytes - iStagingUsedSize) % iStagingSizeInBytes;
+    if (iStagingUsedSize == 0 || iStagingTail < iStagingHead) {
+        // Free space wraps around the end of the buffer.
+        if (iStagingSizeInBytes - iStagingHead >= iSizeInBytes) {
+            const auto iOffset = iStagingHead;
+            iStagingHead = (iStagingHead + iSizeInBytes) % iStagingSizeInBytes;
+            iStagingUsedSize += iSizeInBytes;
+            return std::pair(iOffset, iSizeInBytes);
+        }
+
+        if (iStagingTail >= iSizeInBytes) {
+            // Skip space at the end of the buffer.
+            const auto iReservedSize = iStagingSizeInBytes - iStagingHead + iSizeInBytes;
+            iStagingHead = iSizeInBytes;
+            iStagingUsedSize += iReservedSize;
+            return std::pair(size_t{0}, iReservedSize);
+        }
+
+        return {};
+    }
+
+    if (iStagingTail - iStagingHead >= iSizeInBytes) {
+        const auto iOffset = iStagingHead;
+        iStagingHead += iSizeInBytes;
+        iStagingUsedSize += iSizeInBytes;
+        return std::pair(iOffset, iSizeInBytes);
+    }
+
+    return {};
+}
+
+void TextureUploader::releaseFinishedBatches(bool bWaitForOldest) {
+    constexpr GLuint64 iTimeoutInNanoseconds = 1000000; // NOLINT: 1 ms
+
+    while (!vSubmittedBatches.empty()) {
+        auto& batch = vSubmittedBatches.front();
+
+        // See if the GPU finished commands that were submitted before the fence.
+        const auto iResult = glClientWaitSync(
+            batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, bWaitForOldest ? iTimeoutInNanoseconds : 0);
+        if (iResult == GL_TIMEOUT_EXPIRED) {
+            if (!bWaitForOldest) {
+                break;
+            }
+            continue;
+        }
+        if (iResult == GL_WAIT_FAILED) [[unlikely]] {
+            throw std::runtime_error("failed to wait for a fence of a texture upload");
+        }
+
+        glDeleteSync(batch.fence);
+        iStagingUsedSize -= batch.iStagingSize;
+        vSubmittedBatches.pop_front();
+
+        // Don't wait for newer batches.
+        bWaitForOldest = false;
+    }
+}
+
+void TextureUploader::startCopyingChunks() {
+    while (!vQueuedChunks.empty()) {
+        auto& pChunk = vQueuedChunks.front();
+
+        // Reserve a region (chunks are copied in order so that regions are released in order).
+        const auto iAlignedSize =
+            (pChunk->vData.size() + iStagingAlignment - 1) / iStagingAlignment * iStagingAlignment;
+        const auto optionalRegion = reserveStagingRegion(iAlignedSize);
+        if (!optionalRegion.has_value()) {
+            break;
+        }
+        const auto [iOffset, iReservedSize] = *optionalRegion;
+        pChunk->iStagingOffset = iOffset;
+        pChunk->iStagingSize = iReservedSize;
+
+        // Copy on a worker thread (the chunk keeps its data alive until the copy is finished).
+        auto* const pDestination = pMappedData + iOffset; // NOLINT: pointer arithmetic
+        pChunk->copyTask = ThreadPool::get().addTask([pDestination, vSource = pChunk->vData]() {
+            std::memcpy(pDestination, vSource.data(), vSource.size());
+        });
+
+        vCopyingChunks.push_back(std::move(pChunk));
+        vQueuedChunks.pop_front();
+    }
+}
+
+void TextureUploader::submitCopiedChunks(std::optional<size_t> iBudgetInBytes) {
+    size_t iSubmittedSize = 0;
+    size_t iBatchStagingSize = 0;
+    bool bIsBufferBound = false;
+
+    while (!vCopyingChunks.empty()) {
+        auto& pChunk = vCopyingChunks.front();
+
+        // Chunks are submitted in order so that their regions are released in order.
+        if (!iBudgetInBytes.has_value()) {
+            pChunk->copyTask.wait();
+        } else if (pChunk->copyTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+                   (iSubmittedSize != 0 && iSubmittedSize + pChunk->vData.size() > *iBudgetInBytes)) {
+            break;
+        }
+        pChunk->copyTask.get();
+
+        if (!bIsBufferBound) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, iBufferId);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            bIsBufferBound = true;
+        }
+
+        // Skip textures that were deleted.
+        auto& pendingTexture = *pChunk->pTexture;
+        const auto pTexture = pendingTexture.pTexture.lock();
+        if (pTexture != nullptr) {
+            const auto& data = pendingTexture.data;
+            glBindTexture(data.iBindTarget, pTexture->getTextureId());
+            copyRows(
+                data,
+                data.vLevels[pChunk->iLevelIndex],
+                pChunk->iOffsetY,
+                pChunk->iHeight,
+                reinterpret_cast<const void*>(pChunk->iStagingOffset), // NOLINT: offset in the bound buffer
+                pChunk->vData.size());
+
+            iUploadedSizeInBytes += pChunk->vData.size();
+            pendingTexture.iRemainingChunkCount -= 1;
+            if (pendingTexture.iRemainingChunkCount == 0) {
+                if (data.bGenerateMipmaps) {
+                    glGenerateMipmap(data.iBindTarget);
+                }
+                if (data.onUploaded) {
+                    // The callback might bind other objects.
+                    data.onUploaded();
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, iBufferId);
+                }
+            }
+        }
+
+        iPendingSizeInBytes -= pChunk->vData.size();
+        iSubmittedSize += pChunk->vData.size();
+        iBatchStagingSize += pChunk->iStagingSize;
+        vCopyingChunks.pop_front();
+    }
+
+    if (bIsBufferBound) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // restore default value
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Release regions once the GPU finished reading them.
+    if (iBatchStagingSize != 0) {
+        vSubmittedBatches.push_back(SubmittedBatch{
+            .fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), .iStagingSize = iBatchStagingSize});
+    }
+}
+
+void TextureUploader::copyRows(
+    const TextureData& data, const Level& level, int iOffsetY, int iHeight, const void* pData, size_t iSize) {
+    if (data.bIsCompressed) {
+        glCompressedTexSubImage2D(
+            level.iTarget,
+            level.iLevel,
+            0,
+            iOffsetY,
+            level.iWidth,
+            iHeight,
+            data.iFormat,
+            static_cast<int>(iSize),
+            pData);
+        return;
+    }
+
+    glTexSubImage2D(
+        level.iTarget, level.iLevel, 0, iOffsetY, level.iWidth, iHeight, data.iFormat, data.iType, pData);
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+// Standard.
+#include <memory>
+#include <vector>
+#include <deque>
+#include <span>
+#include <future>
+#include <optional>
+#include <functional>
+
+// Custom.
+#include "window/GLFW.hpp"
+
+class Texture;
+
+/**
+ * Copies pixels to textures asynchronously through a persistently mapped pixel buffer (used as a ring of
+ * staging regions): pixels are copied to the buffer on worker threads and the OpenGL thread only issues
+ * copies from the buffer to textures (limited by a budget per frame).
+ *
+ * @remark Textures are expected to have immutable storage (so that their bindless handles can be created
+ * before pixels are uploaded), the uploader only updates their pixels.
+ */
+class TextureUploader {
+public:
+    /** Pixels of one mip level (or of a cubemap face) to copy to a texture. */
+    struct Level {
+        /** Target to copy pixels to: `GL_TEXTURE_2D` or a face of a cubemap. */
+        int iTarget = GL_TEXTURE_2D;
+
+        /** Index of the mip level. */
+        int iLevel = 0;
+
+        /** Width of the mip level. */
+        int iWidth = 0;
+
+        /** Height of the mip level. */
+        int iHeight = 0;
+
+        /** Pixels (rows from top to bottom, tightly packed) or compressed blocks (rows of blocks). */
+        std::span<const unsigned char> vData;
+    };
+
+    /** Pixels to copy to a texture. */
+    struct TextureData {
+        /** Target to bind the texture to: `GL_TEXTURE_2D` or `GL_TEXTURE_CUBE_MAP`. */
+        int iBindTarget = GL_TEXTURE_2D;
+
+        /** Format of pixels (such as `GL_RGBA`) or internal format of compressed blocks. */
+        int iFormat = 0;
+
+        /** Type of channels (such as `GL_UNSIGNED_BYTE`), ignored if blocks are compressed. */
+        int iType = 0;
+
+        /** Whether @ref Level::vData stores compressed 4x4 blocks or not. */
+        bool bIsCompressed = false;
+
+        /** Whether mipmaps should be generated from the first level once all levels were copied. */
+        bool bGenerateMipmaps = false;
+
+        /** Levels to copy. */
+        std::vector<Level> vLevels;
+
+        /** Keeps data of levels alive until it's copied. */
+        std::shared_ptr<const void> pDataOwner;
+
+        /** Called (on the OpenGL thread) once copies of all levels were issued, optional. */
+        std::function<void()> onUploaded;
+    };
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator=(const TextureUploader&) = delete;
+
+    /** Waits for pending copies (pixels of queued uploads that were not copied yet are discarded). */
+    ~TextureUploader();
+
+    /**
+     * Creates a new uploader.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param iStagingSizeInBytes Size of the persistently mapped buffer that pixels are copied through.
+     *
+     * @return Created uploader.
+     */
+    static std::unique_ptr<TextureUploader> create(size_t iStagingSizeInBytes);
+
+    /**
+     * Copies pixels to the specified texture right away (from client memory).
+     *
+     * @remark Used when there is no uploader (for example, for resources that are needed immediately).
+     *
+     * @param texture Texture to copy pixels to.
+     * @param data    Pixels to copy.
+     */
+    static void uploadImmediately(const Texture& texture, const TextureData& data);
+
+    /**
+     * Queues pixels to be copied to the specified texture (see @ref update).
+     *
+     * @remark Pixels are not copied if the texture is deleted before they are uploaded.
+     *
+     * @param pTexture Texture to copy pixels to.
+     * @param data     Pixels to copy.
+     */
+    void queueUpload(const std::shared_ptr<Texture>& pTexture, TextureData&& data);
+
+    /**
+     * Queues pixels to be copied to the specified texture (see @ref queueUpload) or copies them right away
+     * (see @ref uploadImmediately) if the uploader is not specified.
+     *
+     * @param pTexture         Texture to copy pixels to.
+     * @param data             Pixels to copy.
+     * @param pTextureUploader Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     */
+    static void
+    submit(const std::shared_ptr<Texture>& pTexture, TextureData&& data, TextureUploader* pTextureUploader);
+
+    /**
+     * Releases staging regions that the GPU finished reading, starts copying queued pixels to free
+     * regions on worker threads and copies pixels that were copied to regions to textures.
+     *
+     * @remark Expected to be called once per frame.
+     *
+     * @param iBudgetInBytes Size of pixels after which no more copies to textures will be issued during
+     * this call (at least one copy is issued), empty to upload all queued pixels (blocks until they are
+     * copied to the staging buffer).
+     */
+    void update(std::optional<size_t> iBudgetInBytes);
+
+    /**
+     * Returns size of pixels that were queued but not copied to textures yet.
+     *
+     * @return Size in bytes.
+     */
+    size_t getPendingSizeInBytes() const;
+
+    /**
+     * Returns total size of pixels that were copied to textures.
+     *
+     * @return Size in bytes.
+     */
+    size_t getUploadedSizeInBytes() const;
+
+    /** Default size of the staging buffer. */
+    static constexpr size_t iDefaultStagingSizeInBytes = 64 * 1024 * 1024; // NOLINT: 64 MB
+
+    /** Default size of pixels to copy to textures per frame. */
+    static constexpr size_t iDefaultFrameBudgetInBytes = 16 * 1024 * 1024; // NOLINT: 16 MB
+
+private:
+    /** Texture that has pixels waiting to be uploaded. */
+    struct PendingTexture {
+        /** Texture to copy pixels to. */
+        std::weak_ptr<Texture> pTexture;
+
+        /** Pixels to copy. */
+        TextureData data;
+
+        /** Number of chunks of @ref data that were not copied to the texture yet. */
+        size_t iRemainingChunkCount = 0;
+    };
+
+    /** Rows of a level that are copied through one staging region. */
+    struct Chunk {
+        /** Texture that the chunk belongs to. */
+        std::shared_ptr<PendingTexture> pTexture;
+
+        /** Index of the level in @ref TextureData::vLevels. */
+        size_t iLevelIndex = 0;
+
+        /** First row of pixels (not of blocks) to copy. */
+        int iOffsetY = 0;
+
+        /** Number of rows of pixels to copy. */
+        int iHeight = 0;
+
+        /** Data of the rows. */
+        std::span<const unsigned char> vData;
+
+        /** Offset of the staging region. */
+        size_t iStagingOffset = 0;
+
+        /** Size of the staging region (including space skipped at the end of the buffer). */
+        size_t iStagingSize = 0;
+
+        /** Ready once the data was copied to the staging region by a worker thread. */
+        std::future<void> copyTask;
+    };
+
+    /** Chunks that were copied to textures and whose staging regions are read by the GPU. */
+    struct SubmittedBatch {
+        /** Signaled when the GPU finished reading staging regions of the batch. */
+        GLsync fence = nullptr;
+
+        /** Total size of staging regions of the batch. */
+        size_t iStagingSize = 0;
+    };
+
+    /**
+     * Initializes the object.
+     *
+     * @param iStagingSizeInBytes Size of the staging buffer.
+     */
+    TextureUploader(size_t iStagingSizeInBytes);
+
+    /**
+     * Reserves a region of the staging buffer (regions are released in the order they were reserved).
+     *
+     * @param iSizeInBytes Size of the region.
+     *
+     * @return Empty if there is not enough free space, otherwise offset and size of the region (bigger
+     * than the specified size if space at the end of the buffer was skipped).
+     */
+    std::optional<std::pair<size_t, size_t>> reserveStagingRegion(size_t iSizeInBytes);
+
+    /**
+     * Releases staging regions of submitted batches that the GPU finished reading.
+     *
+     * @param bWaitForOldest `true` to wait for the oldest batch if it's not finished yet.
+     */
+    void releaseFinishedBatches(bool bWaitForOldest);
+
+    /** Reserves staging regions for queued chunks and starts copying them on worker threads. */
+    void startCopyingChunks();
+
+    /**
+     * Issues copies to textures from staging regions of chunks that were copied.
+     *
+     * @param iBudgetInBytes Size after which no more copies will be issued, empty to wait for all
+     * chunks that are being copied.
+     */
+    void submitCopiedChunks(std::optional<size_t> iBudgetInBytes);
+
+    /**
+     * Copies rows of a level to a texture that is bound to its bind target.
+     *
+     * @param data     Pixels that the level belongs to.
+     * @param level    Level to copy.
+     * @param iOffsetY First row to copy.
+     * @param iHeight  Number of rows to copy.
+     * @param pData    Pointer to the rows (or offset in the bound pixel buffer).
+     * @param iSize    Size of the rows in bytes.
+     */
+    static void copyRows(
+        const TextureData& data,
+        const Level& level,
+        int iOffsetY,
+        int iHeight,
+        const void* pData,
+        size_t iSize);
+
+    /** Chunks waiting for staging memory. */
+    std::deque<std::unique_ptr<Chunk>> vQueuedChunks;
+
+    /** Chunks that reserved staging regions (in the order of reservation). */
+    std::deque<std::unique_ptr<Chunk>> vCopyingChunks;
+
+    /** Batches of chunks that were copied to textures (in the order of submission). */
+    std::deque<SubmittedBatch> vSubmittedBatches;
+
+    /** Pointer to the beginning of the mapped staging buffer. */
+    unsigned char* pMappedData = nullptr;
+
+    /** ID of the staging buffer. */
+    unsigned int iBufferId = 0;
+
+    /** Size of the staging buffer. */
+    size_t iStagingSizeInBytes = 0;
+
+    /** Offset of the next region to reserve. */
+    size_t iStagingHead = 0;
+
+    /** Total size of reserved regions. */
+    size_t iStagingUsedSize = 0;
+
+    /** Size of pixels that were queued but not copied to textures yet. */
+    size_t iPendingSizeInBytes = 0;
+
+    /** Total size of pixels that were copied to textures. */
+    size_t iUploadedSizeInBytes = 0;
+
+    /** Largest size of data that is copied through one staging region. */
+    static constexpr size_t iMaxChunkSizeInBytes = 4 * 1024 * 1024; // NOLINT: 4 MB
+
+    /** Alignment of staging regions. */
+    static constexpr size_t iStagingAlignment = 16;
+};
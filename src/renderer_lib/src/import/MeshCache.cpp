@@ -0,0 +1,376 @@
+#include "MeshCache.h"
+
+// Standard.
+#include <format>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+// Custom.
+#include "io/FileHelpers.h"
+
+// External.
+#include "xxHash/xxhash.h"
+
+/** Identifies cache files. */
+static constexpr std::array<char, 8> vCacheFileMagic = {'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H'};
+
+/** Alignment of data blocks in cache files (so that vertices/indices can be used in place). */
+static constexpr uint64_t iCacheDataAlignment = 16;
+
+/**
+ * Returns a range of elements stored in the specified file data if the range is inside of the file.
+ *
+ * @param data          File data.
+ * @param iOffset       Offset of the first element from the start of the file.
+ * @param iElementCount Number of elements.
+ *
+ * @return Empty if the range is outside of the file or misaligned.
+ */
+template <typename T>
+inline std::optional<std::span<const T>>
+getCacheFileRange(std::span<const unsigned char> data, uint64_t iOffset, uint64_t iElementCount) {
+    if (iOffset > data.size() || iElementCount > (data.size() - iOffset) / sizeof(T) ||
+        iOffset % alignof(T) != 0) {
+        return {};
+    }
+
+    return std::span<const T>(
+        reinterpret_cast<const T*>(data.data() + iOffset), static_cast<size_t>(iElementCount)); // NOLINT
+}
+
+std::unique_ptr<MeshCache> MeshCache::load(
+    const std::filesystem::path& pathToSourceFile,
+    std::span<const unsigned char> sourceFileData,
+    const ImageSettings& imageSettings) {
+    // Find cache file.
+    const auto iSourceHash =
+        XXH3_64bits_withSeed(sourceFileData.data(), sourceFileData.size(), iFormatVersion);
+    const auto pathToCacheFile = getPathToCacheFile(iSourceHash);
+    if (!std::filesystem::exists(pathToCacheFile)) {
+        return nullptr;
+    }
+
+    auto pCache = std::unique_ptr<MeshCache>(new MeshCache());
+    pCache->pFile = MappedFile::create(pathToCacheFile);
+    const auto data = pCache->pFile->getData();
+
+    // Check header.
+    const auto optionalHeader = getCacheFileRange<FileHeader>(data, 0, 1);
+    if (!optionalHeader.has_value()) {
+        return nullptr;
+    }
+    const auto& header = optionalHeader->front();
+    if (header.vMagic != vCacheFileMagic || header.iFormatVersion != iFormatVersion ||
+        header.iSourceHash != iSourceHash || header.iSourceSizeInBytes != sourceFileData.size() ||
+        header.iImageSettings != getImageSettingsFlags(imageSettings)) {
+        return nullptr;
+    }
+    pCache->pHeader = &header;
+
+    // Get tables.
+    uint64_t iTableOffset = sizeof(FileHeader);
+    const auto optionalDependencies =
+        getCacheFileRange<DependencyEntry>(data, iTableOffset, header.iDependencyCount);
+    iTableOffset += header.iDependencyCount * sizeof(DependencyEntry);
+    const auto optionalMeshes = getCacheFileRange<MeshEntry>(data, iTableOffset, header.iMeshCount);
+    iTableOffset += header.iMeshCount * sizeof(MeshEntry);
+    const auto optionalMaterials =
+        getCacheFileRange<std::array<int32_t, 4>>(data, iTableOffset, header.iMaterialCount);
+    iTableOffset += header.iMaterialCount * sizeof(std::array<int32_t, 4>);
+    const auto optionalImages = getCacheFileRange<ImageEntry>(data, iTableOffset, header.iImageCount);
+    if (!optionalDependencies.has_value() || !optionalMeshes.has_value() || !optionalMaterials.has_value() ||
+        !optionalImages.has_value()) {
+        return nullptr;
+    }
+    pCache->vMeshEntries = *optionalMeshes;
+    pCache->vMaterialEntries = *optionalMaterials;
+    pCache->vImageEntries = *optionalImages;
+
+    // Make sure files that the model references were not modified.
+    for (const auto& dependency : *optionalDependencies) {
+        const auto optionalPath =
+            getCacheFileRange<char8_t>(data, dependency.iPathOffset, dependency.iPathSize);
+        if (!optionalPath.has_value()) {
+            return nullptr;
+        }
+
+        const auto pathToDependency =
+            pathToSourceFile.parent_path() / std::u8string(optionalPath->begin(), optionalPath->end());
+        if (hashFile(pathToDependency) != dependency.iContentHash) {
+            return nullptr;
+        }
+    }
+
+    // Make sure all data is inside of the file.
+    for (const auto& mesh : pCache->vMeshEntries) {
+        if (!getCacheFileRange<Vertex>(data, mesh.iVertexOffset, mesh.iVertexCount).has_value() ||
+            !getCacheFileRange<unsigned int>(data, mesh.iIndexOffset, mesh.iIndexCount).has_value() ||
+            mesh.iMaterialIndex >= static_cast<int64_t>(header.iMaterialCount)) {
+            return nullptr;
+        }
+
+        const auto optionalLods = getCacheFileRange<MeshLod>(data, mesh.iLodOffset, mesh.iLodCount);
+        if (!optionalLods.has_value()) {
+            return nullptr;
+        }
+        for (const auto& lod : *optionalLods) {
+            if (static_cast<uint64_t>(lod.iFirstIndex) + lod.iIndexCount > mesh.iIndexCount) {
+                return nullptr;
+            }
+        }
+
+        const auto optionalClusters =
+            getCacheFileRange<MeshCluster>(data, mesh.iClusterOffset, mesh.iClusterCount);
+        if (!optionalClusters.has_value()) {
+            return nullptr;
+        }
+        for (const auto& cluster : *optionalClusters) {
+            if (static_cast<uint64_t>(cluster.iFirstIndex) + cluster.iIndexCount > mesh.iIndexCount) {
+                return nullptr;
+            }
+        }
+
+        if (mesh.iInstanceCount == 0 ||
+            !getCacheFileRange<glm::mat4x4>(data, mesh.iInstanceOffset, mesh.iInstanceCount).has_value()) {
+            return nullptr;
+        }
+    }
+    for (const auto& vImageIndices : pCache->vMaterialEntries) {
+        for (const auto& iImageIndex : vImageIndices) {
+            if (iImageIndex >= static_cast<int64_t>(header.iImageCount)) {
+                return nullptr;
+            }
+        }
+    }
+    for (const auto& image : pCache->vImageEntries) {
+        if (image.iCompressedSize != 0) {
+            // Compressed images don't store pixels.
+            const auto optionalFile =
+                getCacheFileRange<unsigned char>(data, image.iCompressedOffset, image.iCompressedSize);
+            if (image.iPixelsSize != 0 || !optionalFile.has_value() ||
+                !TextureCompressor::readDds(*optionalFile).has_value() ||
+                image.compressedFormat > TextureCompressor::Format::BC4) {
+                return nullptr;
+            }
+            continue;
+        }
+
+        const auto iExpectedSize = static_cast<uint64_t>(image.iWidth) * image.iHeight * image.iChannelCount *
+                                   (image.iBitsPerChannel / 8); // NOLINT: bits in byte
+        if (image.iPixelsSize != iExpectedSize ||
+            !getCacheFileRange<unsigned char>(data, image.iPixelsOffset, image.iPixelsSize).has_value()) {
+            return nullptr;
+        }
+    }
+
+    return pCache;
+}
+
+void MeshCache::write(
+    const std::filesystem::path& pathToSourceFile,
+    std::span<const unsigned char> sourceFileData,
+    const Content& content) {
+    // Prepare header.
+    FileHeader header;
+    header.vMagic = vCacheFileMagic;
+    header.iFormatVersion = iFormatVersion;
+    header.largestMeshSize = content.largestMeshSize;
+    header.iSourceHash = XXH3_64bits_withSeed(sourceFileData.data(), sourceFileData.size(), iFormatVersion);
+    header.iSourceSizeInBytes = sourceFileData.size();
+    header.iDependencyCount = content.vDependencies.size();
+    header.iMeshCount = content.vMeshes.size();
+    header.iMaterialCount = content.vMaterialImageIndices.size();
+    header.iImageCount = content.vImages.size();
+    header.iImageSettings = getImageSettingsFlags(content.imageSettings);
+
+    // Prepare tables while writing so that a failure to hash a dependency is handled as a failed write.
+    FileHelpers::writeCacheFile(getPathToCacheFile(header.iSourceHash), [&](std::ofstream& file) {
+        // Place data after tables.
+        uint64_t iDataOffset = sizeof(FileHeader) + header.iDependencyCount * sizeof(DependencyEntry) +
+                               header.iMeshCount * sizeof(MeshEntry) +
+                               header.iMaterialCount * sizeof(std::array<int32_t, 4>) +
+                               header.iImageCount * sizeof(ImageEntry);
+        const auto reserveData = [&iDataOffset](uint64_t iSizeInBytes) -> uint64_t {
+            iDataOffset = (iDataOffset + iCacheDataAlignment - 1) / iCacheDataAlignment * iCacheDataAlignment;
+            const auto iOffset = iDataOffset;
+            iDataOffset += iSizeInBytes;
+            return iOffset;
+        };
+
+        // Prepare tables.
+        std::vector<DependencyEntry> vDependencyEntries(content.vDependencies.size());
+        std::vector<std::u8string> vDependencyPaths(content.vDependencies.size());
+        for (size_t i = 0; i < content.vDependencies.size(); i++) {
+            const auto optionalHash = hashFile(content.vDependencies[i]);
+            if (!optionalHash.has_value()) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "failed to read the file \"{}\" that the model references",
+                    content.vDependencies[i].string()));
+            }
+
+            vDependencyPaths[i] = content.vDependencies[i]
+                                      .lexically_relative(pathToSourceFile.parent_path())
+                                      .generic_u8string();
+            vDependencyEntries[i].iContentHash = *optionalHash;
+            vDependencyEntries[i].iPathSize = vDependencyPaths[i].size();
+            vDependencyEntries[i].iPathOffset = reserveData(vDependencyEntries[i].iPathSize);
+        }
+
+        std::vector<MeshEntry> vMeshEntries(content.vMeshes.size());
+        for (size_t i = 0; i < content.vMeshes.size(); i++) {
+            const auto& mesh = content.vMeshes[i];
+            auto& entry = vMeshEntries[i];
+
+            entry.iVertexCount = mesh.vVertices.size();
+            entry.iVertexOffset = reserveData(mesh.vVertices.size_bytes());
+            entry.iIndexCount = mesh.vIndices.size();
+            entry.iIndexOffset = reserveData(mesh.vIndices.size_bytes());
+            entry.iLodCount = mesh.vLods.size();
+            entry.iLodOffset = reserveData(mesh.vLods.size_bytes());
+            entry.iClusterCount = mesh.vClusters.size();
+            entry.iClusterOffset = reserveData(mesh.vClusters.size_bytes());
+            entry.iInstanceCount = mesh.vInstanceMatrices.size();
+            entry.iInstanceOffset = reserveData(mesh.vInstanceMatrices.size_bytes());
+            entry.aabbCenter = mesh.aabb.center;
+            entry.aabbExtents = mesh.aabb.extents;
+            entry.iMaterialIndex = mesh.iMaterialIndex;
+        }
+
+        std::vector<std::array<int32_t, 4>> vMaterialEntries(
+            content.vMaterialImageIndices.begin(), content.vMaterialImageIndices.end());
+
+        std::vector<ImageEntry> vImageEntries(content.vImages.size());
+        for (size_t i = 0; i < content.vImages.size(); i++) {
+            const auto& image = content.vImages[i];
+            auto& entry = vImageEntries[i];
+
+            entry.iPixelsSize = image.vPixels.size();
+            entry.iPixelsOffset = reserveData(image.vPixels.size());
+            entry.iCompressedSize = image.vCompressedData.size();
+            entry.iCompressedOffset = reserveData(image.vCompressedData.size());
+            entry.compressedFormat = image.compressedFormat;
+            entry.iWidth = image.iWidth;
+            entry.iHeight = image.iHeight;
+            entry.iChannelCount = image.iChannelCount;
+            entry.iBitsPerChannel = image.iBitsPerChannel;
+        }
+
+        uint64_t iWrittenSize = 0;
+        const auto writeBytes = [&](uint64_t iOffset, const void* pData, uint64_t iSizeInBytes) {
+            // Pad to the specified offset.
+            static constexpr std::array<char, iCacheDataAlignment> vZeros{};
+            while (iWrittenSize < iOffset) {
+                const auto iPaddingSize = std::min(iOffset - iWrittenSize, vZeros.size());
+                file.write(vZeros.data(), static_cast<std::streamsize>(iPaddingSize));
+                iWrittenSize += iPaddingSize;
+            }
+
+            file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(iSizeInBytes));
+            iWrittenSize += iSizeInBytes;
+        };
+        const auto writeTable = [&](const auto& vTable) {
+            writeBytes(iWrittenSize, vTable.data(), vTable.size() * sizeof(vTable[0]));
+        };
+
+        // Write header and tables.
+        writeBytes(0, &header, sizeof(header));
+        writeTable(vDependencyEntries);
+        writeTable(vMeshEntries);
+        writeTable(vMaterialEntries);
+        writeTable(vImageEntries);
+
+        // Write data in the order it was reserved.
+        for (size_t i = 0; i < vDependencyEntries.size(); i++) {
+            const auto& sPath = vDependencyPaths[i];
+            writeBytes(vDependencyEntries[i].iPathOffset, sPath.data(), sPath.size());
+        }
+        for (size_t i = 0; i < vMeshEntries.size(); i++) {
+            const auto& mesh = content.vMeshes[i];
+            writeBytes(vMeshEntries[i].iVertexOffset, mesh.vVertices.data(), mesh.vVertices.size_bytes());
+            writeBytes(vMeshEntries[i].iIndexOffset, mesh.vIndices.data(), mesh.vIndices.size_bytes());
+            writeBytes(vMeshEntries[i].iLodOffset, mesh.vLods.data(), mesh.vLods.size_bytes());
+            writeBytes(
+                vMeshEntries[i].iClusterOffset, mesh.vClusters.data(), mesh.vClusters.size_bytes());
+            writeBytes(
+                vMeshEntries[i].iInstanceOffset,
+                mesh.vInstanceMatrices.data(),
+                mesh.vInstanceMatrices.size_bytes());
+        }
+        for (size_t i = 0; i < vImageEntries.size(); i++) {
+            const auto& image = content.vImages[i];
+            writeBytes(vImageEntries[i].iPixelsOffset, image.vPixels.data(), image.vPixels.size());
+            writeBytes(
+                vImageEntries[i].iCompressedOffset,
+                image.vCompressedData.data(),
+                image.vCompressedData.size());
+        }
+    });
+}
+
+size_t MeshCache::getMeshCount() const { return vMeshEntries.size(); }
+
+MeshCache::MeshView MeshCache::getMesh(size_t iMeshIndex) const {
+    const auto& entry = vMeshEntries[iMeshIndex];
+    const auto data = pFile->getData();
+
+    MeshView mesh;
+    mesh.vVertices = *getCacheFileRange<Vertex>(data, entry.iVertexOffset, entry.iVertexCount);
+    mesh.vIndices = *getCacheFileRange<unsigned int>(data, entry.iIndexOffset, entry.iIndexCount);
+    mesh.vLods = *getCacheFileRange<MeshLod>(data, entry.iLodOffset, entry.iLodCount);
+    mesh.vClusters = *getCacheFileRange<MeshCluster>(data, entry.iClusterOffset, entry.iClusterCount);
+    mesh.vInstanceMatrices =
+        *getCacheFileRange<glm::mat4x4>(data, entry.iInstanceOffset, entry.iInstanceCount);
+    mesh.aabb.center = entry.aabbCenter;
+    mesh.aabb.extents = entry.aabbExtents;
+    mesh.iMaterialIndex = entry.iMaterialIndex;
+
+    return mesh;
+}
+
+size_t MeshCache::getMaterialCount() const { return vMaterialEntries.size(); }
+
+std::array<int, 4> MeshCache::getMaterialImageIndices(size_t iMaterialIndex) const {
+    const auto& entry = vMaterialEntries[iMaterialIndex];
+    return {entry[0], entry[1], entry[2], entry[3]};
+}
+
+size_t MeshCache::getImageCount() const { return vImageEntries.size(); }
+
+MeshCache::ImageView MeshCache::getImage(size_t iImageIndex) const {
+    const auto& entry = vImageEntries[iImageIndex];
+
+    ImageView image;
+    image.vPixels =
+        *getCacheFileRange<unsigned char>(pFile->getData(), entry.iPixelsOffset, entry.iPixelsSize);
+    image.vCompressedData = *getCacheFileRange<unsigned char>(
+        pFile->getData(), entry.iCompressedOffset, entry.iCompressedSize);
+    image.compressedFormat = entry.compressedFormat;
+    image.iWidth = entry.iWidth;
+    image.iHeight = entry.iHeight;
+    image.iChannelCount = entry.iChannelCount;
+    image.iBitsPerChannel = entry.iBitsPerChannel;
+
+    return image;
+}
+
+float MeshCache::getLargestMeshSize() const { return pHeader->largestMeshSize; }
+
+uint32_t MeshCache::getImageSettingsFlags(const ImageSettings& imageSettings) {
+    return (imageSettings.bIsCompressed ? 1U : 0U) | (imageSettings.bIsFlipped ? 2U : 0U);
+}
+
+std::filesystem::path MeshCache::getPathToCacheFile(uint64_t iSourceHash) {
+    return pathToCacheDirectory / std::format("{:016x}.meshcache", iSourceHash);
+}
+
+std::optional<uint64_t> MeshCache::hashFile(const std::filesystem::path& pathToFile) {
+    if (!std::filesystem::is_regular_file(pathToFile)) {
+        return {};
+    }
+
+    const auto pFile = MappedFile::create(pathToFile);
+    const auto data = pFile->getData();
+
+    return XXH3_64bits(data.data(), data.size());
+}
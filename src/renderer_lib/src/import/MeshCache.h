@@ -0,0 +1,377 @@
+#pragma once
+
+// Standard.
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <array>
+#include <span>
+#include <optional>
+#include <cstdint>
+
+// Custom.
+#include "Mesh.h"
+#include "io/MappedFile.h"
+#include "import/TextureCompressor.h"
+
+/**
+ * On-disk cache of imported models that stores decoded meshes and images in a layout that can be
+ * uploaded to the GPU directly from the memory-mapped cache file.
+ *
+ * @remark A cache file is found by a hash of the source file contents (and the cache format version)
+ * and is only used if files that the source file references (buffers, images) were not modified.
+ */
+class MeshCache {
+public:
+    /** Decoded mesh data. */
+    struct MeshView {
+        /** Vertices of the mesh. */
+        std::span<const Vertex> vVertices;
+
+        /** Indices of all levels of detail of the mesh. */
+        std::span<const unsigned int> vIndices;
+
+        /** Levels of detail (ranges of @ref vIndices). */
+        std::span<const MeshLod> vLods;
+
+        /** Clusters of the most detailed level of detail (ranges of @ref vIndices). */
+        std::span<const MeshCluster> vClusters;
+
+        /** Transforms (in model space) of instances of the mesh (at least one). */
+        std::span<const glm::mat4x4> vInstanceMatrices;
+
+        /** AABB of the mesh in model space. */
+        AABB aabb;
+
+        /** Index of the mesh's material (negative if the mesh uses the default material). */
+        int iMaterialIndex = -1;
+    };
+
+    /** Decoded image data. */
+    struct ImageView {
+        /** Pixels (rows from top to bottom, tightly packed), empty if the image is not used or compressed. */
+        std::span<const unsigned char> vPixels;
+
+        /** DDS file with mipmaps compressed by @ref TextureCompressor, empty if not compressed. */
+        std::span<const unsigned char> vCompressedData;
+
+        /** Format of @ref vCompressedData. */
+        TextureCompressor::Format compressedFormat = TextureCompressor::Format::BC7;
+
+        /** Width of the image. */
+        int iWidth = 0;
+
+        /** Height of the image. */
+        int iHeight = 0;
+
+        /** Number of channels (1-4). */
+        int iChannelCount = 0;
+
+        /** Size of one channel: 8 or 16. */
+        int iBitsPerChannel = 0;
+    };
+
+    /** Import settings that change stored images (a cache file is only used if they match). */
+    struct ImageSettings {
+        /** Whether used images are block-compressed or stored as decoded pixels. */
+        bool bIsCompressed = false;
+
+        /** Whether compressed images were flipped vertically (decoded pixels are flipped when uploaded). */
+        bool bIsFlipped = false;
+    };
+
+    /** Data to write to a cache file. */
+    struct Content {
+        /** Meshes of the model. */
+        std::vector<MeshView> vMeshes;
+
+        /** Indices of diffuse, normal, metallic-roughness and emission images of each material (or -1). */
+        std::vector<std::array<int, 4>> vMaterialImageIndices;
+
+        /** Images of the model (where index is image index). */
+        std::vector<ImageView> vImages;
+
+        /** Files (other than the source file) that the model was imported from. */
+        std::vector<std::filesystem::path> vDependencies;
+
+        /** Settings that images were imported with. */
+        ImageSettings imageSettings;
+
+        /** Largest size (along any axis) of a mesh. */
+        float largestMeshSize = 0.0F;
+    };
+
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    ~MeshCache() = default;
+
+    /**
+     * Looks for a valid cache file of the specified source file.
+     *
+     * @param pathToSourceFile Path to the imported file.
+     * @param sourceFileData   Contents of the imported file.
+     * @param imageSettings    Settings that images should be imported with.
+     *
+     * @return `nullptr` if there is no cache file or it's outdated/corrupted.
+     */
+    static std::unique_ptr<MeshCache> load(
+        const std::filesystem::path& pathToSourceFile,
+        std::span<const unsigned char> sourceFileData,
+        const ImageSettings& imageSettings);
+
+    /**
+     * Writes a cache file of the specified source file (replaces old cache file if existed).
+     *
+     * @remark Does not use OpenGL so can be called from any thread.
+     *
+     * @remark Failures are only logged (see @ref FileHelpers::writeCacheFile).
+     *
+     * @param pathToSourceFile Path to the imported file.
+     * @param sourceFileData   Contents of the imported file.
+     * @param content          Data to write.
+     */
+    static void write(
+        const std::filesystem::path& pathToSourceFile,
+        std::span<const unsigned char> sourceFileData,
+        const Content& content);
+
+    /**
+     * Returns the number of meshes in the cache.
+     *
+     * @return Mesh count.
+     */
+    size_t getMeshCount() const;
+
+    /**
+     * Returns data of the specified mesh (points to the mapped cache file).
+     *
+     * @param iMeshIndex Index of the mesh.
+     *
+     * @return Mesh data.
+     */
+    MeshView getMesh(size_t iMeshIndex) const;
+
+    /**
+     * Returns the number of materials in the cache.
+     *
+     * @return Material count.
+     */
+    size_t getMaterialCount() const;
+
+    /**
+     * Returns indices of diffuse, normal, metallic-roughness and emission images of the specified material.
+     *
+     * @param iMaterialIndex Index of the material.
+     *
+     * @return Image indices (negative if not used).
+     */
+    std::array<int, 4> getMaterialImageIndices(size_t iMaterialIndex) const;
+
+    /**
+     * Returns the number of images in the cache.
+     *
+     * @return Image count.
+     */
+    size_t getImageCount() const;
+
+    /**
+     * Returns data of the specified image (points to the mapped cache file).
+     *
+     * @param iImageIndex Index of the image.
+     *
+     * @return Image data.
+     */
+    ImageView getImage(size_t iImageIndex) const;
+
+    /**
+     * Returns the largest size (along any axis) of a mesh.
+     *
+     * @return Mesh size.
+     */
+    float getLargestMeshSize() const;
+
+    /** Directory to store cache files in. */
+    static inline std::filesystem::path pathToCacheDirectory =
+        std::filesystem::temp_directory_path() / "opengl-renderer" / "mesh_cache";
+
+    /** Whether imported models should be loaded from/saved to the cache or not. */
+    static inline bool bIsEnabled = true;
+
+    /** Version of the cache format, increase when the format or imported data changes. */
+    static constexpr uint32_t iFormatVersion = 6;
+
+private:
+    /**
+     * Header at the beginning of a cache file, followed by tables (dependencies, meshes, materials,
+     * images) and then by data that the tables reference.
+     */
+    struct FileHeader {
+        /** Identifies the file type. */
+        std::array<char, 8> vMagic{};
+
+        /** Equal to @ref iFormatVersion of the app that wrote the file. */
+        uint32_t iFormatVersion = 0;
+
+        /** Largest size (along any axis) of a mesh. */
+        float largestMeshSize = 0.0F;
+
+        /** Hash of the source file contents. */
+        uint64_t iSourceHash = 0;
+
+        /** Size of the source file in bytes. */
+        uint64_t iSourceSizeInBytes = 0;
+
+        /** Number of entries in the dependency table. */
+        uint64_t iDependencyCount = 0;
+
+        /** Number of entries in the mesh table. */
+        uint64_t iMeshCount = 0;
+
+        /** Number of entries in the material table. */
+        uint64_t iMaterialCount = 0;
+
+        /** Number of entries in the image table. */
+        uint64_t iImageCount = 0;
+
+        /** Settings that images were imported with (see @ref getImageSettingsFlags). */
+        uint32_t iImageSettings = 0;
+
+        /** Unused. */
+        uint32_t iPadding = 0;
+    };
+
+    /** Entry of the table of files (other than the source file) that the model was imported from. */
+    struct DependencyEntry {
+        /** Hash of the file contents. */
+        uint64_t iContentHash = 0;
+
+        /** Offset of the UTF-8 path (relative to the source file directory). */
+        uint64_t iPathOffset = 0;
+
+        /** Size of the path in bytes. */
+        uint64_t iPathSize = 0;
+    };
+
+    /** Entry of the table of meshes. */
+    struct MeshEntry {
+        /** Offset (from the start of the cache file) of vertices. */
+        uint64_t iVertexOffset = 0;
+
+        /** Number of vertices. */
+        uint64_t iVertexCount = 0;
+
+        /** Offset (from the start of the cache file) of indices. */
+        uint64_t iIndexOffset = 0;
+
+        /** Number of indices. */
+        uint64_t iIndexCount = 0;
+
+        /** Offset (from the start of the cache file) of levels of detail. */
+        uint64_t iLodOffset = 0;
+
+        /** Number of levels of detail. */
+        uint64_t iLodCount = 0;
+
+        /** Offset (from the start of the cache file) of clusters. */
+        uint64_t iClusterOffset = 0;
+
+        /** Number of clusters. */
+        uint64_t iClusterCount = 0;
+
+        /** Offset (from the start of the cache file) of instance transforms. */
+        uint64_t iInstanceOffset = 0;
+
+        /** Number of instance transforms. */
+        uint64_t iInstanceCount = 0;
+
+        /** Center of the AABB. */
+        glm::vec3 aabbCenter = glm::vec3(0.0F, 0.0F, 0.0F);
+
+        /** Half extension of the AABB. */
+        glm::vec3 aabbExtents = glm::vec3(0.0F, 0.0F, 0.0F);
+
+        /** Index of the mesh's material (negative if the mesh uses the default material). */
+        int32_t iMaterialIndex = -1;
+
+        /** Unused. */
+        uint32_t iPadding = 0;
+    };
+
+    /** Entry of the table of images. */
+    struct ImageEntry {
+        /** Offset (from the start of the cache file) of pixels. */
+        uint64_t iPixelsOffset = 0;
+
+        /** Size of pixels in bytes (0 if the image is not used or compressed). */
+        uint64_t iPixelsSize = 0;
+
+        /** Offset (from the start of the cache file) of the DDS file with compressed mipmaps. */
+        uint64_t iCompressedOffset = 0;
+
+        /** Size of the DDS file in bytes (0 if the image is not compressed). */
+        uint64_t iCompressedSize = 0;
+
+        /** Width of the image. */
+        int32_t iWidth = 0;
+
+        /** Height of the image. */
+        int32_t iHeight = 0;
+
+        /** Number of channels (1-4). */
+        int32_t iChannelCount = 0;
+
+        /** Size of one channel: 8 or 16. */
+        int32_t iBitsPerChannel = 0;
+
+        /** Format that the image was compressed to. */
+        TextureCompressor::Format compressedFormat = TextureCompressor::Format::BC7;
+
+        /** Unused. */
+        uint32_t iPadding = 0;
+    };
+
+    MeshCache() = default;
+
+    /**
+     * Converts image settings to bit flags stored in cache files.
+     *
+     * @param imageSettings Settings to convert.
+     *
+     * @return Flags.
+     */
+    static uint32_t getImageSettingsFlags(const ImageSettings& imageSettings);
+
+    /**
+     * Returns path to the cache file of a source file.
+     *
+     * @param iSourceHash Hash of the source file contents.
+     *
+     * @return Path to the cache file.
+     */
+    static std::filesystem::path getPathToCacheFile(uint64_t iSourceHash);
+
+    /**
+     * Calculates hash of the contents of the specified file.
+     *
+     * @param pathToFile Path to the file.
+     *
+     * @return Empty if failed to read the file, otherwise hash.
+     */
+    static std::optional<uint64_t> hashFile(const std::filesystem::path& pathToFile);
+
+    /** Mapped cache file. */
+    std::unique_ptr<MappedFile> pFile;
+
+    /** Header of the cache file. */
+    const FileHeader* pHeader = nullptr;
+
+    /** Mesh table. */
+    std::span<const MeshEntry> vMeshEntries;
+
+    /** Material table. */
+    std::span<const std::array<int32_t, 4>> vMaterialEntries;
+
+    /** Image table. */
+    std::span<const ImageEntry> vImageEntries;
+};
@@ -2,6 +2,23 @@
 
 // Standard.
 #include <format>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Custom.
+#include "import/TextureImporter.h"
+#include "import/TextureCompressor.h"
+#include "import/TextureCache.h"
+#include "import/MeshCache.h"
+#include "threading/ThreadPool.h"
+#include "io/MappedFile.h"
 
 // External.
 #define TINYGLTF_IMPLEMENTATION
@@ -55,374 +72,984 @@ calculateTangentsAndBitangents(std::vector<Vertex>& vVertices, const std::vector
     }
 }
 
-inline bool writeGltfTextureToDisk(const tinygltf::Image& image, const std::filesystem::path& pathToImage) {
-    // Prepare callbacks.
-    tinygltf::FsCallbacks fsCallbacks = {
-        &tinygltf::FileExists,
-        &tinygltf::ExpandFilePath,
-        &tinygltf::ReadWholeFile,
-        &tinygltf::WriteWholeFile,
-        &tinygltf::GetFileSizeInBytes,
-        nullptr};
-    tinygltf::URICallbacks uriCallbacks;
-    uriCallbacks.encode = nullptr;
-    uriCallbacks.decode = [](const std::string& sInUri, std::string* pOutUri, void* pUserData) -> bool {
-        *pOutUri = sInUri;
+/**
+ * Image loader for tinygltf that stores encoded images so that they can be decoded later on worker threads.
+ *
+ * @remark Images stored in buffer views are not copied (see @ref mapGltfBufferData).
+ *
+ * @param pImage           Image to load.
+ * @param iImageIndex      Index of the image in the model.
+ * @param pError           Error message.
+ * @param pWarning         Warning message.
+ * @param iRequestedWidth  Requested width of the image.
+ * @param iRequestedHeight Requested height of the image.
+ * @param pBytes           Encoded image.
+ * @param iSize            Size of the encoded image.
+ * @param pUserData        Pointer to `std::vector<std::vector<unsigned char>>` to store encoded images
+ * that are not stored in buffer views in (where index is image index).
+ *
+ * @return `true` if successful.
+ */
+inline bool storeEncodedGltfImage(
+    tinygltf::Image* pImage,
+    const int iImageIndex,
+    std::string* pError,
+    std::string* pWarning,
+    int iRequestedWidth,
+    int iRequestedHeight,
+    const unsigned char* pBytes,
+    int iSize,
+    void* pUserData) {
+    // Images from buffer views are referenced directly once the buffers are mapped.
+    if (pImage->bufferView >= 0) {
         return true;
-    };
+    }
+
+    auto& vEncodedImages = *static_cast<std::vector<std::vector<unsigned char>>*>(pUserData);
 
-    // Prepare paths.
-    const auto sFilename = pathToImage.stem().string() + pathToImage.extension().string();
-    const auto sBasePath = pathToImage.parent_path().string();
-    std::string sOutputUri;
+    if (static_cast<size_t>(iImageIndex) >= vEncodedImages.size()) {
+        vEncodedImages.resize(iImageIndex + 1);
+    }
+    vEncodedImages[iImageIndex].assign(pBytes, pBytes + iSize); // NOLINT: pointer arithmetic
 
-    // Write image to disk.
-    return tinygltf::WriteImageData(
-        &sBasePath, &sFilename, &image, false, &uriCallbacks, &sOutputUri, &fsCallbacks);
+    return true;
 }
 
-inline void processGltfMesh( // NOLINT: too complex
-    const tinygltf::Model& model,
-    const tinygltf::Mesh& mesh,
-    std::vector<std::unique_ptr<Mesh>>& vImportedMeshes,
-    const std::filesystem::path& pathToFile) {
-    // Prepare variables.
-    const std::string sImageExtension = ".png";
-    const std::string sDiffuseTextureName = "diffuse";
-    const std::string sNormalTextureName = "normal";
-    const std::string sMetallicRoughnessTextureName = "metallic_roughness";
-    const std::string sEmissionTextureName = "emission";
-
-    // Prepare paths.
-    const std::filesystem::path pathToTempFiles = pathToFile.parent_path() / "temp";
-    if (std::filesystem::exists(pathToTempFiles)) {
-        std::filesystem::remove_all(pathToTempFiles);
-    }
-    std::filesystem::create_directory(pathToTempFiles);
-
-    // Go through each mesh in this node.
-    for (size_t iPrimitive = 0; iPrimitive < mesh.primitives.size(); iPrimitive++) {
-        auto& primitive = mesh.primitives[iPrimitive];
-
-        // Prepare a new mesh data.
-        std::vector<Vertex> vVertices;
-        std::vector<unsigned int> vIndices;
-
-        {
-            // Add indices.
-            // Save accessor to mesh indices.
-            const auto& indexAccessor = model.accessors[primitive.indices];
-
-            // Get index buffer.
-            const auto& indexBufferView = model.bufferViews[indexAccessor.bufferView];
-            const auto& indexBuffer = model.buffers[indexBufferView.buffer];
-
-            // Make sure index is stored as scalar`.
-            if (indexAccessor.type != TINYGLTF_TYPE_SCALAR) [[unlikely]] {
-                throw std::runtime_error(std::format(
-                    "expected indices of mesh to be stored as `scalar`, actual type: {}",
-                    indexAccessor.type));
-            }
+/**
+ * Returns the binary chunk of a GLB file.
+ *
+ * @param fileData Contents of the GLB file (already validated by the parser).
+ *
+ * @return Empty if the file has no binary chunk.
+ */
+inline std::span<const unsigned char> getGlbBinaryChunk(std::span<const unsigned char> fileData) {
+    // The file starts with a header (magic, version, length) followed by a JSON chunk and an optional
+    // binary chunk, each chunk starts with its length and type.
+    constexpr size_t iHeaderSize = 12;
+    constexpr size_t iChunkHeaderSize = 8;
+    constexpr uint32_t iBinaryChunkType = 0x004E4942; // "BIN\0"
+    const auto readUint32 = [&fileData](size_t iOffset) {
+        uint32_t iValue = 0;
+        std::memcpy(&iValue, fileData.data() + iOffset, sizeof(iValue));
+        return iValue;
+    };
 
-            // Prepare variables to read indices.
-            auto pCurrentIndex =
-                indexBuffer.data.data() + indexBufferView.byteOffset + indexAccessor.byteOffset;
-            vIndices.resize(indexAccessor.count);
+    // Skip the JSON chunk.
+    if (fileData.size() < iHeaderSize + iChunkHeaderSize) {
+        return {};
+    }
+    const auto iBinaryChunkOffset = iHeaderSize + iChunkHeaderSize + readUint32(iHeaderSize);
+    if (iBinaryChunkOffset + iChunkHeaderSize > fileData.size()) {
+        return {};
+    }
 
-            // Allocate indices depending on their type.
-            if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-                using index_t = unsigned int;
+    const auto iBinaryChunkSize = readUint32(iBinaryChunkOffset);
+    if (readUint32(iBinaryChunkOffset + sizeof(uint32_t)) != iBinaryChunkType ||
+        iBinaryChunkSize > fileData.size() - iBinaryChunkOffset - iChunkHeaderSize) {
+        return {};
+    }
 
-                const auto iStride =
-                    indexBufferView.byteStride == 0 ? sizeof(index_t) : indexBufferView.byteStride;
+    return fileData.subspan(iBinaryChunkOffset + iChunkHeaderSize, iBinaryChunkSize);
+}
 
-                // Set indices.
-                for (size_t i = 0; i < vIndices.size(); i++) {
-                    // Set value.
-                    vIndices[i] = reinterpret_cast<const index_t*>(pCurrentIndex)[0];
+/**
+ * Returns data of each buffer of a parsed model. The buffer stored in the binary chunk of a GLB file
+ * is referenced in the memory-mapped file and the copy that the parser made is freed.
+ *
+ * @param model    Parsed GLTF model.
+ * @param fileData Contents of the imported file (must stay valid while returned data is used).
+ * @param bIsGlb   Whether the imported file is a GLB file or not.
+ *
+ * @return Data of each buffer (where index is buffer index).
+ */
+inline std::vector<std::span<const unsigned char>>
+mapGltfBufferData(tinygltf::Model& model, std::span<const unsigned char> fileData, bool bIsGlb) {
+    const auto binaryChunk = bIsGlb ? getGlbBinaryChunk(fileData) : std::span<const unsigned char>();
+
+    std::vector<std::span<const unsigned char>> vBufferData;
+    vBufferData.reserve(model.buffers.size());
+    for (auto& buffer : model.buffers) {
+        // Only a buffer without URI references the binary chunk.
+        if (!buffer.uri.empty() || buffer.data.size() > binaryChunk.size()) {
+            vBufferData.emplace_back(buffer.data);
+            continue;
+        }
 
-                    // Switch to the next item.
-                    pCurrentIndex += iStride;
-                }
-            } else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-                using index_t = unsigned short;
+        vBufferData.push_back(binaryChunk.first(buffer.data.size()));
+        buffer.data = std::vector<unsigned char>(); // free the copy
+    }
+
+    return vBufferData;
+}
 
-                const auto iStride =
-                    indexBufferView.byteStride == 0 ? sizeof(index_t) : indexBufferView.byteStride;
+/**
+ * Returns indices of images used by diffuse, normal, metallic-roughness and emission textures of a material.
+ *
+ * @param model    GLTF model.
+ * @param material GLTF material.
+ *
+ * @return Image indices (negative if not used).
+ */
+inline std::array<int, 4>
+getGltfMaterialImageIndices(const tinygltf::Model& model, const tinygltf::Material& material) {
+    const std::array<int, 4> vTextureIndices = {
+        material.pbrMetallicRoughness.baseColorTexture.index,
+        material.normalTexture.index,
+        material.pbrMetallicRoughness.metallicRoughnessTexture.index,
+        material.emissiveTexture.index};
+
+    std::array<int, 4> vImageIndices{};
+    for (size_t i = 0; i < vTextureIndices.size(); i++) {
+        vImageIndices[i] = vTextureIndices[i] < 0 ? -1 : model.textures[vTextureIndices[i]].source;
+    }
 
-                // Set indices.
-                for (size_t i = 0; i < vIndices.size(); i++) {
-                    // Set value.
-                    vIndices[i] = reinterpret_cast<const index_t*>(pCurrentIndex)[0];
+    return vImageIndices;
+}
 
-                    // Switch to the next item.
-                    pCurrentIndex += iStride;
-                }
-            } else {
-                throw std::runtime_error(std::format(
-                    "expected indices mesh component type to be `unsigned int` or `unsigned short`, "
-                    "actual type: {}",
-                    indexAccessor.componentType));
+/** Decoded image of an imported model. */
+struct ImportedImage {
+    /** Pixels or compressed data of the image. */
+    MeshCache::ImageView view;
+
+    /** Keeps data of @ref view alive (until it's uploaded). */
+    std::shared_ptr<const void> pOwner;
+};
+
+/**
+ * Returns a texture of the specified image of an imported model (loads the texture if it's not loaded yet).
+ *
+ * @param iImageIndex       Index of the image in the model (negative if not used).
+ * @param bIsDiffuseTexture Whether this texture is a diffuse texture or not.
+ * @param getImage          Returns decoded image by image index.
+ * @param pathToFile        Path to the imported file.
+ * @param pTextureCache     Cache of loaded textures.
+ * @param pTextureUploader  Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+ * @param pTextureStreamer  Streamer to load detailed mip levels of compressed textures once they are
+ * needed and to track used memory of textures, `nullptr` to load all levels right away.
+ *
+ * @return `nullptr` if the texture is not used, otherwise loaded texture.
+ */
+inline std::shared_ptr<Texture> loadImportedTexture(
+    int iImageIndex,
+    bool bIsDiffuseTexture,
+    const std::function<ImportedImage(size_t)>& getImage,
+    const std::filesystem::path& pathToFile,
+    TextureCache* pTextureCache,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer) {
+    if (iImageIndex < 0) {
+        return nullptr;
+    }
+
+    // The same image can be used by multiple textures and materials.
+    return pTextureCache->getTexture(
+        pathToFile, static_cast<size_t>(iImageIndex), bIsDiffuseTexture, [&]() -> std::shared_ptr<Texture> {
+            // Upload compressed mipmaps if the image was compressed during the import.
+            auto [image, pOwner] = getImage(static_cast<size_t>(iImageIndex));
+            if (!image.vCompressedData.empty()) {
+                return TextureImporter::loadCompressedTexture(
+                    image.vCompressedData,
+                    image.compressedFormat,
+                    bIsDiffuseTexture,
+                    std::move(pOwner),
+                    pTextureUploader,
+                    pTextureStreamer);
             }
-        }
 
-        {
-            // Find a position attribute to know how much vertices there will be.
-            const auto it = primitive.attributes.find("POSITION");
-            if (it == primitive.attributes.end()) [[unlikely]] {
-                throw std::runtime_error("a GLTF mesh node does not have any positions defined");
+            // Make sure the image was decoded.
+            if (image.vPixels.empty()) [[unlikely]] {
+                throw std::runtime_error(
+                    std::format("image with index {} has no decoded pixels", iImageIndex));
             }
-            const auto iPositionAccessorIndex = it->second;
 
-            // Get accessor.
-            const auto& positionAccessor = model.accessors[iPositionAccessorIndex];
+            // Upload decoded pixels.
+            return TextureImporter::loadTextureFromPixels(
+                image.vPixels.data(),
+                image.iWidth,
+                image.iHeight,
+                image.iChannelCount,
+                image.iBitsPerChannel,
+                bIsDiffuseTexture,
+                std::move(pOwner),
+                pTextureUploader,
+                pTextureStreamer);
+        });
+}
+
+/**
+ * Returns material of the specified material of an imported model (creates the material if it's not
+ * created yet).
+ *
+ * @param iMaterialIndex        Index of the material in the model (negative if not used).
+ * @param vMaterials            Materials created so far, the last element is used for primitives without
+ * a material.
+ * @param vMaterialImageIndices Indices of diffuse, normal, metallic-roughness and emission images of
+ * each material of the model.
+ * @param getImage              Returns decoded image by image index.
+ * @param pathToFile            Path to the imported file.
+ * @param pTextureCache         Cache of loaded textures.
+ * @param pTextureUploader      Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+ * @param pTextureStreamer      Streamer to load detailed mip levels of compressed textures once they are
+ * needed and to track used memory of textures, `nullptr` to load all levels right away.
+ *
+ * @return Material.
+ */
+inline std::shared_ptr<Material> getImportedMaterial(
+    int iMaterialIndex,
+    std::vector<std::shared_ptr<Material>>& vMaterials,
+    const std::vector<std::array<int, 4>>& vMaterialImageIndices,
+    const std::function<ImportedImage(size_t)>& getImage,
+    const std::filesystem::path& pathToFile,
+    TextureCache* pTextureCache,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer) {
+    // See if this material was already created.
+    auto& pMaterial = iMaterialIndex >= 0 ? vMaterials[iMaterialIndex] : vMaterials.back();
+    if (pMaterial != nullptr) {
+        return pMaterial;
+    }
+
+    pMaterial = std::make_shared<Material>();
+    if (iMaterialIndex < 0) {
+        // Use default properties.
+        return pMaterial;
+    }
+
+    // Load textures.
+    const auto& vImageIndices = vMaterialImageIndices[iMaterialIndex];
+    const auto loadTexture = [&](size_t iTexture, bool bIsDiffuseTexture) {
+        return loadImportedTexture(
+            vImageIndices[iTexture],
+            bIsDiffuseTexture,
+            getImage,
+            pathToFile,
+            pTextureCache,
+            pTextureUploader,
+            pTextureStreamer);
+    };
+    pMaterial->pDiffuseTexture = loadTexture(0, true);
+    pMaterial->pNormalTexture = loadTexture(1, false);
+    pMaterial->pMetallicRoughnessTexture = loadTexture(2, false);
+    pMaterial->pEmissionTexture = loadTexture(3, false); // NOLINT
+
+    return pMaterial;
+}
 
-            // Allocate vertices.
-            vVertices.resize(positionAccessor.count);
+/** Vertices and indices of a GLTF primitive (decoded on a worker thread, not uploaded to the GPU). */
+struct GltfPrimitiveData {
+    /** Vertices of the primitive. */
+    std::vector<Vertex> vVertices;
+
+    /** Indices of all levels of detail of the primitive. */
+    std::vector<unsigned int> vIndices;
+
+    /** Levels of detail (ranges of @ref vIndices). */
+    std::vector<MeshLod> vLods;
+
+    /** Clusters of the most detailed level of detail (ranges of @ref vIndices). */
+    std::vector<MeshCluster> vClusters;
+
+    /** AABB of the primitive in model space. */
+    AABB aabb;
+};
+
+/**
+ * Reads vertices and indices of the specified primitive and calculates tangents.
+ *
+ * @remark Does not use OpenGL so can be called from any thread.
+ *
+ * @param model       GLTF model.
+ * @param vBufferData Data of each GLTF buffer (see @ref mapGltfBufferData).
+ * @param primitive   Primitive to decode.
+ *
+ * @return Decoded data.
+ */
+inline GltfPrimitiveData // NOLINT: too complex
+decodeGltfPrimitive(
+    const tinygltf::Model& model,
+    std::span<const std::span<const unsigned char>> vBufferData,
+    const tinygltf::Primitive& primitive) {
+    // Prepare a new mesh data.
+    GltfPrimitiveData data;
+    auto& vVertices = data.vVertices;
+    auto& vIndices = data.vIndices;
+
+    {
+        // Add indices.
+        // Save accessor to mesh indices.
+        const auto& indexAccessor = model.accessors[primitive.indices];
+
+        // Get index buffer.
+        const auto& indexBufferView = model.bufferViews[indexAccessor.bufferView];
+        const auto indexBuffer = vBufferData[indexBufferView.buffer];
+
+        // Make sure index is stored as scalar`.
+        if (indexAccessor.type != TINYGLTF_TYPE_SCALAR) [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "expected indices of mesh to be stored as `scalar`, actual type: {}",
+                indexAccessor.type));
         }
 
-        // Process attributes.
-        for (auto& [sAttributeName, iAccessorIndex] : primitive.attributes) {
-            // Get attribute accessor.
-            const auto& attributeAccessor = model.accessors[iAccessorIndex];
+        // Prepare variables to read indices.
+        auto pCurrentIndex =
+            indexBuffer.data() + indexBufferView.byteOffset + indexAccessor.byteOffset;
+        vIndices.resize(indexAccessor.count);
 
-            // Get buffer.
-            const auto& attributeBufferView = model.bufferViews[attributeAccessor.bufferView];
-            const auto& attributeBuffer = model.buffers[attributeBufferView.buffer];
+        // Allocate indices depending on their type.
+        if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
+            using index_t = unsigned int;
 
-            if (sAttributeName == "POSITION") {
-                using position_t = glm::vec3;
+            const auto iStride =
+                indexBufferView.byteStride == 0 ? sizeof(index_t) : indexBufferView.byteStride;
 
-                // Make sure position is stored as `vec3`.
-                if (attributeAccessor.type != TINYGLTF_TYPE_VEC3) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected POSITION mesh attribute to be stored as `vec3`, actual type: {}",
-                        attributeAccessor.type));
-                }
-                // Make sure that component type is `float`.
-                if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected POSITION mesh attribute component type to be `float`, actual type: {}",
-                        attributeAccessor.componentType));
-                }
+            // Set indices.
+            for (size_t i = 0; i < vIndices.size(); i++) {
+                // Set value.
+                vIndices[i] = reinterpret_cast<const index_t*>(pCurrentIndex)[0];
 
-                // Prepare variables.
-                auto pCurrentPosition = attributeBuffer.data.data() + attributeBufferView.byteOffset +
-                                        attributeAccessor.byteOffset;
-                const auto iStride =
-                    attributeBufferView.byteStride == 0 ? sizeof(position_t) : attributeBufferView.byteStride;
+                // Switch to the next item.
+                pCurrentIndex += iStride;
+            }
+        } else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
+            using index_t = unsigned short;
 
-                // Set positions to mesh data.
-                for (size_t i = 0; i < vVertices.size(); i++) {
-                    // Set value.
-                    vVertices[i].position = reinterpret_cast<const position_t*>(pCurrentPosition)[0];
+            const auto iStride =
+                indexBufferView.byteStride == 0 ? sizeof(index_t) : indexBufferView.byteStride;
 
-                    // Switch to the next item.
-                    pCurrentPosition += iStride;
-                }
+            // Set indices.
+            for (size_t i = 0; i < vIndices.size(); i++) {
+                // Set value.
+                vIndices[i] = reinterpret_cast<const index_t*>(pCurrentIndex)[0];
 
-                // Process next attribute.
-                continue;
+                // Switch to the next item.
+                pCurrentIndex += iStride;
             }
+        } else {
+            throw std::runtime_error(std::format(
+                "expected indices mesh component type to be `unsigned int` or `unsigned short`, "
+                "actual type: {}",
+                indexAccessor.componentType));
+        }
+    }
 
-            if (sAttributeName == "NORMAL") {
-                using normal_t = glm::vec3;
+    {
+        // Find a position attribute to know how much vertices there will be.
+        const auto it = primitive.attributes.find("POSITION");
+        if (it == primitive.attributes.end()) [[unlikely]] {
+            throw std::runtime_error("a GLTF mesh node does not have any positions defined");
+        }
+        const auto iPositionAccessorIndex = it->second;
 
-                // Make sure normal is stored as `vec3`.
-                if (attributeAccessor.type != TINYGLTF_TYPE_VEC3) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected NORMAL mesh attribute to be stored as `vec3`, actual type: {}",
-                        attributeAccessor.type));
-                }
-                // Make sure that component type is `float`.
-                if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected NORMAL mesh attribute component type to be `float`, actual type: {}",
-                        attributeAccessor.componentType));
-                }
+        // Get accessor.
+        const auto& positionAccessor = model.accessors[iPositionAccessorIndex];
+
+        // Allocate vertices.
+        vVertices.resize(positionAccessor.count);
+    }
 
-                // Prepare variables.
-                auto pCurrentNormal = attributeBuffer.data.data() + attributeBufferView.byteOffset +
-                                      attributeAccessor.byteOffset;
-                const auto iStride =
-                    attributeBufferView.byteStride == 0 ? sizeof(normal_t) : attributeBufferView.byteStride;
+    // Process attributes.
+    for (auto& [sAttributeName, iAccessorIndex] : primitive.attributes) {
+        // Get attribute accessor.
+        const auto& attributeAccessor = model.accessors[iAccessorIndex];
 
-                // Set normals to mesh data.
-                for (size_t i = 0; i < vVertices.size(); i++) {
-                    // Set value.
-                    vVertices[i].normal = reinterpret_cast<const normal_t*>(pCurrentNormal)[0];
+        // Get buffer.
+        const auto& attributeBufferView = model.bufferViews[attributeAccessor.bufferView];
+        const auto attributeBuffer = vBufferData[attributeBufferView.buffer];
 
-                    // Switch to the next item.
-                    pCurrentNormal += iStride;
-                }
+        if (sAttributeName == "POSITION") {
+            using position_t = glm::vec3;
+
+            // Make sure position is stored as `vec3`.
+            if (attributeAccessor.type != TINYGLTF_TYPE_VEC3) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected POSITION mesh attribute to be stored as `vec3`, actual type: {}",
+                    attributeAccessor.type));
+            }
+            // Make sure that component type is `float`.
+            if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected POSITION mesh attribute component type to be `float`, actual type: {}",
+                    attributeAccessor.componentType));
+            }
+
+            // Prepare variables.
+            auto pCurrentPosition = attributeBuffer.data() + attributeBufferView.byteOffset +
+                                    attributeAccessor.byteOffset;
+            const auto iStride =
+                attributeBufferView.byteStride == 0 ? sizeof(position_t) : attributeBufferView.byteStride;
 
-                // Process next attribute.
-                continue;
+            // Set positions to mesh data.
+            for (size_t i = 0; i < vVertices.size(); i++) {
+                // Set value.
+                vVertices[i].position = reinterpret_cast<const position_t*>(pCurrentPosition)[0];
+
+                // Switch to the next item.
+                pCurrentPosition += iStride;
             }
 
-            if (sAttributeName == "TEXCOORD_0") {
-                using uv_t = glm::vec2;
+            // Process next attribute.
+            continue;
+        }
+
+        if (sAttributeName == "NORMAL") {
+            using normal_t = glm::vec3;
 
-                // Make sure UV is stored as `vec2`.
-                if (attributeAccessor.type != TINYGLTF_TYPE_VEC2) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected TEXCOORD mesh attribute to be stored as `vec2`, actual type: {}",
-                        attributeAccessor.type));
-                }
-                // Make sure that component type is `float`.
-                if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
-                    throw std::runtime_error(std::format(
-                        "expected TEXCOORD mesh attribute component type to be `float`, actual type: {}",
-                        attributeAccessor.componentType));
-                }
+            // Make sure normal is stored as `vec3`.
+            if (attributeAccessor.type != TINYGLTF_TYPE_VEC3) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected NORMAL mesh attribute to be stored as `vec3`, actual type: {}",
+                    attributeAccessor.type));
+            }
+            // Make sure that component type is `float`.
+            if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected NORMAL mesh attribute component type to be `float`, actual type: {}",
+                    attributeAccessor.componentType));
+            }
 
-                // Prepare variables.
-                auto pCurrentUv = attributeBuffer.data.data() + attributeBufferView.byteOffset +
+            // Prepare variables.
+            auto pCurrentNormal = attributeBuffer.data() + attributeBufferView.byteOffset +
                                   attributeAccessor.byteOffset;
-                const auto iStride =
-                    attributeBufferView.byteStride == 0 ? sizeof(uv_t) : attributeBufferView.byteStride;
+            const auto iStride =
+                attributeBufferView.byteStride == 0 ? sizeof(normal_t) : attributeBufferView.byteStride;
 
-                // Set UVs to mesh data.
-                for (size_t i = 0; i < vVertices.size(); i++) {
-                    // Set value.
-                    vVertices[i].uv = reinterpret_cast<const uv_t*>(pCurrentUv)[0];
+            // Set normals to mesh data.
+            for (size_t i = 0; i < vVertices.size(); i++) {
+                // Set value.
+                vVertices[i].normal = reinterpret_cast<const normal_t*>(pCurrentNormal)[0];
 
-                    // Switch to the next item.
-                    pCurrentUv += iStride;
-                }
+                // Switch to the next item.
+                pCurrentNormal += iStride;
+            }
+
+            // Process next attribute.
+            continue;
+        }
+
+        if (sAttributeName == "TEXCOORD_0") {
+            using uv_t = glm::vec2;
+
+            // Make sure UV is stored as `vec2`.
+            if (attributeAccessor.type != TINYGLTF_TYPE_VEC2) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected TEXCOORD mesh attribute to be stored as `vec2`, actual type: {}",
+                    attributeAccessor.type));
+            }
+            // Make sure that component type is `float`.
+            if (attributeAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) [[unlikely]] {
+                throw std::runtime_error(std::format(
+                    "expected TEXCOORD mesh attribute component type to be `float`, actual type: {}",
+                    attributeAccessor.componentType));
+            }
+
+            // Prepare variables.
+            auto pCurrentUv = attributeBuffer.data() + attributeBufferView.byteOffset +
+                              attributeAccessor.byteOffset;
+            const auto iStride =
+                attributeBufferView.byteStride == 0 ? sizeof(uv_t) : attributeBufferView.byteStride;
 
-                // Process next attribute.
-                continue;
+            // Set UVs to mesh data.
+            for (size_t i = 0; i < vVertices.size(); i++) {
+                // Set value.
+                vVertices[i].uv = reinterpret_cast<const uv_t*>(pCurrentUv)[0];
+
+                // Switch to the next item.
+                pCurrentUv += iStride;
             }
+
+            // Process next attribute.
+            continue;
         }
+    }
 
-        calculateTangentsAndBitangents(vVertices, vIndices);
+    calculateTangentsAndBitangents(vVertices, vIndices);
 
-        // Create a new mesh node with the specified data.
-        auto pNewMesh = Mesh::create(std::move(vVertices), std::move(vIndices));
+    data.aabb = AABB::createFromVertices(&vVertices);
 
-        if (primitive.material >= 0) {
-            // Process material.
-            auto& material = model.materials[primitive.material];
+    return data;
+}
 
-            // Process diffuse texture.
-            const auto iDiffuseTextureIndex = material.pbrMetallicRoughness.baseColorTexture.index;
-            if (iDiffuseTextureIndex >= 0) {
-                auto& diffuseTexture = model.textures[iDiffuseTextureIndex];
-                if (diffuseTexture.source >= 0) {
-                    // Get image.
-                    auto& diffuseImage = model.images[diffuseTexture.source];
+/**
+ * Returns the local transform of the specified node (relative to its parent).
+ *
+ * @param node GLTF node.
+ *
+ * @return Node matrix.
+ */
+inline glm::mat4x4 getGltfNodeMatrix(const tinygltf::Node& node) {
+    // The node either specifies a matrix (column-major) or translation, rotation and scale.
+    if (node.matrix.size() == 16) { // NOLINT: mat4
+        std::array<float, 16> vMatrix{}; // NOLINT: mat4
+        std::ranges::transform(
+            node.matrix, vMatrix.begin(), [](double value) { return static_cast<float>(value); });
+        return glm::make_mat4(vMatrix.data());
+    }
 
-                    // Prepare path to export the image to.
-                    const auto pathToDiffuseImage = pathToTempFiles / (sDiffuseTextureName + sImageExtension);
+    auto matrix = glm::identity<glm::mat4x4>();
+    if (node.translation.size() == 3) {
+        matrix = glm::translate(
+            matrix,
+            glm::vec3(
+                static_cast<float>(node.translation[0]),
+                static_cast<float>(node.translation[1]),
+                static_cast<float>(node.translation[2])));
+    }
+    if (node.rotation.size() == 4) {
+        // GLTF stores quaternions as XYZW.
+        matrix = matrix * glm::mat4_cast(glm::quat(
+                              static_cast<float>(node.rotation[3]),
+                              static_cast<float>(node.rotation[0]),
+                              static_cast<float>(node.rotation[1]),
+                              static_cast<float>(node.rotation[2])));
+    }
+    if (node.scale.size() == 3) {
+        matrix = glm::scale(
+            matrix,
+            glm::vec3(
+                static_cast<float>(node.scale[0]),
+                static_cast<float>(node.scale[1]),
+                static_cast<float>(node.scale[2])));
+    }
 
-                    // Write image to disk.
-                    if (!writeGltfTextureToDisk(diffuseImage, pathToDiffuseImage)) {
-                        throw std::runtime_error(std::format(
-                            "failed to write GLTF image to path \"{}\"", pathToDiffuseImage.string()));
-                    }
+    return matrix;
+}
 
-                    // Load texture.
-                    pNewMesh->setDiffuseTexture(pathToDiffuseImage);
-                }
-            }
+/**
+ * Returns size of one component of the specified type (float or integer types that can be normalized).
+ *
+ * @param iComponentType GLTF component type.
+ *
+ * @return 0 if the type is not supported.
+ */
+inline size_t getGltfNormalizableComponentSize(int iComponentType) {
+    switch (iComponentType) {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        return sizeof(float);
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        return sizeof(uint8_t);
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        return sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
 
-            // Process normal texture.
-            const auto iNormalTextureIndex = material.normalTexture.index;
-            if (iNormalTextureIndex >= 0) {
-                auto& normalTexture = model.textures[iNormalTextureIndex];
-                if (normalTexture.source >= 0) {
-                    // Get image.
-                    auto& normalImage = model.images[normalTexture.source];
-
-                    // Prepare path to export the image to.
-                    const auto pathToNormalImage = pathToTempFiles / (sNormalTextureName + sImageExtension);
-
-                    // Write image to disk.
-                    if (!writeGltfTextureToDisk(normalImage, pathToNormalImage)) {
-                        throw std::runtime_error(std::format(
-                            "failed to write GLTF image to path \"{}\"", pathToNormalImage.string()));
-                    }
+/**
+ * Reads a float or normalized integer component (mapped to [0; 1] or [-1; 1]).
+ *
+ * @param pData          Component data.
+ * @param iComponentType GLTF component type (see @ref getGltfNormalizableComponentSize).
+ *
+ * @return Component value.
+ */
+inline float readGltfNormalizedComponent(const unsigned char* pData, int iComponentType) {
+    switch (iComponentType) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE: {
+        return std::max(static_cast<float>(static_cast<int8_t>(*pData)) / 127.0F, -1.0F); // NOLINT
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+        return static_cast<float>(*pData) / 255.0F; // NOLINT
+    }
+    case TINYGLTF_COMPONENT_TYPE_SHORT: {
+        int16_t iValue = 0;
+        std::memcpy(&iValue, pData, sizeof(iValue));
+        return std::max(static_cast<float>(iValue) / 32767.0F, -1.0F); // NOLINT
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+        uint16_t iValue = 0;
+        std::memcpy(&iValue, pData, sizeof(iValue));
+        return static_cast<float>(iValue) / 65535.0F; // NOLINT
+    }
+    default: {
+        float value = 0.0F;
+        std::memcpy(&value, pData, sizeof(value));
+        return value;
+    }
+    }
+}
 
-                    // Load texture.
-                    pNewMesh->setNormalTexture(pathToNormalImage);
-                }
-            }
+/**
+ * Reads values of a VEC3/VEC4 accessor with float or normalized integer components.
+ *
+ * @param model           GLTF model.
+ * @param vBufferData     Data of each GLTF buffer (see @ref mapGltfBufferData).
+ * @param iAccessorIndex  Index of the accessor.
+ * @param iComponentCount Expected number of components (3 or 4).
+ *
+ * @return Values (`count * iComponentCount` elements).
+ */
+inline std::vector<float> readGltfAccessorFloats(
+    const tinygltf::Model& model,
+    std::span<const std::span<const unsigned char>> vBufferData,
+    int iAccessorIndex,
+    size_t iComponentCount) {
+    if (iAccessorIndex < 0 || static_cast<size_t>(iAccessorIndex) >= model.accessors.size()) [[unlikely]] {
+        throw std::runtime_error(std::format("found an invalid accessor index of {}", iAccessorIndex));
+    }
+    const auto& accessor = model.accessors[iAccessorIndex];
 
-            // Process metallic/roughness texture.
-            const auto iMetallicRoughnessTextureIndex =
-                material.pbrMetallicRoughness.metallicRoughnessTexture.index;
-            if (iMetallicRoughnessTextureIndex >= 0) {
-                auto& metallicRoughnessTexture = model.textures[iMetallicRoughnessTextureIndex];
-                if (metallicRoughnessTexture.source >= 0) {
-                    // Get image.
-                    auto& metallicRoughnessImage = model.images[metallicRoughnessTexture.source];
-
-                    // Prepare path to export the image to.
-                    const auto pathToMetallicRoughnessImage =
-                        pathToTempFiles / (sMetallicRoughnessTextureName + sImageExtension);
-
-                    // Write image to disk.
-                    if (!writeGltfTextureToDisk(metallicRoughnessImage, pathToMetallicRoughnessImage)) {
-                        throw std::runtime_error(std::format(
-                            "failed to write GLTF image to path \"{}\"",
-                            pathToMetallicRoughnessImage.string()));
-                    }
+    // Make sure the accessor has the expected format.
+    const auto iExpectedType = iComponentCount == 3 ? TINYGLTF_TYPE_VEC3 : TINYGLTF_TYPE_VEC4;
+    if (accessor.type != iExpectedType) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "expected accessor {} to have {} components, actual type: {}",
+            iAccessorIndex,
+            iComponentCount,
+            accessor.type));
+    }
+    const auto iComponentSize = getGltfNormalizableComponentSize(accessor.componentType);
+    if (iComponentSize == 0 ||
+        (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT && !accessor.normalized)) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "expected accessor {} to have float or normalized integer components, actual type: {}",
+            iAccessorIndex,
+            accessor.componentType));
+    }
+    if (accessor.bufferView < 0 || static_cast<size_t>(accessor.bufferView) >= model.bufferViews.size())
+        [[unlikely]] {
+        throw std::runtime_error(std::format("expected accessor {} to have a buffer view", iAccessorIndex));
+    }
 
-                    // Load texture.
-                    pNewMesh->setMetallicRoughnessTexture(pathToMetallicRoughnessImage);
-                }
-            }
+    // Make sure the data is in bounds of the buffer.
+    const auto& bufferView = model.bufferViews[accessor.bufferView];
+    const auto buffer = vBufferData[bufferView.buffer];
+    const auto iElementSize = iComponentSize * iComponentCount;
+    const auto iStride = bufferView.byteStride == 0 ? iElementSize : bufferView.byteStride;
+    const auto iStartOffset = bufferView.byteOffset + accessor.byteOffset;
+    const auto iEndOffset = iStartOffset + (accessor.count - 1) * iStride + iElementSize;
+    if (accessor.count > 0 && iEndOffset > buffer.size()) [[unlikely]] {
+        throw std::runtime_error(std::format("data of accessor {} is out of buffer bounds", iAccessorIndex));
+    }
 
-            // Process emission texture.
-            const auto iEmissionTextureIndex = material.emissiveTexture.index;
-            if (iEmissionTextureIndex >= 0) {
-                auto& emissionTexture = model.textures[iEmissionTextureIndex];
-                if (emissionTexture.source >= 0) {
-                    // Get image.
-                    auto& emissionImage = model.images[emissionTexture.source];
-
-                    // Prepare path to export the image to.
-                    const auto pathEmissionImage = pathToTempFiles / (sEmissionTextureName + sImageExtension);
-
-                    // Write image to disk.
-                    if (!writeGltfTextureToDisk(emissionImage, pathEmissionImage)) {
-                        throw std::runtime_error(std::format(
-                            "failed to write GLTF image to path \"{}\"", pathEmissionImage.string()));
-                    }
+    // Read values.
+    std::vector<float> vValues(accessor.count * iComponentCount);
+    const auto pData = buffer.data() + iStartOffset;
+    for (size_t i = 0; i < accessor.count; i++) {
+        for (size_t iComponent = 0; iComponent < iComponentCount; iComponent++) {
+            vValues[i * iComponentCount + iComponent] = readGltfNormalizedComponent(
+                pData + i * iStride + iComponent * iComponentSize, accessor.componentType);
+        }
+    }
 
-                    // Load texture.
-                    pNewMesh->setEmissionTexture(pathEmissionImage);
-                }
-            }
+    return vValues;
+}
+
+/**
+ * Returns per-instance transforms of the specified node (relative to the node) if it uses the
+ * `EXT_mesh_gpu_instancing` extension.
+ *
+ * @param model       GLTF model.
+ * @param vBufferData Data of each GLTF buffer (see @ref mapGltfBufferData).
+ * @param node        GLTF node.
+ *
+ * @return Empty if the node does not use the extension.
+ */
+inline std::vector<glm::mat4x4> getGltfGpuInstanceMatrices(
+    const tinygltf::Model& model,
+    std::span<const std::span<const unsigned char>> vBufferData,
+    const tinygltf::Node& node) {
+    const auto extensionIt = node.extensions.find("EXT_mesh_gpu_instancing");
+    if (extensionIt == node.extensions.end() || !extensionIt->second.Has("attributes")) {
+        return {};
+    }
+    const auto& attributes = extensionIt->second.Get("attributes");
+
+    // Read attributes (all of them are optional but have the same count).
+    std::optional<size_t> iInstanceCount;
+    const auto readAttribute = [&](const char* pName, size_t iComponentCount) -> std::vector<float> {
+        if (!attributes.Has(pName)) {
+            return {};
         }
+        auto vValues = readGltfAccessorFloats(
+            model, vBufferData, attributes.Get(pName).GetNumberAsInt(), iComponentCount);
 
-        // Add this new mesh node to results.
-        vImportedMeshes.push_back(std::move(pNewMesh));
+        const auto iCount = vValues.size() / iComponentCount;
+        if (iInstanceCount.has_value() && *iInstanceCount != iCount) [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "expected instancing attributes to have the same count ({} has {} while expected {})",
+                pName,
+                iCount,
+                *iInstanceCount));
+        }
+        iInstanceCount = iCount;
+
+        return vValues;
+    };
+    const auto vTranslations = readAttribute("TRANSLATION", 3);
+    const auto vRotations = readAttribute("ROTATION", 4);
+    const auto vScales = readAttribute("SCALE", 3);
+    if (!iInstanceCount.has_value()) {
+        return {};
+    }
+
+    std::vector<glm::mat4x4> vMatrices(*iInstanceCount, glm::identity<glm::mat4x4>());
+    for (size_t i = 0; i < vMatrices.size(); i++) {
+        auto& matrix = vMatrices[i];
+        if (!vTranslations.empty()) {
+            matrix = glm::translate(
+                matrix, glm::vec3(vTranslations[i * 3], vTranslations[i * 3 + 1], vTranslations[i * 3 + 2]));
+        }
+        if (!vRotations.empty()) {
+            // GLTF stores quaternions as XYZW.
+            matrix = matrix * glm::mat4_cast(glm::quat(
+                                  vRotations[i * 4 + 3],
+                                  vRotations[i * 4],
+                                  vRotations[i * 4 + 1],
+                                  vRotations[i * 4 + 2]));
+        }
+        if (!vScales.empty()) {
+            matrix = glm::scale(matrix, glm::vec3(vScales[i * 3], vScales[i * 3 + 1], vScales[i * 3 + 2]));
+        }
     }
 
-    // Cleanup.
-    std::filesystem::remove_all(pathToTempFiles);
+    return vMatrices;
 }
 
-inline void processGltfNode(
-    const tinygltf::Node& node,
+/**
+ * Collects transforms (in model space) of all instances of meshes referenced by the specified node and
+ * its child nodes.
+ *
+ * @param model                  GLTF model.
+ * @param vBufferData            Data of each GLTF buffer (see @ref mapGltfBufferData).
+ * @param iNode                  Index of the node to process.
+ * @param parentMatrix           Transform of the parent node in model space.
+ * @param vMeshInstanceMatrices  Instance transforms of each GLTF mesh (where index is mesh index).
+ * @param iDepth                 Depth of the node in the hierarchy.
+ */
+inline void collectGltfMeshInstances(
     const tinygltf::Model& model,
-    std::vector<std::unique_ptr<Mesh>>& vImportedMeshes,
-    const std::filesystem::path& pathToFile) {
+    std::span<const std::span<const unsigned char>> vBufferData,
+    int iNode,
+    const glm::mat4x4& parentMatrix,
+    std::vector<std::vector<glm::mat4x4>>& vMeshInstanceMatrices,
+    size_t iDepth = 0) {
+    // Make sure this node index is valid.
+    if (iNode < 0 || static_cast<size_t>(iNode) >= model.nodes.size()) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "found an invalid node index of {} while model nodes only has {} entries",
+            iNode,
+            model.nodes.size()));
+    }
+    if (iDepth > model.nodes.size()) [[unlikely]] {
+        throw std::runtime_error("found a cycle in the node hierarchy");
+    }
+    const auto& node = model.nodes[iNode];
+
+    const auto nodeMatrix = parentMatrix * getGltfNodeMatrix(node);
+
     // See if this node stores a mesh.
     if ((node.mesh >= 0) && (static_cast<size_t>(node.mesh) < model.meshes.size())) {
-        // Process mesh.
-        processGltfMesh(model, model.meshes[node.mesh], vImportedMeshes, pathToFile);
+        auto& vInstanceMatrices = vMeshInstanceMatrices[node.mesh];
+
+        const auto vGpuInstanceMatrices = getGltfGpuInstanceMatrices(model, vBufferData, node);
+        if (vGpuInstanceMatrices.empty()) {
+            vInstanceMatrices.push_back(nodeMatrix);
+        } else {
+            for (const auto& instanceMatrix : vGpuInstanceMatrices) {
+                vInstanceMatrices.push_back(nodeMatrix * instanceMatrix);
+            }
+        }
     }
 
     // Process child nodes.
-    for (const auto& iNode : node.children) {
-        processGltfNode(model.nodes[iNode], model, vImportedMeshes, pathToFile);
+    for (const auto& iChildNode : node.children) {
+        collectGltfMeshInstances(
+            model, vBufferData, iChildNode, nodeMatrix, vMeshInstanceMatrices, iDepth + 1);
+    }
+}
+
+/**
+ * Returns the largest size (along any axis) of all instances of the specified primitive using bounds
+ * of its positions (GLTF requires position accessors to specify them) so that the primitive does not
+ * need to be decoded.
+ *
+ * @param model             GLTF model.
+ * @param primitive         Primitive to process.
+ * @param vInstanceMatrices Transforms of instances of the primitive in model space.
+ *
+ * @return Size of the primitive (0 if bounds are not specified).
+ */
+inline float getGltfPrimitiveSize(
+    const tinygltf::Model& model,
+    const tinygltf::Primitive& primitive,
+    std::span<const glm::mat4x4> vInstanceMatrices) {
+    const auto it = primitive.attributes.find("POSITION");
+    if (it == primitive.attributes.end()) {
+        return 0.0F;
+    }
+
+    const auto& accessor = model.accessors[it->second];
+    if (accessor.minValues.size() != 3 || accessor.maxValues.size() != 3) { // NOLINT: vec3
+        return 0.0F;
+    }
+    const auto min = glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
+    const auto max = glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
+
+    if (vInstanceMatrices.empty()) {
+        return 0.0F;
+    }
+
+    // Find bounds of the transformed corners of the primitive's bounds.
+    auto totalMin = glm::vec3(std::numeric_limits<float>::max());
+    auto totalMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& matrix : vInstanceMatrices) {
+        for (size_t iCorner = 0; iCorner < 8; iCorner++) { // NOLINT: box corners
+            const auto corner = glm::vec3(
+                (iCorner & 1) != 0 ? max.x : min.x,
+                (iCorner & 2) != 0 ? max.y : min.y,
+                (iCorner & 4) != 0 ? max.z : min.z); // NOLINT
+            const auto transformedCorner = glm::vec3(matrix * glm::vec4(corner, 1.0F));
+            totalMin = glm::min(totalMin, transformedCorner);
+            totalMax = glm::max(totalMax, transformedCorner);
+        }
     }
+
+    const auto size = totalMax - totalMin;
+    return std::max({size.x, size.y, size.z});
 }
 
-std::vector<std::unique_ptr<Mesh>> MeshImporter::importMesh(const std::filesystem::path& pathToFile) {
+/**
+ * Returns time since the specified time point.
+ *
+ * @param startTime Time point to measure from.
+ *
+ * @return Time in milliseconds.
+ */
+inline float getTimeSinceInMs(std::chrono::steady_clock::time_point startTime) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+struct AsyncMeshImport::State {
+    /** Path to the imported file. */
+    std::filesystem::path pathToFile;
+
+    /** Set to stop decoding data that was not decoded yet. */
+    std::atomic<bool> bIsCancelled = false;
+
+    /** Settings that images are imported with (taken when the import is started). */
+    MeshCache::ImageSettings imageSettings;
+
+    /** Imported file mapped into memory (only written by the parse task before @ref bIsParsed is set). */
+    std::unique_ptr<MappedFile> pSourceFile;
+
+    /**
+     * Not `nullptr` if meshes are loaded from the mesh cache instead of the source file (only written by
+     * the parse task before @ref bIsParsed is set).
+     */
+    std::unique_ptr<MeshCache> pCache;
+
+    /** Parsed file (only written by the parse task before @ref bIsParsed is set). */
+    tinygltf::Model model;
+
+    /**
+     * Data of each buffer of @ref model, points into @ref pSourceFile for GLB files (only written by the
+     * parse task before @ref bIsParsed is set).
+     */
+    std::vector<std::span<const unsigned char>> vBufferData;
+
+    /** Primitives to decode (only written by the parse task before @ref bIsParsed is set). */
+    std::vector<const tinygltf::Primitive*> vPrimitives;
+
+    /**
+     * Transforms (in model space) of instances of each primitive, a primitive of a mesh that is referenced
+     * by multiple nodes is only decoded once (only written by the parse task before @ref bIsParsed is set).
+     */
+    std::vector<std::vector<glm::mat4x4>> vPrimitiveInstanceMatrices;
+
+    /**
+     * Material index of each mesh, negative for the default material (only written by the parse task
+     * before @ref bIsParsed is set).
+     */
+    std::vector<int> vMeshMaterialIndices;
+
+    /**
+     * Indices of diffuse, normal, metallic-roughness and emission images of each material (only written
+     * by the parse task before @ref bIsParsed is set).
+     */
+    std::vector<std::array<int, 4>> vMaterialImageIndices;
+
+    /**
+     * Files (other than the source file) that the model was imported from (only written by the parse
+     * task before @ref bIsParsed is set).
+     */
+    std::vector<std::filesystem::path> vDependencies;
+
+    /**
+     * Whether each image is used as a diffuse, normal, metallic-roughness and emission texture or not
+     * (only written by the parse task before @ref bIsParsed is set).
+     */
+    std::vector<std::array<bool, 4>> vImageUsage;
+
+    /**
+     * Encoded images (where index is image index) that point into @ref vBufferData or
+     * @ref vEncodedImageFiles, each element is only accessed by the task that decodes it.
+     */
+    std::vector<std::span<const unsigned char>> vEncodedImages;
+
+    /**
+     * Encoded images that are not stored in buffers (external files and data URIs), each element is only
+     * accessed by the task that decodes the image.
+     */
+    std::vector<std::vector<unsigned char>> vEncodedImageFiles;
+
+    /** Guards fields below. */
+    mutable std::mutex mtx;
+
+    /** Notified after the file was parsed, a task was finished or an error occurred. */
+    mutable std::condition_variable cvProgress;
+
+    /** Whether the file was parsed and decode tasks were submitted or not. */
+    bool bIsParsed = false;
+
+    /** First error that occurred on a worker thread. */
+    std::exception_ptr pError;
+
+    /** Decoded primitives (where index is primitive index), `nullptr` if not decoded yet. */
+    std::vector<std::shared_ptr<const GltfPrimitiveData>> vDecodedPrimitives;
+
+    /** Decoded images (where index is image index), `nullptr` if not used or not decoded yet. */
+    std::vector<std::shared_ptr<const TextureImporter::DecodedImage>> vDecodedImages;
+
+    /** Number of meshes to create. */
+    size_t iMeshCount = 0;
+
+    /** Number of submitted image decode tasks. */
+    size_t iImageTaskCount = 0;
+
+    /** Number of finished image decode tasks. */
+    size_t iFinishedImageTaskCount = 0;
+
+    /** Number of finished primitive decode tasks. */
+    size_t iFinishedPrimitiveTaskCount = 0;
+
+    /** Number of meshes that were created. */
+    size_t iUploadedMeshCount = 0;
+
+    /**
+     * `true` until decoded data is copied for writing the mesh cache (decoded data is not freed
+     * after meshes are created while it's `true`).
+     */
+    bool bIsCacheWritePending = false;
+
+    /** Largest size (along any axis) of a mesh. */
+    float largestMeshSize = 0.0F;
+
+    /** Time when decode tasks were submitted. */
+    std::chrono::steady_clock::time_point decodeStartTime;
+
+    /** Time spent in each import stage. */
+    MeshImporter::ImportStatistics statistics;
+
+    /** Materials created so far (only accessed on the OpenGL thread). */
+    std::vector<std::shared_ptr<Material>> vMaterials;
+
+    /** Whether a mesh was created or not (only accessed on the OpenGL thread). */
+    std::vector<bool> vIsMeshUploaded;
+};
+
+std::unique_ptr<AsyncMeshImport> MeshImporter::importMeshAsync(const std::filesystem::path& pathToFile) {
     // Make sure the file has ".GLTF" or ".GLB" extension.
     if (pathToFile.extension() != ".GLTF" && pathToFile.extension() != ".gltf" &&
         pathToFile.extension() != ".GLB" && pathToFile.extension() != ".glb") [[unlikely]] {
@@ -438,29 +1065,129 @@ std::vector<std::unique_ptr<Mesh>> MeshImporter::importMesh(const std::filesyste
             std::format("the specified path \"{}\" does not exists", pathToFile.string()));
     }
 
+    auto pState = std::make_shared<AsyncMeshImport::State>();
+    pState->pathToFile = pathToFile;
+    pState->imageSettings.bIsCompressed = TextureCompressor::bIsEnabled;
+    pState->imageSettings.bIsFlipped =
+        TextureCompressor::bIsEnabled && TextureImporter::bFlipTexturesVertically;
+
+    auto& threadPool = ThreadPool::get();
+    pState->statistics.iWorkerThreadCount = threadPool.getThreadCount();
+
+    // Parse the file on a worker thread, the parse task submits decode tasks without waiting for them
+    // so that even a single worker thread can't deadlock.
+    threadPool.addTask([pState]() {
+        try {
+            AsyncMeshImport::parseFile(pState);
+        } catch (...) {
+            AsyncMeshImport::setError(*pState, std::current_exception());
+        }
+    });
+
+    return std::unique_ptr<AsyncMeshImport>(new AsyncMeshImport(std::move(pState)));
+}
+
+std::vector<std::unique_ptr<Mesh>> MeshImporter::importMesh(
+    const std::filesystem::path& pathToFile,
+    GeometryBuffer* pGeometryBuffer,
+    GeometryBuffer* pPackedGeometryBuffer,
+    TextureCache* pTextureCache,
+    ImportStatistics* pStatistics) {
+    const auto pImport = importMeshAsync(pathToFile);
+
+    // Wait for worker threads and then upload everything at once.
+    pImport->waitUntilDecoded();
+    auto vImportedMeshes = pImport->uploadReadyMeshes(
+        pGeometryBuffer, pPackedGeometryBuffer, pTextureCache, nullptr, nullptr, {});
+
+    if (pStatistics != nullptr) {
+        *pStatistics = pImport->getStatistics();
+    }
+
+    return vImportedMeshes;
+}
+
+AsyncMeshImport::AsyncMeshImport(std::shared_ptr<State> pState) : pState(std::move(pState)) {}
+
+AsyncMeshImport::~AsyncMeshImport() {
+    cancel();
+
+    // Release materials (and thus textures) here on the OpenGL thread because worker threads might
+    // keep the state alive for a while.
+    pState->vMaterials.clear();
+}
+
+void AsyncMeshImport::parseFile(const std::shared_ptr<State>& pState) {
+    if (pState->bIsCancelled) {
+        return;
+    }
+
+    const auto& pathToFile = pState->pathToFile;
+    auto& model = pState->model;
+    const auto parseStartTime = std::chrono::steady_clock::now();
+
+    // Use decoded data from the cache if the file was imported before.
+    pState->pSourceFile = MappedFile::create(pathToFile);
+    if (MeshCache::bIsEnabled) {
+        auto pCache = MeshCache::load(pathToFile, pState->pSourceFile->getData(), pState->imageSettings);
+        if (pCache != nullptr) {
+            for (size_t i = 0; i < pCache->getMeshCount(); i++) {
+                pState->vMeshMaterialIndices.push_back(pCache->getMesh(i).iMaterialIndex);
+            }
+            for (size_t i = 0; i < pCache->getMaterialCount(); i++) {
+                pState->vMaterialImageIndices.push_back(pCache->getMaterialImageIndices(i));
+            }
+
+            {
+                std::scoped_lock guard(pState->mtx);
+
+                pState->iMeshCount = pCache->getMeshCount();
+                pState->largestMeshSize = pCache->getLargestMeshSize();
+                pState->statistics.parseTimeInMs = getTimeSinceInMs(parseStartTime);
+                pState->statistics.bIsLoadedFromCache = true;
+                pState->pCache = std::move(pCache);
+                pState->bIsParsed = true;
+            }
+            pState->cvProgress.notify_all();
+
+            return;
+        }
+    }
+
     // See if we have a binary GTLF file or not.
     bool bIsGlb = false;
     if (pathToFile.extension() == ".GLB" || pathToFile.extension() == ".glb") {
         bIsGlb = true;
     }
 
-    using namespace tinygltf;
-
     // Prepare variables for storing results.
-    Model model;
-    TinyGLTF loader;
+    tinygltf::TinyGLTF loader;
     std::string sError;
     std::string sWarning;
     bool bIsSuccess = false;
 
-    // Don't make all images to be in RGBA format.
-    loader.SetPreserveImageChannels(true);
+    // Don't decode images while parsing, they will be decoded by separate tasks.
+    loader.SetImageLoader(storeEncodedGltfImage, &pState->vEncodedImageFiles);
 
-    // Load data from file.
+    // Parse the mapped file (instead of reading the whole file into memory).
+    const auto fileData = pState->pSourceFile->getData();
+    const auto sBaseDirectory = pathToFile.parent_path().string();
     if (bIsGlb) {
-        bIsSuccess = loader.LoadBinaryFromFile(&model, &sError, &sWarning, pathToFile.string());
+        bIsSuccess = loader.LoadBinaryFromMemory(
+            &model,
+            &sError,
+            &sWarning,
+            fileData.data(),
+            static_cast<unsigned int>(fileData.size()),
+            sBaseDirectory);
     } else {
-        bIsSuccess = loader.LoadASCIIFromFile(&model, &sError, &sWarning, pathToFile.string());
+        bIsSuccess = loader.LoadASCIIFromString(
+            &model,
+            &sError,
+            &sWarning,
+            reinterpret_cast<const char*>(fileData.data()), // NOLINT: JSON text
+            static_cast<unsigned int>(fileData.size()),
+            sBaseDirectory);
     }
 
     // See if there were any warnings/errors.
@@ -476,27 +1203,483 @@ std::vector<std::unique_ptr<Mesh>> MeshImporter::importMesh(const std::filesyste
             "there was an error during the import process but no error message was received");
     }
 
+    // Read vertices, indices and images of GLB files directly from the mapped file.
+    auto& vBufferData = pState->vBufferData;
+    vBufferData = mapGltfBufferData(model, fileData, bIsGlb);
+    pState->vEncodedImageFiles.resize(model.images.size());
+    pState->vEncodedImages.resize(model.images.size());
+    for (size_t i = 0; i < model.images.size(); i++) {
+        const auto iBufferViewIndex = model.images[i].bufferView;
+        if (iBufferViewIndex < 0) {
+            pState->vEncodedImages[i] = pState->vEncodedImageFiles[i];
+            continue;
+        }
+
+        if (static_cast<size_t>(iBufferViewIndex) >= model.bufferViews.size()) [[unlikely]] {
+            throw std::runtime_error(std::format("image {} has an invalid buffer view index", i));
+        }
+        const auto& bufferView = model.bufferViews[iBufferViewIndex];
+        const auto bufferData = vBufferData[bufferView.buffer];
+        if (bufferView.byteOffset > bufferData.size() ||
+            bufferView.byteLength > bufferData.size() - bufferView.byteOffset) [[unlikely]] {
+            throw std::runtime_error(std::format("image {} is out of buffer bounds", i));
+        }
+        pState->vEncodedImages[i] = bufferData.subspan(bufferView.byteOffset, bufferView.byteLength);
+    }
+
     // Get default scene.
     const auto& scene = model.scenes[model.defaultScene];
 
-    std::vector<std::unique_ptr<::Mesh>> vImportedMeshes;
-
+    // Collect transforms of all instances of each mesh from the node hierarchy.
+    std::vector<std::vector<glm::mat4x4>> vMeshInstanceMatrices(model.meshes.size());
     for (const auto& iNode : scene.nodes) {
-        // Make sure this node index is valid.
-        if (iNode < 0) [[unlikely]] {
-            throw std::runtime_error(
-                std::format("found a negative node index of {} in default scene", iNode));
+        collectGltfMeshInstances(
+            model, vBufferData, iNode, glm::identity<glm::mat4x4>(), vMeshInstanceMatrices);
+    }
+
+    // Collect primitives to import (once per mesh no matter how many nodes reference it).
+    auto& vPrimitives = pState->vPrimitives;
+    for (size_t iMeshIndex = 0; iMeshIndex < model.meshes.size(); iMeshIndex++) {
+        if (vMeshInstanceMatrices[iMeshIndex].empty()) {
+            continue; // not used by the scene
         }
-        if (static_cast<size_t>(iNode) >= model.nodes.size()) [[unlikely]] {
-            throw std::runtime_error(std::format(
-                "found an out of bounds node index of {} while model nodes only has {} entries",
-                iNode,
-                model.nodes.size()));
+        for (const auto& primitive : model.meshes[iMeshIndex].primitives) {
+            vPrimitives.push_back(&primitive);
+            pState->vPrimitiveInstanceMatrices.push_back(vMeshInstanceMatrices[iMeshIndex]);
+        }
+    }
+
+    // Collect images of materials.
+    for (const auto& material : model.materials) {
+        pState->vMaterialImageIndices.push_back(getGltfMaterialImageIndices(model, material));
+    }
+
+    // See which images are used by materials of the primitives (and as which textures).
+    std::vector<bool> vIsImageUsed(model.images.size(), false);
+    pState->vImageUsage.resize(model.images.size());
+    float largestMeshSize = 0.0F;
+    for (size_t i = 0; i < vPrimitives.size(); i++) {
+        const auto& pPrimitive = vPrimitives[i];
+        pState->vMeshMaterialIndices.push_back(pPrimitive->material);
+        if (pPrimitive->material >= 0) {
+            const auto& vImageIndices = pState->vMaterialImageIndices[pPrimitive->material];
+            for (size_t iTexture = 0; iTexture < vImageIndices.size(); iTexture++) {
+                if (vImageIndices[iTexture] >= 0) {
+                    vIsImageUsed[vImageIndices[iTexture]] = true;
+                    pState->vImageUsage[vImageIndices[iTexture]][iTexture] = true;
+                }
+            }
+        }
+
+        largestMeshSize = std::max(
+            largestMeshSize,
+            getGltfPrimitiveSize(model, *pPrimitive, pState->vPrimitiveInstanceMatrices[i]));
+    }
+
+    // Remember external files to detect changes of the model when using the mesh cache.
+    const auto addDependency = [&](const std::string& sUri) {
+        if (!sUri.empty() && !sUri.starts_with("data:")) {
+            pState->vDependencies.push_back(pathToFile.parent_path() / sUri);
+        }
+    };
+    for (const auto& buffer : model.buffers) {
+        addDependency(buffer.uri);
+    }
+    for (const auto& image : model.images) {
+        addDependency(image.uri);
+    }
+
+    {
+        std::scoped_lock guard(pState->mtx);
+
+        pState->iMeshCount = vPrimitives.size();
+        pState->vDecodedPrimitives.resize(vPrimitives.size());
+        pState->vDecodedImages.resize(model.images.size());
+        pState->iImageTaskCount = static_cast<size_t>(std::ranges::count(vIsImageUsed, true));
+        pState->largestMeshSize = largestMeshSize;
+        pState->statistics.parseTimeInMs = getTimeSinceInMs(parseStartTime);
+        pState->decodeStartTime = std::chrono::steady_clock::now();
+        pState->bIsCacheWritePending = MeshCache::bIsEnabled;
+        pState->bIsParsed = true;
+    }
+    pState->cvProgress.notify_all();
+
+    // Decode used images and all primitives in parallel (images first since materials wait for them).
+    auto& threadPool = ThreadPool::get();
+    for (size_t i = 0; i < model.images.size(); i++) {
+        if (!vIsImageUsed[i]) {
+            continue;
+        }
+        threadPool.addTask([pState, i]() {
+            runDecodeTask(pState, true, [&state = *pState, i]() {
+                const auto encodedImage = state.vEncodedImages[i];
+                auto image = TextureImporter::decodeImage(encodedImage.data(), encodedImage.size());
+                state.vEncodedImages[i] = {};
+                state.vEncodedImageFiles[i] = {}; // free encoded image (if it was not in a buffer)
+
+                // Compress depending on how materials use the image and free decoded pixels.
+                if (state.imageSettings.bIsCompressed) {
+                    const auto& vUsage = state.vImageUsage[i];
+                    image.compressedFormat = TextureCompressor::selectFormat(vUsage, image.iChannelCount);
+                    image.vCompressedData = TextureCompressor::compress(
+                        image.vPixels.data(),
+                        image.iWidth,
+                        image.iHeight,
+                        image.iChannelCount,
+                        image.iBitsPerChannel,
+                        image.compressedFormat,
+                        vUsage[0],
+                        state.imageSettings.bIsFlipped);
+                    image.vPixels = {};
+                }
+
+                auto pImage = std::make_shared<const TextureImporter::DecodedImage>(std::move(image));
+
+                return [&state, i, pImage = std::move(pImage)]() mutable {
+                    state.vDecodedImages[i] = std::move(pImage);
+                };
+            });
+        });
+    }
+    for (size_t i = 0; i < vPrimitives.size(); i++) {
+        threadPool.addTask([pState, i]() {
+            runDecodeTask(pState, false, [&state = *pState, i]() {
+                auto data = decodeGltfPrimitive(state.model, state.vBufferData, *state.vPrimitives[i]);
+
+                // Reorder triangles and vertices for faster rendering.
+                const auto cacheStatsBefore =
+                    MeshOptimizer::analyzeVertexCache(data.vIndices, data.vVertices.size());
+                MeshOptimizer::optimize(data.vVertices, data.vIndices);
+
+                // Group triangles into clusters to cull invisible parts of the mesh.
+                data.vClusters = MeshOptimizer::buildClusters(data.vVertices, data.vIndices);
+                const auto cacheStatsAfter =
+                    MeshOptimizer::analyzeVertexCache(data.vIndices, data.vVertices.size());
+
+                // Generate simplified versions (indices are appended).
+                data.vLods = MeshOptimizer::generateLods(data.vVertices, data.vIndices);
+
+                auto pData = std::make_shared<const GltfPrimitiveData>(std::move(data));
+
+                return [&state, i, pData = std::move(pData), cacheStatsBefore, cacheStatsAfter]() mutable {
+                    state.vDecodedPrimitives[i] = std::move(pData);
+                    state.statistics.vertexCacheBeforeOptimization += cacheStatsBefore;
+                    state.statistics.vertexCacheAfterOptimization += cacheStatsAfter;
+                };
+            });
+        });
+    }
+}
+
+void AsyncMeshImport::runDecodeTask(
+    const std::shared_ptr<State>& pState,
+    bool bIsImageTask,
+    const std::function<std::function<void()>()>& decode) {
+    auto& state = *pState;
+    std::function<void()> storeResult;
+    if (!state.bIsCancelled) {
+        try {
+            storeResult = decode();
+        } catch (...) {
+            setError(state, std::current_exception());
+        }
+    }
+
+    {
+        std::scoped_lock guard(state.mtx);
+
+        // Store the result and mark the task as finished at once so that the import never sees all meshes
+        // created while the task is not counted as finished.
+        if (storeResult) {
+            storeResult();
+        }
+
+        // Measure time since decoding started once the last task of its kind is finished.
+        if (bIsImageTask) {
+            state.iFinishedImageTaskCount += 1;
+            if (state.iFinishedImageTaskCount == state.iImageTaskCount) {
+                state.statistics.imageDecodeTimeInMs = getTimeSinceInMs(state.decodeStartTime);
+            }
+        } else {
+            state.iFinishedPrimitiveTaskCount += 1;
+            if (state.iFinishedPrimitiveTaskCount == state.vPrimitives.size()) {
+                state.statistics.primitiveDecodeTimeInMs = getTimeSinceInMs(state.decodeStartTime);
+            }
+        }
+
+        // Write the mesh cache once everything was successfully decoded.
+        const auto bIsEverythingDecoded = state.iFinishedImageTaskCount == state.iImageTaskCount &&
+                                          state.iFinishedPrimitiveTaskCount == state.vPrimitives.size();
+        if (bIsEverythingDecoded && state.bIsCacheWritePending && !state.bIsCancelled) {
+            MeshCache::Content content;
+            content.vMaterialImageIndices = state.vMaterialImageIndices;
+            content.vDependencies = state.vDependencies;
+            content.imageSettings = state.imageSettings;
+            content.largestMeshSize = state.largestMeshSize;
+            for (size_t i = 0; i < state.vDecodedPrimitives.size(); i++) {
+                const auto& pData = state.vDecodedPrimitives[i];
+                content.vMeshes.push_back(MeshCache::MeshView{
+                    .vVertices = pData->vVertices,
+                    .vIndices = pData->vIndices,
+                    .vLods = pData->vLods,
+                    .vClusters = pData->vClusters,
+                    .vInstanceMatrices = state.vPrimitiveInstanceMatrices[i],
+                    .aabb = pData->aabb,
+                    .iMaterialIndex = state.vMeshMaterialIndices[i]});
+            }
+            for (const auto& pImage : state.vDecodedImages) {
+                auto& image = content.vImages.emplace_back();
+                if (pImage != nullptr) {
+                    image.vPixels = pImage->vPixels;
+                    image.vCompressedData = pImage->vCompressedData;
+                    image.compressedFormat = pImage->compressedFormat;
+                    image.iWidth = pImage->iWidth;
+                    image.iHeight = pImage->iHeight;
+                    image.iChannelCount = pImage->iChannelCount;
+                    image.iBitsPerChannel = pImage->iBitsPerChannel;
+                }
+            }
+
+            // Decoded data is kept alive by the task (the import might free it earlier).
+            ThreadPool::get().addTask([pState,
+                                       content = std::move(content),
+                                       vPrimitives = state.vDecodedPrimitives,
+                                       vImages = state.vDecodedImages]() {
+                MeshCache::write(pState->pathToFile, pState->pSourceFile->getData(), content);
+            });
+        }
+        if (bIsEverythingDecoded && state.bIsCacheWritePending) {
+            state.bIsCacheWritePending = false;
+
+            // Free decoded data if all meshes were created before the cache got its copy.
+            if (state.iUploadedMeshCount == state.iMeshCount) {
+                state.vDecodedPrimitives.clear();
+                state.vDecodedImages.clear();
+            }
+        }
+    }
+    state.cvProgress.notify_all();
+}
+
+void AsyncMeshImport::setError(State& state, std::exception_ptr pError) {
+    state.bIsCancelled = true;
+    {
+        std::scoped_lock guard(state.mtx);
+        if (state.pError == nullptr) {
+            state.pError = std::move(pError);
+        }
+    }
+    state.cvProgress.notify_all();
+}
+
+std::vector<std::unique_ptr<Mesh>> AsyncMeshImport::uploadReadyMeshes(
+    GeometryBuffer* pGeometryBuffer,
+    GeometryBuffer* pPackedGeometryBuffer,
+    TextureCache* pTextureCache,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer,
+    std::optional<float> uploadTimeBudgetInMs) {
+    const auto uploadStartTime = std::chrono::steady_clock::now();
+
+    {
+        std::scoped_lock guard(pState->mtx);
+
+        // Rethrow errors from worker threads.
+        if (pState->pError != nullptr) {
+            std::rethrow_exception(pState->pError);
+        }
+
+        if (!pState->bIsParsed) {
+            return {};
+        }
+    }
+
+    // Since the file is parsed we can now access parse results without locking.
+    const auto& pCache = pState->pCache;
+    const auto& vMeshMaterialIndices = pState->vMeshMaterialIndices;
+    const auto& vMaterialImageIndices = pState->vMaterialImageIndices;
+    auto& vMaterials = pState->vMaterials;
+    auto& vIsMeshUploaded = pState->vIsMeshUploaded;
+    if (vIsMeshUploaded.empty()) {
+        // Materials that are shared between meshes (plus one for meshes without a material).
+        vMaterials.resize(vMaterialImageIndices.size() + 1);
+        vIsMeshUploaded.resize(vMeshMaterialIndices.size(), false);
+    }
+
+    // Images are only accessed after they were decoded (they are no longer modified by worker threads).
+    // Uploads keep the cache (via the import state) or the decoded image alive.
+    const auto getImage = [this](size_t iImageIndex) -> ImportedImage {
+        if (pState->pCache != nullptr) {
+            return ImportedImage{.view = pState->pCache->getImage(iImageIndex), .pOwner = pState};
+        }
+
+        ImportedImage imported;
+        auto& image = imported.view;
+        const auto& pImage = pState->vDecodedImages[iImageIndex];
+        if (pImage != nullptr) {
+            imported.pOwner = pImage;
+            image.vPixels = pImage->vPixels;
+            image.vCompressedData = pImage->vCompressedData;
+            image.compressedFormat = pImage->compressedFormat;
+            image.iWidth = pImage->iWidth;
+            image.iHeight = pImage->iHeight;
+            image.iChannelCount = pImage->iChannelCount;
+            image.iBitsPerChannel = pImage->iBitsPerChannel;
+        }
+        return imported;
+    };
+
+    // Prefer the packed vertex format if the mesh's data allows it.
+    const auto getGeometryBuffer = [&](std::span<const Vertex> vVertices) -> GeometryBuffer* {
+        if (pPackedGeometryBuffer != nullptr && PackedVertex::isPackable(vVertices)) {
+            return pPackedGeometryBuffer;
+        }
+        return pGeometryBuffer;
+    };
+
+    std::vector<std::unique_ptr<Mesh>> vImportedMeshes;
+    for (size_t i = 0; i < vIsMeshUploaded.size(); i++) {
+        if (vIsMeshUploaded[i]) {
+            continue;
+        }
+
+        // Stop if out of time (but upload at least one mesh to always make progress).
+        if (uploadTimeBudgetInMs.has_value() && !vImportedMeshes.empty() &&
+            getTimeSinceInMs(uploadStartTime) >= *uploadTimeBudgetInMs) {
+            break;
+        }
+
+        // Create a new mesh with the specified data.
+        std::unique_ptr<Mesh> pNewMesh;
+        if (pCache != nullptr) {
+            // Vertices and indices are copied to the GPU directly from the mapped cache file.
+            const auto mesh = pCache->getMesh(i);
+            pNewMesh = Mesh::create(
+                mesh.vVertices,
+                mesh.vIndices,
+                mesh.vLods,
+                mesh.vClusters,
+                mesh.aabb,
+                getGeometryBuffer(mesh.vVertices));
+            pNewMesh->setInstanceMatrices(mesh.vInstanceMatrices);
+        } else {
+            // Take decoded primitive if it and images of its material are ready.
+            std::shared_ptr<const GltfPrimitiveData> pData;
+            {
+                std::scoped_lock guard(pState->mtx);
+
+                if (pState->vDecodedPrimitives[i] == nullptr) {
+                    continue;
+                }
+
+                const auto iMaterialIndex = vMeshMaterialIndices[i];
+                if (iMaterialIndex >= 0) {
+                    const auto bAreImagesDecoded = std::ranges::all_of(
+                        vMaterialImageIndices[iMaterialIndex], [this](int iImageIndex) {
+                            return iImageIndex < 0 || pState->vDecodedImages[iImageIndex] != nullptr;
+                        });
+                    if (!bAreImagesDecoded) {
+                        continue;
+                    }
+                }
+
+                pData = pState->vDecodedPrimitives[i];
+            }
+
+            pNewMesh = Mesh::create(
+                pData->vVertices,
+                pData->vIndices,
+                pData->vLods,
+                pData->vClusters,
+                pData->aabb,
+                getGeometryBuffer(pData->vVertices));
+            pNewMesh->setInstanceMatrices(pState->vPrimitiveInstanceMatrices[i]);
+        }
+
+        // Assign material (shared by all meshes that use it).
+        pNewMesh->pMaterial = getImportedMaterial(
+            vMeshMaterialIndices[i],
+            vMaterials,
+            vMaterialImageIndices,
+            getImage,
+            pState->pathToFile,
+            pTextureCache,
+            pTextureUploader,
+            pTextureStreamer);
+
+        // Add this new mesh to results.
+        vImportedMeshes.push_back(std::move(pNewMesh));
+        vIsMeshUploaded[i] = true;
+    }
+
+    {
+        std::scoped_lock guard(pState->mtx);
+
+        pState->iUploadedMeshCount += vImportedMeshes.size();
+        pState->statistics.uploadTimeInMs += getTimeSinceInMs(uploadStartTime);
+        for (const auto& pMesh : vImportedMeshes) {
+            pState->statistics.iMeshCount += 1;
+            pState->statistics.iMeshInstanceCount += pMesh->getInstanceCount();
+            for (size_t i = 0; i < pMesh->vLods.size() && i < MeshOptimizer::iMaxLodCount; i++) {
+                pState->statistics.vLodTriangleCounts[i] += pMesh->vLods[i].iIndexCount / 3;
+            }
         }
 
-        // Process node.
-        processGltfNode(model.nodes[iNode], model, vImportedMeshes, pathToFile);
+        // Free decoded data once all meshes were created (unless the mesh cache still needs it).
+        if (pState->iUploadedMeshCount == pState->iMeshCount && !pState->bIsCacheWritePending) {
+            pState->vDecodedPrimitives.clear();
+            pState->vDecodedImages.clear();
+        }
     }
 
     return vImportedMeshes;
 }
+
+void AsyncMeshImport::waitUntilDecoded() const {
+    std::unique_lock guard(pState->mtx);
+    pState->cvProgress.wait(guard, [this]() {
+        return pState->pError != nullptr ||
+               (pState->bIsParsed && pState->iFinishedImageTaskCount == pState->iImageTaskCount &&
+                pState->iFinishedPrimitiveTaskCount == pState->vPrimitives.size());
+    });
+}
+
+void AsyncMeshImport::cancel() { pState->bIsCancelled = true; }
+
+bool AsyncMeshImport::isFinished() const {
+    std::scoped_lock guard(pState->mtx);
+    return pState->bIsParsed && pState->iUploadedMeshCount == pState->iMeshCount;
+}
+
+float AsyncMeshImport::getProgress() const {
+    std::scoped_lock guard(pState->mtx);
+
+    if (!pState->bIsParsed) {
+        return 0.0F;
+    }
+
+    // Count decode tasks and uploads as equal steps.
+    const auto iTotalStepCount = pState->iImageTaskCount + pState->vPrimitives.size() + pState->iMeshCount;
+    const auto iFinishedStepCount =
+        pState->iFinishedImageTaskCount + pState->iFinishedPrimitiveTaskCount + pState->iUploadedMeshCount;
+    if (iTotalStepCount == 0) {
+        return 1.0F;
+    }
+
+    return static_cast<float>(iFinishedStepCount) / static_cast<float>(iTotalStepCount);
+}
+
+std::optional<float> AsyncMeshImport::getLargestMeshSize() const {
+    std::scoped_lock guard(pState->mtx);
+
+    if (!pState->bIsParsed) {
+        return {};
+    }
+
+    return pState->largestMeshSize;
+}
+
+MeshImporter::ImportStatistics AsyncMeshImport::getStatistics() const {
+    std::scoped_lock guard(pState->mtx);
+    return pState->statistics;
+}
@@ -4,9 +4,20 @@
 #include <filesystem>
 #include <optional>
 #include <functional>
+#include <memory>
+#include <vector>
+#include <array>
+#include <exception>
 
 // Custom.
 #include "Mesh.h"
+#include "import/MeshOptimizer.h"
+
+class GeometryBuffer;
+class TextureCache;
+class TextureUploader;
+class TextureStreamer;
+class AsyncMeshImport;
 
 /**
  * Provides static functions for importing files in special formats (such as GLTF/GLB) as meshes,
@@ -14,14 +25,219 @@
  */
 class MeshImporter {
 public:
+    /** Time spent in stages of an import. */
+    struct ImportStatistics {
+        /** Time spent parsing the file (images are not decoded at this stage). */
+        float parseTimeInMs = 0.0F;
+
+        /** Time (since decoding started) until all used images were decoded/compressed on worker threads. */
+        float imageDecodeTimeInMs = 0.0F;
+
+        /**
+         * Time (since decoding started) until all primitives were decoded on worker threads
+         * (decoded in parallel with images).
+         */
+        float primitiveDecodeTimeInMs = 0.0F;
+
+        /** Time spent creating meshes and textures on the calling (OpenGL) thread. */
+        float uploadTimeInMs = 0.0F;
+
+        /** Vertex cache efficiency of all decoded primitives in the order they were stored in the file. */
+        MeshOptimizer::VertexCacheStatistics vertexCacheBeforeOptimization;
+
+        /** Vertex cache efficiency of all decoded primitives after @ref MeshOptimizer::optimize. */
+        MeshOptimizer::VertexCacheStatistics vertexCacheAfterOptimization;
+
+        /** Number of imported meshes. */
+        size_t iMeshCount = 0;
+
+        /**
+         * Number of drawn instances of all imported meshes (larger than @ref iMeshCount if multiple nodes
+         * reference the same mesh).
+         */
+        size_t iMeshInstanceCount = 0;
+
+        /** Total number of triangles of each level of detail of all meshes (that have this level). */
+        std::array<size_t, MeshOptimizer::iMaxLodCount> vLodTriangleCounts{};
+
+        /** Number of worker threads used to decode images and primitives. */
+        size_t iWorkerThreadCount = 0;
+
+        /** Whether meshes were loaded from the mesh cache (nothing to decode) or not. */
+        bool bIsLoadedFromCache = false;
+    };
+
     MeshImporter() = delete;
 
     /**
-     * Imports a file in a special format (such as GTLF/GLB).
+     * Starts importing a file in a special format (such as GLTF/GLB) on worker threads and returns
+     * immediately.
+     *
+     * @remark Use returned object to upload meshes (on the OpenGL thread) as they become ready.
      *
      * @param pathToFile Path to the file to import.
      *
-     * @return Imported meshes.
+     * @return Handle to the started import, destroying it cancels the import.
+     */
+    static std::unique_ptr<AsyncMeshImport> importMeshAsync(const std::filesystem::path& pathToFile);
+
+    /**
+     * Imports a file in a special format (such as GTLF/GLB) and waits for the import to finish.
+     *
+     * @param pathToFile            Path to the file to import.
+     * @param pGeometryBuffer       Buffer to store vertices and indices of imported meshes in.
+     * @param pPackedGeometryBuffer If not `nullptr` buffer of @ref VertexFormat::PACKED to store meshes
+     * in if their vertices can be packed (see @ref PackedVertex::isPackable).
+     * @param pTextureCache         Cache to share textures of images that are used by multiple materials.
+     * @param pStatistics           If not `nullptr` time spent in each import stage will be stored here.
+     *
+     * @return Imported meshes, meshes that use the same material share it.
+     */
+    static std::vector<std::unique_ptr<Mesh>> importMesh(
+        const std::filesystem::path& pathToFile,
+        GeometryBuffer* pGeometryBuffer,
+        GeometryBuffer* pPackedGeometryBuffer,
+        TextureCache* pTextureCache,
+        ImportStatistics* pStatistics = nullptr);
+};
+
+/**
+ * Import started by @ref MeshImporter::importMeshAsync.
+ *
+ * @remark The file is parsed and its images/primitives are decoded on worker threads while meshes
+ * and textures are created on the OpenGL thread (see @ref uploadReadyMeshes) so that the caller
+ * can continue rendering while the import is in progress.
+ */
+class AsyncMeshImport {
+    // Only mesh importer can create instances of this class.
+    friend class MeshImporter;
+
+public:
+    AsyncMeshImport() = delete;
+
+    AsyncMeshImport(const AsyncMeshImport&) = delete;
+    AsyncMeshImport& operator=(const AsyncMeshImport&) = delete;
+
+    /**
+     * Cancels the import (does not wait for worker threads).
+     *
+     * @remark Must be destroyed on the OpenGL thread.
+     */
+    ~AsyncMeshImport();
+
+    /**
+     * Creates meshes (and their textures) of primitives that were decoded and which material images
+     * were decoded.
+     *
+     * @remark Must be called on the OpenGL thread.
+     * @remark Rethrows the first error that occurred on worker threads.
+     *
+     * @param pGeometryBuffer       Buffer to store vertices and indices of imported meshes in.
+     * @param pPackedGeometryBuffer If not `nullptr` buffer of @ref VertexFormat::PACKED to store meshes
+     * in if their vertices can be packed (see @ref PackedVertex::isPackable).
+     * @param pTextureCache         Cache to share textures of images that are used by multiple materials.
+     * @param pTextureUploader      Uploader to copy pixels of textures asynchronously (see
+     * @ref TextureUploader::update), `nullptr` to copy them right away.
+     * @param pTextureStreamer      Streamer to load detailed mip levels of compressed textures once they
+     * are needed (see @ref TextureStreamer::update), `nullptr` to load all levels right away.
+     * @param uploadTimeBudgetInMs  Time after which no more meshes will be created during this call
+     * (at least one mesh is created if ready), empty to create all ready meshes.
+     *
+     * @return Created meshes (might be empty if nothing is ready yet), meshes that use the same material
+     * share it (also between calls).
+     */
+    std::vector<std::unique_ptr<Mesh>> uploadReadyMeshes(
+        GeometryBuffer* pGeometryBuffer,
+        GeometryBuffer* pPackedGeometryBuffer,
+        TextureCache* pTextureCache,
+        TextureUploader* pTextureUploader,
+        TextureStreamer* pTextureStreamer,
+        std::optional<float> uploadTimeBudgetInMs);
+
+    /**
+     * Blocks the calling thread until the file is parsed and all its images/primitives are decoded
+     * (or an error occurred).
+     *
+     * @warning Do not call after @ref cancel.
+     */
+    void waitUntilDecoded() const;
+
+    /** Stops decoding data that was not decoded yet, no more meshes will become ready. */
+    void cancel();
+
+    /**
+     * Tells whether all meshes of the file were returned by @ref uploadReadyMeshes or not.
+     *
+     * @return `true` if the import is finished.
+     */
+    bool isFinished() const;
+
+    /**
+     * Returns progress of the import.
+     *
+     * @return Value in range [0.0; 1.0] (0.0 while the file is being parsed).
+     */
+    float getProgress() const;
+
+    /**
+     * Returns the largest size (along any axis) of an imported mesh, known once the file is parsed
+     * (before meshes are uploaded).
+     *
+     * @return Empty if the file is not parsed yet.
+     */
+    std::optional<float> getLargestMeshSize() const;
+
+    /**
+     * Returns time spent in each import stage so far.
+     *
+     * @return Statistics.
+     */
+    MeshImporter::ImportStatistics getStatistics() const;
+
+private:
+    /** Data shared with worker threads. */
+    struct State;
+
+    /**
+     * Creates a new object.
+     *
+     * @param pState Shared import state.
+     */
+    AsyncMeshImport(std::shared_ptr<State> pState);
+
+    /**
+     * Parses the file and submits tasks to decode used images and all primitives (does not wait for them).
+     *
+     * @remark Called on a worker thread.
+     *
+     * @param pState Import state.
      */
-    static std::vector<std::unique_ptr<Mesh>> importMesh(const std::filesystem::path& pathToFile);
+    static void parseFile(const std::shared_ptr<State>& pState);
+
+    /**
+     * Runs a decode task (unless the import was cancelled) and marks it as finished, the last finished
+     * task submits a task to write the mesh cache.
+     *
+     * @remark Called on a worker thread.
+     *
+     * @param pState       Import state.
+     * @param bIsImageTask `true` if the task decodes an image, `false` if a primitive.
+     * @param decode       Function that decodes data and returns a function that stores it in the state
+     * (called while the state's mutex is locked, together with marking the task as finished).
+     */
+    static void runDecodeTask(
+        const std::shared_ptr<State>& pState,
+        bool bIsImageTask,
+        const std::function<std::function<void()>()>& decode);
+
+    /**
+     * Stores the first error that occurred on a worker thread and cancels the import.
+     *
+     * @param state  Import state.
+     * @param pError Error to store.
+     */
+    static void setError(State& state, std::exception_ptr pError);
+
+    /** Data shared with worker threads (worker threads keep it alive after this object is destroyed). */
+    std::shared_ptr<State> pState;
 };
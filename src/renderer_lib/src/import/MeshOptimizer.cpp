@@ -0,0 +1,933 @@
+#include "MeshOptimizer.h"
+
+// Standard.
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+/** Sum of squared distances to planes of triangles (weighted by their areas). */
+struct Quadric {
+    /**
+     * Adds the plane of the specified triangle.
+     *
+     * @param position0 First vertex of the triangle.
+     * @param position1 Second vertex of the triangle.
+     * @param position2 Third vertex of the triangle.
+     */
+    void addTriangle(const glm::vec3& position0, const glm::vec3& position1, const glm::vec3& position2) {
+        const auto normal = glm::cross(position1 - position0, position2 - position0);
+        const auto doubleArea = static_cast<double>(glm::length(normal));
+        if (doubleArea == 0.0) {
+            return;
+        }
+
+        // Plane equation: n * p + d = 0.
+        const auto nx = static_cast<double>(normal.x) / doubleArea;
+        const auto ny = static_cast<double>(normal.y) / doubleArea;
+        const auto nz = static_cast<double>(normal.z) / doubleArea;
+        const auto d = -(nx * position0.x + ny * position0.y + nz * position0.z);
+        const auto w = doubleArea * 0.5; // NOLINT: area
+
+        a00 += w * nx * nx;
+        a01 += w * nx * ny;
+        a02 += w * nx * nz;
+        a11 += w * ny * ny;
+        a12 += w * ny * nz;
+        a22 += w * nz * nz;
+        b0 += w * nx * d;
+        b1 += w * ny * d;
+        b2 += w * nz * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    /**
+     * Returns average squared distance from the specified point to planes of the quadric.
+     *
+     * @param position Point to test.
+     *
+     * @return Squared distance.
+     */
+    double evaluate(const glm::vec3& position) const {
+        if (weight == 0.0) {
+            return 0.0;
+        }
+
+        const auto x = static_cast<double>(position.x);
+        const auto y = static_cast<double>(position.y);
+        const auto z = static_cast<double>(position.z);
+        const auto error = a00 * x * x + a11 * y * y + a22 * z * z +
+                           2.0 * (a01 * x * y + a02 * x * z + a12 * y * z + b0 * x + b1 * y + b2 * z) + c;
+
+        return std::max(error, 0.0) / weight;
+    }
+
+    /**
+     * Adds planes of the specified quadric.
+     *
+     * @param other Quadric to add.
+     *
+     * @return This object.
+     */
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    /** Elements of the symmetric matrix nn^T. */
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+
+    /** Elements of the vector dn. */
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+
+    /** Sum of d^2. */
+    double c = 0.0;
+
+    /** Sum of triangle areas. */
+    double weight = 0.0;
+};
+
+/** Hashes vertex positions (to find vertices at the same position). */
+struct PositionHash {
+    size_t operator()(const glm::vec3& position) const {
+        const auto iX = static_cast<uint64_t>(std::bit_cast<uint32_t>(position.x));
+        const auto iY = static_cast<uint64_t>(std::bit_cast<uint32_t>(position.y));
+        const auto iZ = static_cast<uint64_t>(std::bit_cast<uint32_t>(position.z));
+        return std::hash<uint64_t>{}((iX * 73856093) ^ (iY * 19349663) ^ (iZ * 83492791)); // NOLINT: primes
+    }
+};
+
+float MeshOptimizer::VertexCacheStatistics::getAcmr() const {
+    if (iTriangleCount == 0) {
+        return 0.0F;
+    }
+    return static_cast<float>(iTransformedVertexCount) / static_cast<float>(iTriangleCount);
+}
+
+float MeshOptimizer::VertexCacheStatistics::getAtvr() const {
+    if (iVertexCount == 0) {
+        return 0.0F;
+    }
+    return static_cast<float>(iTransformedVertexCount) / static_cast<float>(iVertexCount);
+}
+
+MeshOptimizer::VertexCacheStatistics&
+MeshOptimizer::VertexCacheStatistics::operator+=(const VertexCacheStatistics& other) {
+    iTransformedVertexCount += other.iTransformedVertexCount;
+    iTriangleCount += other.iTriangleCount;
+    iVertexCount += other.iVertexCount;
+    return *this;
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vVertices, std::vector<unsigned int>& vIndices) {
+    // Only triangle lists are supported.
+    if (vIndices.size() % 3 != 0) [[unlikely]] {
+        return;
+    }
+
+    optimizeVertexCache(vIndices, vVertices.size());
+    optimizeOverdraw(vIndices, vVertices);
+    optimizeVertexFetch(vVertices, vIndices);
+}
+
+MeshOptimizer::VertexCacheStatistics
+MeshOptimizer::analyzeVertexCache(std::span<const unsigned int> vIndices, size_t iVertexCount) {
+    VertexCacheStatistics stats;
+    stats.iTriangleCount = vIndices.size() / 3;
+    stats.iVertexCount = iVertexCount;
+
+    std::vector<unsigned int> vTimestamps(iVertexCount, 0);
+    unsigned int iTimestamp = iFifoCacheSize + 1;
+    for (size_t i = 0; i < stats.iTriangleCount; i++) {
+        stats.iTransformedVertexCount += simulateFifoCache(&vIndices[i * 3], vTimestamps, iTimestamp);
+    }
+
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& vIndices, size_t iVertexCount) {
+    const auto iTriangleCount = vIndices.size() / 3;
+    if (iTriangleCount == 0) {
+        return;
+    }
+
+    // Prepare scores of vertex positions in the cache (the last triangle's vertices get a fixed score
+    // so that the next triangle does not simply reuse the same edge).
+    constexpr float lastTriangleScore = 0.75F;
+    constexpr float cacheDecayPower = 1.5F;
+    std::array<float, iLruCacheSize> vCachePositionScores{};
+    for (unsigned int i = 0; i < iLruCacheSize; i++) {
+        vCachePositionScores[i] = i < 3 ? lastTriangleScore
+                                        : std::pow(
+                                              1.0F - static_cast<float>(i - 3) /
+                                                         static_cast<float>(iLruCacheSize - 3),
+                                              cacheDecayPower);
+    }
+
+    // Prepare scores of remaining triangle counts (vertices with few triangles left are preferred
+    // to not leave lone triangles behind).
+    constexpr float valenceBoostScale = 2.0F;
+    constexpr size_t iMaxTabulatedValence = 32;
+    std::array<float, iMaxTabulatedValence> vValenceScores{};
+    for (size_t i = 1; i < iMaxTabulatedValence; i++) {
+        vValenceScores[i] = valenceBoostScale / std::sqrt(static_cast<float>(i));
+    }
+
+    const auto getVertexScore = [&](int iCachePosition, unsigned int iRemainingTriangleCount) -> float {
+        if (iRemainingTriangleCount == 0) {
+            // Not used by other triangles.
+            return -1.0F;
+        }
+
+        float score = iCachePosition < 0 ? 0.0F : vCachePositionScores[iCachePosition];
+        score += iRemainingTriangleCount < iMaxTabulatedValence
+                     ? vValenceScores[iRemainingTriangleCount]
+                     : valenceBoostScale / std::sqrt(static_cast<float>(iRemainingTriangleCount));
+        return score;
+    };
+
+    // Collect triangles of each vertex, only first `vRemainingTriangleCounts[i]` triangles of
+    // a vertex are not emitted yet.
+    std::vector<unsigned int> vTriangleOffsets(iVertexCount + 1, 0);
+    for (const auto iIndex : vIndices) {
+        vTriangleOffsets[iIndex + 1] += 1;
+    }
+    std::partial_sum(vTriangleOffsets.begin(), vTriangleOffsets.end(), vTriangleOffsets.begin());
+    std::vector<unsigned int> vRemainingTriangleCounts(iVertexCount, 0);
+    std::vector<unsigned int> vVertexTriangles(vIndices.size());
+    for (size_t i = 0; i < vIndices.size(); i++) {
+        const auto iVertex = vIndices[i];
+        vVertexTriangles[vTriangleOffsets[iVertex] + vRemainingTriangleCounts[iVertex]] =
+            static_cast<unsigned int>(i / 3);
+        vRemainingTriangleCounts[iVertex] += 1;
+    }
+
+    // Calculate initial scores.
+    std::vector<int> vCachePositions(iVertexCount, -1);
+    std::vector<float> vVertexScores(iVertexCount, 0.0F);
+    for (size_t i = 0; i < iVertexCount; i++) {
+        vVertexScores[i] = getVertexScore(-1, vRemainingTriangleCounts[i]);
+    }
+    std::vector<float> vTriangleScores(iTriangleCount, 0.0F);
+    for (size_t i = 0; i < iTriangleCount; i++) {
+        vTriangleScores[i] = vVertexScores[vIndices[i * 3]] + vVertexScores[vIndices[i * 3 + 1]] +
+                             vVertexScores[vIndices[i * 3 + 2]];
+    }
+
+    std::vector<bool> vIsTriangleEmitted(iTriangleCount, false);
+    std::vector<unsigned int> vOptimizedIndices;
+    vOptimizedIndices.reserve(vIndices.size());
+
+    std::vector<unsigned int> vCache;
+    std::vector<unsigned int> vNewCache;
+    vCache.reserve(iLruCacheSize + 3);
+    vNewCache.reserve(iLruCacheSize + 3);
+
+    constexpr auto iNoTriangle = std::numeric_limits<size_t>::max();
+    size_t iBestTriangle = 0;
+    size_t iNextTriangleToScan = 0;
+    for (size_t iEmittedCount = 0; iEmittedCount < iTriangleCount; iEmittedCount++) {
+        if (iBestTriangle == iNoTriangle) {
+            // Vertices in the cache have no triangles left, continue from any triangle.
+            while (vIsTriangleEmitted[iNextTriangleToScan]) {
+                iNextTriangleToScan += 1;
+            }
+            iBestTriangle = iNextTriangleToScan;
+        }
+
+        // Emit the triangle.
+        const auto* const pTriangle = &vIndices[iBestTriangle * 3];
+        vOptimizedIndices.insert(vOptimizedIndices.end(), pTriangle, pTriangle + 3);
+        vIsTriangleEmitted[iBestTriangle] = true;
+
+        // Remove the triangle from triangles of its vertices.
+        for (size_t i = 0; i < 3; i++) {
+            const auto iVertex = pTriangle[i];
+            auto* const pTriangles = &vVertexTriangles[vTriangleOffsets[iVertex]];
+            auto& iRemainingCount = vRemainingTriangleCounts[iVertex];
+            const auto pFound = std::find(pTriangles, pTriangles + iRemainingCount, iBestTriangle);
+            std::swap(*pFound, pTriangles[iRemainingCount - 1]);
+            iRemainingCount -= 1;
+        }
+
+        // Put the triangle's vertices to the front of the cache.
+        vNewCache.clear();
+        for (size_t i = 0; i < 3; i++) {
+            if (std::ranges::find(vNewCache, pTriangle[i]) == vNewCache.end()) {
+                vNewCache.push_back(pTriangle[i]);
+            }
+        }
+        for (const auto iVertex : vCache) {
+            if (iVertex != pTriangle[0] && iVertex != pTriangle[1] && iVertex != pTriangle[2]) {
+                vNewCache.push_back(iVertex);
+            }
+        }
+
+        // Update scores of vertices that were moved or evicted (and triangles that use them).
+        for (size_t i = 0; i < vNewCache.size(); i++) {
+            const auto iVertex = vNewCache[i];
+            vCachePositions[iVertex] = i < iLruCacheSize ? static_cast<int>(i) : -1;
+
+            const auto newScore = getVertexScore(vCachePositions[iVertex], vRemainingTriangleCounts[iVertex]);
+            const auto scoreDelta = newScore - vVertexScores[iVertex];
+            vVertexScores[iVertex] = newScore;
+
+            const auto* const pTriangles = &vVertexTriangles[vTriangleOffsets[iVertex]];
+            for (size_t j = 0; j < vRemainingTriangleCounts[iVertex]; j++) {
+                vTriangleScores[pTriangles[j]] += scoreDelta;
+            }
+        }
+        if (vNewCache.size() > iLruCacheSize) {
+            vNewCache.resize(iLruCacheSize);
+        }
+        std::swap(vCache, vNewCache);
+
+        // Pick the next triangle from triangles of cached vertices.
+        iBestTriangle = iNoTriangle;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (const auto iVertex : vCache) {
+            const auto* const pTriangles = &vVertexTriangles[vTriangleOffsets[iVertex]];
+            for (size_t j = 0; j < vRemainingTriangleCounts[iVertex]; j++) {
+                if (vTriangleScores[pTriangles[j]] > bestScore) {
+                    bestScore = vTriangleScores[pTriangles[j]];
+                    iBestTriangle = pTriangles[j];
+                }
+            }
+        }
+    }
+
+    vIndices = std::move(vOptimizedIndices);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& vIndices, std::span<const Vertex> vVertices) {
+    const auto iTriangleCount = vIndices.size() / 3;
+    if (iTriangleCount == 0) {
+        return;
+    }
+
+    std::vector<unsigned int> vTimestamps(vVertices.size(), 0);
+    unsigned int iTimestamp = iFifoCacheSize + 1;
+    const auto resetCache = [&iTimestamp]() { iTimestamp += iFifoCacheSize + 1; };
+
+    // Split triangles into regions that start where all vertices of a triangle miss the cache
+    // (usually a new patch of the mesh that was produced by the vertex cache optimization).
+    std::vector<size_t> vRegionStarts;
+    for (size_t i = 0; i < iTriangleCount; i++) {
+        if (simulateFifoCache(&vIndices[i * 3], vTimestamps, iTimestamp) == 3 || i == 0) {
+            vRegionStarts.push_back(i);
+        }
+    }
+    vRegionStarts.push_back(iTriangleCount);
+
+    // Split regions into smaller clusters which cache efficiency is close to the region's efficiency
+    // (the cache is flushed at cluster boundaries since clusters will be reordered).
+    std::vector<size_t> vClusterStarts;
+    for (size_t iRegion = 0; iRegion + 1 < vRegionStarts.size(); iRegion++) {
+        const auto iRegionStart = vRegionStarts[iRegion];
+        const auto iRegionEnd = vRegionStarts[iRegion + 1];
+
+        resetCache();
+        size_t iRegionMissCount = 0;
+        for (size_t i = iRegionStart; i < iRegionEnd; i++) {
+            iRegionMissCount += simulateFifoCache(&vIndices[i * 3], vTimestamps, iTimestamp);
+        }
+        const auto maxClusterAcmr = overdrawCacheMissThreshold * static_cast<float>(iRegionMissCount) /
+                                    static_cast<float>(iRegionEnd - iRegionStart);
+
+        resetCache();
+        vClusterStarts.push_back(iRegionStart);
+        size_t iClusterMissCount = 0;
+        for (size_t i = iRegionStart; i < iRegionEnd; i++) {
+            iClusterMissCount += simulateFifoCache(&vIndices[i * 3], vTimestamps, iTimestamp);
+
+            const auto iClusterTriangleCount = i + 1 - vClusterStarts.back();
+            if (static_cast<float>(iClusterMissCount) / static_cast<float>(iClusterTriangleCount) <=
+                    maxClusterAcmr &&
+                i + 1 < iRegionEnd) {
+                // Start a new cluster.
+                vClusterStarts.push_back(i + 1);
+                resetCache();
+                iClusterMissCount = 0;
+            }
+        }
+    }
+    vClusterStarts.push_back(iTriangleCount);
+    const auto iClusterCount = vClusterStarts.size() - 1;
+    if (iClusterCount < 2) {
+        return;
+    }
+
+    // Calculate the center of the mesh.
+    auto meshCenter = glm::vec3(0.0F, 0.0F, 0.0F);
+    for (const auto& vertex : vVertices) {
+        meshCenter += vertex.position;
+    }
+    meshCenter /= static_cast<float>(std::max(vVertices.size(), size_t(1)));
+
+    // Calculate how much each cluster faces away from the center of the mesh.
+    std::vector<float> vClusterSortKeys(iClusterCount, 0.0F);
+    for (size_t iCluster = 0; iCluster < iClusterCount; iCluster++) {
+        auto clusterCenter = glm::vec3(0.0F, 0.0F, 0.0F);
+        auto clusterNormal = glm::vec3(0.0F, 0.0F, 0.0F);
+        float clusterArea = 0.0F;
+        for (size_t i = vClusterStarts[iCluster]; i < vClusterStarts[iCluster + 1]; i++) {
+            const auto& position0 = vVertices[vIndices[i * 3]].position;
+            const auto& position1 = vVertices[vIndices[i * 3 + 1]].position;
+            const auto& position2 = vVertices[vIndices[i * 3 + 2]].position;
+
+            // Weight by area (length of the non-normalized normal is 2 * area).
+            const auto normal = glm::cross(position1 - position0, position2 - position0);
+            const auto area = glm::length(normal);
+
+            clusterCenter += (position0 + position1 + position2) * (area / 3.0F);
+            clusterNormal += normal;
+            clusterArea += area;
+        }
+        if (clusterArea == 0.0F) {
+            continue;
+        }
+        clusterCenter /= clusterArea;
+
+        const auto normalLength = glm::length(clusterNormal);
+        if (normalLength > 0.0F) {
+            vClusterSortKeys[iCluster] = glm::dot(clusterCenter - meshCenter, clusterNormal / normalLength);
+        }
+    }
+
+    // Draw clusters that face outwards first.
+    std::vector<size_t> vClusterOrder(iClusterCount);
+    std::iota(vClusterOrder.begin(), vClusterOrder.end(), 0);
+    std::ranges::stable_sort(vClusterOrder, [&vClusterSortKeys](size_t iA, size_t iB) {
+        return vClusterSortKeys[iA] > vClusterSortKeys[iB];
+    });
+
+    std::vector<unsigned int> vSortedIndices;
+    vSortedIndices.reserve(vIndices.size());
+    for (const auto iCluster : vClusterOrder) {
+        vSortedIndices.insert(
+            vSortedIndices.end(),
+            vIndices.begin() + static_cast<std::ptrdiff_t>(vClusterStarts[iCluster] * 3),
+            vIndices.begin() + static_cast<std::ptrdiff_t>(vClusterStarts[iCluster + 1] * 3));
+    }
+
+    vIndices = std::move(vSortedIndices);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vVertices, std::vector<unsigned int>& vIndices) {
+    constexpr auto iNotRemapped = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> vRemap(vVertices.size(), iNotRemapped);
+
+    // Place vertices in the order of first use.
+    std::vector<Vertex> vOrderedVertices;
+    vOrderedVertices.reserve(vVertices.size());
+    for (auto& iIndex : vIndices) {
+        auto& iNewIndex = vRemap[iIndex];
+        if (iNewIndex == iNotRemapped) {
+            iNewIndex = static_cast<unsigned int>(vOrderedVertices.size());
+            vOrderedVertices.push_back(vVertices[iIndex]);
+        }
+        iIndex = iNewIndex;
+    }
+
+    vVertices = std::move(vOrderedVertices);
+}
+
+std::vector<unsigned int> MeshOptimizer::simplify(
+    std::span<const Vertex> vVertices,
+    std::span<const unsigned int> vIndices,
+    size_t iTargetIndexCount,
+    float maxError,
+    float& resultError) {
+    resultError = 0.0F;
+    std::vector<unsigned int> vResult(vIndices.begin(), vIndices.end());
+    if (vResult.size() <= iTargetIndexCount || vResult.size() % 3 != 0) {
+        return vResult;
+    }
+    const auto iVertexCount = vVertices.size();
+
+    // Calculate radius of the mesh (errors are relative to it).
+    auto min = glm::vec3(std::numeric_limits<float>::max());
+    auto max = glm::vec3(-std::numeric_limits<float>::max());
+    for (const auto& vertex : vVertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+    const auto radius = glm::length(max - min) * 0.5F;
+    if (radius <= 0.0F) {
+        return vResult;
+    }
+    const auto maxAbsoluteError = static_cast<double>(maxError * radius);
+    const auto maxErrorSquared = maxAbsoluteError * maxAbsoluteError;
+
+    // Lock vertices that share a position with other vertices (seams of UVs or normals)
+    // because moving them would tear the surface apart.
+    std::vector<bool> vIsLocked(iVertexCount, false);
+    std::vector<unsigned int> vPositionVertices(iVertexCount);
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionHash> positionToVertex;
+        positionToVertex.reserve(iVertexCount);
+        for (unsigned int i = 0; i < iVertexCount; i++) {
+            // Add 0 to turn -0 into +0.
+            const auto position = vVertices[i].position + glm::vec3(0.0F, 0.0F, 0.0F);
+
+            const auto [it, bIsInserted] = positionToVertex.try_emplace(position, i);
+            vPositionVertices[i] = it->second;
+            if (!bIsInserted) {
+                vIsLocked[i] = true;
+                vIsLocked[it->second] = true;
+            }
+        }
+    }
+
+    // Lock vertices of open borders and non-manifold edges (compared by positions so that seams are
+    // not treated as borders).
+    {
+        const auto getEdgeKey = [&vPositionVertices](unsigned int iA, unsigned int iB) -> uint64_t {
+            const auto iPositionA = vPositionVertices[iA];
+            const auto iPositionB = vPositionVertices[iB];
+            return (static_cast<uint64_t>(std::min(iPositionA, iPositionB)) << 32) | // NOLINT
+                   std::max(iPositionA, iPositionB);
+        };
+
+        std::unordered_map<uint64_t, unsigned int> edgeTriangleCounts;
+        edgeTriangleCounts.reserve(vResult.size());
+        for (size_t i = 0; i < vResult.size(); i++) {
+            edgeTriangleCounts[getEdgeKey(vResult[i], vResult[i % 3 == 2 ? i - 2 : i + 1])] += 1;
+        }
+        for (size_t i = 0; i < vResult.size(); i++) {
+            const auto iNext = vResult[i % 3 == 2 ? i - 2 : i + 1];
+            if (edgeTriangleCounts[getEdgeKey(vResult[i], iNext)] != 2) {
+                vIsLocked[vResult[i]] = true;
+                vIsLocked[iNext] = true;
+            }
+        }
+    }
+
+    // Calculate error quadrics of vertices.
+    std::vector<Quadric> vQuadrics(iVertexCount);
+    for (size_t i = 0; i < vResult.size(); i += 3) {
+        Quadric quadric;
+        quadric.addTriangle(
+            vVertices[vResult[i]].position,
+            vVertices[vResult[i + 1]].position,
+            vVertices[vResult[i + 2]].position);
+        for (size_t j = 0; j < 3; j++) {
+            vQuadrics[vResult[i + j]] += quadric;
+        }
+    }
+
+    /** Moves one vertex to another vertex. */
+    struct Collapse {
+        /** Vertex to remove. */
+        unsigned int iFrom = 0;
+
+        /** Vertex to move triangles of @ref iFrom to. */
+        unsigned int iTo = 0;
+
+        /** Squared error of the collapse. */
+        double errorSquared = 0.0;
+    };
+    std::vector<Collapse> vCollapses;
+    std::vector<unsigned int> vCollapseTargets(iVertexCount);
+    std::vector<bool> vIsTouched(iVertexCount);
+    std::vector<unsigned int> vTriangleOffsets(iVertexCount + 1);
+    std::vector<unsigned int> vVertexTriangles;
+    double maxAppliedErrorSquared = 0.0;
+
+    // Each pass collapses cheapest edges that are far enough from each other to not affect each other.
+    while (vResult.size() > iTargetIndexCount) {
+        // Collect possible collapses.
+        vCollapses.clear();
+        for (size_t i = 0; i < vResult.size(); i++) {
+            const auto iA = vResult[i];
+            const auto iB = vResult[i % 3 == 2 ? i - 2 : i + 1];
+            if (iA >= iB) {
+                // Edges around unlocked vertices are used by 2 triangles in opposite directions.
+                continue;
+            }
+
+            for (const auto& [iFrom, iTo] : {std::pair(iA, iB), std::pair(iB, iA)}) {
+                if (vIsLocked[iFrom]) {
+                    continue;
+                }
+
+                auto quadric = vQuadrics[iFrom];
+                quadric += vQuadrics[iTo];
+                const auto errorSquared = quadric.evaluate(vVertices[iTo].position);
+                if (errorSquared <= maxErrorSquared) {
+                    vCollapses.push_back(Collapse{.iFrom = iFrom, .iTo = iTo, .errorSquared = errorSquared});
+                }
+            }
+        }
+        if (vCollapses.empty()) {
+            break;
+        }
+        std::ranges::sort(
+            vCollapses, [](const Collapse& a, const Collapse& b) { return a.errorSquared < b.errorSquared; });
+
+        // Collect triangles of each vertex.
+        std::ranges::fill(vTriangleOffsets, 0);
+        for (const auto iIndex : vResult) {
+            vTriangleOffsets[iIndex + 1] += 1;
+        }
+        std::partial_sum(vTriangleOffsets.begin(), vTriangleOffsets.end(), vTriangleOffsets.begin());
+        vVertexTriangles.resize(vResult.size());
+        {
+            auto vWriteOffsets = vTriangleOffsets;
+            for (size_t i = 0; i < vResult.size(); i++) {
+                vVertexTriangles[vWriteOffsets[vResult[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        // Make sure triangles don't flip or become degenerate.
+        const auto isCollapseFlippingTriangles = [&](unsigned int iFrom, unsigned int iTo) -> bool {
+            for (auto i = vTriangleOffsets[iFrom]; i < vTriangleOffsets[iFrom + 1]; i++) {
+                const auto* const pTriangle = &vResult[static_cast<size_t>(vVertexTriangles[i]) * 3];
+                if (pTriangle[0] == iTo || pTriangle[1] == iTo || pTriangle[2] == iTo) {
+                    // Will be removed.
+                    continue;
+                }
+
+                std::array<glm::vec3, 3> vPositions;
+                for (size_t j = 0; j < 3; j++) {
+                    vPositions[j] = vVertices[pTriangle[j]].position;
+                }
+                const auto oldNormal =
+                    glm::cross(vPositions[1] - vPositions[0], vPositions[2] - vPositions[0]);
+                for (size_t j = 0; j < 3; j++) {
+                    if (pTriangle[j] == iFrom) {
+                        vPositions[j] = vVertices[iTo].position;
+                    }
+                }
+                const auto newNormal =
+                    glm::cross(vPositions[1] - vPositions[0], vPositions[2] - vPositions[0]);
+
+                // Don't allow rotating triangles by more than ~75 degrees.
+                constexpr float minNormalCos = 0.25F;
+                if (glm::dot(oldNormal, newNormal) <=
+                    minNormalCos * glm::length(oldNormal) * glm::length(newNormal)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // Apply collapses (each collapse removes about 2 triangles).
+        std::iota(vCollapseTargets.begin(), vCollapseTargets.end(), 0);
+        std::fill(vIsTouched.begin(), vIsTouched.end(), false);
+        const auto iTrianglesToRemove = (vResult.size() - iTargetIndexCount) / 3;
+        size_t iRemovedTriangleCount = 0;
+        for (const auto& collapse : vCollapses) {
+            if (iRemovedTriangleCount >= iTrianglesToRemove) {
+                break;
+            }
+            if (vIsTouched[collapse.iFrom] || vIsTouched[collapse.iTo] ||
+                isCollapseFlippingTriangles(collapse.iFrom, collapse.iTo)) {
+                continue;
+            }
+
+            vCollapseTargets[collapse.iFrom] = collapse.iTo;
+            vQuadrics[collapse.iTo] += vQuadrics[collapse.iFrom];
+            maxAppliedErrorSquared = std::max(maxAppliedErrorSquared, collapse.errorSquared);
+            iRemovedTriangleCount += 2;
+
+            // Changed triangles should not be changed again during this pass.
+            for (auto i = vTriangleOffsets[collapse.iFrom]; i < vTriangleOffsets[collapse.iFrom + 1]; i++) {
+                const auto* const pTriangle = &vResult[static_cast<size_t>(vVertexTriangles[i]) * 3];
+                for (size_t j = 0; j < 3; j++) {
+                    vIsTouched[pTriangle[j]] = true;
+                }
+            }
+        }
+        if (iRemovedTriangleCount == 0) {
+            break;
+        }
+
+        // Move triangles to new vertices and remove degenerate triangles.
+        size_t iWriteIndex = 0;
+        for (size_t i = 0; i < vResult.size(); i += 3) {
+            const auto iA = vCollapseTargets[vResult[i]];
+            const auto iB = vCollapseTargets[vResult[i + 1]];
+            const auto iC = vCollapseTargets[vResult[i + 2]];
+            if (iA == iB || iB == iC || iA == iC) {
+                continue;
+            }
+            vResult[iWriteIndex] = iA;
+            vResult[iWriteIndex + 1] = iB;
+            vResult[iWriteIndex + 2] = iC;
+            iWriteIndex += 3;
+        }
+        vResult.resize(iWriteIndex);
+    }
+
+    resultError = static_cast<float>(std::sqrt(maxAppliedErrorSquared)) / radius;
+
+    return vResult;
+}
+
+std::vector<MeshLod>
+MeshOptimizer::generateLods(std::span<const Vertex> vVertices, std::vector<unsigned int>& vIndices) {
+    std::vector<MeshLod> vLods;
+    vLods.push_back(MeshLod{.iFirstIndex = 0, .iIndexCount = static_cast<unsigned int>(vIndices.size())});
+    if (vIndices.size() / 3 < iMinLodTriangleCount || vIndices.size() % 3 != 0) {
+        return vLods;
+    }
+
+    // Simplify each level from the previous one (faster than from the original mesh), errors of
+    // previous levels are added to the error of the level.
+    std::vector<unsigned int> vPreviousLodIndices = vIndices;
+    float previousLodError = 0.0F;
+    for (const auto maxLodError : vLodMaxErrors) {
+        const auto iTargetIndexCount =
+            static_cast<size_t>(static_cast<float>(vPreviousLodIndices.size() / 3) * lodTriangleRatio) * 3;
+
+        float error = 0.0F;
+        auto vLodIndices = simplify(
+            vVertices, vPreviousLodIndices, iTargetIndexCount, maxLodError - previousLodError, error);
+
+        // Skip levels that are not much simpler (the next level allows a larger error).
+        constexpr float minTriangleReduction = 0.1F;
+        if (static_cast<float>(vLodIndices.size()) >
+            static_cast<float>(vPreviousLodIndices.size()) * (1.0F - minTriangleReduction)) {
+            continue;
+        }
+
+        optimizeVertexCache(vLodIndices, vVertices.size());
+
+        previousLodError += error;
+        vLods.push_back(MeshLod{
+            .iFirstIndex = static_cast<unsigned int>(vIndices.size()),
+            .iIndexCount = static_cast<unsigned int>(vLodIndices.size()),
+            .error = previousLodError});
+        vIndices.insert(vIndices.end(), vLodIndices.begin(), vLodIndices.end());
+
+        vPreviousLodIndices = std::move(vLodIndices);
+    }
+
+    return vLods;
+}
+
+std::vector<MeshCluster>
+MeshOptimizer::buildClusters(std::span<const Vertex> vVertices, std::vector<unsigned int>& vIndices) {
+    std::vector<MeshCluster> vClusters;
+    const auto iTriangleCount = vIndices.size() / 3;
+    if (iTriangleCount < iMinClusteredMeshTriangleCount || vIndices.size() % 3 != 0) {
+        return vClusters;
+    }
+
+    // Prepare triangles that use each vertex (triangles of vertex N are stored
+    // in range [vAdjacencyOffsets[N]; vAdjacencyOffsets[N + 1])).
+    std::vector<unsigned int> vAdjacencyOffsets(vVertices.size() + 1, 0);
+    for (const auto iIndex : vIndices) {
+        vAdjacencyOffsets[iIndex + 1] += 1;
+    }
+    std::partial_sum(vAdjacencyOffsets.begin(), vAdjacencyOffsets.end(), vAdjacencyOffsets.begin());
+    std::vector<unsigned int> vAdjacentTriangles(vIndices.size());
+    {
+        auto vWriteOffsets = vAdjacencyOffsets;
+        for (size_t i = 0; i < vIndices.size(); i++) {
+            vAdjacentTriangles[vWriteOffsets[vIndices[i]]] = static_cast<unsigned int>(i / 3);
+            vWriteOffsets[vIndices[i]] += 1;
+        }
+    }
+
+    std::vector<glm::vec3> vTriangleCenters(iTriangleCount);
+    for (size_t i = 0; i < iTriangleCount; i++) {
+        vTriangleCenters[i] = (vVertices[vIndices[i * 3]].position + vVertices[vIndices[i * 3 + 1]].position +
+                               vVertices[vIndices[i * 3 + 2]].position) /
+                              3.0F;
+    }
+
+    std::vector<unsigned int> vClusteredIndices;
+    vClusteredIndices.reserve(vIndices.size());
+
+    // Calculates bounds of the cluster that has its index range already set.
+    const auto finishCluster = [&](MeshCluster& cluster) {
+        const auto vClusterIndices = std::span<const unsigned int>(vClusteredIndices).subspan(
+            cluster.iFirstIndex, cluster.iIndexCount);
+
+        // Use center of the cluster's AABB as sphere center (close to the optimal one for compact clusters).
+        auto min = glm::vec3(std::numeric_limits<float>::max());
+        auto max = glm::vec3(-std::numeric_limits<float>::max());
+        for (const auto iIndex : vClusterIndices) {
+            min = glm::min(min, vVertices[iIndex].position);
+            max = glm::max(max, vVertices[iIndex].position);
+        }
+        cluster.center = (min + max) * 0.5F; // NOLINT: half
+        for (const auto iIndex : vClusterIndices) {
+            cluster.radius =
+                std::max(cluster.radius, glm::length(vVertices[iIndex].position - cluster.center));
+        }
+
+        // Average normals of triangles (front faces are counter-clockwise).
+        std::vector<glm::vec3> vTriangleNormals;
+        vTriangleNormals.reserve(vClusterIndices.size() / 3);
+        auto normalSum = glm::vec3(0.0F, 0.0F, 0.0F);
+        for (size_t i = 0; i < vClusterIndices.size(); i += 3) {
+            const auto& position0 = vVertices[vClusterIndices[i]].position;
+            const auto normal = glm::cross(
+                vVertices[vClusterIndices[i + 1]].position - position0,
+                vVertices[vClusterIndices[i + 2]].position - position0);
+            const auto length = glm::length(normal);
+            if (length == 0.0F) {
+                continue;
+            }
+            vTriangleNormals.push_back(normal / length);
+            normalSum = normalSum + vTriangleNormals.back();
+        }
+        const auto normalSumLength = glm::length(normalSum);
+        if (normalSumLength == 0.0F) {
+            return;
+        }
+        cluster.coneAxis = normalSum / normalSumLength;
+
+        // Find the widest deviation from the axis, if it's 90 degrees or more the cluster is never culled.
+        float minDot = 1.0F;
+        for (const auto& normal : vTriangleNormals) {
+            minDot = std::min(minDot, glm::dot(normal, cluster.coneAxis));
+        }
+        cluster.coneCutoff = minDot <= 0.0F ? 1.0F : std::sqrt(1.0F - minDot * minDot);
+    };
+
+    // Grow clusters over adjacent triangles (so that clusters are compact), each vertex stores
+    // the number of the last cluster that uses it and each triangle stores the number of the last
+    // cluster that considered adding it.
+    std::vector<bool> vIsTriangleClustered(iTriangleCount, false);
+    std::vector<size_t> vVertexClusterNumbers(vVertices.size(), 0);
+    std::vector<size_t> vTriangleCandidateClusterNumbers(iTriangleCount, 0);
+    std::vector<unsigned int> vClusterTriangles;
+    std::vector<unsigned int> vCandidateTriangles;
+    size_t iSeedTriangle = 0;
+    while (true) {
+        // Start from the first triangle that is not clustered yet (so that clusters roughly keep
+        // the optimized order of triangles).
+        while (iSeedTriangle < iTriangleCount && vIsTriangleClustered[iSeedTriangle]) {
+            iSeedTriangle += 1;
+        }
+        if (iSeedTriangle == iTriangleCount) {
+            break;
+        }
+
+        const auto iClusterNumber = vClusters.size() + 1;
+        const auto seedCenter = vTriangleCenters[iSeedTriangle];
+        size_t iClusterVertexCount = 0;
+        vClusterTriangles.clear();
+        vCandidateTriangles.clear();
+
+        auto iNextTriangle = iSeedTriangle;
+        while (true) {
+            // Add the triangle and remember triangles adjacent to its new vertices.
+            vIsTriangleClustered[iNextTriangle] = true;
+            vClusterTriangles.push_back(static_cast<unsigned int>(iNextTriangle));
+            for (size_t i = 0; i < 3; i++) {
+                const auto iVertex = vIndices[iNextTriangle * 3 + i];
+                if (vVertexClusterNumbers[iVertex] == iClusterNumber) {
+                    continue;
+                }
+                vVertexClusterNumbers[iVertex] = iClusterNumber;
+                iClusterVertexCount += 1;
+                for (auto j = vAdjacencyOffsets[iVertex]; j < vAdjacencyOffsets[iVertex + 1]; j++) {
+                    const auto iTriangle = vAdjacentTriangles[j];
+                    if (!vIsTriangleClustered[iTriangle] &&
+                        vTriangleCandidateClusterNumbers[iTriangle] != iClusterNumber) {
+                        vTriangleCandidateClusterNumbers[iTriangle] = iClusterNumber;
+                        vCandidateTriangles.push_back(iTriangle);
+                    }
+                }
+            }
+            if (vClusterTriangles.size() == iMaxClusterTriangleCount) {
+                break;
+            }
+
+            // Pick the adjacent triangle that adds the least vertices (the closest to the seed on ties).
+            std::optional<size_t> optionalBestTriangle;
+            size_t iBestNewVertexCount = 0;
+            float bestDistance = 0.0F;
+            for (size_t i = 0; i < vCandidateTriangles.size(); i++) {
+                const auto iTriangle = vCandidateTriangles[i];
+                if (vIsTriangleClustered[iTriangle]) {
+                    vCandidateTriangles[i] = vCandidateTriangles.back();
+                    vCandidateTriangles.pop_back();
+                    i -= 1;
+                    continue;
+                }
+
+                // Degenerate triangles might count the same vertex twice which only makes the cluster
+                // a bit smaller.
+                size_t iNewVertexCount = 0;
+                for (size_t j = 0; j < 3; j++) {
+                    if (vVertexClusterNumbers[vIndices[iTriangle * 3 + j]] != iClusterNumber) {
+                        iNewVertexCount += 1;
+                    }
+                }
+                if (iClusterVertexCount + iNewVertexCount > iMaxClusterVertexCount ||
+                    (optionalBestTriangle.has_value() && iNewVertexCount > iBestNewVertexCount)) {
+                    continue;
+                }
+
+                const auto distance = glm::length(vTriangleCenters[iTriangle] - seedCenter);
+                if (!optionalBestTriangle.has_value() || iNewVertexCount < iBestNewVertexCount ||
+                    distance < bestDistance) {
+                    optionalBestTriangle = iTriangle;
+                    iBestNewVertexCount = iNewVertexCount;
+                    bestDistance = distance;
+                }
+            }
+            if (!optionalBestTriangle.has_value()) {
+                break;
+            }
+            iNextTriangle = *optionalBestTriangle;
+        }
+
+        // Keep the optimized order of triangles inside of the cluster.
+        std::ranges::sort(vClusterTriangles);
+
+        MeshCluster cluster;
+        cluster.iFirstIndex = static_cast<unsigned int>(vClusteredIndices.size());
+        cluster.iIndexCount = static_cast<unsigned int>(vClusterTriangles.size() * 3);
+        for (const auto iTriangle : vClusterTriangles) {
+            vClusteredIndices.insert(
+                vClusteredIndices.end(),
+                vIndices.begin() + static_cast<std::ptrdiff_t>(iTriangle) * 3,
+                vIndices.begin() + static_cast<std::ptrdiff_t>(iTriangle) * 3 + 3);
+        }
+        finishCluster(cluster);
+        vClusters.push_back(cluster);
+    }
+
+    vIndices = std::move(vClusteredIndices);
+
+    return vClusters;
+}
+
+unsigned int MeshOptimizer::simulateFifoCache(
+    const unsigned int* pTriangle, std::vector<unsigned int>& vTimestamps, unsigned int& iTimestamp) {
+    unsigned int iMissCount = 0;
+    for (size_t i = 0; i < 3; i++) {
+        auto& iVertexTimestamp = vTimestamps[pTriangle[i]];
+
+        // The vertex was pushed out of the cache if more than cache size vertices were added after it.
+        if (iTimestamp - iVertexTimestamp > iFifoCacheSize) {
+            iVertexTimestamp = iTimestamp;
+            iTimestamp += 1;
+            iMissCount += 1;
+        }
+    }
+    return iMissCount;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <array>
+#include <span>
+
+// Custom.
+#include "Mesh.h"
+
+/**
+ * Provides static functions that reorder triangles and vertices of imported meshes to make the GPU
+ * transform less vertices, shade less hidden pixels and fetch vertices in a more cache-friendly order.
+ *
+ * @remark Does not use OpenGL so can be called from any thread.
+ */
+class MeshOptimizer {
+public:
+    /** Efficiency of the post-transform vertex cache when drawing a mesh. */
+    struct VertexCacheStatistics {
+        /**
+         * Returns average cache miss ratio (transformed vertices per triangle, 0.5 is the best possible
+         * value for large regular grids, 3 is the worst).
+         *
+         * @return ACMR (0 if there are no triangles).
+         */
+        float getAcmr() const;
+
+        /**
+         * Returns average transform to vertex ratio (transformed vertices per vertex, 1 is the best).
+         *
+         * @return ATVR (0 if there are no vertices).
+         */
+        float getAtvr() const;
+
+        /**
+         * Adds counters of the specified statistics (to get statistics of multiple meshes).
+         *
+         * @param other Statistics to add.
+         *
+         * @return This object.
+         */
+        VertexCacheStatistics& operator+=(const VertexCacheStatistics& other);
+
+        /** Number of vertices that were transformed (cache misses). */
+        size_t iTransformedVertexCount = 0;
+
+        /** Number of drawn triangles. */
+        size_t iTriangleCount = 0;
+
+        /** Number of vertices of the mesh. */
+        size_t iVertexCount = 0;
+    };
+
+    MeshOptimizer() = delete;
+
+    /**
+     * Runs all optimizations: @ref optimizeVertexCache, @ref optimizeOverdraw and @ref optimizeVertexFetch.
+     *
+     * @param vVertices Vertices of the mesh (reordered, unused vertices are removed).
+     * @param vIndices  Indices of the triangle list of the mesh (reordered and remapped).
+     */
+    static void optimize(std::vector<Vertex>& vVertices, std::vector<unsigned int>& vIndices);
+
+    /**
+     * Simulates a FIFO post-transform vertex cache to measure how efficiently the mesh can be drawn.
+     *
+     * @param vIndices     Indices of the triangle list of the mesh.
+     * @param iVertexCount Number of vertices of the mesh.
+     *
+     * @return Cache statistics.
+     */
+    static VertexCacheStatistics
+    analyzeVertexCache(std::span<const unsigned int> vIndices, size_t iVertexCount);
+
+    /**
+     * Reorders triangles to reuse recently transformed vertices (Tom Forsyth's linear-speed vertex cache
+     * optimization that simulates an LRU cache).
+     *
+     * @param vIndices     Indices of the triangle list of the mesh.
+     * @param iVertexCount Number of vertices of the mesh.
+     */
+    static void optimizeVertexCache(std::vector<unsigned int>& vIndices, size_t iVertexCount);
+
+    /**
+     * Reorders clusters of triangles (that were produced by @ref optimizeVertexCache) so that clusters
+     * facing outwards are drawn first (to reject more pixels of other clusters using the depth test).
+     *
+     * @param vIndices  Indices of the triangle list of the mesh.
+     * @param vVertices Vertices of the mesh.
+     */
+    static void optimizeOverdraw(std::vector<unsigned int>& vIndices, std::span<const Vertex> vVertices);
+
+    /**
+     * Reorders vertices in the order they are referenced by triangles (so that vertex fetches access
+     * memory mostly sequentially) and removes vertices that are not used.
+     *
+     * @param vVertices Vertices of the mesh.
+     * @param vIndices  Indices of the triangle list of the mesh (remapped).
+     */
+    static void optimizeVertexFetch(std::vector<Vertex>& vVertices, std::vector<unsigned int>& vIndices);
+
+    /**
+     * Reduces the number of triangles by collapsing edges in the order of the smallest quadric error
+     * (vertices are moved to positions of existing vertices so simplified triangles reference the same
+     * vertices).
+     *
+     * @remark Vertices on open borders and attribute seams (vertices that share a position with other
+     * vertices) are never moved so that no holes appear.
+     *
+     * @param vVertices          Vertices of the mesh.
+     * @param vIndices           Indices of the triangle list to simplify.
+     * @param iTargetIndexCount  Index count to stop at (might not be reached).
+     * @param maxError           Maximum allowed deviation relative to the mesh's radius.
+     * @param resultError        Deviation (relative to the mesh's radius) of the simplified mesh.
+     *
+     * @return Indices of the simplified triangle list.
+     */
+    static std::vector<unsigned int> simplify(
+        std::span<const Vertex> vVertices,
+        std::span<const unsigned int> vIndices,
+        size_t iTargetIndexCount,
+        float maxError,
+        float& resultError);
+
+    /**
+     * Generates less detailed levels of the mesh (see @ref simplify) and appends their indices
+     * to the specified indices.
+     *
+     * @param vVertices Vertices of the mesh.
+     * @param vIndices  Indices of the triangle list of the mesh, indices of new levels are appended.
+     *
+     * @return Levels of detail from the most detailed one (the original indices) to the least detailed one.
+     */
+    static std::vector<MeshLod>
+    generateLods(std::span<const Vertex> vVertices, std::vector<unsigned int>& vIndices);
+
+    /**
+     * Splits triangles into clusters of adjacent triangles and calculates bounding spheres and normal
+     * cones of the clusters.
+     *
+     * @remark Triangles are reordered so that each cluster is a range of indices (triangles inside
+     * of a cluster keep their order so the result of @ref optimizeVertexCache is mostly preserved).
+     *
+     * @param vVertices Vertices of the mesh.
+     * @param vIndices  Indices of the triangle list of the mesh (reordered).
+     *
+     * @return Clusters that cover all indices (in order), empty if the mesh is too small to be split.
+     */
+    static std::vector<MeshCluster>
+    buildClusters(std::span<const Vertex> vVertices, std::vector<unsigned int>& vIndices);
+
+    /** Maximum number of levels of detail (including the original mesh) created by @ref generateLods. */
+    static constexpr size_t iMaxLodCount = 5;
+
+    /**
+     * Maximum errors (relative to the mesh's radius) of levels of detail created by @ref generateLods
+     * (for each level except the original one).
+     */
+    static constexpr std::array<float, iMaxLodCount - 1> vLodMaxErrors = {
+        0.005F, 0.01F, 0.025F, 0.05F}; // NOLINT: roughly doubled per level
+
+    /** Part of the previous level's triangles that a level created by @ref generateLods aims at. */
+    static constexpr float lodTriangleRatio = 0.5F;
+
+    /** Meshes with less triangles don't get levels of detail. */
+    static constexpr size_t iMinLodTriangleCount = 256;
+
+    /** Maximum number of triangles in a cluster created by @ref buildClusters. */
+    static constexpr size_t iMaxClusterTriangleCount = 128;
+
+    /** Maximum number of unique vertices in a cluster created by @ref buildClusters. */
+    static constexpr size_t iMaxClusterVertexCount = 64;
+
+    /** Meshes with less triangles are not split into clusters (culled as a whole). */
+    static constexpr size_t iMinClusteredMeshTriangleCount = 1024;
+
+    /** Size of the FIFO cache simulated by @ref analyzeVertexCache and @ref optimizeOverdraw. */
+    static constexpr unsigned int iFifoCacheSize = 16;
+
+    /** Size of the LRU cache simulated by @ref optimizeVertexCache. */
+    static constexpr unsigned int iLruCacheSize = 32;
+
+    /**
+     * Maximum allowed ratio of cache misses of a cluster to cache misses of the whole cache-optimized
+     * region it belongs to (higher values produce smaller clusters and so less overdraw but more
+     * transformed vertices).
+     */
+    static constexpr float overdrawCacheMissThreshold = 1.05F;
+
+private:
+    /**
+     * Simulates drawing a triangle using a FIFO cache.
+     *
+     * @param pTriangle   3 indices of the triangle.
+     * @param vTimestamps Per-vertex time when the vertex was added to the cache.
+     * @param iTimestamp  Current time (incremented on each cache miss).
+     *
+     * @return Number of cache misses.
+     */
+    static unsigned int simulateFifoCache(
+        const unsigned int* pTriangle, std::vector<unsigned int>& vTimestamps, unsigned int& iTimestamp);
+};
@@ -0,0 +1,35 @@
+#include "TextureCache.h"
+
+// Standard.
+#include <algorithm>
+
+std::shared_ptr<Texture> TextureCache::getTexture(
+    const std::filesystem::path& pathToModel,
+    size_t iImageIndex,
+    bool bIsSrgb,
+    const std::function<std::shared_ptr<Texture>()>& loadTexture) {
+    const auto key = std::make_tuple(pathToModel, iImageIndex, bIsSrgb);
+
+    // See if this texture is already loaded.
+    const auto it = loadedTextures.find(key);
+    if (it != loadedTextures.end()) {
+        auto pTexture = it->second.lock();
+        if (pTexture != nullptr) {
+            return pTexture;
+        }
+    }
+
+    // Remove entries of deleted textures.
+    std::erase_if(loadedTextures, [](const auto& item) { return item.second.expired(); });
+
+    // Load texture.
+    auto pTexture = loadTexture();
+    loadedTextures[key] = pTexture;
+
+    return pTexture;
+}
+
+size_t TextureCache::getLoadedTextureCount() const {
+    return static_cast<size_t>(std::ranges::count_if(
+        loadedTextures, [](const auto& item) { return !item.second.expired(); }));
+}
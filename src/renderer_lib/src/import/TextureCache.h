@@ -0,0 +1,50 @@
+#pragma once
+
+// Standard.
+#include <filesystem>
+#include <memory>
+#include <map>
+#include <tuple>
+#include <functional>
+
+// Custom.
+#include "Texture.h"
+
+/**
+ * Keeps track of textures loaded from images of imported models so that an image that is used
+ * by multiple materials (or imported multiple times) is only loaded once.
+ *
+ * @remark The cache does not own textures, a texture is deleted when the last material that uses it
+ * is destroyed.
+ */
+class TextureCache {
+public:
+    /**
+     * Returns a previously loaded texture of the specified image if it's still used,
+     * otherwise loads the texture.
+     *
+     * @param pathToModel   Path to the model file that the image belongs to.
+     * @param iImageIndex   Index of the image in the model.
+     * @param bIsSrgb       Whether the image stores colors in sRGB space or not (the same image might
+     * be loaded in both spaces).
+     * @param loadTexture   Callback to load the texture if it's not in the cache, returns the texture.
+     *
+     * @return Texture.
+     */
+    std::shared_ptr<Texture> getTexture(
+        const std::filesystem::path& pathToModel,
+        size_t iImageIndex,
+        bool bIsSrgb,
+        const std::function<std::shared_ptr<Texture>()>& loadTexture);
+
+    /**
+     * Returns the number of textures that were loaded and are still used.
+     *
+     * @return Texture count.
+     */
+    size_t getLoadedTextureCount() const;
+
+private:
+    /** Pairs of "model path, image index, sRGB" - "loaded texture". */
+    std::map<std::tuple<std::filesystem::path, size_t, bool>, std::weak_ptr<Texture>> loadedTextures;
+};
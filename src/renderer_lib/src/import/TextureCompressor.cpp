@@ -0,0 +1,702 @@
+#include "TextureCompressor.h"
+
+// Standard.
+#include <format>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+// Custom.
+#include "math/MathHelpers.hpp"
+
+/** Pixel with 4 channels of 8 bits. */
+using Rgba8 = std::array<uint8_t, 4>;
+
+/** Pixels of a 4x4 block (rows from top to bottom). */
+using PixelBlock = std::array<Rgba8, 16>; // NOLINT: 4x4 pixels
+
+/** Weights (out of 64) of the second endpoint for 4 bit indices of BC7 blocks. */
+constexpr std::array<int, 16> vBc7Weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/** Size of the magic number, the DDS header and the DX10 header extension in bytes. */
+constexpr size_t iDdsFileHeaderSize = 148;
+
+/** Values of the DXGI format field of DDS files. */
+enum class DxgiFormat : uint32_t {
+    BC4_UNORM = 80,
+    BC5_UNORM = 83,
+    BC7_UNORM = 98,
+    BC7_UNORM_SRGB = 99,
+};
+
+/**
+ * Converts pixels of an image to 8 bit RGBA.
+ *
+ * @param pPixels         Pixels (rows from top to bottom, tightly packed).
+ * @param iWidth          Width of the image.
+ * @param iHeight         Height of the image.
+ * @param iChannelCount   Number of channels (1-4), grayscale is expanded to RGB.
+ * @param iBitsPerChannel Size of one channel: 8 or 16.
+ * @param bFlipVertically Whether rows should be flipped or not.
+ *
+ * @return Converted pixels.
+ */
+inline std::vector<Rgba8> convertToRgba8(
+    const unsigned char* pPixels,
+    int iWidth,
+    int iHeight,
+    int iChannelCount,
+    int iBitsPerChannel,
+    bool bFlipVertically) {
+    const auto iChannelSize = static_cast<size_t>(iBitsPerChannel / 8); // NOLINT
+    const auto iRowSize = static_cast<size_t>(iWidth) * iChannelCount * iChannelSize;
+
+    // Read the most significant byte of a channel.
+    const auto readChannel = [&](const unsigned char* pPixel, int iChannel) -> uint8_t {
+        if (iChannelSize == 1) {
+            return pPixel[iChannel]; // NOLINT: pointer arithmetic
+        }
+        uint16_t iValue = 0;
+        std::memcpy(&iValue, pPixel + iChannel * iChannelSize, sizeof(iValue)); // NOLINT
+        return static_cast<uint8_t>(iValue >> 8U);                           // NOLINT
+    };
+
+    std::vector<Rgba8> vResult(static_cast<size_t>(iWidth) * iHeight);
+    for (size_t y = 0; y < static_cast<size_t>(iHeight); y++) {
+        const auto iSourceRow = bFlipVertically ? static_cast<size_t>(iHeight) - 1 - y : y;
+        const auto* pRow = pPixels + iSourceRow * iRowSize; // NOLINT: pointer arithmetic
+
+        for (size_t x = 0; x < static_cast<size_t>(iWidth); x++) {
+            const auto* pPixel = pRow + x * iChannelCount * iChannelSize; // NOLINT: pointer arithmetic
+            auto& pixel = vResult[y * iWidth + x];
+
+            switch (iChannelCount) {
+            case 1: {
+                const auto iGray = readChannel(pPixel, 0);
+                pixel = {iGray, iGray, iGray, 255}; // NOLINT
+                break;
+            }
+            case 2: {
+                const auto iGray = readChannel(pPixel, 0);
+                pixel = {iGray, iGray, iGray, readChannel(pPixel, 1)};
+                break;
+            }
+            case 3: {
+                pixel = {
+                    readChannel(pPixel, 0), readChannel(pPixel, 1), readChannel(pPixel, 2), 255}; // NOLINT
+                break;
+            }
+            default: {
+                pixel = {
+                    readChannel(pPixel, 0),
+                    readChannel(pPixel, 1),
+                    readChannel(pPixel, 2),
+                    readChannel(pPixel, 3)};
+                break;
+            }
+            }
+        }
+    }
+
+    return vResult;
+}
+
+/**
+ * Creates the next mip level of an image (2x2 box filter).
+ *
+ * @param vPixels Pixels of the current level.
+ * @param iWidth  Width of the current level.
+ * @param iHeight Height of the current level.
+ * @param bIsSrgb Whether RGB channels store sRGB colors (averaged in linear space) or not.
+ *
+ * @return Pixels of the next level.
+ */
+inline std::vector<Rgba8>
+downsample(const std::vector<Rgba8>& vPixels, int iWidth, int iHeight, bool bIsSrgb) {
+    const auto iNewWidth = std::max(iWidth / 2, 1);
+    const auto iNewHeight = std::max(iHeight / 2, 1);
+
+    // Clamp samples for levels with an odd or 1 pixel size.
+    const auto getPixel = [&](int x, int y) -> const Rgba8* {
+        return &vPixels[static_cast<size_t>(std::min(y, iHeight - 1)) * iWidth + std::min(x, iWidth - 1)];
+    };
+
+    std::vector<Rgba8> vResult(static_cast<size_t>(iNewWidth) * iNewHeight);
+    for (int y = 0; y < iNewHeight; y++) {
+        for (int x = 0; x < iNewWidth; x++) {
+            const std::array<const Rgba8*, 4> vSamples = {
+                getPixel(x * 2, y * 2),
+                getPixel(x * 2 + 1, y * 2),
+                getPixel(x * 2, y * 2 + 1),
+                getPixel(x * 2 + 1, y * 2 + 1)};
+
+            auto& pixel = vResult[static_cast<size_t>(y) * iNewWidth + x];
+            for (size_t iChannel = 0; iChannel < pixel.size(); iChannel++) {
+                if (bIsSrgb && iChannel < 3) {
+                    float sum = 0.0F;
+                    for (const auto* pSample : vSamples) {
+                        sum += MathHelpers::srgbToLinear((*pSample)[iChannel]);
+                    }
+                    pixel[iChannel] = MathHelpers::linearToSrgb(sum * 0.25F); // NOLINT: average of 4 samples
+                    continue;
+                }
+
+                int iSum = 2; // round to nearest
+                for (const auto* pSample : vSamples) {
+                    iSum += (*pSample)[iChannel];
+                }
+                pixel[iChannel] = static_cast<uint8_t>(iSum / 4);
+            }
+        }
+    }
+
+    return vResult;
+}
+
+/**
+ * Writes bits to a block (starting from the least significant bit of the first byte).
+ *
+ * @param pBlock      Block to write to (must be zero-initialized).
+ * @param iBitOffset  Offset of the first bit to write, incremented by the bit count.
+ * @param iValue      Value to write.
+ * @param iBitCount   Number of bits of the value to write.
+ */
+inline void writeBits(unsigned char* pBlock, size_t& iBitOffset, uint32_t iValue, size_t iBitCount) {
+    for (size_t i = 0; i < iBitCount; i++) {
+        if (((iValue >> i) & 1U) != 0) {
+            const auto iBit = iBitOffset + i;
+            pBlock[iBit / 8] |= static_cast<unsigned char>(1U << (iBit % 8)); // NOLINT
+        }
+    }
+    iBitOffset += iBitCount;
+}
+
+/** Endpoints and indices of a BC7 mode 6 block. */
+struct Bc7Mode6Block {
+    /** RGBA of the first endpoint (7 bits per channel). */
+    std::array<int, 4> vEndpoint0{};
+
+    /** RGBA of the second endpoint (7 bits per channel). */
+    std::array<int, 4> vEndpoint1{};
+
+    /** Least significant bit of all channels of the first endpoint. */
+    int iPBit0 = 0;
+
+    /** Least significant bit of all channels of the second endpoint. */
+    int iPBit1 = 0;
+
+    /** Index of the interpolated color of each pixel (4 bits). */
+    std::array<int, 16> vIndices{}; // NOLINT: 4x4 pixels
+
+    /** Sum of squared errors of all channels of all pixels. */
+    int64_t iError = std::numeric_limits<int64_t>::max();
+};
+
+/**
+ * Quantizes the specified endpoints to BC7 mode 6 (trying all combinations of p-bits) and assigns
+ * indices to pixels.
+ *
+ * @param vPixels   Pixels of the block.
+ * @param endpoint0 First endpoint (RGBA in range [0; 255]).
+ * @param endpoint1 Second endpoint (RGBA in range [0; 255]).
+ *
+ * @return Block with the smallest error.
+ */
+inline Bc7Mode6Block fitBc7Mode6Block(
+    const PixelBlock& vPixels, const std::array<float, 4>& endpoint0, const std::array<float, 4>& endpoint1) {
+    Bc7Mode6Block bestBlock;
+
+    for (int iPBits = 0; iPBits < 4; iPBits++) {
+        Bc7Mode6Block block;
+        block.iPBit0 = iPBits & 1;
+        block.iPBit1 = iPBits >> 1;
+
+        // Quantize endpoints.
+        std::array<int, 4> vColor0{};
+        std::array<int, 4> vColor1{};
+        for (size_t c = 0; c < 4; c++) {
+            const auto value0 = (endpoint0[c] - static_cast<float>(block.iPBit0)) * 0.5F;
+            const auto value1 = (endpoint1[c] - static_cast<float>(block.iPBit1)) * 0.5F;
+            block.vEndpoint0[c] = std::clamp(static_cast<int>(std::lround(value0)), 0, 127); // NOLINT
+            block.vEndpoint1[c] = std::clamp(static_cast<int>(std::lround(value1)), 0, 127); // NOLINT
+            vColor0[c] = (block.vEndpoint0[c] << 1) | block.iPBit0;
+            vColor1[c] = (block.vEndpoint1[c] << 1) | block.iPBit1;
+        }
+
+        // Interpolate colors the same way as the GPU.
+        std::array<std::array<int, 4>, 16> vPalette{}; // NOLINT: 4 bit indices
+        for (size_t i = 0; i < vPalette.size(); i++) {
+            for (size_t c = 0; c < 4; c++) {
+                vPalette[i][c] =
+                    ((64 - vBc7Weights[i]) * vColor0[c] + vBc7Weights[i] * vColor1[c] + 32) >> 6; // NOLINT
+            }
+        }
+
+        // Project pixels onto the line between endpoints to find the closest colors.
+        std::array<float, 4> direction{};
+        float directionLengthSquared = 0.0F;
+        for (size_t c = 0; c < 4; c++) {
+            direction[c] = static_cast<float>(vColor1[c] - vColor0[c]);
+            directionLengthSquared += direction[c] * direction[c];
+        }
+
+        block.iError = 0;
+        for (size_t iPixel = 0; iPixel < vPixels.size(); iPixel++) {
+            const auto& pixel = vPixels[iPixel];
+
+            int iEstimatedIndex = 0;
+            if (directionLengthSquared > 0.0F) {
+                float projection = 0.0F;
+                for (size_t c = 0; c < 4; c++) {
+                    projection += static_cast<float>(pixel[c] - vColor0[c]) * direction[c];
+                }
+                const auto iIndex = std::lround(projection / directionLengthSquared * 15.0F); // NOLINT
+                iEstimatedIndex = std::clamp(static_cast<int>(iIndex), 0, 15);              // NOLINT
+            }
+
+            // Weights are not uniform so also check neighbours.
+            int64_t iBestError = std::numeric_limits<int64_t>::max();
+            for (int i = std::max(iEstimatedIndex - 1, 0); i <= std::min(iEstimatedIndex + 1, 15); i++) {
+                int64_t iError = 0;
+                for (size_t c = 0; c < 4; c++) {
+                    const auto iDifference = vPalette[i][c] - pixel[c];
+                    iError += iDifference * iDifference;
+                }
+                if (iError < iBestError) {
+                    iBestError = iError;
+                    block.vIndices[iPixel] = i;
+                }
+            }
+            block.iError += iBestError;
+        }
+
+        if (block.iError < bestBlock.iError) {
+            bestBlock = block;
+        }
+    }
+
+    return bestBlock;
+}
+
+/**
+ * Compresses pixels into a BC7 block (mode 6: one subset, RGBA endpoints, 4 bit indices).
+ *
+ * @param vPixels Pixels of the block.
+ * @param pBlock  16 bytes to write the block to.
+ */
+inline void encodeBc7Block(const PixelBlock& vPixels, unsigned char* pBlock) {
+    // Find the average color and the bounding box of colors.
+    std::array<float, 4> mean{};
+    std::array<float, 4> min{255.0F, 255.0F, 255.0F, 255.0F}; // NOLINT
+    std::array<float, 4> max{};
+    for (const auto& pixel : vPixels) {
+        for (size_t c = 0; c < 4; c++) {
+            mean[c] += static_cast<float>(pixel[c]) / static_cast<float>(vPixels.size());
+            min[c] = std::min(min[c], static_cast<float>(pixel[c]));
+            max[c] = std::max(max[c], static_cast<float>(pixel[c]));
+        }
+    }
+
+    // Find the principal axis of colors (power iteration on the covariance matrix starting from
+    // the diagonal of the bounding box).
+    std::array<std::array<float, 4>, 4> covariance{};
+    for (const auto& pixel : vPixels) {
+        for (size_t i = 0; i < 4; i++) {
+            for (size_t j = 0; j < 4; j++) {
+                covariance[i][j] +=
+                    (static_cast<float>(pixel[i]) - mean[i]) * (static_cast<float>(pixel[j]) - mean[j]);
+            }
+        }
+    }
+    std::array<float, 4> axis{};
+    for (size_t c = 0; c < 4; c++) {
+        axis[c] = max[c] - min[c];
+    }
+    constexpr size_t iIterationCount = 8;
+    for (size_t iIteration = 0; iIteration < iIterationCount; iIteration++) {
+        std::array<float, 4> newAxis{};
+        float length = 0.0F;
+        for (size_t i = 0; i < 4; i++) {
+            for (size_t j = 0; j < 4; j++) {
+                newAxis[i] += covariance[i][j] * axis[j];
+            }
+            length += newAxis[i] * newAxis[i];
+        }
+        if (length <= 0.0F) {
+            break;
+        }
+        length = std::sqrt(length);
+        for (size_t i = 0; i < 4; i++) {
+            axis[i] = newAxis[i] / length;
+        }
+    }
+
+    // Use extreme projections of colors on the axis as endpoints (single color if the axis is zero).
+    float axisLengthSquared = 0.0F;
+    for (const auto& value : axis) {
+        axisLengthSquared += value * value;
+    }
+    float minProjection = 0.0F;
+    float maxProjection = 0.0F;
+    if (axisLengthSquared > 0.0F) {
+        minProjection = std::numeric_limits<float>::max();
+        maxProjection = std::numeric_limits<float>::lowest();
+        for (const auto& pixel : vPixels) {
+            float projection = 0.0F;
+            for (size_t c = 0; c < 4; c++) {
+                projection += (static_cast<float>(pixel[c]) - mean[c]) * axis[c] / axisLengthSquared;
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+    }
+    std::array<float, 4> endpoint0{};
+    std::array<float, 4> endpoint1{};
+    for (size_t c = 0; c < 4; c++) {
+        endpoint0[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0F, 255.0F); // NOLINT
+        endpoint1[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0F, 255.0F); // NOLINT
+    }
+    auto block = fitBc7Mode6Block(vPixels, endpoint0, endpoint1);
+
+    // Refine endpoints using least squares for the selected indices.
+    float sumAlphaSquared = 0.0F;
+    float sumAlphaBeta = 0.0F;
+    float sumBetaSquared = 0.0F;
+    std::array<float, 4> sumAlphaColor{};
+    std::array<float, 4> sumBetaColor{};
+    for (size_t iPixel = 0; iPixel < vPixels.size(); iPixel++) {
+        const auto beta = static_cast<float>(vBc7Weights[block.vIndices[iPixel]]) / 64.0F; // NOLINT
+        const auto alpha = 1.0F - beta;
+        sumAlphaSquared += alpha * alpha;
+        sumAlphaBeta += alpha * beta;
+        sumBetaSquared += beta * beta;
+        for (size_t c = 0; c < 4; c++) {
+            sumAlphaColor[c] += alpha * static_cast<float>(vPixels[iPixel][c]);
+            sumBetaColor[c] += beta * static_cast<float>(vPixels[iPixel][c]);
+        }
+    }
+    const auto determinant = sumAlphaSquared * sumBetaSquared - sumAlphaBeta * sumAlphaBeta;
+    if (std::abs(determinant) > 0.0001F) { // NOLINT: all pixels use the same weight
+        for (size_t c = 0; c < 4; c++) {
+            endpoint0[c] = std::clamp(
+                (sumAlphaColor[c] * sumBetaSquared - sumBetaColor[c] * sumAlphaBeta) / determinant,
+                0.0F,
+                255.0F); // NOLINT
+            endpoint1[c] = std::clamp(
+                (sumBetaColor[c] * sumAlphaSquared - sumAlphaColor[c] * sumAlphaBeta) / determinant,
+                0.0F,
+                255.0F); // NOLINT
+        }
+        const auto refinedBlock = fitBc7Mode6Block(vPixels, endpoint0, endpoint1);
+        if (refinedBlock.iError < block.iError) {
+            block = refinedBlock;
+        }
+    }
+
+    // The most significant bit of the first index is not stored (implied to be zero).
+    if (block.vIndices[0] >= 8) { // NOLINT
+        std::swap(block.vEndpoint0, block.vEndpoint1);
+        std::swap(block.iPBit0, block.iPBit1);
+        for (auto& iIndex : block.vIndices) {
+            iIndex = 15 - iIndex; // NOLINT
+        }
+    }
+
+    // Write the block.
+    std::memset(pBlock, 0, 16); // NOLINT: block size
+    size_t iBitOffset = 0;
+    writeBits(pBlock, iBitOffset, 1U << 6U, 7); // NOLINT: mode 6
+    for (size_t c = 0; c < 4; c++) {
+        writeBits(pBlock, iBitOffset, static_cast<uint32_t>(block.vEndpoint0[c]), 7); // NOLINT
+        writeBits(pBlock, iBitOffset, static_cast<uint32_t>(block.vEndpoint1[c]), 7); // NOLINT
+    }
+    writeBits(pBlock, iBitOffset, static_cast<uint32_t>(block.iPBit0), 1);
+    writeBits(pBlock, iBitOffset, static_cast<uint32_t>(block.iPBit1), 1);
+    for (size_t iPixel = 0; iPixel < block.vIndices.size(); iPixel++) {
+        writeBits(pBlock, iBitOffset, static_cast<uint32_t>(block.vIndices[iPixel]), iPixel == 0 ? 3 : 4);
+    }
+}
+
+/**
+ * Compresses one channel of pixels into a BC4 block (8 interpolated values between two endpoints).
+ *
+ * @param vPixels  Pixels of the block.
+ * @param iChannel Channel to compress.
+ * @param pBlock   8 bytes to write the block to.
+ */
+inline void encodeBc4Block(const PixelBlock& vPixels, size_t iChannel, unsigned char* pBlock) {
+    uint8_t iMin = 255; // NOLINT
+    uint8_t iMax = 0;
+    for (const auto& pixel : vPixels) {
+        iMin = std::min(iMin, pixel[iChannel]);
+        iMax = std::max(iMax, pixel[iChannel]);
+    }
+
+    // The first endpoint is larger so that values are interpolated in 7 steps: index 0 is the first endpoint,
+    // index 1 is the second endpoint and indices 2-7 are values in between.
+    uint64_t iIndices = 0;
+    if (iMax > iMin) {
+        for (size_t iPixel = 0; iPixel < vPixels.size(); iPixel++) {
+            const auto iStep = std::lround(
+                static_cast<float>(iMax - vPixels[iPixel][iChannel]) * 7.0F / // NOLINT
+                static_cast<float>(iMax - iMin));
+            const auto iIndex = iStep == 0 ? 0 : (iStep == 7 ? 1 : iStep + 1); // NOLINT
+            iIndices |= static_cast<uint64_t>(iIndex) << (3 * iPixel);
+        }
+    }
+
+    pBlock[0] = iMax;
+    pBlock[1] = iMin;
+    for (size_t i = 0; i < 6; i++) {                                               // NOLINT: 48 bits
+        pBlock[2 + i] = static_cast<unsigned char>((iIndices >> (8 * i)) & 0xFFU); // NOLINT
+    }
+}
+
+/**
+ * Returns size of one block of the specified format.
+ *
+ * @param format Compression format.
+ *
+ * @return Size in bytes.
+ */
+inline size_t getBlockSize(TextureCompressor::Format format) {
+    return format == TextureCompressor::Format::BC4 ? 8 : 16; // NOLINT
+}
+
+/**
+ * Returns size of a mip level of the specified format.
+ *
+ * @param iWidth  Width of the level.
+ * @param iHeight Height of the level.
+ * @param format  Compression format.
+ *
+ * @return Size in bytes.
+ */
+inline size_t getMipLevelSize(int iWidth, int iHeight, TextureCompressor::Format format) {
+    const auto iBlockCount = static_cast<size_t>((iWidth + 3) / 4) * static_cast<size_t>((iHeight + 3) / 4);
+    return iBlockCount * getBlockSize(format);
+}
+
+/**
+ * Compresses pixels of a mip level and appends resulting blocks (rows of blocks from top to bottom).
+ *
+ * @param vPixels  Pixels of the level.
+ * @param iWidth   Width of the level.
+ * @param iHeight  Height of the level.
+ * @param format   Compression format.
+ * @param vOutput  Data to append blocks to.
+ */
+inline void compressMipLevel(
+    const std::vector<Rgba8>& vPixels,
+    int iWidth,
+    int iHeight,
+    TextureCompressor::Format format,
+    std::vector<unsigned char>& vOutput) {
+    const auto iBlockSize = getBlockSize(format);
+    const auto iBlockCountX = (iWidth + 3) / 4;
+    const auto iBlockCountY = (iHeight + 3) / 4;
+    const auto iLevelOffset = vOutput.size();
+    vOutput.resize(iLevelOffset + getMipLevelSize(iWidth, iHeight, format));
+
+    PixelBlock vBlock{};
+    for (int iBlockY = 0; iBlockY < iBlockCountY; iBlockY++) {
+        for (int iBlockX = 0; iBlockX < iBlockCountX; iBlockX++) {
+            // Repeat edge pixels if the level size is not a multiple of the block size.
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    const auto iPixelY = std::min(iBlockY * 4 + y, iHeight - 1);
+                    const auto iPixelX = std::min(iBlockX * 4 + x, iWidth - 1);
+                    vBlock[static_cast<size_t>(y) * 4 + x] =
+                        vPixels[static_cast<size_t>(iPixelY) * iWidth + iPixelX];
+                }
+            }
+
+            const auto iBlockIndex = static_cast<size_t>(iBlockY) * iBlockCountX + iBlockX;
+            auto* const pBlock = vOutput.data() + iLevelOffset + iBlockIndex * iBlockSize; // NOLINT
+            switch (format) {
+            case TextureCompressor::Format::BC7: {
+                encodeBc7Block(vBlock, pBlock);
+                break;
+            }
+            case TextureCompressor::Format::BC5: {
+                encodeBc4Block(vBlock, 0, pBlock);
+                encodeBc4Block(vBlock, 1, pBlock + 8); // NOLINT: second channel block
+                break;
+            }
+            case TextureCompressor::Format::BC5_GREEN_BLUE: {
+                encodeBc4Block(vBlock, 1, pBlock);
+                encodeBc4Block(vBlock, 2, pBlock + 8); // NOLINT: second channel block
+                break;
+            }
+            case TextureCompressor::Format::BC4: {
+                encodeBc4Block(vBlock, 0, pBlock);
+                break;
+            }
+            }
+        }
+    }
+}
+
+TextureCompressor::Format
+TextureCompressor::selectFormat(const std::array<bool, 4>& vTextureUsage, int iChannelCount) {
+    const auto& [bIsDiffuse, bIsNormal, bIsMetallicRoughness, bIsEmission] = vTextureUsage;
+
+    // Keep all channels of colors and of images that are used in multiple ways.
+    if (bIsDiffuse || bIsEmission || (bIsNormal && bIsMetallicRoughness)) {
+        return Format::BC7;
+    }
+
+    if (bIsNormal) {
+        return Format::BC5;
+    }
+
+    if (bIsMetallicRoughness) {
+        // Grayscale images store the same value in all channels.
+        return iChannelCount < 3 ? Format::BC4 : Format::BC5_GREEN_BLUE;
+    }
+
+    return Format::BC7;
+}
+
+std::vector<unsigned char> TextureCompressor::compress(
+    const unsigned char* pPixels,
+    int iWidth,
+    int iHeight,
+    int iChannelCount,
+    int iBitsPerChannel,
+    Format format,
+    bool bIsSrgb,
+    bool bFlipVertically) {
+    // Make sure the image can be compressed.
+    if (iChannelCount < 1 || iChannelCount > 4) [[unlikely]] {
+        throw std::runtime_error(std::format("unsupported image channel count {}", iChannelCount));
+    }
+    if (iBitsPerChannel != 8 && iBitsPerChannel != 16) [[unlikely]] { // NOLINT
+        throw std::runtime_error(std::format("unsupported image bit depth {}", iBitsPerChannel));
+    }
+    if (iWidth <= 0 || iHeight <= 0) [[unlikely]] {
+        throw std::runtime_error(std::format("unsupported image size {}x{}", iWidth, iHeight));
+    }
+    bIsSrgb = bIsSrgb && format == Format::BC7;
+
+    // Compress all mip levels (down to 1x1) after the header.
+    auto vPixels = convertToRgba8(pPixels, iWidth, iHeight, iChannelCount, iBitsPerChannel, bFlipVertically);
+    std::vector<unsigned char> vFileData(iDdsFileHeaderSize);
+    uint32_t iMipLevelCount = 0;
+    for (auto [iLevelWidth, iLevelHeight] = std::pair(iWidth, iHeight);;) {
+        compressMipLevel(vPixels, iLevelWidth, iLevelHeight, format, vFileData);
+        iMipLevelCount += 1;
+
+        if (iLevelWidth == 1 && iLevelHeight == 1) {
+            break;
+        }
+        vPixels = downsample(vPixels, iLevelWidth, iLevelHeight, bIsSrgb);
+        iLevelWidth = std::max(iLevelWidth / 2, 1);
+        iLevelHeight = std::max(iLevelHeight / 2, 1);
+    }
+
+    // Prepare DXGI format.
+    DxgiFormat dxgiFormat = DxgiFormat::BC7_UNORM;
+    switch (format) {
+    case Format::BC7: {
+        dxgiFormat = bIsSrgb ? DxgiFormat::BC7_UNORM_SRGB : DxgiFormat::BC7_UNORM;
+        break;
+    }
+    case Format::BC5:
+    case Format::BC5_GREEN_BLUE: {
+        dxgiFormat = DxgiFormat::BC5_UNORM;
+        break;
+    }
+    case Format::BC4: {
+        dxgiFormat = DxgiFormat::BC4_UNORM;
+        break;
+    }
+    }
+
+    // Write the magic number, DDS header (124 bytes) and DX10 header extension (20 bytes).
+    std::array<uint32_t, iDdsFileHeaderSize / sizeof(uint32_t)> vHeader{};
+    vHeader[0] = 0x20534444;                                                  // NOLINT: "DDS "
+    vHeader[1] = 124;                                                         // NOLINT: header size
+    vHeader[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;                // NOLINT: header flags
+    vHeader[3] = static_cast<uint32_t>(iHeight);                              // NOLINT
+    vHeader[4] = static_cast<uint32_t>(iWidth);                               // NOLINT
+    vHeader[5] = static_cast<uint32_t>(getMipLevelSize(iWidth, iHeight, format)); // NOLINT: linear size
+    vHeader[7] = iMipLevelCount;                                              // NOLINT
+    vHeader[19] = 32;                                                         // NOLINT: pixel format size
+    vHeader[20] = 0x4;                                                        // NOLINT: FourCC is used
+    vHeader[21] = 0x30315844;                                                 // NOLINT: "DX10"
+    vHeader[27] = 0x1000 | 0x400000 | 0x8;                                    // NOLINT: texture, mipmaps
+    vHeader[32] = static_cast<uint32_t>(dxgiFormat);                          // NOLINT
+    vHeader[33] = 3;                                                          // NOLINT: 2D texture
+    vHeader[35] = 1;                                                          // NOLINT: array size
+    std::memcpy(vFileData.data(), vHeader.data(), iDdsFileHeaderSize);
+
+    return vFileData;
+}
+
+std::optional<TextureCompressor::CompressedImage>
+TextureCompressor::readDds(std::span<const unsigned char> vFileData) {
+    if (vFileData.size() < iDdsFileHeaderSize) {
+        return {};
+    }
+    std::array<uint32_t, iDdsFileHeaderSize / sizeof(uint32_t)> vHeader{};
+    std::memcpy(vHeader.data(), vFileData.data(), iDdsFileHeaderSize);
+
+    // Make sure this is a 2D texture with a DX10 header.
+    if (vHeader[0] != 0x20534444 || vHeader[1] != 124 || vHeader[21] != 0x30315844 || // NOLINT
+        vHeader[33] != 3 || vHeader[35] != 1) {                                        // NOLINT
+        return {};
+    }
+
+    CompressedImage image;
+    image.iHeight = static_cast<int>(vHeader[3]);
+    image.iWidth = static_cast<int>(vHeader[4]);
+    if (image.iWidth <= 0 || image.iHeight <= 0) {
+        return {};
+    }
+
+    switch (static_cast<DxgiFormat>(vHeader[32])) { // NOLINT
+    case DxgiFormat::BC4_UNORM: {
+        image.blockFormat = Format::BC4;
+        break;
+    }
+    case DxgiFormat::BC5_UNORM: {
+        image.blockFormat = Format::BC5;
+        break;
+    }
+    case DxgiFormat::BC7_UNORM: {
+        image.blockFormat = Format::BC7;
+        break;
+    }
+    case DxgiFormat::BC7_UNORM_SRGB: {
+        image.blockFormat = Format::BC7;
+        image.bIsSrgb = true;
+        break;
+    }
+    default: {
+        return {};
+    }
+    }
+
+    // Find mip levels (stored one after another).
+    const auto iMipLevelCount = std::max(vHeader[7], 1U); // NOLINT
+    size_t iOffset = iDdsFileHeaderSize;
+    for (uint32_t i = 0; i < iMipLevelCount; i++) {
+        const auto iLevelWidth = std::max(image.iWidth >> i, 1);
+        const auto iLevelHeight = std::max(image.iHeight >> i, 1);
+        const auto iLevelSize = getMipLevelSize(iLevelWidth, iLevelHeight, image.blockFormat);
+        if (iLevelSize > vFileData.size() - iOffset) {
+            return {};
+        }
+        image.vMipLevels.push_back(vFileData.subspan(iOffset, iLevelSize));
+        iOffset += iLevelSize;
+
+        if (iLevelWidth == 1 && iLevelHeight == 1) {
+            break;
+        }
+    }
+
+    return image;
+}
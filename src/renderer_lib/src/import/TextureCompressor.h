@@ -0,0 +1,104 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <array>
+#include <span>
+#include <optional>
+#include <cstdint>
+
+/**
+ * Provides static functions for compressing images into GPU block-compressed formats (on the CPU, at
+ * import time) and for storing them with precomputed mipmaps in DDS containers.
+ */
+class TextureCompressor {
+public:
+    /** Block compression format, defines which channels of the source image are stored. */
+    enum class Format : uint32_t {
+        /** RGBA in 16 byte blocks (BC7 mode 6), used for color textures. */
+        BC7,
+
+        /** Red and green channels in 16 byte blocks, used for normal maps (Z is reconstructed in shaders). */
+        BC5,
+
+        /**
+         * Green and blue channels (roughness and metallic) stored as red and green channels of BC5 blocks,
+         * sampled as green and blue using texture swizzle.
+         */
+        BC5_GREEN_BLUE,
+
+        /** Red channel in 8 byte blocks, used for grayscale images that don't store colors. */
+        BC4,
+    };
+
+    /** Block-compressed image with mipmaps that points into the contents of a DDS file. */
+    struct CompressedImage {
+        /** Format of blocks (@ref Format::BC7, @ref Format::BC5 or @ref Format::BC4). */
+        Format blockFormat = Format::BC7;
+
+        /** Whether mipmaps were generated from sRGB colors or not. */
+        bool bIsSrgb = false;
+
+        /** Width of the most detailed mip level. */
+        int iWidth = 0;
+
+        /** Height of the most detailed mip level. */
+        int iHeight = 0;
+
+        /** Blocks of each mip level (starting from the most detailed level). */
+        std::vector<std::span<const unsigned char>> vMipLevels;
+    };
+
+    TextureCompressor() = delete;
+
+    /**
+     * Selects a compression format for an image depending on how materials use it.
+     *
+     * @param vTextureUsage Whether the image is used as a diffuse, normal, metallic-roughness and emission
+     * texture or not.
+     * @param iChannelCount Number of channels of the image (1-4).
+     *
+     * @return Compression format.
+     */
+    static Format selectFormat(const std::array<bool, 4>& vTextureUsage, int iChannelCount);
+
+    /**
+     * Generates mipmaps of the specified image, compresses them and stores them in a DDS container.
+     *
+     * @remark Does not use OpenGL so can be called from any thread.
+     *
+     * @param pPixels          Pixels (rows from top to bottom, tightly packed).
+     * @param iWidth           Width of the image.
+     * @param iHeight          Height of the image.
+     * @param iChannelCount    Number of channels (1-4), grayscale images are expanded to RGB.
+     * @param iBitsPerChannel  Size of one channel: 8 or 16 (16 bit channels are stored as 8 bit).
+     * @param format           Compression format.
+     * @param bIsSrgb          Whether the image stores sRGB colors (averaged in linear space when
+     * generating mipmaps) or not.
+     * @param bFlipVertically  Whether rows of the image should be flipped or not.
+     *
+     * @return Contents of the DDS file.
+     */
+    static std::vector<unsigned char> compress(
+        const unsigned char* pPixels,
+        int iWidth,
+        int iHeight,
+        int iChannelCount,
+        int iBitsPerChannel,
+        Format format,
+        bool bIsSrgb,
+        bool bFlipVertically);
+
+    /**
+     * Reads a DDS file written by @ref compress.
+     *
+     * @param vFileData Contents of the DDS file.
+     *
+     * @return Empty if the file is corrupted or stores an unsupported format, otherwise image that points
+     * into the specified data.
+     */
+    static std::optional<CompressedImage> readDds(std::span<const unsigned char> vFileData);
+
+    /** Whether images of imported models should be compressed or uploaded as is. */
+    static inline bool bIsEnabled = true;
+};
@@ -3,135 +3,592 @@
 // Standard.
 #include <format>
 #include <array>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <future>
+#include <exception>
 
 // Custom.
 #include "window/GLFW.hpp"
+#include "Texture.h"
+#include "io/MappedFile.h"
+#include "io/FileHelpers.h"
+#include "math/MathHelpers.hpp"
+#include "threading/ThreadPool.h"
 
 // External.
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
+#include "xxHash/xxhash.h"
 
 bool TextureImporter::bFlipTexturesVertically = false;
 
-unsigned int TextureImporter::loadTexture(const std::filesystem::path& pathToImage, bool bIsDiffuseTexture) {
+/** Number of faces of a cubemap. */
+static constexpr size_t iCubemapFaceCount = 6;
+
+/** Number of channels of cubemap pixels (RGB). */
+static constexpr size_t iCubemapChannelCount = 3;
+
+/** Identifies prepacked cubemap files. */
+static constexpr std::array<char, 8> vPackedCubemapMagic = {'C', 'U', 'B', 'E', 'M', 'A', 'P', '\0'};
+
+/**
+ * Header of a prepacked cubemap file, followed by pixels of faces of all mip levels (from the most detailed
+ * level, faces in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i`, sRGB, 3 channels, tightly packed).
+ */
+struct PackedCubemapHeader {
+    /** Identifies the file type. */
+    std::array<char, 8> vMagic{};
+
+    /** Equal to @ref TextureImporter::iPackedCubemapFormatVersion of the app that wrote the file. */
+    uint32_t iFormatVersion = 0;
+
+    /** Width and height of each face of the most detailed level. */
+    int32_t iSize = 0;
+
+    /** Number of mip levels (the last one is 1x1). */
+    int32_t iLevelCount = 0;
+
+    /** Unused. */
+    uint32_t iPadding = 0;
+};
+
+/**
+ * Generates mipmaps of a cubemap face (texels are averaged in linear space).
+ *
+ * @param pPixels Decoded sRGB pixels (3 channels) of the face.
+ * @param iSize   Width and height of the face.
+ *
+ * @return Pixels of all levels of the face one after another (down to 1x1).
+ */
+static std::vector<unsigned char> generateCubemapFaceMipmaps(const unsigned char* pPixels, int iSize) {
+    // Copy the most detailed level.
+    const auto iLevelCount = static_cast<int>(std::bit_width(static_cast<unsigned int>(iSize)));
+    size_t iTotalSize = 0;
+    for (int iLevel = 0; iLevel < iLevelCount; iLevel++) {
+        const auto iLevelSize = static_cast<size_t>(std::max(iSize >> iLevel, 1));
+        iTotalSize += iLevelSize * iLevelSize * iCubemapChannelCount;
+    }
+    std::vector<unsigned char> vPixels(iTotalSize);
+    const auto iBaseSize = static_cast<size_t>(iSize) * iSize * iCubemapChannelCount;
+    std::memcpy(vPixels.data(), pPixels, iBaseSize);
+
+    // Keep linear values of the previous level to not lose precision between levels.
+    std::vector<float> vLinear(iBaseSize);
+    for (size_t i = 0; i < iBaseSize; i++) {
+        vLinear[i] = MathHelpers::srgbToLinear(pPixels[i]);
+    }
+
+    size_t iLevelOffset = iBaseSize;
+    int iPreviousSize = iSize;
+    for (int iLevel = 1; iLevel < iLevelCount; iLevel++) {
+        const auto iLevelSize = std::max(iSize >> iLevel, 1);
+        std::vector<float> vLevelLinear(static_cast<size_t>(iLevelSize) * iLevelSize * iCubemapChannelCount);
+
+        for (int iY = 0; iY < iLevelSize; iY++) {
+            // Texels of odd-sized levels are clamped to the last row/column.
+            const auto iY0 = static_cast<size_t>(iY * 2);
+            const auto iY1 = static_cast<size_t>(std::min(iY * 2 + 1, iPreviousSize - 1));
+            for (int iX = 0; iX < iLevelSize; iX++) {
+                const auto iX0 = static_cast<size_t>(iX * 2);
+                const auto iX1 = static_cast<size_t>(std::min(iX * 2 + 1, iPreviousSize - 1));
+                const auto iTexel = static_cast<size_t>(iY) * iLevelSize + static_cast<size_t>(iX);
+
+                for (size_t iChannel = 0; iChannel < iCubemapChannelCount; iChannel++) {
+                    const auto getPrevious = [&](size_t iPreviousX, size_t iPreviousY) {
+                        const auto iPreviousTexel = iPreviousY * iPreviousSize + iPreviousX;
+                        return vLinear[iPreviousTexel * iCubemapChannelCount + iChannel];
+                    };
+                    const auto linear = (getPrevious(iX0, iY0) + getPrevious(iX1, iY0) +
+                                         getPrevious(iX0, iY1) + getPrevious(iX1, iY1)) *
+                                        0.25F; // NOLINT
+                    vLevelLinear[iTexel * iCubemapChannelCount + iChannel] = linear;
+
+                    // Convert back to sRGB.
+                    vPixels[iLevelOffset + iTexel * iCubemapChannelCount + iChannel] =
+                        MathHelpers::linearToSrgb(linear);
+                }
+            }
+        }
+
+        iLevelOffset += vLevelLinear.size();
+        iPreviousSize = iLevelSize;
+        vLinear = std::move(vLevelLinear);
+    }
+
+    return vPixels;
+}
+
+std::shared_ptr<Texture> TextureImporter::loadTexture(
+    const std::filesystem::path& pathToImage, bool bIsDiffuseTexture, TextureUploader* pTextureUploader) {
     // Make sure the specified path exists.
     if (!std::filesystem::exists(pathToImage)) [[unlikely]] {
         throw std::runtime_error(
             std::format("the specified path \"{}\" does not exists", pathToImage.string()));
     }
 
-    // Prepare image format.
-    const auto iStbiFormat = STBI_rgb;
-    const auto iGlFormat = GL_RGB;
-
     // Flip images vertically when loading.
     stbi_set_flip_vertically_on_load(static_cast<int>(bFlipTexturesVertically));
 
-    // Load image pixels.
+    // Load image pixels (freed once they are uploaded).
     int iWidth = 0;
     int iHeight = 0;
     int iChannels = 0;
-    const auto pPixels = stbi_load(pathToImage.string().c_str(), &iWidth, &iHeight, &iChannels, iStbiFormat);
+    const auto pPixels = std::shared_ptr<unsigned char>(
+        stbi_load(pathToImage.string().c_str(), &iWidth, &iHeight, &iChannels, STBI_rgb), stbi_image_free);
     if (pPixels == nullptr) [[unlikely]] {
         throw std::runtime_error(std::format("failed to load image from path \"{}\"", pathToImage.string()));
     }
 
+    // Create texture.
+    return uploadTexture(
+        pPixels.get(),
+        iWidth,
+        iHeight,
+        3, // NOLINT: RGB
+        8, // NOLINT: 8 bits per channel
+        bIsDiffuseTexture,
+        pPixels,
+        pTextureUploader,
+        nullptr);
+}
+
+TextureImporter::DecodedImage
+TextureImporter::decodeImage(const unsigned char* pEncodedImage, size_t iSizeInBytes) {
+    const auto iSize = static_cast<int>(iSizeInBytes);
+
+    // Rows are flipped (if needed) when the texture is created.
+    stbi_set_flip_vertically_on_load_thread(0);
+
+    // Keep 16 bit images as is.
+    DecodedImage image;
+    const auto bIs16Bit = stbi_is_16_bit_from_memory(pEncodedImage, iSize) != 0;
+    image.iBitsPerChannel = bIs16Bit ? 16 : 8; // NOLINT
+
+    // Decode pixels in the number of channels that the image has.
+    void* pPixels = nullptr;
+    if (bIs16Bit) {
+        pPixels = stbi_load_16_from_memory(
+            pEncodedImage, iSize, &image.iWidth, &image.iHeight, &image.iChannelCount, 0);
+    } else {
+        pPixels = stbi_load_from_memory(
+            pEncodedImage, iSize, &image.iWidth, &image.iHeight, &image.iChannelCount, 0);
+    }
+    if (pPixels == nullptr) [[unlikely]] {
+        throw std::runtime_error(std::format("failed to decode image, error: {}", stbi_failure_reason()));
+    }
+
+    // Copy pixels.
+    const auto iPixelsSize = static_cast<size_t>(image.iWidth) * image.iHeight * image.iChannelCount *
+                             (image.iBitsPerChannel / 8); // NOLINT
+    image.vPixels.resize(iPixelsSize);
+    std::memcpy(image.vPixels.data(), pPixels, iPixelsSize);
+
+    // Free pixels.
+    stbi_image_free(pPixels);
+
+    return image;
+}
+
+std::shared_ptr<Texture> TextureImporter::loadTextureFromPixels(
+    const unsigned char* pPixels,
+    int iWidth,
+    int iHeight,
+    int iChannelCount,
+    int iBitsPerChannel,
+    bool bIsDiffuseTexture,
+    std::shared_ptr<const void> pPixelsOwner,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer) {
+    if (!bFlipTexturesVertically) {
+        return uploadTexture(
+            pPixels,
+            iWidth,
+            iHeight,
+            iChannelCount,
+            iBitsPerChannel,
+            bIsDiffuseTexture,
+            std::move(pPixelsOwner),
+            pTextureUploader,
+            pTextureStreamer);
+    }
+
+    // Flip rows.
+    const auto iRowSize = static_cast<size_t>(iWidth) * iChannelCount * (iBitsPerChannel / 8); // NOLINT
+    auto pFlippedPixels = std::make_shared<std::vector<unsigned char>>(iRowSize * iHeight);
+    for (size_t iRow = 0; iRow < static_cast<size_t>(iHeight); iRow++) {
+        std::memcpy(
+            pFlippedPixels->data() + (iHeight - 1 - iRow) * iRowSize,
+            pPixels + iRow * iRowSize, // NOLINT: pointer arithmetic
+            iRowSize);
+    }
+
+    return uploadTexture(
+        pFlippedPixels->data(),
+        iWidth,
+        iHeight,
+        iChannelCount,
+        iBitsPerChannel,
+        bIsDiffuseTexture,
+        pFlippedPixels,
+        pTextureUploader,
+        pTextureStreamer);
+}
+
+std::shared_ptr<Texture> TextureImporter::loadCompressedTexture(
+    std::span<const unsigned char> vDdsFile,
+    TextureCompressor::Format format,
+    bool bIsDiffuseTexture,
+    std::shared_ptr<const void> pFileOwner,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer) {
+    // Make sure the file stores blocks of the expected format.
+    const auto optionalImage = TextureCompressor::readDds(vDdsFile);
+    const auto blockFormat =
+        format == TextureCompressor::Format::BC5_GREEN_BLUE ? TextureCompressor::Format::BC5 : format;
+    if (!optionalImage.has_value() || optionalImage->blockFormat != blockFormat) [[unlikely]] {
+        throw std::runtime_error("failed to read compressed image");
+    }
+    const auto& image = *optionalImage;
+
+    // Prepare internal format.
+    int iInternalFormat = 0;
+    switch (format) {
+    case TextureCompressor::Format::BC7: {
+        // Same as for uncompressed diffuse textures, colors are converted to linear space when sampled.
+        iInternalFormat =
+            bIsDiffuseTexture ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        break;
+    }
+    case TextureCompressor::Format::BC5:
+    case TextureCompressor::Format::BC5_GREEN_BLUE: {
+        iInternalFormat = GL_COMPRESSED_RG_RGTC2;
+        break;
+    }
+    case TextureCompressor::Format::BC4: {
+        iInternalFormat = GL_COMPRESSED_RED_RGTC1;
+        break;
+    }
+    }
+
+    // Sample stored channels where the shaders expect them.
+    TextureStreamer::TextureSource source;
+    source.iInternalFormat = iInternalFormat;
+    if (format == TextureCompressor::Format::BC5_GREEN_BLUE) {
+        source.vSwizzle = {GL_ZERO, GL_RED, GL_GREEN, GL_ONE};
+    } else if (format == TextureCompressor::Format::BC4) {
+        source.vSwizzle = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    }
+
+    // Prepare blocks of all mip levels (mipmaps were generated during the import).
+    auto& data = source.data;
+    data.iFormat = iInternalFormat;
+    data.bIsCompressed = true;
+    data.pDataOwner = std::move(pFileOwner);
+    for (size_t iLevel = 0; iLevel < image.vMipLevels.size(); iLevel++) {
+        data.vLevels.push_back(TextureUploader::Level{
+            .iTarget = GL_TEXTURE_2D,
+            .iLevel = static_cast<int>(iLevel),
+            .iWidth = std::max(image.iWidth >> iLevel, 1),
+            .iHeight = std::max(image.iHeight >> iLevel, 1),
+            .vData = image.vMipLevels[iLevel]});
+    }
+
+    // Load detailed levels once they are needed.
+    if (pTextureStreamer != nullptr) {
+        return pTextureStreamer->createTexture(std::move(source), pTextureUploader);
+    }
+
     // Create a new texture object.
     unsigned int iTextureId = 0;
     glGenTextures(1, &iTextureId);
+    auto pTexture = Texture::create(iTextureId);
 
-    // Bind texture to texture target to update its data.
+    // Allocate all mip levels.
     glBindTexture(GL_TEXTURE_2D, iTextureId);
-
-    // Copy pixels to the texture.
-    glTexImage2D(
+    glTexStorage2D(
         GL_TEXTURE_2D,
-        0,
-        bIsDiffuseTexture
-            ? GL_SRGB    // Specifying `SRGB` so that OpenGL will correct the colors
-            : iGlFormat, // to linear-space as soon as we use them to avoid applying gamma correction twice.
-        iWidth,
-        iHeight,
-        0,
-        iGlFormat,
-        GL_UNSIGNED_BYTE,
-        pPixels);
+        static_cast<int>(image.vMipLevels.size()),
+        iInternalFormat,
+        image.iWidth,
+        image.iHeight);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, source.vSwizzle.data());
 
-    // Generate mipmaps.
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Copy blocks of all mip levels.
+    TextureUploader::submit(pTexture, std::move(data), pTextureUploader);
 
-    // Free pixels.
-    stbi_image_free(pPixels);
+    return pTexture;
+}
+
+std::shared_ptr<Texture> TextureImporter::uploadTexture(
+    const unsigned char* pPixels,
+    int iWidth,
+    int iHeight,
+    int iChannelCount,
+    int iBitsPerChannel,
+    bool bIsDiffuseTexture,
+    std::shared_ptr<const void> pPixelsOwner,
+    TextureUploader* pTextureUploader,
+    TextureStreamer* pTextureStreamer) {
+    // Make sure the channel count is valid.
+    if (iChannelCount < 1 || iChannelCount > 4) [[unlikely]] {
+        throw std::runtime_error(std::format("unsupported image channel count {}", iChannelCount));
+    }
+    const auto iChannelIndex = static_cast<size_t>(iChannelCount - 1);
+
+    // Prepare pixel format.
+    constexpr std::array<int, 4> vPixelFormats = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    const auto iPixelFormat = vPixelFormats[iChannelIndex];
 
-    return iTextureId;
+    // Prepare pixel type and internal formats depending on the bit depth.
+    int iPixelType = 0;
+    std::array<int, 4> vInternalFormats{};
+    if (iBitsPerChannel == 8) { // NOLINT
+        iPixelType = GL_UNSIGNED_BYTE;
+        vInternalFormats = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    } else if (iBitsPerChannel == 16) { // NOLINT
+        iPixelType = GL_UNSIGNED_SHORT;
+        vInternalFormats = {GL_R16, GL_RG16, GL_RGB16, GL_RGBA16};
+    } else if (iBitsPerChannel == 32) { // NOLINT
+        iPixelType = GL_FLOAT;
+        vInternalFormats = {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F};
+    } else [[unlikely]] {
+        throw std::runtime_error(std::format("unsupported image bit depth {}", iBitsPerChannel));
+    }
+
+    if (bIsDiffuseTexture) {
+        // Specifying `SRGB` so that OpenGL will correct the colors to linear-space as soon as we use them
+        // to avoid applying gamma correction twice (there are no 1/2 channel sRGB formats so use 3/4).
+        vInternalFormats = {GL_SRGB8, GL_SRGB8_ALPHA8, GL_SRGB8, GL_SRGB8_ALPHA8};
+    }
+    const auto iInternalFormat = vInternalFormats[iChannelIndex];
+
+    // Create a new texture object.
+    unsigned int iTextureId = 0;
+    glGenTextures(1, &iTextureId);
+    auto pTexture = Texture::create(iTextureId);
+
+    // Allocate immutable storage for all mip levels (pixels are uploaded later so that bindless handles
+    // can be created right away).
+    glBindTexture(GL_TEXTURE_2D, iTextureId);
+    const auto iMipLevelCount = std::bit_width(static_cast<unsigned int>(std::max(iWidth, iHeight)));
+    glTexStorage2D(GL_TEXTURE_2D, iMipLevelCount, iInternalFormat, iWidth, iHeight);
+
+    // Make grayscale images to be sampled as RGB (as if they were loaded as RGB).
+    std::array<int, 4> vSwizzle = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+    if (iChannelCount == 1) {
+        vSwizzle = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    } else if (iChannelCount == 2) {
+        vSwizzle = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+    }
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, vSwizzle.data());
+
+    // Copy pixels and then generate mipmaps.
+    const auto iPixelsSize =
+        static_cast<size_t>(iWidth) * iHeight * iChannelCount * (iBitsPerChannel / 8); // NOLINT
+    TextureUploader::TextureData data;
+    data.iFormat = iPixelFormat;
+    data.iType = iPixelType;
+    data.bGenerateMipmaps = true;
+    data.pDataOwner = std::move(pPixelsOwner);
+    data.vLevels.push_back(TextureUploader::Level{
+        .iTarget = GL_TEXTURE_2D,
+        .iLevel = 0,
+        .iWidth = iWidth,
+        .iHeight = iHeight,
+        .vData = std::span<const unsigned char>(pPixels, iPixelsSize)});
+
+    // Track used memory (sRGB formats of grayscale images store 3 or 4 channels).
+    if (pTextureStreamer != nullptr) {
+        const auto iStoredChannelCount = bIsDiffuseTexture ? std::max(iChannelCount, 3) : iChannelCount;
+        const auto iBytesPerTexel =
+            static_cast<size_t>(iStoredChannelCount * (iBitsPerChannel / 8)); // NOLINT
+        pTextureStreamer->registerTexture(
+            pTexture, iInternalFormat, vSwizzle, iWidth, iHeight, iBytesPerTexel, data);
+    }
+
+    TextureUploader::submit(pTexture, std::move(data), pTextureUploader);
+
+    return pTexture;
+}
+
+std::span<const unsigned char> TextureImporter::DecodedCubemap::getFace(int iLevel, size_t iFace) const {
+    return vFaces[static_cast<size_t>(iLevel) * iCubemapFaceCount + iFace];
 }
 
-unsigned int TextureImporter::loadCubemap(const std::filesystem::path& pathToImagesDirectory) {
+int TextureImporter::DecodedCubemap::getLevelSize(int iLevel) const { return std::max(iSize >> iLevel, 1); }
+
+std::shared_ptr<TextureImporter::DecodedCubemap>
+TextureImporter::decodeCubemap(const std::filesystem::path& pathToCubemap) {
     // Make sure the specified path exists.
-    if (!std::filesystem::exists(pathToImagesDirectory)) [[unlikely]] {
+    if (!std::filesystem::exists(pathToCubemap)) [[unlikely]] {
         throw std::runtime_error(
-            std::format("the specified path \"{}\" does not exists", pathToImagesDirectory.string()));
+            std::format("the specified path \"{}\" does not exists", pathToCubemap.string()));
     }
 
-    // Make sure the specified path points to a directory.
-    if (!std::filesystem::is_directory(pathToImagesDirectory)) [[unlikely]] {
-        throw std::runtime_error(std::format(
-            "expected the specified path \"{}\" to be a directory", pathToImagesDirectory.string()));
+    // Load prepacked cubemap as is.
+    if (!std::filesystem::is_directory(pathToCubemap)) {
+        auto pCubemap = loadPackedCubemap(pathToCubemap);
+        if (pCubemap == nullptr) [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "expected the specified path \"{}\" to be a directory or a prepacked cubemap file",
+                pathToCubemap.string()));
+        }
+        return pCubemap;
     }
 
-    // Create a new cubemap object.
-    unsigned int iCubemapId = 0;
-    glGenTextures(1, &iCubemapId);
-
-    // Bind texture to texture target to update its data.
-    glBindTexture(GL_TEXTURE_CUBE_MAP, iCubemapId);
+    // Prepare image file names.
+    std::array<std::string, iCubemapFaceCount> vFilenames = {
+        "right.jpg", "left.jpg", "top.jpg", "bottom.jpg", "front.jpg", "back.jpg"};
 
-    // Prepare image format.
-    const auto iStbiFormat = STBI_rgb;
-    const auto iGlFormat = GL_RGB;
+    // Map encoded images and hash them.
+    std::array<std::unique_ptr<MappedFile>, iCubemapFaceCount> vEncodedFaces;
+    const auto pHashState = std::unique_ptr<XXH3_state_t, decltype(&XXH3_freeState)>(
+        XXH3_createState(), &XXH3_freeState);
+    if (pHashState == nullptr) [[unlikely]] {
+        throw std::runtime_error("failed to create a hash state");
+    }
+    XXH3_64bits_reset_withSeed(pHashState.get(), iPackedCubemapFormatVersion);
+    for (size_t i = 0; i < vFilenames.size(); i++) {
+        vEncodedFaces[i] = MappedFile::create(pathToCubemap / vFilenames[i]);
+        const auto data = vEncodedFaces[i]->getData();
+        XXH3_64bits_update(pHashState.get(), data.data(), data.size());
+    }
 
-    // Prepare image file names.
-    std::array<std::string, 6> vFilenames = {// NOLINT: magic number - 6 faces
-                                             "right.jpg",
-                                             "left.jpg",
-                                             "top.jpg",
-                                             "bottom.jpg",
-                                             "front.jpg",
-                                             "back.jpg"};
+    // See if these images were already decoded.
+    const auto pathToCacheFile =
+        pathToCubemapCacheDirectory / std::format("{:016x}.cubemap", XXH3_64bits_digest(pHashState.get()));
+    if (std::filesystem::exists(pathToCacheFile)) {
+        auto pCubemap = loadPackedCubemap(pathToCacheFile);
+        if (pCubemap != nullptr) {
+            return pCubemap;
+        }
+    }
 
+    // Decode faces and generate their mipmaps on worker threads.
+    const auto pFacePixels = std::make_shared<std::array<std::vector<unsigned char>, iCubemapFaceCount>>();
+    std::array<int, iCubemapFaceCount> vFaceSizes{};
+    std::vector<std::future<void>> vTasks;
     for (size_t i = 0; i < vFilenames.size(); i++) {
-        // Prepare to load image pixels.
-        int iWidth = 0;
-        int iHeight = 0;
-        int iChannels = 0;
-        const auto pathToImage = pathToImagesDirectory / vFilenames[i];
-
-        // Load image pixels.
-        const auto pPixels =
-            stbi_load(pathToImage.string().c_str(), &iWidth, &iHeight, &iChannels, iStbiFormat);
-        if (pPixels == nullptr) [[unlikely]] {
-            throw std::runtime_error(
-                std::format("failed to load image from path \"{}\"", pathToImage.string()));
+        vTasks.push_back(ThreadPool::get().addTask([&, i]() {
+            const auto pathToImage = pathToCubemap / vFilenames[i];
+            const auto encodedData = vEncodedFaces[i]->getData();
+
+            // Faces are never flipped.
+            stbi_set_flip_vertically_on_load_thread(0);
+
+            int iFaceWidth = 0;
+            int iFaceHeight = 0;
+            int iChannels = 0;
+            const auto pPixels = std::unique_ptr<unsigned char, decltype(&stbi_image_free)>(
+                stbi_load_from_memory(
+                    encodedData.data(),
+                    static_cast<int>(encodedData.size()),
+                    &iFaceWidth,
+                    &iFaceHeight,
+                    &iChannels,
+                    STBI_rgb),
+                &stbi_image_free);
+            if (pPixels == nullptr) [[unlikely]] {
+                throw std::runtime_error(
+                    std::format("failed to load image from path \"{}\"", pathToImage.string()));
+            }
+
+            // Make sure the face is a square (required by cubemaps).
+            if (iFaceWidth != iFaceHeight) [[unlikely]] {
+                throw std::runtime_error(
+                    std::format("expected the cubemap face \"{}\" to be square", pathToImage.string()));
+            }
+
+            vFaceSizes[i] = iFaceWidth;
+            (*pFacePixels)[i] = generateCubemapFaceMipmaps(pPixels.get(), iFaceWidth);
+        }));
+    }
+
+    // Wait for all tasks before rethrowing an error (tasks reference local variables).
+    std::exception_ptr pError;
+    for (auto& task : vTasks) {
+        try {
+            task.get();
+        } catch (...) {
+            if (pError == nullptr) {
+                pError = std::current_exception();
+            }
         }
+    }
+    if (pError != nullptr) [[unlikely]] {
+        std::rethrow_exception(pError);
+    }
 
-        // Load pixels to one face of the cubemap.
-        glTexImage2D(
-            GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<int>(i),
-            0,
-            GL_SRGB,
-            iWidth,
-            iHeight,
-            0,
-            iGlFormat,
-            GL_UNSIGNED_BYTE,
-            pPixels);
+    // Make sure all faces have the same size (required by immutable storage).
+    for (size_t i = 1; i < vFaceSizes.size(); i++) {
+        if (vFaceSizes[i] != vFaceSizes[0]) [[unlikely]] {
+            throw std::runtime_error(std::format(
+                "expected the image \"{}\" to have the same size as other cubemap faces",
+                (pathToCubemap / vFilenames[i]).string()));
+        }
+    }
 
-        // Free pixels.
-        stbi_image_free(pPixels);
+    // Reference levels of faces.
+    const auto pCubemap = std::make_shared<DecodedCubemap>();
+    pCubemap->iSize = vFaceSizes[0];
+    pCubemap->iLevelCount = static_cast<int>(std::bit_width(static_cast<unsigned int>(pCubemap->iSize)));
+    std::array<size_t, iCubemapFaceCount> vFaceOffsets{};
+    for (int iLevel = 0; iLevel < pCubemap->iLevelCount; iLevel++) {
+        const auto iLevelSize = static_cast<size_t>(pCubemap->getLevelSize(iLevel));
+        const auto iFaceSize = iLevelSize * iLevelSize * iCubemapChannelCount;
+        for (size_t i = 0; i < iCubemapFaceCount; i++) {
+            const auto facePixels = std::span<const unsigned char>((*pFacePixels)[i]);
+            pCubemap->vFaces.push_back(facePixels.subspan(vFaceOffsets[i], iFaceSize));
+            vFaceOffsets[i] += iFaceSize;
+        }
     }
+    pCubemap->pPixelsOwner = pFacePixels;
+
+    savePackedCubemap(*pCubemap, pathToCacheFile);
+
+    return pCubemap;
+}
+
+void TextureImporter::savePackedCubemap(
+    const DecodedCubemap& cubemap, const std::filesystem::path& pathToFile) {
+    PackedCubemapHeader header;
+    header.vMagic = vPackedCubemapMagic;
+    header.iFormatVersion = iPackedCubemapFormatVersion;
+    header.iSize = cubemap.iSize;
+    header.iLevelCount = cubemap.iLevelCount;
+
+    FileHelpers::writeCacheFile(pathToFile, [&header, &cubemap](std::ofstream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT
+        for (const auto& face : cubemap.vFaces) {
+            file.write(
+                reinterpret_cast<const char*>(face.data()), // NOLINT
+                static_cast<std::streamsize>(face.size()));
+        }
+    });
+}
+
+std::shared_ptr<Texture> TextureImporter::loadCubemap(
+    std::shared_ptr<const DecodedCubemap> pDecodedCubemap, TextureUploader* pTextureUploader) {
+    // Create a new cubemap object.
+    unsigned int iCubemapId = 0;
+    glGenTextures(1, &iCubemapId);
+    auto pCubemap = Texture::create(iCubemapId);
+
+    // Allocate immutable storage for all faces of all levels.
+    glBindTexture(GL_TEXTURE_CUBE_MAP, iCubemapId);
+    glTexStorage2D(
+        GL_TEXTURE_CUBE_MAP,
+        pDecodedCubemap->iLevelCount,
+        GL_SRGB8,
+        pDecodedCubemap->iSize,
+        pDecodedCubemap->iSize);
 
     // Set cubemap texture filtering.
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // no mipmaps on cubemap
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(
         GL_TEXTURE_CUBE_MAP,
         GL_TEXTURE_MAG_FILTER,
@@ -143,5 +600,62 @@ unsigned int TextureImporter::loadCubemap(const std::filesystem::path& pathToIma
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    return iCubemapId;
+    // Copy pixels of all faces of all levels.
+    TextureUploader::TextureData data;
+    data.iBindTarget = GL_TEXTURE_CUBE_MAP;
+    data.iFormat = GL_RGB;
+    data.iType = GL_UNSIGNED_BYTE;
+    for (int iLevel = 0; iLevel < pDecodedCubemap->iLevelCount; iLevel++) {
+        const auto iLevelSize = pDecodedCubemap->getLevelSize(iLevel);
+        for (size_t i = 0; i < iCubemapFaceCount; i++) {
+            data.vLevels.push_back(TextureUploader::Level{
+                .iTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<int>(i),
+                .iLevel = iLevel,
+                .iWidth = iLevelSize,
+                .iHeight = iLevelSize,
+                .vData = pDecodedCubemap->getFace(iLevel, i)});
+        }
+    }
+    data.pDataOwner = std::move(pDecodedCubemap);
+    TextureUploader::submit(pCubemap, std::move(data), pTextureUploader);
+
+    return pCubemap;
+}
+
+std::shared_ptr<TextureImporter::DecodedCubemap>
+TextureImporter::loadPackedCubemap(const std::filesystem::path& pathToFile) {
+    const auto pFile = std::shared_ptr<MappedFile>(MappedFile::create(pathToFile));
+    const auto data = pFile->getData();
+
+    // Check header.
+    PackedCubemapHeader header;
+    if (data.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.vMagic != vPackedCubemapMagic || header.iFormatVersion != iPackedCubemapFormatVersion ||
+        header.iSize <= 0 ||
+        header.iLevelCount != static_cast<int>(std::bit_width(static_cast<unsigned int>(header.iSize)))) {
+        return nullptr;
+    }
+
+    // Reference levels of faces.
+    const auto pCubemap = std::make_shared<DecodedCubemap>();
+    pCubemap->iSize = header.iSize;
+    pCubemap->iLevelCount = header.iLevelCount;
+    size_t iOffset = sizeof(header);
+    for (int iLevel = 0; iLevel < pCubemap->iLevelCount; iLevel++) {
+        const auto iLevelSize = static_cast<size_t>(pCubemap->getLevelSize(iLevel));
+        const auto iFaceSize = iLevelSize * iLevelSize * iCubemapChannelCount;
+        for (size_t i = 0; i < iCubemapFaceCount; i++) {
+            if (iFaceSize > data.size() - iOffset) {
+                return nullptr;
+            }
+            pCubemap->vFaces.push_back(data.subspan(iOffset, iFaceSize));
+            iOffset += iFaceSize;
+        }
+    }
+    pCubemap->pPixelsOwner = pFile;
+
+    return pCubemap;
 }
@@ -2,34 +2,242 @@
 
 // Standard.
 #include <filesystem>
+#include <vector>
+#include <array>
+#include <memory>
+#include <span>
+#include <cstdint>
+
+// Custom.
+#include "import/TextureCompressor.h"
+#include "TextureUploader.h"
+#include "TextureStreamer.h"
+
+class Texture;
 
 /** Provides static functions for importing (loading) textures. */
 class TextureImporter {
 public:
+    /** Pixels of a decoded image (not uploaded to the GPU). */
+    struct DecodedImage {
+        /** Pixels (rows from top to bottom, tightly packed), empty if the image was compressed. */
+        std::vector<unsigned char> vPixels;
+
+        /** DDS file with mipmaps compressed by @ref TextureCompressor, empty if not compressed. */
+        std::vector<unsigned char> vCompressedData;
+
+        /** Format of @ref vCompressedData. */
+        TextureCompressor::Format compressedFormat = TextureCompressor::Format::BC7;
+
+        /** Width of the image. */
+        int iWidth = 0;
+
+        /** Height of the image. */
+        int iHeight = 0;
+
+        /** Number of channels (1-4). */
+        int iChannelCount = 0;
+
+        /** Size of one channel: 8 or 16. */
+        int iBitsPerChannel = 0;
+    };
+
+    /** Pixels of decoded cubemap faces with mipmaps (not uploaded to the GPU). */
+    struct DecodedCubemap {
+        /**
+         * Returns pixels of a face of a mip level.
+         *
+         * @param iLevel Index of the mip level.
+         * @param iFace  Index of the face (in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X + i`).
+         *
+         * @return sRGB pixels (3 channels, rows from top to bottom, tightly packed).
+         */
+        std::span<const unsigned char> getFace(int iLevel, size_t iFace) const;
+
+        /**
+         * Returns width and height of faces of a mip level.
+         *
+         * @param iLevel Index of the mip level.
+         *
+         * @return Size of a face.
+         */
+        int getLevelSize(int iLevel) const;
+
+        /** Pixels of faces of all mip levels (faces of a level are stored one after another). */
+        std::vector<std::span<const unsigned char>> vFaces;
+
+        /** Keeps pixels of faces alive (decoded pixels or a mapped prepacked cubemap file). */
+        std::shared_ptr<const void> pPixelsOwner;
+
+        /** Width and height of each face of the most detailed level. */
+        int iSize = 0;
+
+        /** Number of mip levels (the last one is 1x1). */
+        int iLevelCount = 0;
+    };
+
     TextureImporter() = delete;
 
     /**
-     * Loads the specified image and returns its ID.
+     * Decodes an image file (such as PNG or JPEG) that is stored in memory.
+     *
+     * @remark Does not use OpenGL so can be called from any thread.
+     *
+     * @param pEncodedImage Encoded image.
+     * @param iSizeInBytes  Size of the encoded image.
+     *
+     * @return Decoded pixels (in the number of channels that the image has).
+     */
+    static DecodedImage decodeImage(const unsigned char* pEncodedImage, size_t iSizeInBytes);
+
+    /**
+     * Loads the specified image.
      *
      * @remark Expects that OpenGL is initialized.
      *
      * @param pathToImage       Path to the image to load.
      * @param bIsDiffuseTexture Whether this texture is a diffuse texture or not.
+     * @param pTextureUploader  Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     *
+     * @return Loaded texture.
+     */
+    static std::shared_ptr<Texture> loadTexture(
+        const std::filesystem::path& pathToImage, bool bIsDiffuseTexture, TextureUploader* pTextureUploader);
+
+    /**
+     * Creates a texture from the specified decoded pixels.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param pPixels           Pixels (rows from top to bottom, tightly packed).
+     * @param iWidth            Width of the image.
+     * @param iHeight           Height of the image.
+     * @param iChannelCount     Number of channels (1-4).
+     * @param iBitsPerChannel   Size of one channel: 8, 16 or 32 (float).
+     * @param bIsDiffuseTexture Whether this texture is a diffuse texture or not.
+     * @param pPixelsOwner      Keeps pixels alive until they are uploaded.
+     * @param pTextureUploader  Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     * @param pTextureStreamer  Streamer to track used memory of the texture (to downscale it when over
+     * budget), `nullptr` to not track.
+     *
+     * @return Created texture.
+     */
+    static std::shared_ptr<Texture> loadTextureFromPixels(
+        const unsigned char* pPixels,
+        int iWidth,
+        int iHeight,
+        int iChannelCount,
+        int iBitsPerChannel,
+        bool bIsDiffuseTexture,
+        std::shared_ptr<const void> pPixelsOwner,
+        TextureUploader* pTextureUploader,
+        TextureStreamer* pTextureStreamer);
+
+    /**
+     * Creates a texture from mipmaps of a block-compressed image.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param vDdsFile          Contents of a DDS file written by @ref TextureCompressor::compress.
+     * @param format            Format that the image was compressed to.
+     * @param bIsDiffuseTexture Whether this texture is a diffuse texture or not.
+     * @param pFileOwner        Keeps the DDS file alive until it's uploaded.
+     * @param pTextureUploader  Uploader to copy blocks asynchronously, `nullptr` to copy them right away.
+     * @param pTextureStreamer  Streamer to load detailed mip levels once they are needed (the file is then
+     * kept alive while the texture exists), `nullptr` to load all levels right away.
      *
-     * @return Loaded image ID.
+     * @return Created texture.
      */
-    static unsigned int loadTexture(const std::filesystem::path& pathToImage, bool bIsDiffuseTexture);
+    static std::shared_ptr<Texture> loadCompressedTexture(
+        std::span<const unsigned char> vDdsFile,
+        TextureCompressor::Format format,
+        bool bIsDiffuseTexture,
+        std::shared_ptr<const void> pFileOwner,
+        TextureUploader* pTextureUploader,
+        TextureStreamer* pTextureStreamer);
 
     /**
      * Looks into the specified directory with 6 textures named "back", "right", "front", "left", "top",
-     * "bottom" and loads them as one cubemap.
+     * "bottom" and decodes them as faces of one cubemap (or loads a prepacked cubemap file).
+     *
+     * @remark Does not use OpenGL so can be called from any thread.
+     * @remark Faces are decoded (and their mipmaps are generated) on worker threads, the result is cached
+     * as a prepacked cubemap file in @ref pathToCubemapCacheDirectory so that the same images are
+     * decoded only once.
+     *
+     * @param pathToCubemap Path to the directory with images or to a file written by @ref savePackedCubemap.
      *
-     * @param pathToImagesDirectory Path to the directory with images.
+     * @return Decoded faces with mipmaps.
+     */
+    static std::shared_ptr<DecodedCubemap> decodeCubemap(const std::filesystem::path& pathToCubemap);
+
+    /**
+     * Writes faces of all mip levels of a cubemap to a prepacked file which can be loaded by
+     * @ref decodeCubemap without decoding.
+     *
+     * @remark Failures are only logged (see @ref FileHelpers::writeCacheFile).
      *
-     * @return ID of the loaded cubemap.
+     * @param cubemap    Decoded cubemap.
+     * @param pathToFile Path to the file to write.
      */
-    static unsigned int loadCubemap(const std::filesystem::path& pathToImagesDirectory);
+    static void savePackedCubemap(const DecodedCubemap& cubemap, const std::filesystem::path& pathToFile);
+
+    /**
+     * Creates a cubemap from the specified decoded faces.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param pDecodedCubemap  Decoded faces (kept alive until they are uploaded).
+     * @param pTextureUploader Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     *
+     * @return Created cubemap.
+     */
+    static std::shared_ptr<Texture>
+    loadCubemap(std::shared_ptr<const DecodedCubemap> pDecodedCubemap, TextureUploader* pTextureUploader);
 
     /** Whether we need to flip the texture vertically during the import or not. */
     static bool bFlipTexturesVertically;
+
+    /** Directory to store decoded cubemaps in (as prepacked cubemap files). */
+    static inline std::filesystem::path pathToCubemapCacheDirectory =
+        std::filesystem::temp_directory_path() / "opengl-renderer" / "cubemap_cache";
+
+    /** Version of the prepacked cubemap format, increase when the format changes. */
+    static constexpr uint32_t iPackedCubemapFormatVersion = 1;
+
+private:
+    /**
+     * Maps a prepacked cubemap file.
+     *
+     * @param pathToFile Path to a file written by @ref savePackedCubemap.
+     *
+     * @return `nullptr` if the file is not a valid prepacked cubemap of the current format version.
+     */
+    static std::shared_ptr<DecodedCubemap> loadPackedCubemap(const std::filesystem::path& pathToFile);
+
+    /**
+     * Creates a texture with mipmaps from the specified pixels (without flipping them).
+     *
+     * @param pPixels           Pixels (tightly packed).
+     * @param iWidth            Width of the image.
+     * @param iHeight           Height of the image.
+     * @param iChannelCount     Number of channels (1-4).
+     * @param iBitsPerChannel   Size of one channel: 8, 16 or 32 (float).
+     * @param bIsDiffuseTexture Whether this texture is a diffuse texture (stores sRGB colors) or not.
+     * @param pPixelsOwner      Keeps pixels alive until they are uploaded.
+     * @param pTextureUploader  Uploader to copy pixels asynchronously, `nullptr` to copy them right away.
+     * @param pTextureStreamer  Streamer to track used memory of the texture, `nullptr` to not track.
+     *
+     * @return Created texture.
+     */
+    static std::shared_ptr<Texture> uploadTexture(
+        const unsigned char* pPixels,
+        int iWidth,
+        int iHeight,
+        int iChannelCount,
+        int iBitsPerChannel,
+        bool bIsDiffuseTexture,
+        std::shared_ptr<const void> pPixelsOwner,
+        TextureUploader* pTextureUploader,
+        TextureStreamer* pTextureStreamer);
 };
@@ -0,0 +1,75 @@
+#include "FileHelpers.h"
+
+// Standard.
+#include <format>
+#include <thread>
+#include <iostream>
+#include <stdexcept>
+
+// OS.
+#if defined(WIN32)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * Returns a path to a temporary file next to the specified file that is unique for the calling thread
+ * of this process.
+ *
+ * @param pathToFile Path to the file that will be written.
+ *
+ * @return Path to the temporary file.
+ */
+static std::filesystem::path getPathToTemporaryFile(const std::filesystem::path& pathToFile) {
+#if defined(WIN32)
+    const auto iProcessId = static_cast<unsigned long long>(GetCurrentProcessId());
+#else
+    const auto iProcessId = static_cast<unsigned long long>(getpid());
+#endif
+
+    auto pathToTemporaryFile = pathToFile;
+    pathToTemporaryFile += std::format(
+        ".{}.{}.tmp", iProcessId, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    return pathToTemporaryFile;
+}
+
+void FileHelpers::writeCacheFile(
+    const std::filesystem::path& pathToFile, const std::function<void(std::ofstream&)>& write) {
+    const auto pathToTemporaryFile = getPathToTemporaryFile(pathToFile);
+
+    try {
+        if (pathToFile.has_parent_path()) {
+            std::filesystem::create_directories(pathToFile.parent_path());
+        }
+
+        // Write to a temporary file first so that a partially written file is never used.
+        {
+            std::ofstream file(pathToTemporaryFile, std::ios::binary);
+            if (!file.is_open()) [[unlikely]] {
+                throw std::runtime_error(
+                    std::format("failed to create the file \"{}\"", pathToTemporaryFile.string()));
+            }
+
+            write(file);
+
+            file.close();
+            if (file.fail()) [[unlikely]] {
+                throw std::runtime_error(
+                    std::format("failed to write the file \"{}\"", pathToTemporaryFile.string()));
+            }
+        }
+
+        std::filesystem::rename(pathToTemporaryFile, pathToFile);
+    } catch (const std::exception& exception) {
+        // Not critical, the cached data will be generated again next time.
+        std::error_code error;
+        std::filesystem::remove(pathToTemporaryFile, error);
+        std::cerr << std::format(
+                         "failed to write the cache file \"{}\", error: {}",
+                         pathToFile.string(),
+                         exception.what())
+                  << std::endl;
+    }
+}
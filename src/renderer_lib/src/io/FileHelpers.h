@@ -0,0 +1,26 @@
+#pragma once
+
+// Standard.
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+/** Static helper functions for working with files. */
+class FileHelpers {
+public:
+    FileHelpers() = delete;
+
+    /**
+     * Writes a cache file through a temporary file (unique for the calling thread of this process) that
+     * then replaces the specified file so that other threads and processes never see a partially written
+     * file.
+     *
+     * @remark Failures are not critical (the cached data is generated again next time) so they are only
+     * logged.
+     *
+     * @param pathToFile Path to the file to write (missing directories are created).
+     * @param write      Function that writes contents of the file to the specified stream (can throw).
+     */
+    static void
+    writeCacheFile(const std::filesystem::path& pathToFile, const std::function<void(std::ofstream&)>& write);
+};
@@ -0,0 +1,117 @@
+#include "MappedFile.h"
+
+// Standard.
+#include <format>
+#include <stdexcept>
+
+// OS.
+#if defined(WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+#if defined(WIN32)
+    if (pData != nullptr) {
+        UnmapViewOfFile(pData);
+    }
+    if (pMappingHandle != nullptr) {
+        CloseHandle(pMappingHandle);
+    }
+    if (pFileHandle != nullptr) {
+        CloseHandle(pFileHandle);
+    }
+#else
+    if (pData != nullptr) {
+        munmap(const_cast<unsigned char*>(pData), iSizeInBytes);
+    }
+    if (iFileDescriptor != -1) {
+        close(iFileDescriptor);
+    }
+#endif
+}
+
+std::unique_ptr<MappedFile> MappedFile::create(const std::filesystem::path& pathToFile) {
+    auto pFile = std::unique_ptr<MappedFile>(new MappedFile());
+
+#if defined(WIN32)
+    // Open the file.
+    const auto pFileHandle = CreateFileW(
+        pathToFile.wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (pFileHandle == INVALID_HANDLE_VALUE) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "failed to open the file \"{}\", error: {}", pathToFile.string(), GetLastError()));
+    }
+    pFile->pFileHandle = pFileHandle;
+
+    // Get file size.
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(pFileHandle, &size) == 0) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "failed to get size of the file \"{}\", error: {}", pathToFile.string(), GetLastError()));
+    }
+    pFile->iSizeInBytes = static_cast<size_t>(size.QuadPart);
+    if (pFile->iSizeInBytes == 0) {
+        // Empty files can't be mapped.
+        return pFile;
+    }
+
+    // Map the file.
+    pFile->pMappingHandle = CreateFileMappingW(pFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (pFile->pMappingHandle == nullptr) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "failed to create a mapping of the file \"{}\", error: {}", pathToFile.string(), GetLastError()));
+    }
+    pFile->pData =
+        static_cast<const unsigned char*>(MapViewOfFile(pFile->pMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (pFile->pData == nullptr) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "failed to map the file \"{}\", error: {}", pathToFile.string(), GetLastError()));
+    }
+#else
+    // Open the file.
+    pFile->iFileDescriptor = open(pathToFile.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT: vararg
+    if (pFile->iFileDescriptor == -1) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("failed to open the file \"{}\", error: {}", pathToFile.string(), errno));
+    }
+
+    // Get file size.
+    struct stat fileStatus {};
+    if (fstat(pFile->iFileDescriptor, &fileStatus) == -1) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("failed to get size of the file \"{}\", error: {}", pathToFile.string(), errno));
+    }
+    pFile->iSizeInBytes = static_cast<size_t>(fileStatus.st_size);
+    if (pFile->iSizeInBytes == 0) {
+        // Empty files can't be mapped.
+        return pFile;
+    }
+
+    // Map the file.
+    void* pMappedMemory =
+        mmap(nullptr, pFile->iSizeInBytes, PROT_READ, MAP_PRIVATE, pFile->iFileDescriptor, 0);
+    if (pMappedMemory == MAP_FAILED) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("failed to map the file \"{}\", error: {}", pathToFile.string(), errno));
+    }
+    pFile->pData = static_cast<const unsigned char*>(pMappedMemory);
+
+    // We read the file front to back.
+    madvise(pMappedMemory, pFile->iSizeInBytes, MADV_SEQUENTIAL);
+#endif
+
+    return pFile;
+}
+
+std::span<const unsigned char> MappedFile::getData() const { return {pData, iSizeInBytes}; }
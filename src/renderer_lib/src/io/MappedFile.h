@@ -0,0 +1,54 @@
+#pragma once
+
+// Standard.
+#include <filesystem>
+#include <memory>
+#include <span>
+
+/** Read-only view of a file that is mapped into the address space of the process. */
+class MappedFile {
+public:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Unmaps the file. */
+    ~MappedFile();
+
+    /**
+     * Maps the specified file for reading.
+     *
+     * @param pathToFile Path to the file to map.
+     *
+     * @return Mapped file.
+     */
+    static std::unique_ptr<MappedFile> create(const std::filesystem::path& pathToFile);
+
+    /**
+     * Returns contents of the file.
+     *
+     * @remark Returned memory is valid while this object exists.
+     *
+     * @return File contents (empty if the file is empty).
+     */
+    std::span<const unsigned char> getData() const;
+
+private:
+    MappedFile() = default;
+
+    /** Start of the mapped memory (`nullptr` if the file is empty). */
+    const unsigned char* pData = nullptr;
+
+    /** Size of the file in bytes. */
+    size_t iSizeInBytes = 0;
+
+#if defined(WIN32)
+    /** Handle of the opened file. */
+    void* pFileHandle = nullptr;
+
+    /** Handle of the file mapping object. */
+    void* pMappingHandle = nullptr;
+#else
+    /** Descriptor of the opened file. */
+    int iFileDescriptor = -1;
+#endif
+};
@@ -2,6 +2,9 @@
 
 // Standard.
 #include <cmath>
+#include <array>
+#include <cstdint>
+#include <algorithm>
 #include <stdexcept>
 
 // Custom.
@@ -103,6 +106,24 @@ public:
      */
     static inline glm::vec3 normalizeSafely(const glm::vec3& vector);
 
+    /**
+     * Converts an 8 bit sRGB color component to linear space.
+     *
+     * @param iValue Component value.
+     *
+     * @return Linear value in range [0; 1].
+     */
+    static inline float srgbToLinear(uint8_t iValue);
+
+    /**
+     * Converts a linear color component to an 8 bit sRGB value.
+     *
+     * @param value Linear value in range [0; 1] (clamped).
+     *
+     * @return sRGB component value.
+     */
+    static inline uint8_t linearToSrgb(float value);
+
 private:
     /** Default tolerance for floats to use. */
     static inline const float smallFloatEpsilon = 0.0000001F; // NOLINT: not a very small number
@@ -208,3 +229,23 @@ glm::vec3 MathHelpers::normalizeSafely(const glm::vec3& vector) {
 
     return vector * glm::inversesqrt(squareSum);
 }
+
+float MathHelpers::srgbToLinear(uint8_t iValue) {
+    static const auto vTable = []() {
+        std::array<float, 256> vTable{}; // NOLINT: all 8 bit values
+        for (size_t i = 0; i < vTable.size(); i++) {
+            const auto value = static_cast<float>(i) / 255.0F; // NOLINT
+            vTable[i] = value <= 0.04045F ? value / 12.92F                                 // NOLINT
+                                          : std::pow((value + 0.055F) / 1.055F, 2.4F); // NOLINT
+        }
+        return vTable;
+    }();
+
+    return vTable[iValue];
+}
+
+uint8_t MathHelpers::linearToSrgb(float value) {
+    const auto srgb = value <= 0.0031308F ? value * 12.92F                                 // NOLINT
+                                          : 1.055F * std::pow(value, 1.0F / 2.4F) - 0.055F; // NOLINT
+    return static_cast<uint8_t>(std::clamp(std::lround(srgb * 255.0F), 0L, 255L)); // NOLINT
+}
@@ -0,0 +1,108 @@
+#include "FreeListAllocator.h"
+
+// Standard.
+#include <format>
+#include <stdexcept>
+
+FreeListAllocator::FreeListAllocator(size_t iCapacity) : iCapacity(iCapacity) {
+    if (iCapacity > 0) {
+        addFreeBlock(0, iCapacity);
+    }
+}
+
+std::optional<size_t> FreeListAllocator::allocate(size_t iSize) {
+    if (iSize == 0) [[unlikely]] {
+        throw std::runtime_error("unable to allocate a range of zero size");
+    }
+
+    // Find the smallest free block that can fit the range.
+    const auto blockIt = freeBlocksBySize.lower_bound({iSize, 0});
+    if (blockIt == freeBlocksBySize.end()) {
+        return {};
+    }
+    const auto [iBlockSize, iBlockOffset] = *blockIt;
+
+    // Take the beginning of the block and keep the rest free.
+    removeFreeBlock(iBlockOffset, iBlockSize);
+    if (iBlockSize > iSize) {
+        addFreeBlock(iBlockOffset + iSize, iBlockSize - iSize);
+    }
+
+    iUsedSize += iSize;
+    iAllocationCount += 1;
+
+    return iBlockOffset;
+}
+
+void FreeListAllocator::free(size_t iOffset, size_t iSize) {
+    if (iSize == 0 || iOffset + iSize > iCapacity || iSize > iUsedSize || iAllocationCount == 0)
+        [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "unable to free range (offset: {}, size: {}) because it was not allocated", iOffset, iSize));
+    }
+
+    iUsedSize -= iSize;
+    iAllocationCount -= 1;
+
+    // Merge with the next free block (if touching).
+    const auto nextIt = freeBlocksByOffset.lower_bound(iOffset);
+    if (nextIt != freeBlocksByOffset.end() && nextIt->first == iOffset + iSize) {
+        const auto iNextSize = nextIt->second;
+        removeFreeBlock(iOffset + iSize, iNextSize);
+        iSize += iNextSize;
+    }
+
+    // Merge with the previous free block (if touching).
+    const auto previousIt = freeBlocksByOffset.lower_bound(iOffset);
+    if (previousIt != freeBlocksByOffset.begin()) {
+        const auto [iPreviousOffset, iPreviousSize] = *std::prev(previousIt);
+        if (iPreviousOffset + iPreviousSize == iOffset) {
+            removeFreeBlock(iPreviousOffset, iPreviousSize);
+            iOffset = iPreviousOffset;
+            iSize += iPreviousSize;
+        }
+    }
+
+    addFreeBlock(iOffset, iSize);
+}
+
+void FreeListAllocator::grow(size_t iNewCapacity) {
+    if (iNewCapacity <= iCapacity) [[unlikely]] {
+        throw std::runtime_error(
+            std::format("expected new capacity {} to be bigger than {}", iNewCapacity, iCapacity));
+    }
+
+    // Treat new space as a freed range (merges with the last free block if it's touching the end).
+    const auto iOldCapacity = iCapacity;
+    iCapacity = iNewCapacity;
+    iUsedSize += iNewCapacity - iOldCapacity;
+    iAllocationCount += 1;
+    free(iOldCapacity, iNewCapacity - iOldCapacity);
+}
+
+FreeListAllocator::Statistics FreeListAllocator::getStatistics() const {
+    Statistics stats;
+    stats.iCapacity = iCapacity;
+    stats.iUsedSize = iUsedSize;
+    stats.iAllocationCount = iAllocationCount;
+    stats.iFreeBlockCount = freeBlocksByOffset.size();
+    stats.iLargestFreeBlockSize = freeBlocksBySize.empty() ? 0 : freeBlocksBySize.rbegin()->first;
+
+    const auto iFreeSize = iCapacity - iUsedSize;
+    if (iFreeSize > 0) {
+        stats.fragmentation =
+            1.0F - static_cast<float>(stats.iLargestFreeBlockSize) / static_cast<float>(iFreeSize);
+    }
+
+    return stats;
+}
+
+void FreeListAllocator::addFreeBlock(size_t iOffset, size_t iSize) {
+    freeBlocksByOffset[iOffset] = iSize;
+    freeBlocksBySize.insert({iSize, iOffset});
+}
+
+void FreeListAllocator::removeFreeBlock(size_t iOffset, size_t iSize) {
+    freeBlocksByOffset.erase(iOffset);
+    freeBlocksBySize.erase({iSize, iOffset});
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+// Standard.
+#include <map>
+#include <set>
+#include <utility>
+#include <optional>
+
+/**
+ * Manages free/used ranges of some linear storage (such as a GPU buffer) without owning the storage,
+ * uses best-fit search over a list of free blocks and merges neighbour free blocks when a range is freed.
+ *
+ * @remark Offsets and sizes are expressed in abstract units (for example, vertices).
+ */
+class FreeListAllocator {
+public:
+    /** Groups information about memory usage. */
+    struct Statistics {
+        /** Total size of the managed storage. */
+        size_t iCapacity = 0;
+
+        /** Total size of all allocated ranges. */
+        size_t iUsedSize = 0;
+
+        /** Number of allocated ranges. */
+        size_t iAllocationCount = 0;
+
+        /** Number of free blocks (a single block means no fragmentation). */
+        size_t iFreeBlockCount = 0;
+
+        /** Size of the largest free block. */
+        size_t iLargestFreeBlockSize = 0;
+
+        /**
+         * Value in range [0.0F; 1.0F] where 0 means that all free space is in one block and values close
+         * to 1 mean that free space is split into many small blocks.
+         */
+        float fragmentation = 0.0F;
+    };
+
+    /**
+     * Creates a new allocator.
+     *
+     * @param iCapacity Size of the managed storage.
+     */
+    explicit FreeListAllocator(size_t iCapacity);
+
+    /**
+     * Looks for a free range of the specified size.
+     *
+     * @param iSize Size of the range.
+     *
+     * @return Empty if there's no free block big enough (see @ref grow), otherwise offset of the
+     * allocated range.
+     */
+    std::optional<size_t> allocate(size_t iSize);
+
+    /**
+     * Marks the specified range (previously returned by @ref allocate) as free.
+     *
+     * @param iOffset Offset of the range.
+     * @param iSize   Size of the range.
+     */
+    void free(size_t iOffset, size_t iSize);
+
+    /**
+     * Extends the managed storage.
+     *
+     * @param iNewCapacity New size of the managed storage, expected to be bigger than the current one.
+     */
+    void grow(size_t iNewCapacity);
+
+    /**
+     * Returns information about memory usage.
+     *
+     * @return Statistics.
+     */
+    Statistics getStatistics() const;
+
+private:
+    /**
+     * Adds a free block (expects that it does not overlap with or touch other free blocks).
+     *
+     * @param iOffset Offset of the block.
+     * @param iSize   Size of the block.
+     */
+    void addFreeBlock(size_t iOffset, size_t iSize);
+
+    /**
+     * Removes a free block.
+     *
+     * @param iOffset Offset of the block.
+     * @param iSize   Size of the block.
+     */
+    void removeFreeBlock(size_t iOffset, size_t iSize);
+
+    /** Pairs of "offset" - "size" of free blocks (sorted by offset to merge neighbour blocks). */
+    std::map<size_t, size_t> freeBlocksByOffset;
+
+    /** Pairs of "size" - "offset" of free blocks (sorted by size for best-fit search). */
+    std::set<std::pair<size_t, size_t>> freeBlocksBySize;
+
+    /** Total size of the managed storage. */
+    size_t iCapacity = 0;
+
+    /** Total size of all allocated ranges. */
+    size_t iUsedSize = 0;
+
+    /** Number of allocated ranges. */
+    size_t iAllocationCount = 0;
+};
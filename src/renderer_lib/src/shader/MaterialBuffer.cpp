@@ -0,0 +1,155 @@
+#include "MaterialBuffer.h"
+
+// Standard.
+#include <algorithm>
+
+// Custom.
+#include "window/GLFW.hpp"
+#include "shader/StorageBlocks.hpp"
+#include "Mesh.h"
+
+// GLAD is generated without extensions so load `ARB_bindless_texture` functions manually.
+using PFNGLGETTEXTURESAMPLERHANDLEARBPROC = GLuint64(APIENTRYP)(GLuint texture, GLuint sampler);
+using PFNGLMAKETEXTUREHANDLERESIDENTARBPROC = void(APIENTRYP)(GLuint64 handle);
+using PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC = void(APIENTRYP)(GLuint64 handle);
+
+static PFNGLGETTEXTURESAMPLERHANDLEARBPROC glGetTextureSamplerHandleARB = nullptr;
+static PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glMakeTextureHandleResidentARB = nullptr;
+static PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glMakeTextureHandleNonResidentARB = nullptr;
+
+/**
+ * Loads functions of `ARB_bindless_texture` extension.
+ *
+ * @return `false` if the extension is not supported, `true` otherwise.
+ */
+static bool loadBindlessTextureFunctions() {
+    if (glfwExtensionSupported("GL_ARB_bindless_texture") == GLFW_FALSE) {
+        return false;
+    }
+
+    glGetTextureSamplerHandleARB = reinterpret_cast<PFNGLGETTEXTURESAMPLERHANDLEARBPROC>(
+        glfwGetProcAddress("glGetTextureSamplerHandleARB"));
+    glMakeTextureHandleResidentARB = reinterpret_cast<PFNGLMAKETEXTUREHANDLERESIDENTARBPROC>(
+        glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+    glMakeTextureHandleNonResidentARB = reinterpret_cast<PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC>(
+        glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+
+    return glGetTextureSamplerHandleARB != nullptr && glMakeTextureHandleResidentARB != nullptr &&
+           glMakeTextureHandleNonResidentARB != nullptr;
+}
+
+MaterialBuffer::~MaterialBuffer() {
+    clear();
+
+    glDeleteBuffers(1, &iBufferId);
+    glDeleteSamplers(1, &iSamplerId);
+}
+
+std::unique_ptr<MaterialBuffer> MaterialBuffer::create() {
+    auto pBuffer = std::unique_ptr<MaterialBuffer>(new MaterialBuffer());
+
+    // See if we can reference textures without binding them.
+    pBuffer->bUseBindlessTextures = loadBindlessTextureFunctions();
+
+    // Create sampler.
+    glGenSamplers(1, &pBuffer->iSamplerId);
+    const auto iSamplerId = pBuffer->iSamplerId;
+
+    // Set texture wrapping.
+    glSamplerParameteri(iSamplerId, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(iSamplerId, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // Set texture filtering.
+    glSamplerParameteri(iSamplerId, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(
+        iSamplerId,
+        GL_TEXTURE_MAG_FILTER,
+        GL_LINEAR); // no need to set `MIPMAP` option since magnification does not use mipmaps
+
+    // Enable anisotropic texture filtering (core in OpenGL 4.6 which we are using).
+    float maxSupportedAnisotropy = 0.0F;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxSupportedAnisotropy);
+    glSamplerParameterf(iSamplerId, GL_TEXTURE_MAX_ANISOTROPY, maxSupportedAnisotropy);
+
+    // Create an empty buffer.
+    pBuffer->setMaterials({});
+
+    return pBuffer;
+}
+
+void MaterialBuffer::setMaterials(const std::vector<Material*>& vMaterials) {
+    // Previous handles are kept resident since materials are added while a scene is streamed in
+    // (and frames that are still in flight use them).
+
+    // Prepare data (buffer can't have zero size).
+    std::vector<MaterialData> vMaterialData(std::max(vMaterials.size(), size_t(1)));
+    for (size_t i = 0; i < vMaterials.size(); i++) {
+        auto& material = *vMaterials[i];
+        auto& data = vMaterialData[i];
+
+        material.iMaterialIndex = static_cast<unsigned int>(i);
+
+        data.diffuseColor = material.diffuseColor;
+        data.specularColor = material.specularColor;
+        data.shininess = material.shininess;
+
+        if (bUseBindlessTextures) {
+            const auto vTextureIds = material.getTextureIds();
+            data.iDiffuseTextureHandle = makeTextureHandleResident(vTextureIds[0]);
+            data.iNormalTextureHandle = makeTextureHandleResident(vTextureIds[1]);
+            data.iMetallicRoughnessTextureHandle = makeTextureHandleResident(vTextureIds[2]);
+            data.iEmissionTextureHandle = makeTextureHandleResident(vTextureIds[3]); // NOLINT
+        }
+    }
+
+    // Recreate buffer (materials are rarely changed so use immutable storage).
+    glDeleteBuffers(1, &iBufferId);
+    glGenBuffers(1, &iBufferId);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, iBufferId);
+    glBufferStorage(
+        GL_SHADER_STORAGE_BUFFER,
+        static_cast<GLsizeiptr>(vMaterialData.size() * sizeof(MaterialData)),
+        vMaterialData.data(),
+        0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Bind to the binding point so that all shader programs will see it.
+    glBindBufferBase(
+        GL_SHADER_STORAGE_BUFFER, static_cast<unsigned int>(StorageBlockBinding::MATERIAL_DATA), iBufferId);
+}
+
+void MaterialBuffer::clear() {
+    for (const auto& iHandle : residentTextureHandles) {
+        glMakeTextureHandleNonResidentARB(iHandle);
+    }
+    residentTextureHandles.clear();
+}
+
+void MaterialBuffer::releaseTextureHandle(unsigned int iTextureId) {
+    if (!bUseBindlessTextures || iTextureId == 0) {
+        return;
+    }
+
+    const auto iHandle = glGetTextureSamplerHandleARB(iTextureId, iSamplerId);
+    if (residentTextureHandles.erase(iHandle) != 0) {
+        glMakeTextureHandleNonResidentARB(iHandle);
+    }
+}
+
+bool MaterialBuffer::isUsingBindlessTextures() const { return bUseBindlessTextures; }
+
+unsigned int MaterialBuffer::getSamplerId() const { return iSamplerId; }
+
+uint64_t MaterialBuffer::makeTextureHandleResident(unsigned int iTextureId) {
+    if (iTextureId == 0) {
+        return 0;
+    }
+
+    // Same texture + sampler pair always gives the same handle.
+    const auto iHandle = glGetTextureSamplerHandleARB(iTextureId, iSamplerId);
+    if (residentTextureHandles.insert(iHandle).second) {
+        glMakeTextureHandleResidentARB(iHandle);
+    }
+
+    return iHandle;
+}
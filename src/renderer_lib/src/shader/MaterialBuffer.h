@@ -0,0 +1,98 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_set>
+
+struct Material;
+
+/**
+ * Storage buffer with properties of all materials in the scene (indexed by material index of a drawn mesh)
+ * and a sampler object used for all material textures.
+ *
+ * @remark If `ARB_bindless_texture` is supported, the buffer also stores texture handles
+ * so that textures don't need to be bound when drawing, otherwise material textures should be bound
+ * (see @ref Material::bindTextures) to texture units 0-3 that use @ref getSamplerId.
+ */
+class MaterialBuffer {
+public:
+    MaterialBuffer(const MaterialBuffer&) = delete;
+    MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+    ~MaterialBuffer();
+
+    /**
+     * Creates a new empty buffer and a sampler, checks if bindless textures are supported.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @return Created buffer.
+     */
+    static std::unique_ptr<MaterialBuffer> create();
+
+    /**
+     * Replaces all materials in the buffer with the specified ones and assigns
+     * @ref Material::iMaterialIndex of each material.
+     *
+     * @remark Each material is expected to be specified once (materials can be shared between meshes).
+     *
+     * @remark Texture handles of previously specified materials stay resident, call @ref clear before
+     * deleting textures of materials that are in the buffer.
+     *
+     * @param vMaterials Materials to store.
+     */
+    void setMaterials(const std::vector<Material*>& vMaterials);
+
+    /** Removes all materials (makes their bindless texture handles non-resident). */
+    void clear();
+
+    /**
+     * Makes the bindless handle of the specified texture non-resident (if it was made resident).
+     *
+     * @remark Should be called before deleting a texture that is no longer used by materials in the
+     * buffer (for example, when a streamed texture was replaced by a texture with other mip levels).
+     *
+     * @param iTextureId ID of the texture.
+     */
+    void releaseTextureHandle(unsigned int iTextureId);
+
+    /**
+     * Tells if texture handles are stored in the buffer.
+     *
+     * @return `true` if material textures don't need to be bound, `false` otherwise.
+     */
+    bool isUsingBindlessTextures() const;
+
+    /**
+     * Returns sampler object that should be used to sample material textures.
+     *
+     * @return Sampler ID.
+     */
+    unsigned int getSamplerId() const;
+
+private:
+    MaterialBuffer() = default;
+
+    /**
+     * Returns a resident bindless handle of the specified texture (used with @ref iSamplerId).
+     *
+     * @param iTextureId ID of the texture, 0 if not used.
+     *
+     * @return 0 if the texture is not used, otherwise handle.
+     */
+    uint64_t makeTextureHandleResident(unsigned int iTextureId);
+
+    /** Bindless texture handles that were made resident. */
+    std::unordered_set<uint64_t> residentTextureHandles;
+
+    /** ID of the storage buffer. */
+    unsigned int iBufferId = 0;
+
+    /** ID of the sampler object used for material textures. */
+    unsigned int iSamplerId = 0;
+
+    /** `true` if `ARB_bindless_texture` is supported. */
+    bool bUseBindlessTextures = false;
+};
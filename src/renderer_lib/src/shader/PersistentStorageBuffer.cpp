@@ -0,0 +1,134 @@
+#include "PersistentStorageBuffer.h"
+
+// Standard.
+#include <format>
+#include <algorithm>
+
+PersistentStorageBuffer::PersistentStorageBuffer(
+    std::optional<unsigned int> iBindingIndex, size_t iElementSizeInBytes)
+    : iBindingIndex(iBindingIndex), iElementSizeInBytes(iElementSizeInBytes) {}
+
+PersistentStorageBuffer::~PersistentStorageBuffer() {
+    // Wait for the GPU to finish reading all regions before unmapping.
+    for (size_t i = 0; i < iRegionCount; i++) {
+        waitForRegion(i);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, iBufferId);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glDeleteBuffers(1, &iBufferId);
+}
+
+std::unique_ptr<PersistentStorageBuffer> PersistentStorageBuffer::create(
+    std::optional<unsigned int> iBindingIndex, size_t iElementSizeInBytes, size_t iElementCapacity) {
+    if (iElementSizeInBytes == 0 || iElementCapacity == 0) [[unlikely]] {
+        throw std::runtime_error("expected the element size and capacity to be positive");
+    }
+
+    auto pBuffer = std::unique_ptr<PersistentStorageBuffer>(
+        new PersistentStorageBuffer(iBindingIndex, iElementSizeInBytes));
+    pBuffer->allocate(iElementCapacity);
+
+    return pBuffer;
+}
+
+void* PersistentStorageBuffer::mapNextRegion(size_t iElementCount) {
+    // Grow the buffer if needed.
+    if (iElementCount > iElementCapacity) {
+        allocate(std::max(iElementCount, iElementCapacity * 2));
+    }
+
+    // Switch to the next region.
+    iCurrentRegionIndex = (iCurrentRegionIndex + 1) % iRegionCount;
+
+    // Make sure the GPU is no longer reading it.
+    waitForRegion(iCurrentRegionIndex);
+
+    // Bind region.
+    const auto iRegionOffset = getCurrentRegionOffset();
+    if (iBindingIndex.has_value()) {
+        glBindBufferRange(
+            GL_SHADER_STORAGE_BUFFER,
+            *iBindingIndex,
+            iBufferId,
+            static_cast<GLintptr>(iRegionOffset),
+            static_cast<GLsizeiptr>(iRegionSizeInBytes));
+    }
+
+    return pMappedData + iRegionOffset; // NOLINT: pointer arithmetic
+}
+
+void PersistentStorageBuffer::fenceCurrentRegion() {
+    auto& fence = vRegionFences[iCurrentRegionIndex];
+    if (fence != nullptr) [[unlikely]] {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+unsigned int PersistentStorageBuffer::getBufferId() const { return iBufferId; }
+
+size_t PersistentStorageBuffer::getCurrentRegionOffset() const {
+    return iCurrentRegionIndex * iRegionSizeInBytes;
+}
+
+void PersistentStorageBuffer::allocate(size_t iElementCapacity) {
+    // Delete the previous buffer (if existed).
+    if (iBufferId != 0) {
+        for (size_t i = 0; i < iRegionCount; i++) {
+            waitForRegion(i);
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, iBufferId);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glDeleteBuffers(1, &iBufferId);
+        iBufferId = 0;
+    }
+
+    // Region offsets should be a multiple of the offset alignment.
+    int iOffsetAlignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &iOffsetAlignment);
+    const auto iAlignment = static_cast<size_t>(std::max(iOffsetAlignment, 1));
+
+    this->iElementCapacity = iElementCapacity;
+    iRegionSizeInBytes = (iElementCapacity * iElementSizeInBytes + iAlignment - 1) / iAlignment * iAlignment;
+
+    // Create an immutable buffer that will stay mapped while it's used by the GPU.
+    constexpr GLbitfield iFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto iBufferSize = static_cast<GLsizeiptr>(iRegionSizeInBytes * iRegionCount);
+    glGenBuffers(1, &iBufferId);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, iBufferId);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, iBufferSize, nullptr, iFlags);
+    pMappedData = static_cast<char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, iBufferSize, iFlags));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (pMappedData == nullptr) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "failed to persistently map a shader storage buffer of size {} byte(s)", iBufferSize));
+    }
+}
+
+void PersistentStorageBuffer::waitForRegion(size_t iRegionIndex) {
+    auto& fence = vRegionFences[iRegionIndex];
+    if (fence == nullptr) {
+        // The region was not used.
+        return;
+    }
+
+    // Wait for the GPU to finish commands that were submitted before the fence.
+    constexpr GLuint64 iTimeoutInNanoseconds = 1000000; // NOLINT: 1 ms
+    auto iResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, iTimeoutInNanoseconds);
+    while (iResult == GL_TIMEOUT_EXPIRED) {
+        iResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, iTimeoutInNanoseconds);
+    }
+    if (iResult == GL_WAIT_FAILED) [[unlikely]] {
+        throw std::runtime_error("failed to wait for a fence of a shader storage buffer region");
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <memory>
+#include <optional>
+
+// Custom.
+#include "window/GLFW.hpp"
+
+/**
+ * Shader storage buffer that is persistently mapped and split into multiple regions
+ * so that the CPU can write data for the next frame while the GPU is still reading data of previous frames.
+ *
+ * @remark Can also be used to store commands for indirect drawing (see @ref getCurrentRegionOffset).
+ */
+class PersistentStorageBuffer {
+public:
+    PersistentStorageBuffer(const PersistentStorageBuffer&) = delete;
+    PersistentStorageBuffer& operator=(const PersistentStorageBuffer&) = delete;
+
+    ~PersistentStorageBuffer();
+
+    /**
+     * Creates a new buffer.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param iBindingIndex       Index of the shader storage buffer binding point (`binding` from shaders)
+     * to bind regions to, empty if regions should not be bound.
+     * @param iElementSizeInBytes Size of one element (in std430 layout).
+     * @param iElementCapacity    Initial number of elements that one region can store
+     * (the buffer grows if needed).
+     *
+     * @return Created buffer.
+     */
+    static std::unique_ptr<PersistentStorageBuffer> create(
+        std::optional<unsigned int> iBindingIndex, size_t iElementSizeInBytes, size_t iElementCapacity);
+
+    /**
+     * Switches to the next region, waits for the GPU to finish reading it (if needed) and binds it
+     * to the binding point (if specified).
+     *
+     * @remark Call @ref fenceCurrentRegion after the last command that uses the region was submitted.
+     *
+     * @param iElementCount Number of elements that will be written to the region.
+     *
+     * @return Pointer to the beginning of the region to write elements to.
+     */
+    void* mapNextRegion(size_t iElementCount);
+
+    /** Marks the region returned by the last call to @ref mapNextRegion as being used by the GPU. */
+    void fenceCurrentRegion();
+
+    /**
+     * Returns ID of the buffer.
+     *
+     * @remark Changes when the buffer grows in @ref mapNextRegion.
+     *
+     * @return Buffer ID.
+     */
+    unsigned int getBufferId() const;
+
+    /**
+     * Returns offset (in bytes) of the region returned by the last call to @ref mapNextRegion.
+     *
+     * @return Offset from the beginning of the buffer.
+     */
+    size_t getCurrentRegionOffset() const;
+
+private:
+    /**
+     * Initializes the object.
+     *
+     * @param iBindingIndex       Index of the shader storage buffer binding point (if used).
+     * @param iElementSizeInBytes Size of one element.
+     */
+    PersistentStorageBuffer(std::optional<unsigned int> iBindingIndex, size_t iElementSizeInBytes);
+
+    /**
+     * (Re)creates the buffer so that each region can store the specified number of elements.
+     *
+     * @param iElementCapacity Number of elements that one region can store.
+     */
+    void allocate(size_t iElementCapacity);
+
+    /**
+     * Waits for the GPU to finish using the specified region (if it was used).
+     *
+     * @param iRegionIndex Index of the region to wait for.
+     */
+    void waitForRegion(size_t iRegionIndex);
+
+    /** Number of regions (frames in-flight). */
+    static constexpr size_t iRegionCount = 3;
+
+    /** Fences of regions that are (or were) used by the GPU, `nullptr` if not used. */
+    std::array<GLsync, iRegionCount> vRegionFences{};
+
+    /** Pointer to the beginning of the mapped buffer. */
+    char* pMappedData = nullptr;
+
+    /** Index of the shader storage buffer binding point, empty if regions are not bound. */
+    std::optional<unsigned int> iBindingIndex;
+
+    /** ID of the buffer. */
+    unsigned int iBufferId = 0;
+
+    /** Size of one element in bytes. */
+    size_t iElementSizeInBytes = 0;
+
+    /** Number of elements that one region can store. */
+    size_t iElementCapacity = 0;
+
+    /** Size of one region in bytes (aligned to the storage buffer offset alignment). */
+    size_t iRegionSizeInBytes = 0;
+
+    /** Index of the region that was last returned from @ref mapNextRegion. */
+    size_t iCurrentRegionIndex = 0;
+};
@@ -14,6 +14,8 @@ enum class ShaderProgramMacro : unsigned int {
     USE_NORMAL_TEXTURE,
     USE_METALLIC_ROUGHNESS_TEXTURE,
     USE_EMISSION_TEXTURE,
+    USE_BINDLESS_TEXTURES,
+    USE_PACKED_VERTICES,
     // ... new macros go here, DON'T FORGET to add them to `macroToText` function ...
 };
 
@@ -31,6 +33,12 @@ inline std::string macroToText(ShaderProgramMacro macro) {
     case (ShaderProgramMacro::USE_EMISSION_TEXTURE): {
         return "USE_EMISSION_TEXTURE";
     }
+    case (ShaderProgramMacro::USE_BINDLESS_TEXTURES): {
+        return "USE_BINDLESS_TEXTURES";
+    }
+    case (ShaderProgramMacro::USE_PACKED_VERTICES): {
+        return "USE_PACKED_VERTICES";
+    }
     }
 
     throw std::runtime_error("unhandled case");
@@ -10,10 +10,15 @@
 
 /** Provides static helper function for working with shader uniforms. */
 class ShaderUniformHelpers {
-private:
+public:
+    ShaderUniformHelpers() = delete;
+
     /**
      * Returns location of a shader uniform with the specified name.
      *
+     * @remark Prefer to query locations once after the shader program is linked
+     * and use setters that take locations.
+     *
      * @param iShaderProgramId ID of the shader program to query for uniform.
      * @param sUniformName     Name of a uniform.
      *
@@ -28,9 +33,6 @@ private:
         return iLocation;
     }
 
-public:
-    ShaderUniformHelpers() = delete;
-
     /**
      * Sets the specified matrix to a `uniform` with the specified name in shaders.
      *
@@ -80,4 +82,44 @@ public:
     setFloatToShader(unsigned int iShaderProgramId, const std::string& sUniformName, float value) {
         glUniform1f(getUniformLocation(iShaderProgramId, sUniformName), value);
     }
+
+    /**
+     * Sets the specified matrix to a `uniform` with the specified location in the currently used shader.
+     *
+     * @param iUniformLocation Location of the `uniform` to set the matrix to.
+     * @param matrix           Matrix to set.
+     */
+    static inline void setMatrix4ToShader(int iUniformLocation, const glm::mat4x4& matrix) {
+        glUniformMatrix4fv(iUniformLocation, 1, GL_FALSE, glm::value_ptr(matrix));
+    }
+
+    /**
+     * Sets the specified matrix to a `uniform` with the specified location in the currently used shader.
+     *
+     * @param iUniformLocation Location of the `uniform` to set the matrix to.
+     * @param matrix           Matrix to set.
+     */
+    static inline void setMatrix3ToShader(int iUniformLocation, const glm::mat3x3& matrix) {
+        glUniformMatrix3fv(iUniformLocation, 1, GL_FALSE, glm::value_ptr(matrix));
+    }
+
+    /**
+     * Sets the specified vector to a `uniform` with the specified location in the currently used shader.
+     *
+     * @param iUniformLocation Location of the `uniform` to set the vector to.
+     * @param vector           Vector to set.
+     */
+    static inline void setVector3ToShader(int iUniformLocation, const glm::vec3& vector) {
+        glUniform3fv(iUniformLocation, 1, glm::value_ptr(vector));
+    }
+
+    /**
+     * Sets the specified float value to a `uniform` with the specified location in the currently used shader.
+     *
+     * @param iUniformLocation Location of the `uniform` to set the value to.
+     * @param value            Value to set.
+     */
+    static inline void setFloatToShader(int iUniformLocation, float value) {
+        glUniform1f(iUniformLocation, value);
+    }
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <cstdint>
+
+// Custom.
+#include "math/GLMath.hpp"
+
+/** Binding points of shader storage blocks used by shader programs that draw meshes. */
+enum class StorageBlockBinding : unsigned int {
+    MESH_INSTANCE_DATA = 0,
+    MATERIAL_DATA = 1,
+};
+
+/** Mirrors `MeshInstanceData` struct from shaders (std430 layout). */
+struct MeshInstanceData {
+    /** Matrix that transforms positions from model space to world space. */
+    glm::mat4x4 worldMatrix = glm::identity<glm::mat4x4>();
+
+    /** Matrix that transforms normals from model space to world space (only 3x3 part is used). */
+    glm::mat4x4 normalMatrix = glm::identity<glm::mat4x4>();
+
+    /** Index of the mesh's material in the material buffer. */
+    unsigned int iMaterialIndex = 0;
+
+    /** Padding to the std430 alignment of the struct. */
+    std::array<unsigned int, 3> vPadding{};
+};
+static_assert(sizeof(MeshInstanceData) == 144, "update `MeshInstanceData` struct in shaders"); // NOLINT
+
+/** Mirrors `Material` struct from shaders (std430 layout). */
+struct MaterialData {
+    /** Diffuse light color. */
+    glm::vec3 diffuseColor = glm::vec3(1.0F, 1.0F, 1.0F);
+
+    /** Determines how shiny the surface is. */
+    float shininess = 0.0F;
+
+    /** Specular light color. */
+    glm::vec3 specularColor = glm::vec3(1.0F, 1.0F, 1.0F);
+
+    /** Padding to the alignment of texture handles. */
+    float padding = 0.0F;
+
+    /** Bindless handle of the diffuse texture (0 if not used or bindless textures are not supported). */
+    uint64_t iDiffuseTextureHandle = 0;
+
+    /** Bindless handle of the normal texture (0 if not used or bindless textures are not supported). */
+    uint64_t iNormalTextureHandle = 0;
+
+    /** Bindless handle of the metallic-roughness texture (0 if not used or bindless is not supported). */
+    uint64_t iMetallicRoughnessTextureHandle = 0;
+
+    /** Bindless handle of the emission texture (0 if not used or bindless textures are not supported). */
+    uint64_t iEmissionTextureHandle = 0;
+};
+static_assert(sizeof(MaterialData) == 64, "update `Material` struct in shaders"); // NOLINT
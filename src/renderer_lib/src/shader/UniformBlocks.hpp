@@ -0,0 +1,66 @@
+#pragma once
+
+// Standard.
+#include <array>
+
+// Custom.
+#include "math/GLMath.hpp"
+
+/**
+ * Binding points of uniform blocks from `base.glsl` that are shared by all shader programs
+ * used to draw meshes.
+ */
+enum class UniformBlockBinding : unsigned int {
+    FRAME_DATA = 0,
+    LIGHT_DATA = 1,
+};
+
+/** Total number of light sources in the scene (equal to `LIGHT_COUNT` from shaders). */
+inline constexpr size_t iLightSourceCount = 2;
+
+/** Number of spherical harmonics coefficients of environment irradiance (3 bands). */
+inline constexpr size_t iIrradianceCoefficientCount = 9;
+
+/** Mirrors `FrameData` uniform block from shaders (std140 layout). */
+struct FrameUniformData {
+    /** Matrix that transforms positions from world space to projection space. */
+    glm::mat4x4 viewProjectionMatrix = glm::identity<glm::mat4x4>();
+
+    /** Camera's position in world space. */
+    glm::vec3 cameraPositionInWorldSpace = glm::vec3(0.0F, 0.0F, 0.0F);
+
+    /** Ambient lighting intensity. */
+    float ambientLightIntensity = 0.0F;
+
+    /** Portion of environment color that objects should receive. */
+    float environmentIntensity = 0.0F;
+
+    /** Padding to the alignment of `vec4` arrays in std140 layout. */
+    std::array<float, 3> vPadding{};
+
+    /**
+     * Spherical harmonics coefficients (RGB, alpha is unused) of environment irradiance divided by pi
+     * (see @ref EnvironmentLighting).
+     */
+    std::array<glm::vec4, iIrradianceCoefficientCount> vIrradianceCoefficients{};
+};
+static_assert(sizeof(FrameUniformData) == 240, "update `FrameData` block in shaders"); // NOLINT
+
+/** Mirrors `LightSource` struct from shaders (std140 layout). */
+struct LightSourceUniformData {
+    /** Light source position in world space. */
+    glm::vec3 position = glm::vec3(0.0F, 0.0F, 0.0F);
+
+    /** Light intensity. */
+    float intensity = 0.0F;
+
+    /** Color of the light source. */
+    glm::vec3 color = glm::vec3(0.0F, 0.0F, 0.0F);
+
+    /** Distance where the light intensity is half the maximal intensity. */
+    float distance = 0.0F;
+};
+static_assert(sizeof(LightSourceUniformData) == 32, "update `LightSource` struct in shaders"); // NOLINT
+
+/** Mirrors `LightData` uniform block from shaders (std140 layout). */
+using LightUniformData = std::array<LightSourceUniformData, iLightSourceCount>;
@@ -0,0 +1,46 @@
+#include "UniformBuffer.h"
+
+// Standard.
+#include <format>
+#include <stdexcept>
+
+// Custom.
+#include "window/GLFW.hpp"
+
+UniformBuffer::UniformBuffer(unsigned int iBufferId, size_t iSizeInBytes)
+    : iBufferId(iBufferId), iSizeInBytes(iSizeInBytes) {}
+
+UniformBuffer::~UniformBuffer() { glDeleteBuffers(1, &iBufferId); }
+
+std::unique_ptr<UniformBuffer> UniformBuffer::create(unsigned int iBindingIndex, size_t iSizeInBytes) {
+    // Create buffer.
+    unsigned int iBufferId = 0;
+    glGenBuffers(1, &iBufferId);
+
+    // Allocate memory.
+    glBindBuffer(GL_UNIFORM_BUFFER, iBufferId);
+    glBufferData(
+        GL_UNIFORM_BUFFER,
+        static_cast<GLsizeiptr>(iSizeInBytes),
+        nullptr,
+        GL_DYNAMIC_DRAW); // `DYNAMIC` because the data will be updated every frame
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Bind to the binding point so that all shader programs will see it.
+    glBindBufferBase(GL_UNIFORM_BUFFER, iBindingIndex, iBufferId);
+
+    return std::unique_ptr<UniformBuffer>(new UniformBuffer(iBufferId, iSizeInBytes));
+}
+
+void UniformBuffer::copyData(const void* pData, size_t iSizeInBytes) const {
+    if (iSizeInBytes > this->iSizeInBytes) [[unlikely]] {
+        throw std::runtime_error(std::format(
+            "unable to copy {} byte(s) to a uniform buffer of size {} byte(s)",
+            iSizeInBytes,
+            this->iSizeInBytes));
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, iBufferId);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(iSizeInBytes), pData);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Standard.
+#include <memory>
+
+/** Buffer that stores data of a uniform block and is bound to a fixed binding point. */
+class UniformBuffer {
+public:
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    ~UniformBuffer();
+
+    /**
+     * Creates a new uniform buffer and binds it to the specified binding point.
+     *
+     * @remark Expects that OpenGL is initialized.
+     *
+     * @param iBindingIndex Index of the uniform buffer binding point (`binding` from shaders).
+     * @param iSizeInBytes  Size of the buffer.
+     *
+     * @return Created buffer.
+     */
+    static std::unique_ptr<UniformBuffer> create(unsigned int iBindingIndex, size_t iSizeInBytes);
+
+    /**
+     * Copies the specified data to the beginning of the buffer.
+     *
+     * @param pData        Data to copy.
+     * @param iSizeInBytes Size of the data, expected to not exceed the size of the buffer.
+     */
+    void copyData(const void* pData, size_t iSizeInBytes) const;
+
+    /**
+     * Copies the specified object to the beginning of the buffer.
+     *
+     * @param data Data to copy.
+     */
+    template <typename T> void copyData(const T& data) const { copyData(&data, sizeof(T)); }
+
+private:
+    /**
+     * Initializes the object.
+     *
+     * @param iBufferId     ID of the created buffer.
+     * @param iSizeInBytes  Size of the buffer.
+     */
+    UniformBuffer(unsigned int iBufferId, size_t iSizeInBytes);
+
+    /** ID of the buffer. */
+    unsigned int iBufferId = 0;
+
+    /** Size of the buffer in bytes. */
+    size_t iSizeInBytes = 0;
+};
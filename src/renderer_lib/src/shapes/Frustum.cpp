@@ -53,3 +53,14 @@ bool Frustum::isAabbInFrustum(const AABB& aabbInModelSpace, const glm::mat4x4& w
            aabb.isIntersectsOrInFrontOfPlane(topFace) && aabb.isIntersectsOrInFrontOfPlane(bottomFace) &&
            aabb.isIntersectsOrInFrontOfPlane(nearFace) && aabb.isIntersectsOrInFrontOfPlane(farFace);
 }
+
+bool Frustum::isSphereInFrustum(const glm::vec3& center, float radius) const {
+    // The sphere is outside if it's fully behind any face.
+    for (const auto* pFace : {&leftFace, &rightFace, &topFace, &bottomFace, &nearFace, &farFace}) {
+        if (glm::dot(pFace->normal, center) - pFace->distanceFromOrigin < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -18,6 +18,17 @@ struct Frustum {
      */
     bool isAabbInFrustum(const AABB& aabbInModelSpace, const glm::mat4x4& worldMatrix) const;
 
+    /**
+     * Tests if the specified sphere is inside of the frustum or intersects it.
+     *
+     * @param center Center of the sphere in world space.
+     * @param radius Radius of the sphere in world space.
+     *
+     * @return `true` if the sphere is inside of the frustum or intersects it, `false` if the sphere
+     * is outside of the frustum.
+     */
+    bool isSphereInFrustum(const glm::vec3& center, float radius) const;
+
     /** Top face of the frustum that points inside of the frustum volume. */
     Plane topFace;
 
@@ -0,0 +1,65 @@
+#include "ThreadPool.h"
+
+// Standard.
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t iThreadCount) {
+    vThreads.reserve(iThreadCount);
+    for (size_t i = 0; i < iThreadCount; i++) {
+        vThreads.push_back(std::thread(&ThreadPool::workerThread, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock guard(mtxTasks);
+        bIsShuttingDown = true;
+    }
+    cvTaskAdded.notify_all();
+
+    for (auto& thread : vThreads) {
+        thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::get() {
+    // Hardware concurrency might be unknown (zero).
+    static ThreadPool threadPool(std::max(std::thread::hardware_concurrency(), 1U));
+    return threadPool;
+}
+
+std::future<void> ThreadPool::addTask(std::function<void()> task) {
+    std::packaged_task<void()> packagedTask(std::move(task));
+    auto future = packagedTask.get_future();
+
+    {
+        std::scoped_lock guard(mtxTasks);
+        tasks.push(std::move(packagedTask));
+    }
+    cvTaskAdded.notify_one();
+
+    return future;
+}
+
+size_t ThreadPool::getThreadCount() const { return vThreads.size(); }
+
+void ThreadPool::workerThread() {
+    while (true) {
+        std::packaged_task<void()> task;
+
+        {
+            // Wait for a task.
+            std::unique_lock guard(mtxTasks);
+            cvTaskAdded.wait(guard, [this]() { return bIsShuttingDown || !tasks.empty(); });
+            if (bIsShuttingDown) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        // Exceptions are stored in the future of the task.
+        task();
+    }
+}
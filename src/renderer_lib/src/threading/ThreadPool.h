@@ -0,0 +1,71 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+
+/** Fixed number of worker threads that execute submitted tasks. */
+class ThreadPool {
+public:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** Waits for already started tasks to finish and stops worker threads. */
+    ~ThreadPool();
+
+    /**
+     * Creates a static thread pool (with one worker per hardware thread) on the first call
+     * and returns it.
+     *
+     * @return Singleton.
+     */
+    static ThreadPool& get();
+
+    /**
+     * Adds a task to be executed on a worker thread.
+     *
+     * @param task Task to execute.
+     *
+     * @return Future that becomes ready when the task is finished, rethrows exceptions of the task
+     * on `get`.
+     */
+    std::future<void> addTask(std::function<void()> task);
+
+    /**
+     * Returns the number of worker threads.
+     *
+     * @return Thread count.
+     */
+    size_t getThreadCount() const;
+
+private:
+    /**
+     * Starts worker threads.
+     *
+     * @param iThreadCount Number of worker threads to start.
+     */
+    ThreadPool(size_t iThreadCount);
+
+    /** Executes tasks until the pool is shutting down. */
+    void workerThread();
+
+    /** Guards @ref tasks and @ref bIsShuttingDown. */
+    std::mutex mtxTasks;
+
+    /** Tasks waiting to be executed. */
+    std::queue<std::packaged_task<void()>> tasks;
+
+    /** `true` if worker threads should exit. */
+    bool bIsShuttingDown = false;
+
+    /** Notified when a new task is added or the pool is shutting down. */
+    std::condition_variable cvTaskAdded;
+
+    /** Worker threads. */
+    std::vector<std::thread> vThreads;
+};
@@ -27,18 +27,32 @@ public:
     /**
      * Creates a static GLFW instance and return instance if not created before.
      *
+     * @param bHeadless `true` to initialize GLFW without a display so that created windows are invisible
+     * and use an offscreen OpenGL context, only considered on the first call.
+     *
      * @return Singleton.
      */
-    static GLFW& get() {
-        static GLFW glfw;
+    static GLFW& get(bool bHeadless = false) {
+        static GLFW glfw(bHeadless);
         return glfw;
     }
 
 private:
-    /** Initializes GLFW. */
-    GLFW() {
+    /**
+     * Initializes GLFW.
+     *
+     * @param bHeadless `true` to initialize GLFW without a display.
+     */
+    GLFW(bool bHeadless) {
         glfwSetErrorCallback(glfwErrorCallback);
 
+#if defined(GLFW_PLATFORM_NULL)
+        if (bHeadless) {
+            // Don't connect to a display server (we might not have one on build machines).
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+#endif
+
         if (glfwInit() != GLFW_TRUE) {
             throw std::runtime_error("failed to initialize GLFW");
         }
@@ -50,5 +64,11 @@ private:
 #if defined(DEBUG)
         glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 #endif
+
+        if (bHeadless) {
+            // Use an offscreen context that does not need a GPU or a display (OSMesa/llvmpipe).
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        }
     }
 };
@@ -6,6 +6,8 @@
 // Custom.
 #include "Application.h"
 #include "import/TextureImporter.h"
+#include "import/MeshCache.h"
+#include "import/TextureCompressor.h"
 
 // External.
 #include "imgui.h"
@@ -16,6 +18,26 @@ class ImGuiWindow {
 public:
     ImGuiWindow() = delete;
 
+    /**
+     * Queues ImGui widgets that display memory usage of an allocator.
+     *
+     * @param pTitle Title of the allocator.
+     * @param stats  Statistics of the allocator.
+     */
+    static inline void drawAllocatorStats(const char* pTitle, const FreeListAllocator::Statistics& stats) {
+        ImGui::Text("%s:", pTitle);
+        ImGui::Text(
+            "  used: %zu / %zu in %zu allocation(s)",
+            stats.iUsedSize,
+            stats.iCapacity,
+            stats.iAllocationCount);
+        ImGui::Text(
+            "  free blocks: %zu, largest: %zu, fragmentation: %.1f%%",
+            stats.iFreeBlockCount,
+            stats.iLargestFreeBlockSize,
+            stats.fragmentation * 100.0F); // NOLINT
+    }
+
     /**
      * Queues ImGui widgets to be drawn.
      *
@@ -38,6 +60,12 @@ public:
             ImGui::SeparatorText("Import");
 
             ImGui::Checkbox("flip textures vertically", &TextureImporter::bFlipTexturesVertically);
+            ImGui::SameLine();
+            ImGui::Checkbox("use mesh cache", &MeshCache::bIsEnabled);
+            ImGui::SameLine();
+            ImGui::Checkbox("compress textures", &TextureCompressor::bIsEnabled);
+            ImGui::SameLine();
+            ImGui::Checkbox("use packed vertices", pApp->getUsePackedVertices());
 
             if (ImGui::Button("select GLTF/GLB file to display")) {
                 const auto vPickedPaths = pfd::open_file(
@@ -47,7 +75,17 @@ public:
                                               pfd::opt::none)
                                               .result();
                 if (!vPickedPaths.empty()) {
-                    pApp->prepareScene(vPickedPaths[0]);
+                    pApp->loadSceneAsync(vPickedPaths[0]);
+                }
+            }
+
+            const auto optionalImportProgress = pApp->getSceneImportProgress();
+            if (optionalImportProgress.has_value()) {
+                ImGui::ProgressBar(
+                    *optionalImportProgress, ImVec2(ImGui::GetFontSize() * 15.0F, 0.0F)); // NOLINT
+                ImGui::SameLine();
+                if (ImGui::Button("cancel import")) {
+                    pApp->cancelSceneImport();
                 }
             }
 
@@ -59,6 +97,10 @@ public:
 
             ImGui::PushItemWidth(ImGui::GetFontSize() * 15.0F);                                      // NOLINT
             ImGui::SliderFloat2("model pitch / yaw", pApp->getModelRotationToApply(), 0.0F, 360.0F); // NOLINT
+            ImGui::SliderFloat("LOD error (px)", pApp->getLodPixelErrorThreshold(), 0.0F, 10.0F); // NOLINT
+            ImGui::Checkbox("cull mesh clusters", pApp->getUseClusterCulling());
+            ImGui::SliderInt(
+                "video memory budget (MB)", pApp->getVideoMemoryBudgetInMb(), 64, 8192); // NOLINT
 
             ImGui::SeparatorText("Lighting");
 
@@ -81,6 +123,71 @@ public:
 
             ImGui::Text("FPS: %zu", pApp->getProfilingStats()->iFramesPerSecond);
             ImGui::Text("Culled objects: %zu", pApp->getProfilingStats()->iCulledObjectsLastFrame);
+            ImGui::Text("Culled clusters: %zu", pApp->getProfilingStats()->iCulledClustersLastFrame);
+            ImGui::Text("Loaded textures: %zu", pApp->getLoadedTextureCount());
+            constexpr double bytesInMb = 1024.0 * 1024.0; // NOLINT
+            ImGui::Text(
+                "Pending texture uploads: %.1f MB",
+                static_cast<double>(pApp->getPendingTextureUploadSize()) / bytesInMb);
+
+            const auto* const pTextureStreamer = pApp->getTextureStreamer();
+            const auto iTextureSize = pTextureStreamer->getResidentSizeInBytes();
+            const auto iGeometrySize = pApp->getGeometrySizeInBytes();
+            ImGui::Text(
+                "Video memory: %.1f / %d MB (textures: %.1f MB, geometry: %.1f MB)",
+                static_cast<double>(iTextureSize + iGeometrySize) / bytesInMb,
+                *pApp->getVideoMemoryBudgetInMb(),
+                static_cast<double>(iTextureSize) / bytesInMb,
+                static_cast<double>(iGeometrySize) / bytesInMb);
+            ImGui::Text(
+                "Tracked textures: %zu (streamed: %zu), released to stay within budget: %.1f MB",
+                pTextureStreamer->getTextureCount(),
+                pTextureStreamer->getStreamedTextureCount(),
+                static_cast<double>(pTextureStreamer->getReleasedSizeInBytes()) / bytesInMb);
+
+            const auto& importStats = pApp->getProfilingStats()->lastImport;
+            ImGui::Text(
+                "Last import (%zu worker threads%s):",
+                importStats.iWorkerThreadCount,
+                importStats.bIsLoadedFromCache ? ", from mesh cache" : "");
+            ImGui::Text(
+                "meshes: %zu, drawn instances: %zu",
+                importStats.iMeshCount,
+                importStats.iMeshInstanceCount);
+            ImGui::Text(
+                "parse: %.1f ms, decode images: %.1f ms, decode primitives: %.1f ms, upload: %.1f ms",
+                importStats.parseTimeInMs,
+                importStats.imageDecodeTimeInMs,
+                importStats.primitiveDecodeTimeInMs,
+                importStats.uploadTimeInMs);
+            if (!importStats.bIsLoadedFromCache) {
+                ImGui::Text(
+                    "vertex cache optimization: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                    importStats.vertexCacheBeforeOptimization.getAcmr(),
+                    importStats.vertexCacheAfterOptimization.getAcmr(),
+                    importStats.vertexCacheBeforeOptimization.getAtvr(),
+                    importStats.vertexCacheAfterOptimization.getAtvr());
+            }
+
+            ImGui::Text("Levels of detail (max error relative to mesh radius, imported / drawn triangles):");
+            for (size_t i = 0; i < MeshOptimizer::iMaxLodCount; i++) {
+                ImGui::Text(
+                    "LOD %zu (%.3f): %zu / %zu",
+                    i,
+                    i == 0 ? 0.0F : MeshOptimizer::vLodMaxErrors[i - 1],
+                    importStats.vLodTriangleCounts[i],
+                    pApp->getProfilingStats()->vDrawnTrianglesPerLodLastFrame[i]);
+            }
+
+            const auto geometryStats = pApp->getGeometryBufferStats(VertexFormat::FULL);
+            drawAllocatorStats("Vertex buffer (vertices)", geometryStats.vertices);
+            drawAllocatorStats("Index buffer (32-bit indices)", geometryStats.indices);
+            drawAllocatorStats("Index buffer (16-bit indices)", geometryStats.shortIndices);
+
+            const auto packedGeometryStats = pApp->getGeometryBufferStats(VertexFormat::PACKED);
+            drawAllocatorStats("Packed vertex buffer (vertices)", packedGeometryStats.vertices);
+            drawAllocatorStats("Packed index buffer (32-bit indices)", packedGeometryStats.indices);
+            drawAllocatorStats("Packed index buffer (16-bit indices)", packedGeometryStats.shortIndices);
         }
 
         ImGui::End();